@@ -0,0 +1,99 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <claraparabricks/genomeworks/utils/lock_free_producer_consumer.hpp>
+#include <claraparabricks/genomeworks/utils/threadsafe_containers.hpp>
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+template <typename ProducerConsumer>
+static void BM_ProducerConsumer(benchmark::State& state)
+{
+    const std::int32_t number_of_producers             = state.range(0);
+    const std::int32_t number_of_consumers             = state.range(1);
+    const std::int64_t number_of_elements_per_producer = 1'000'000 / number_of_producers;
+
+    for (auto _ : state)
+    {
+        std::unique_ptr<ProducerConsumer> producer_consumer(new ProducerConsumer());
+
+        std::vector<std::thread> producer_threads;
+        std::vector<std::thread> consumer_threads;
+
+        for (std::int32_t consumer_id = 0; consumer_id < number_of_consumers; ++consumer_id)
+        {
+            consumer_threads.emplace_back([&producer_consumer]() {
+                std::int64_t sum = 0;
+                while (auto val = producer_consumer->get_next_element())
+                {
+                    sum += val.value();
+                }
+                benchmark::DoNotOptimize(sum);
+            });
+        }
+
+        for (std::int32_t producer_id = 0; producer_id < number_of_producers; ++producer_id)
+        {
+            producer_threads.emplace_back([&producer_consumer, number_of_elements_per_producer]() {
+                for (std::int64_t i = 0; i < number_of_elements_per_producer; ++i)
+                {
+                    producer_consumer->add_new_element(i);
+                }
+            });
+        }
+
+        for (std::thread& producer_thread : producer_threads)
+        {
+            producer_thread.join();
+        }
+        producer_consumer->signal_pushed_last_element();
+        for (std::thread& consumer_thread : consumer_threads)
+        {
+            consumer_thread.join();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * number_of_elements_per_producer * number_of_producers);
+}
+
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, ThreadsafeProducerConsumer<std::int64_t>)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->RangeMultiplier(4)
+    ->Ranges({{1, 16}, {1, 16}});
+
+BENCHMARK_TEMPLATE(BM_ProducerConsumer, LockFreeProducerConsumer<std::int64_t>)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->RangeMultiplier(4)
+    ->Ranges({{1, 16}, {1, 16}});
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
+
+BENCHMARK_MAIN();
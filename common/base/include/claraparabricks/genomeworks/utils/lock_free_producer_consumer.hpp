@@ -0,0 +1,562 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#else
+#include <condition_variable>
+#include <mutex>
+#endif
+
+#include <claraparabricks/genomeworks/types.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace details
+{
+
+/// assumed size of cache line, used to keep frequently written atomics on separate cache lines
+constexpr std::size_t cache_line_size = 64;
+
+/// EventCount - lets threads sleep until a condition that is checked without a lock might have changed
+///
+/// Waiting is done in three steps: prepare_wait() returns the current epoch, the waiter then checks its condition once more and
+/// either calls cancel_wait() if the condition is fulfilled or commit_wait() otherwise. commit_wait() returns as soon as notify_one()
+/// or notify_all() has been called after prepare_wait(), so no notification can get lost between checking the condition and going to sleep.
+///
+/// Notifying is cheap if nobody is waiting. On Linux threads sleep on a futex, otherwise a mutex and a condition_variable are used
+class EventCount
+{
+public:
+    /// \brief constructor
+    EventCount()
+        : epoch_(0)
+        , number_of_waiters_(0)
+    {
+    }
+
+    /// \brief deleted copy constructor
+    /// \param rhs
+    EventCount(const EventCount& rhs) = delete;
+
+    /// \brief deleted copy assignment operator
+    /// \param rhs
+    EventCount& operator=(const EventCount& rhs) = delete;
+
+    /// \brief registers the calling thread as a waiter, the condition has to be checked again after this call
+    /// \return epoch to pass to commit_wait()
+    std::uint32_t prepare_wait()
+    {
+        number_of_waiters_.fetch_add(1, std::memory_order_seq_cst);
+        return epoch_.load(std::memory_order_seq_cst);
+    }
+
+    /// \brief unregisters the calling thread if the condition got fulfilled after prepare_wait()
+    void cancel_wait()
+    {
+        number_of_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// \brief sleeps until notify_one() or notify_all() is called, unless it has already been called after prepare_wait()
+    /// \param epoch value returned by prepare_wait()
+    void commit_wait(const std::uint32_t epoch)
+    {
+#ifdef __linux__
+        while (epoch_.load(std::memory_order_acquire) == epoch)
+        {
+            // returns immediately if epoch_ has already been changed, spurious wakeups are handled by the loop
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAIT_PRIVATE, epoch, nullptr, nullptr, 0);
+        }
+#else
+        std::unique_lock<std::mutex> ul(mutex_);
+        while (epoch_.load(std::memory_order_acquire) == epoch)
+        {
+            condition_variable_.wait(ul);
+        }
+#endif
+        number_of_waiters_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /// \brief wakes one thread that called prepare_wait() before this call
+    ///
+    /// Threads that have not gone to sleep yet return from commit_wait() immediately, so waking up one sleeping thread
+    /// is enough to guarantee that one waiter rechecks its condition
+    void notify_one()
+    {
+        notify(1);
+    }
+
+    /// \brief wakes all threads that called prepare_wait() before this call
+    void notify_all()
+    {
+        notify(INT32_MAX);
+    }
+
+private:
+    /// \brief increments the epoch and wakes up to number_of_threads sleeping threads, does nothing if there are no waiters
+    /// \param number_of_threads
+    void notify(const std::int32_t number_of_threads)
+    {
+        // pairs with the seq_cst increment in prepare_wait(): either the waiter sees the change of the condition or this thread sees the waiter
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (number_of_waiters_.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+#ifdef __linux__
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch_), FUTEX_WAKE_PRIVATE, number_of_threads, nullptr, nullptr, 0);
+#else
+        {
+            std::lock_guard<std::mutex> lg(mutex_);
+            epoch_.fetch_add(1, std::memory_order_seq_cst);
+        }
+        if (number_of_threads == 1)
+        {
+            condition_variable_.notify_one();
+        }
+        else
+        {
+            condition_variable_.notify_all();
+        }
+#endif
+    }
+
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "futex requires std::atomic<std::uint32_t> to have the same layout as std::uint32_t");
+
+    /// incremented on every notification that has waiters
+    std::atomic<std::uint32_t> epoch_;
+    /// number of threads between prepare_wait() and commit_wait()/cancel_wait()
+    std::atomic<std::int32_t> number_of_waiters_;
+#ifndef __linux__
+    /// mutex for condition_variable_
+    std::mutex mutex_;
+    /// condition_variable to sleep on
+    std::condition_variable condition_variable_;
+#endif
+};
+
+} // namespace details
+
+/// LockFreeProducerConsumer - bounded lock-free multi-producer multi-consumer queue with an option to signal that there will be no new elements
+///
+/// Has the same interface and semantics as ThreadsafeProducerConsumer, but elements are stored in a ring buffer of fixed capacity
+/// (Dmitry Vyukov's bounded MPMC queue). Adding and taking elements does not take any lock, each operation is a CAS on the producer
+/// or consumer position plus a store into the cell. Producers wait if the queue is full, consumers wait if it is empty.
+/// Threads spin for a short while before going to sleep and are only woken up (through a futex on Linux) if somebody is sleeping.
+///
+/// Producers add elements using add_new_element(), consumers consume elements in the order the were added using get_next_element().
+/// T has to be default constructible and move assignable.
+/// One producer can signal that there are not going to be any new elements using signal_pushed_last_element(). After this is done and all elements
+/// have been consumed get_next_element() returns empty optionals indicating that there is not going to be any new data and consumers can carry on
+template <typename T>
+class LockFreeProducerConsumer
+{
+public:
+    /// \brief Constructor
+    /// \param capacity max number of elements in the queue, rounded up to the next power of two (at least 2)
+    explicit LockFreeProducerConsumer(const std::size_t capacity = 1024)
+        : capacity_(round_up_to_power_of_two(capacity))
+        , cells_(new Cell[capacity_])
+        , enqueue_position_(0)
+        , dequeue_position_(0)
+        , number_of_active_producers_(0)
+        , pushed_last_element_(false)
+    {
+        for (std::size_t i = 0; i < capacity_; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /// \brief deleted copy constructor
+    /// \param rhs
+    LockFreeProducerConsumer(const LockFreeProducerConsumer& rhs) = delete;
+
+    /// \brief deleted copy assignment operator
+    /// \param rhs
+    LockFreeProducerConsumer& operator=(const LockFreeProducerConsumer& rhs) = delete;
+
+    /// \brief deleted move constructor
+    /// \param rhs
+    LockFreeProducerConsumer(LockFreeProducerConsumer&& rhs) = delete;
+
+    /// \brief deleted move assignment operator
+    /// \param rhs
+    LockFreeProducerConsumer& operator=(LockFreeProducerConsumer&& rhs) = delete;
+
+    /// \brief destructor, destroys all elements that have not been consumed
+    ~LockFreeProducerConsumer()
+    {
+        T element;
+        while (try_get_next_element(element))
+        {
+        }
+    }
+
+    /// \brief returns the capacity of the queue
+    /// \return the capacity of the queue
+    std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    /// \brief adds an element to the queue
+    ///
+    /// If the queue is full waits for consumers to make space
+    ///
+    /// \param element element to add
+    /// \throw std::logic_error if called after signal_pushed_last_element() has been called by any producer
+    void add_new_element(const T& element)
+    {
+        add_new_element(T(element));
+    }
+
+    /// \brief adds an element to the queue
+    ///
+    /// If the queue is full waits for consumers to make space
+    ///
+    /// \param element element to add
+    /// \throw std::logic_error if called after signal_pushed_last_element() has been called by any producer
+    void add_new_element(T&& element)
+    {
+        // consumers only report the end of data once there are no active producers, so an element added concurrently with
+        // signal_pushed_last_element() is either rejected or consumed, but never lost
+        ActiveProducerGuard active_producer_guard(*this);
+        throw_if_pushed_last_element();
+
+        while (!try_add_new_element_spinning(element))
+        {
+            const std::uint32_t epoch = space_available_.prepare_wait();
+            if (try_add_new_element(element))
+            {
+                space_available_.cancel_wait();
+                break;
+            }
+            if (pushed_last_element_.load(std::memory_order_seq_cst))
+            {
+                space_available_.cancel_wait();
+                throw_if_pushed_last_element();
+            }
+            space_available_.commit_wait(epoch);
+        }
+        // consumers get notified by active_producer_guard
+    }
+
+    /// \brief tells container that no new elements are going to be added
+    ///
+    /// After this method has been called and all elements have been consumed get_next_element() will be returning
+    /// empty optionals to indicate that there will be no new elements and that consumers can finish processing
+    ///
+    /// \throw std::logic_error if called after any producer has already called this method
+    void signal_pushed_last_element()
+    {
+        if (pushed_last_element_.exchange(true, std::memory_order_seq_cst))
+        {
+            throw std::logic_error("LockFreeProducerConsumer: called signal_pushed_last_element() more than once");
+        }
+        element_available_.notify_all();
+        space_available_.notify_all();
+    }
+
+    /// \brief gets the next element
+    ///
+    /// If no element is available waits for an element to become available
+    /// If no element is available and signal_pushed_last_element() has already been called returns an empty optional
+    ///
+    /// \return optional, either with the value or empty if no element available and signal_pushed_last_element() has been called
+    gw_optional_t<T> get_next_element()
+    {
+        T element;
+        while (!try_get_next_element_spinning(element))
+        {
+            const std::uint32_t epoch = element_available_.prepare_wait();
+            if (try_get_next_element(element))
+            {
+                element_available_.cancel_wait();
+                break;
+            }
+            const EndOfDataCheck end_of_data_check = check_end_of_data(element);
+            if (end_of_data_check == EndOfDataCheck::no_elements_left)
+            {
+                element_available_.cancel_wait();
+                return gw_nullopt;
+            }
+            if (end_of_data_check == EndOfDataCheck::element_taken)
+            {
+                element_available_.cancel_wait();
+                break;
+            }
+            element_available_.commit_wait(epoch);
+        }
+
+        // producers only wait if the queue is full, waking them up after every element would mean one syscall per element,
+        // so they are woken once the queue is half empty. Consumers keep consuming until the queue is empty so this point is always reached
+        const std::intptr_t number_of_elements = static_cast<std::intptr_t>(enqueue_position_.value.load(std::memory_order_relaxed)) -
+                                                 static_cast<std::intptr_t>(dequeue_position_.value.load(std::memory_order_relaxed));
+        if (number_of_elements <= static_cast<std::intptr_t>(capacity_ / 2))
+        {
+            space_available_.notify_one();
+        }
+        return gw_optional_t<T>(std::move(element));
+    }
+
+    /// \brief adds an element if there is space in the queue, never blocks
+    ///
+    /// Unlike add_new_element() does not check if signal_pushed_last_element() has been called and does not wake waiting consumers
+    ///
+    /// \param element element to add, moved from only if the function returns true
+    /// \return true if element has been added
+    bool try_add_new_element(T& element)
+    {
+        std::size_t position = enqueue_position_.value.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell                 = cells_[position & (capacity_ - 1)];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff   = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position);
+            if (diff == 0)
+            {
+                if (enqueue_position_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    new (&cell.storage) T(std::move(element));
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+                // position has been updated by compare_exchange_weak
+            }
+            else if (diff < 0)
+            {
+                // queue is full
+                return false;
+            }
+            else
+            {
+                position = enqueue_position_.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// \brief takes the next element if there is one, never blocks
+    /// \param element output, the next element
+    /// \return true if an element has been taken
+    bool try_get_next_element(T& element)
+    {
+        std::size_t position = dequeue_position_.value.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell& cell                 = cells_[position & (capacity_ - 1)];
+            const std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            const std::intptr_t diff   = static_cast<std::intptr_t>(sequence) - static_cast<std::intptr_t>(position + 1);
+            if (diff == 0)
+            {
+                if (dequeue_position_.value.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    T* const stored_element = reinterpret_cast<T*>(&cell.storage);
+                    element                 = std::move(*stored_element);
+                    stored_element->~T();
+                    cell.sequence.store(position + capacity_, std::memory_order_release);
+                    return true;
+                }
+                // position has been updated by compare_exchange_weak
+            }
+            else if (diff < 0)
+            {
+                // queue is empty
+                return false;
+            }
+            else
+            {
+                position = dequeue_position_.value.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    /// number of attempts before a thread goes to sleep
+    static constexpr std::int32_t number_of_spins = 64;
+
+    /// EndOfDataCheck - result of check_end_of_data()
+    enum class EndOfDataCheck
+    {
+        element_taken,    ///< an element has been added in the meantime and has been taken
+        no_elements_left, ///< signal_pushed_last_element() has been called and all elements have been consumed
+        keep_waiting      ///< new elements can still be added
+    };
+
+    /// Cell - one slot of the ring buffer
+    struct Cell
+    {
+        /// position for which this cell is ready to be written to (== position) or read from (== position + 1)
+        std::atomic<std::size_t> sequence;
+        /// uninitialized storage for the element
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    };
+
+    /// PaddedPosition - position on a cache line of its own, producers and consumers do not invalidate each other's cache lines
+    struct PaddedPosition
+    {
+        PaddedPosition(const std::size_t initial_value)
+            : value(initial_value)
+        {
+        }
+
+        char padding_before[details::cache_line_size];
+        std::atomic<std::size_t> value;
+        char padding_after[details::cache_line_size - sizeof(std::atomic<std::size_t>)];
+    };
+
+    /// ActiveProducerGuard - counts producers currently inside add_new_element() and wakes consumers when a producer leaves it
+    ///
+    /// Consumers are woken only after the producer has been unregistered, otherwise a consumer could see an active producer,
+    /// go to sleep and never be woken up if that producer leaves add_new_element() after signal_pushed_last_element()
+    class ActiveProducerGuard
+    {
+    public:
+        ActiveProducerGuard(LockFreeProducerConsumer& queue)
+            : queue_(queue)
+        {
+            queue_.number_of_active_producers_.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        ~ActiveProducerGuard()
+        {
+            queue_.number_of_active_producers_.fetch_sub(1, std::memory_order_seq_cst);
+            if (queue_.pushed_last_element_.load(std::memory_order_seq_cst))
+            {
+                // all consumers might be waiting for the last producer to leave
+                queue_.element_available_.notify_all();
+            }
+            else
+            {
+                queue_.element_available_.notify_one();
+            }
+        }
+
+    private:
+        LockFreeProducerConsumer& queue_;
+    };
+
+    /// \brief rounds up to the next power of two, at least 2
+    /// \param value
+    /// \return rounded value
+    static std::size_t round_up_to_power_of_two(const std::size_t value)
+    {
+        std::size_t rounded_value = 2;
+        while (rounded_value < value)
+        {
+            rounded_value *= 2;
+        }
+        return rounded_value;
+    }
+
+    /// \brief calls try_add_new_element() up to number_of_spins times
+    bool try_add_new_element_spinning(T& element)
+    {
+        for (std::int32_t i = 0; i < number_of_spins; ++i)
+        {
+            if (try_add_new_element(element))
+            {
+                return true;
+            }
+            // let the other side make progress if there are more threads than cores
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    /// \brief calls try_get_next_element() up to number_of_spins times
+    bool try_get_next_element_spinning(T& element)
+    {
+        for (std::int32_t i = 0; i < number_of_spins; ++i)
+        {
+            if (try_get_next_element(element))
+            {
+                return true;
+            }
+            // let the other side make progress if there are more threads than cores
+            std::this_thread::yield();
+        }
+        return false;
+    }
+
+    /// \brief checks if signal_pushed_last_element() has been called and all elements have been consumed
+    ///
+    /// Only reports the end of data if there are no producers in add_new_element(). Queue is checked again after that, and if
+    /// an element has been added in the meantime it is taken and returned through element.
+    ///
+    /// \param element output, set if the function returns EndOfDataCheck::element_taken
+    /// \return EndOfDataCheck::element_taken if an element has been taken, EndOfDataCheck::no_elements_left if there will be no new elements,
+    ///         EndOfDataCheck::keep_waiting otherwise
+    EndOfDataCheck check_end_of_data(T& element)
+    {
+        if (!pushed_last_element_.load(std::memory_order_seq_cst) || number_of_active_producers_.load(std::memory_order_seq_cst) != 0)
+        {
+            return EndOfDataCheck::keep_waiting;
+        }
+        // an element might have been added just before the producer left add_new_element()
+        return try_get_next_element(element) ? EndOfDataCheck::element_taken : EndOfDataCheck::no_elements_left;
+    }
+
+    /// \brief throws if signal_pushed_last_element() has been called
+    /// \throw std::logic_error
+    void throw_if_pushed_last_element() const
+    {
+        if (pushed_last_element_.load(std::memory_order_seq_cst))
+        {
+            throw std::logic_error("LockFreeProducerConsumer: pushed an element after signal_pushed_last_element() has been called");
+        }
+    }
+
+    /// number of cells, power of two
+    const std::size_t capacity_;
+    /// ring buffer
+    std::unique_ptr<Cell[]> cells_;
+    /// position the next element will be written to
+    PaddedPosition enqueue_position_;
+    /// position the next element will be read from
+    PaddedPosition dequeue_position_;
+    /// number of producers in add_new_element()
+    std::atomic<std::int32_t> number_of_active_producers_;
+    /// set by signal_pushed_last_element()
+    std::atomic<bool> pushed_last_element_;
+    /// consumers wait on this if the queue is empty
+    details::EventCount element_available_;
+    /// producers wait on this if the queue is full
+    details::EventCount space_available_;
+};
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
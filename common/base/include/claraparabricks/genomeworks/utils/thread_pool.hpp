@@ -0,0 +1,190 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <claraparabricks/genomeworks/utils/threadsafe_containers.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+/// ThreadPool - fixed number of threads which execute submitted tasks in the order they were submitted
+///
+/// Threads are created once and reused, so submitting a task does not pay the cost of creating a thread.
+/// Tasks should not block waiting for other tasks submitted to the same pool, use TaskGroup for that.
+class ThreadPool
+{
+public:
+    /// \brief Constructor
+    /// \param number_of_threads number of threads in the pool, 0 means number of hardware threads
+    /// \param cpu_affinity if not empty i-th thread is pinned to CPU cpu_affinity[i % cpu_affinity.size()], ignored on platforms without thread affinity support
+    explicit ThreadPool(std::int32_t number_of_threads                = 0,
+                        const std::vector<std::int32_t>& cpu_affinity = {});
+
+    /// \brief deleted copy constructor
+    /// \param rhs
+    ThreadPool(const ThreadPool& rhs) = delete;
+
+    /// \brief deleted copy assignment operator
+    /// \param rhs
+    ThreadPool& operator=(const ThreadPool& rhs) = delete;
+
+    /// \brief deleted move constructor
+    /// \param rhs
+    ThreadPool(ThreadPool&& rhs) = delete;
+
+    /// \brief deleted move assignment operator
+    /// \param rhs
+    ThreadPool& operator=(ThreadPool&& rhs) = delete;
+
+    /// \brief destructor, executes all tasks that have already been submitted and joins the threads
+    ~ThreadPool();
+
+    /// \brief returns the number of threads in the pool
+    /// \return the number of threads in the pool
+    std::int32_t number_of_threads() const;
+
+    /// \brief submits a task
+    /// \param function function to execute
+    /// \param args arguments to pass to the function, they are copied (use std::ref to pass references)
+    /// \return future with the return value of the function, exceptions thrown by the function get rethrown by future::get()
+    template <typename Function, typename... Args>
+    std::future<typename std::result_of<typename std::decay<Function>::type(typename std::decay<Args>::type...)>::type> submit(Function&& function, Args&&... args)
+    {
+        using result_t               = typename std::result_of<typename std::decay<Function>::type(typename std::decay<Args>::type...)>::type;
+        auto task                    = std::make_shared<std::packaged_task<result_t()>>(std::bind(std::forward<Function>(function), std::forward<Args>(args)...));
+        std::future<result_t> result = task->get_future();
+        submit_detached([task]() { (*task)(); });
+        return result;
+    }
+
+    /// \brief submits a task without a way to wait for it, the task must not throw
+    /// \param task
+    void submit_detached(std::function<void()> task);
+
+private:
+    /// \brief executes tasks until the pool gets destroyed
+    void thread_function();
+
+    /// tasks waiting to be executed
+    ThreadsafeProducerConsumer<std::function<void()>> tasks_;
+    /// threads executing the tasks
+    std::vector<std::thread> threads_;
+};
+
+/// TaskGroup - set of tasks executed on a ThreadPool which can be waited for together
+///
+/// wait() does not only wait, it also executes the tasks of this group which have not been picked up by the pool yet.
+/// This way a thread can wait for a group even when all threads of the pool are busy, and waiting never executes
+/// tasks that belong to some other group.
+///
+/// run() can be called from multiple threads, including from tasks of the group itself.
+class TaskGroup
+{
+public:
+    /// \brief Constructor
+    /// \param thread_pool pool to execute the tasks on
+    explicit TaskGroup(ThreadPool& thread_pool);
+
+    /// \brief deleted copy constructor
+    /// \param rhs
+    TaskGroup(const TaskGroup& rhs) = delete;
+
+    /// \brief deleted copy assignment operator
+    /// \param rhs
+    TaskGroup& operator=(const TaskGroup& rhs) = delete;
+
+    /// \brief deleted move constructor
+    /// \param rhs
+    TaskGroup(TaskGroup&& rhs) = delete;
+
+    /// \brief deleted move assignment operator
+    /// \param rhs
+    TaskGroup& operator=(TaskGroup&& rhs) = delete;
+
+    /// \brief destructor, waits for all tasks, exceptions are not rethrown
+    ~TaskGroup();
+
+    /// \brief submits a task to the group
+    /// \param task
+    void run(std::function<void()> task);
+
+    /// \brief waits for all tasks of the group to finish
+    ///
+    /// Tasks which have not been started yet are executed by the calling thread. Tasks added by other tasks of this group while waiting are waited for as well.
+    ///
+    /// \throw rethrows the first exception thrown by any of the tasks
+    void wait();
+
+private:
+    /// GroupTask - a task which is executed either by the pool or by wait(), whichever takes it first
+    struct GroupTask
+    {
+        std::function<void()> function;
+        std::atomic<bool> taken{false};
+    };
+
+    /// \brief executes the task, the caller has to set task.taken first
+    /// \param task
+    void execute(GroupTask& task);
+
+    /// pool to execute tasks on
+    ThreadPool& thread_pool_;
+    /// tasks submitted since last wait()
+    std::vector<std::shared_ptr<GroupTask>> tasks_;
+    /// number of tasks that have not finished yet
+    std::int64_t number_of_unfinished_tasks_;
+    /// first exception thrown by a task
+    std::exception_ptr first_exception_;
+    /// mutex for tasks_, number_of_unfinished_tasks_ and first_exception_
+    std::mutex mutex_;
+    /// signaled when a task gets added or finishes
+    std::condition_variable state_changed_;
+};
+
+/// \brief creates the process-wide thread pool
+///
+/// Has to be called before first call to get_global_thread_pool(), if it is never called the pool is created with default parameters
+///
+/// \param number_of_threads number of threads in the pool, 0 means number of hardware threads
+/// \param cpu_affinity CPUs to pin threads to, see ThreadPool::ThreadPool()
+/// \throw std::logic_error if the pool has already been created
+void initialize_global_thread_pool(std::int32_t number_of_threads,
+                                   const std::vector<std::int32_t>& cpu_affinity = {});
+
+/// \brief returns the process-wide thread pool, creates it with default parameters if it does not exist yet
+/// \return the process-wide thread pool
+ThreadPool& get_global_thread_pool();
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
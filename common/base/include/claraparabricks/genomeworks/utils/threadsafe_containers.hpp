@@ -16,11 +16,16 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <deque>
-#include <exception>
+#include <functional>
 #include <mutex>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include <claraparabricks/genomeworks/types.hpp>
@@ -92,6 +97,25 @@ private:
     std::atomic<std::size_t> counter_;
 };
 
+/// ThreadsafeProducerConsumerStatistics - queue depth and wait time statistics collected by ThreadsafeProducerConsumer
+struct ThreadsafeProducerConsumerStatistics
+{
+    /// number of elements added to the queue so far
+    std::int64_t number_of_added_elements = 0;
+    /// largest number of elements that have been in the queue at the same time
+    std::int64_t max_number_of_elements = 0;
+    /// largest total size of elements that have been in the queue at the same time, as reported by element size function (0 if no size function)
+    std::int64_t max_number_of_bytes = 0;
+    /// number of times a producer had to wait for consumers to make space in the queue
+    std::int64_t number_of_producer_waits = 0;
+    /// number of times try_add_new_element() did not add an element because the queue was full
+    std::int64_t number_of_rejected_elements = 0;
+    /// total time producers have spent waiting for consumers to make space in the queue
+    std::chrono::nanoseconds producer_wait_time = std::chrono::nanoseconds(0);
+    /// total time consumers have spent waiting for elements to become available
+    std::chrono::nanoseconds consumer_wait_time = std::chrono::nanoseconds(0);
+};
+
 /// ThreadsafeProducerConsumer - a threadsafe implementation of producer-consumer pattern with an option to signal that there will be no new elements
 ///
 /// Producers add elements using add_new_element(), consumers consume elements in the order the were added using get_next_element().
@@ -99,17 +123,50 @@ private:
 ///
 /// One producer can signal that there are not going to be any new elements using signal_pushed_last_element(). After this is done and all elements
 /// have been consumed get_next_element() returns empty optionals indicating that there is not going to be any new data and consumers can carry on
+///
+/// Capacity of the queue can optionally be limited by the number of elements and/or by the total size of elements in bytes. If adding an element would
+/// exceed the capacity add_new_element() blocks until consumers make enough space. An element is always accepted if the queue is empty, even if it is
+/// larger than the byte limit on its own, so producers can never deadlock.
 template <typename T>
 class ThreadsafeProducerConsumer
 {
 public:
-    /// \brief default constructor
+    /// function which returns the (approximate) size of an element in bytes
+    using element_size_function_t = std::function<std::int64_t(const T&)>;
+
+    /// \brief default constructor, capacity of the queue is not limited
     ThreadsafeProducerConsumer()
+        : ThreadsafeProducerConsumer(0)
+    {
+    }
+
+    /// \brief Constructor
+    /// \param max_number_of_elements max number of elements in the queue, 0 means no limit
+    /// \param max_number_of_bytes max total size of elements in the queue in bytes, 0 means no limit
+    /// \param element_size function returning size of an element in bytes, required if max_number_of_bytes is not 0, optional otherwise (if set max_number_of_bytes in statistics gets collected)
+    /// \throw std::invalid_argument if limits are negative or max_number_of_bytes is set without element_size
+    explicit ThreadsafeProducerConsumer(const std::int64_t max_number_of_elements,
+                                        const std::int64_t max_number_of_bytes = 0,
+                                        element_size_function_t element_size   = nullptr)
         : data_()
+        , max_number_of_elements_(max_number_of_elements)
+        , max_number_of_bytes_(max_number_of_bytes)
+        , element_size_(std::move(element_size))
+        , number_of_bytes_(0)
         , pushed_last_element_(false)
+        , statistics_()
         , mutex_()
         , condition_variable_()
+        , space_available_condition_variable_()
     {
+        if (max_number_of_elements_ < 0 || max_number_of_bytes_ < 0)
+        {
+            throw std::invalid_argument("ThreadsafeProducerConsumer: capacity limits must not be negative");
+        }
+        if (max_number_of_bytes_ > 0 && !element_size_)
+        {
+            throw std::invalid_argument("ThreadsafeProducerConsumer: max_number_of_bytes set without element_size function");
+        }
     }
 
     /// \brief deleted copy constructor
@@ -133,38 +190,68 @@ public:
 
     /// \brief adds an element to the queue
     ///
+    /// If the queue is full waits for consumers to make space
+    ///
+    /// \param element element to add
+    /// \throw std::logic_error if called after signal_pushed_last_element() has been called by any producer
+    void add_new_element(const T& element)
+    {
+        add_new_element(T(element));
+    }
+
+    /// \brief adds an element to the queue
+    ///
+    /// If the queue is full waits for consumers to make space
+    ///
     /// \param element element to add
     /// \throw std::logic_error if called after signal_pushed_last_element() has been called by any producer
-    void add_new_element(const T& element) // not using reference in order to support both rvalue and lvalue
+    void add_new_element(T&& element)
     {
-        // consider adding max number of elements and waiting for consumer to process an element before adding a new one
+        // calculate the size outside of the critical section as it might be expensive
+        const std::int64_t element_size = element_size_ ? element_size_(element) : 0;
         {
-            std::lock_guard<std::mutex> lg(mutex_);
-            if (pushed_last_element_)
+            std::unique_lock<std::mutex> ul(mutex_);
+            throw_if_pushed_last_element();
+
+            if (!has_space_for(element_size))
             {
-                throw std::logic_error("ThreadsafeProducerConsumer: pushed an element after signal_pushed_last_element() has been called");
+                ++statistics_.number_of_producer_waits;
+                const auto wait_start = std::chrono::steady_clock::now();
+                while (!has_space_for(element_size) && !pushed_last_element_)
+                {
+                    space_available_condition_variable_.wait(ul);
+                }
+                statistics_.producer_wait_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wait_start);
+                throw_if_pushed_last_element();
             }
-            data_.push_front(element);
+
+            push_front(std::move(element), element_size);
         }
         condition_variable_.notify_one();
     }
 
-    /// \brief adds an element to the queue
+    /// \brief adds an element to the queue if there is space for it, never waits
     ///
-    /// \param element element to add
+    /// \param element element to add, only moved from if it has been added
+    /// \return true if the element has been added, false if the queue was full
     /// \throw std::logic_error if called after signal_pushed_last_element() has been called by any producer
-    void add_new_element(T&& element) // not using reference in order to support both rvalue and lvalue
+    bool try_add_new_element(T& element)
     {
-        // consider adding max number of elements and waiting for consumer to process an element before adding a new one
+        const std::int64_t element_size = element_size_ ? element_size_(element) : 0;
         {
             std::lock_guard<std::mutex> lg(mutex_);
-            if (pushed_last_element_)
+            throw_if_pushed_last_element();
+
+            if (!has_space_for(element_size))
             {
-                throw std::logic_error("ThreadsafeProducerConsumer: pushed an element after signal_pushed_last_element() has been called");
+                ++statistics_.number_of_rejected_elements;
+                return false;
             }
-            data_.push_front(std::move(element));
+
+            push_front(std::move(element), element_size);
         }
         condition_variable_.notify_one();
+        return true;
     }
 
     /// \brief tells container that no new elements are going to be added
@@ -184,6 +271,7 @@ public:
             pushed_last_element_ = true;
         }
         condition_variable_.notify_all();
+        space_available_condition_variable_.notify_all();
     }
 
     /// \brief gets the next element
@@ -194,35 +282,100 @@ public:
     /// \return optional, either with the value or empty if no element available and signal_pushed_last_element() has been called
     gw_optional_t<T> get_next_element()
     {
-        std::unique_lock<std::mutex> ul(mutex_);
-
-        while (data_.empty() && !pushed_last_element_)
+        gw_optional_t<T> res = gw_nullopt;
         {
-            condition_variable_.wait(ul);
+            std::unique_lock<std::mutex> ul(mutex_);
+
+            if (data_.empty() && !pushed_last_element_)
+            {
+                const auto wait_start = std::chrono::steady_clock::now();
+                while (data_.empty() && !pushed_last_element_)
+                {
+                    condition_variable_.wait(ul);
+                }
+                statistics_.consumer_wait_time += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wait_start);
+            }
+
+            const bool no_elements_left = pushed_last_element_ && data_.empty();
+            if (no_elements_left)
+            {
+                return gw_nullopt;
+            }
+
+            res = std::move(data_.back().first);
+            number_of_bytes_ -= data_.back().second;
+            data_.pop_back();
         }
+        space_available_condition_variable_.notify_one();
+        return res;
+    }
 
-        const bool no_elements_left = pushed_last_element_ && data_.empty();
-        if (no_elements_left)
+    /// \brief returns statistics collected so far
+    /// \return statistics collected so far
+    ThreadsafeProducerConsumerStatistics get_statistics() const
+    {
+        std::lock_guard<std::mutex> lg(mutex_);
+        return statistics_;
+    }
+
+private:
+    /// \brief checks if an element of given size can be added without exceeding the capacity, expects mutex_ to be locked
+    /// \param element_size
+    /// \return true if element can be added
+    bool has_space_for(const std::int64_t element_size) const
+    {
+        if (data_.empty())
         {
-            return gw_nullopt;
+            return true;
         }
-        else
+        const bool too_many_elements = max_number_of_elements_ > 0 && static_cast<std::int64_t>(data_.size()) >= max_number_of_elements_;
+        const bool too_many_bytes    = max_number_of_bytes_ > 0 && number_of_bytes_ + element_size > max_number_of_bytes_;
+        return !too_many_elements && !too_many_bytes;
+    }
+
+    /// \brief adds the element to data_ and updates statistics, expects mutex_ to be locked
+    /// \param element
+    /// \param element_size
+    void push_front(T&& element, const std::int64_t element_size)
+    {
+        data_.emplace_front(std::move(element), element_size);
+        number_of_bytes_ += element_size;
+
+        ++statistics_.number_of_added_elements;
+        statistics_.max_number_of_elements = std::max(statistics_.max_number_of_elements, static_cast<std::int64_t>(data_.size()));
+        statistics_.max_number_of_bytes    = std::max(statistics_.max_number_of_bytes, number_of_bytes_);
+    }
+
+    /// \brief throws if signal_pushed_last_element() has been called, expects mutex_ to be locked
+    /// \throw std::logic_error
+    void throw_if_pushed_last_element() const
+    {
+        if (pushed_last_element_)
         {
-            gw_optional_t<T> res = std::move(data_.back());
-            data_.pop_back();
-            return res;
+            throw std::logic_error("ThreadsafeProducerConsumer: pushed an element after signal_pushed_last_element() has been called");
         }
     }
 
-private:
-    /// data
-    std::deque<T> data_;
+    /// data and size of each element
+    std::deque<std::pair<T, std::int64_t>> data_;
+    /// max number of elements in data_, 0 means no limit
+    const std::int64_t max_number_of_elements_;
+    /// max total size of elements in data_, 0 means no limit
+    const std::int64_t max_number_of_bytes_;
+    /// returns the size of an element, can be empty
+    const element_size_function_t element_size_;
+    /// total size of all elements in data_
+    std::int64_t number_of_bytes_;
     /// if true no new calls to signal_pushed_last_element() is called
     bool pushed_last_element_;
-    /// mutex for condition_variable_
-    std::mutex mutex_;
+    /// statistics
+    ThreadsafeProducerConsumerStatistics statistics_;
+    /// mutex for condition_variable_ and space_available_condition_variable_
+    mutable std::mutex mutex_;
     /// condition_variable to wait on if there are no available elements
     std::condition_variable condition_variable_;
+    /// condition_variable to wait on if there is no space for new elements
+    std::condition_variable space_available_condition_variable_;
 };
 
 } // namespace genomeworks
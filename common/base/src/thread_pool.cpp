@@ -0,0 +1,236 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <algorithm>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <claraparabricks/genomeworks/logging/logging.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace
+{
+
+/// \brief pins thread to one CPU
+/// \param thread
+/// \param cpu_id
+void set_thread_affinity(std::thread& thread, const std::int32_t cpu_id)
+{
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(cpu_id, &cpu_set);
+    if (pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpu_set) != 0)
+    {
+        GW_LOG_WARN("Could not pin thread pool thread to CPU {}", cpu_id);
+    }
+#else
+    static_cast<void>(thread);
+    static_cast<void>(cpu_id);
+#endif
+}
+
+/// process-wide thread pool
+std::unique_ptr<ThreadPool> global_thread_pool = nullptr;
+/// protects global_thread_pool
+std::mutex global_thread_pool_mutex;
+
+} // namespace
+
+ThreadPool::ThreadPool(std::int32_t number_of_threads,
+                       const std::vector<std::int32_t>& cpu_affinity)
+    : tasks_()
+    , threads_()
+{
+    if (number_of_threads < 0)
+    {
+        throw std::invalid_argument("ThreadPool: number_of_threads must not be negative");
+    }
+    if (number_of_threads == 0)
+    {
+        number_of_threads = std::max(static_cast<std::int32_t>(std::thread::hardware_concurrency()), 1);
+    }
+
+    threads_.reserve(number_of_threads);
+    for (std::int32_t i = 0; i < number_of_threads; ++i)
+    {
+        threads_.emplace_back(&ThreadPool::thread_function, this);
+        if (!cpu_affinity.empty())
+        {
+            set_thread_affinity(threads_.back(), cpu_affinity[i % cpu_affinity.size()]);
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    tasks_.signal_pushed_last_element();
+    for (std::thread& thread : threads_)
+    {
+        thread.join();
+    }
+}
+
+std::int32_t ThreadPool::number_of_threads() const
+{
+    return static_cast<std::int32_t>(threads_.size());
+}
+
+void ThreadPool::submit_detached(std::function<void()> task)
+{
+    tasks_.add_new_element(std::move(task));
+}
+
+void ThreadPool::thread_function()
+{
+    gw_optional_t<std::function<void()>> task;
+    while (task = tasks_.get_next_element()) // if optional is empty the pool is being destroyed and all tasks have been executed
+    {
+        task.value()();
+    }
+}
+
+TaskGroup::TaskGroup(ThreadPool& thread_pool)
+    : thread_pool_(thread_pool)
+    , tasks_()
+    , number_of_unfinished_tasks_(0)
+    , first_exception_(nullptr)
+    , mutex_()
+    , state_changed_()
+{
+}
+
+TaskGroup::~TaskGroup()
+{
+    try
+    {
+        wait();
+    }
+    catch (...)
+    {
+        // destructor must not throw, exception is lost if wait() has not been called explicitly
+    }
+}
+
+void TaskGroup::run(std::function<void()> task)
+{
+    auto group_task      = std::make_shared<GroupTask>();
+    group_task->function = std::move(task);
+    {
+        std::lock_guard<std::mutex> lg(mutex_);
+        ++number_of_unfinished_tasks_;
+        tasks_.push_back(group_task);
+    }
+    state_changed_.notify_all();
+    thread_pool_.submit_detached([this, group_task]() {
+        // if wait() has already taken the task this group might not exist anymore
+        if (!group_task->taken.exchange(true))
+        {
+            execute(*group_task);
+        }
+    });
+}
+
+void TaskGroup::wait()
+{
+    std::unique_lock<std::mutex> ul(mutex_);
+    while (number_of_unfinished_tasks_ > 0)
+    {
+        if (tasks_.empty())
+        {
+            state_changed_.wait(ul);
+            continue;
+        }
+
+        // execute tasks the pool has not started yet, including tasks added by other tasks of this group
+        std::vector<std::shared_ptr<GroupTask>> tasks;
+        tasks.swap(tasks_);
+        ul.unlock();
+        for (const std::shared_ptr<GroupTask>& task : tasks)
+        {
+            if (!task->taken.exchange(true))
+            {
+                execute(*task);
+            }
+        }
+        ul.lock();
+    }
+
+    if (first_exception_)
+    {
+        std::exception_ptr exception = first_exception_;
+        first_exception_             = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+void TaskGroup::execute(GroupTask& task)
+{
+    std::exception_ptr exception = nullptr;
+    try
+    {
+        task.function();
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+    task.function = nullptr; // release captured resources as soon as possible
+
+    std::lock_guard<std::mutex> lg(mutex_);
+    if (exception && !first_exception_)
+    {
+        first_exception_ = exception;
+    }
+    --number_of_unfinished_tasks_;
+    state_changed_.notify_all();
+}
+
+void initialize_global_thread_pool(const std::int32_t number_of_threads,
+                                   const std::vector<std::int32_t>& cpu_affinity)
+{
+    std::lock_guard<std::mutex> lg(global_thread_pool_mutex);
+    if (global_thread_pool)
+    {
+        throw std::logic_error("initialize_global_thread_pool: global thread pool has already been created");
+    }
+    global_thread_pool.reset(new ThreadPool(number_of_threads, cpu_affinity));
+}
+
+ThreadPool& get_global_thread_pool()
+{
+    std::lock_guard<std::mutex> lg(global_thread_pool_mutex);
+    if (!global_thread_pool)
+    {
+        global_thread_pool.reset(new ThreadPool());
+    }
+    return *global_thread_pool;
+}
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
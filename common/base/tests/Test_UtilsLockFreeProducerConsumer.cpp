@@ -0,0 +1,368 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <claraparabricks/genomeworks/utils/lock_free_producer_consumer.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+void test_lock_free_producer_consumer(const std::int32_t number_of_elements,
+                                      const std::int32_t number_of_producers,
+                                      const std::int32_t number_of_consumers,
+                                      const std::size_t capacity)
+{
+    ASSERT_GT(number_of_elements, 0);
+    ASSERT_GT(number_of_producers, 0);
+    ASSERT_GT(number_of_consumers, 0);
+    const std::int32_t number_of_elements_per_producer = number_of_elements / number_of_producers;
+
+    LockFreeProducerConsumer<std::int32_t> producer_consumer(capacity);
+
+    std::mutex occurrences_per_element_mutex;
+    std::vector<std::int32_t> occurrences_per_element(number_of_elements, 0);
+    std::atomic<bool> order_within_producer_preserved(true);
+
+    std::vector<std::thread> producer_threads;
+    std::vector<std::thread> consumer_threads;
+
+    for (std::int32_t producer_id = 0; producer_id < number_of_producers; ++producer_id)
+    {
+        producer_threads.push_back(std::thread([&producer_consumer, producer_id, number_of_elements_per_producer]() {
+            const std::int32_t producer_offset = producer_id * number_of_elements_per_producer;
+            for (std::int32_t i = 0; i < number_of_elements_per_producer; ++i)
+            {
+                producer_consumer.add_new_element(producer_offset + i);
+            }
+        }));
+    }
+
+    for (std::int32_t consumer_id = 0; consumer_id < number_of_consumers; ++consumer_id)
+    {
+        consumer_threads.push_back(std::thread([&producer_consumer,
+                                                &occurrences_per_element,
+                                                &occurrences_per_element_mutex,
+                                                &order_within_producer_preserved,
+                                                number_of_producers,
+                                                number_of_elements_per_producer]() {
+            // every consumer should see elements of one producer in the order they were added
+            std::vector<std::int32_t> last_seen_per_producer(number_of_producers, -1);
+            while (true)
+            {
+                gw_optional_t<std::int32_t> val = producer_consumer.get_next_element();
+                if (!val) // reached the end
+                {
+                    break;
+                }
+                const std::int32_t producer_id = val.value() / number_of_elements_per_producer;
+                if (val.value() <= last_seen_per_producer[producer_id])
+                {
+                    order_within_producer_preserved = false;
+                }
+                last_seen_per_producer[producer_id] = val.value();
+                std::lock_guard<std::mutex> lg(occurrences_per_element_mutex);
+                occurrences_per_element[val.value()]++;
+            }
+        }));
+    }
+
+    for (std::thread& producer_thread : producer_threads)
+    {
+        producer_thread.join();
+    }
+    producer_consumer.signal_pushed_last_element();
+    for (std::thread& consumer_thread : consumer_threads)
+    {
+        consumer_thread.join();
+    }
+
+    ASSERT_TRUE(order_within_producer_preserved);
+    ASSERT_TRUE(std::all_of(std::begin(occurrences_per_element),
+                            std::begin(occurrences_per_element) + number_of_elements_per_producer * number_of_producers,
+                            [](const std::int32_t val) {
+                                return val == 1;
+                            }));
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, single_producer_single_consumer)
+{
+    test_lock_free_producer_consumer(1'000'000, 1, 1, 1024);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, multiple_producers_multiple_consumers)
+{
+    test_lock_free_producer_consumer(10'000'000, 16, 32, 1024);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, multiple_producers_multiple_consumers_small_capacity)
+{
+    // producers and consumers constantly wait for each other
+    test_lock_free_producer_consumer(1'000'000, 8, 8, 2);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, more_producers_than_consumers)
+{
+    test_lock_free_producer_consumer(1'000'000, 32, 2, 64);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, signal_while_producers_add_and_consumers_wait)
+{
+    // producers pause regularly so consumers go to sleep, signal_pushed_last_element() is called while elements are still being added
+    // and every element that has been added successfully has to be consumed exactly once
+    const std::int32_t number_of_rounds                = 500;
+    const std::int32_t number_of_producers             = 4;
+    const std::int32_t number_of_consumers             = 8;
+    const std::int32_t number_of_elements_per_producer = 64;
+    const std::int32_t number_of_elements              = number_of_producers * number_of_elements_per_producer;
+
+    for (std::int32_t round = 0; round < number_of_rounds; ++round)
+    {
+        LockFreeProducerConsumer<std::int32_t> producer_consumer(16);
+        std::vector<std::int32_t> added_per_element(number_of_elements, 0);
+        std::atomic<std::int32_t> number_of_added_elements(0);
+        std::vector<std::atomic<std::int32_t>> occurrences_per_element(number_of_elements);
+        for (std::atomic<std::int32_t>& occurrences : occurrences_per_element)
+        {
+            occurrences = 0;
+        }
+
+        std::vector<std::thread> producer_threads;
+        std::vector<std::thread> consumer_threads;
+        for (std::int32_t consumer_id = 0; consumer_id < number_of_consumers; ++consumer_id)
+        {
+            consumer_threads.push_back(std::thread([&producer_consumer, &occurrences_per_element]() {
+                while (gw_optional_t<std::int32_t> val = producer_consumer.get_next_element())
+                {
+                    occurrences_per_element[val.value()]++;
+                }
+            }));
+        }
+        for (std::int32_t producer_id = 0; producer_id < number_of_producers; ++producer_id)
+        {
+            producer_threads.push_back(std::thread([&producer_consumer, &added_per_element, &number_of_added_elements, producer_id, number_of_elements_per_producer]() {
+                for (std::int32_t i = 0; i < number_of_elements_per_producer; ++i)
+                {
+                    if (i % 8 == 0)
+                    {
+                        std::this_thread::sleep_for(std::chrono::microseconds(50));
+                    }
+                    const std::int32_t element = producer_id * number_of_elements_per_producer + i;
+                    try
+                    {
+                        producer_consumer.add_new_element(element);
+                    }
+                    catch (const std::logic_error&)
+                    {
+                        break;
+                    }
+                    added_per_element[element] = 1;
+                    ++number_of_added_elements;
+                }
+            }));
+        }
+
+        // signal at a different point of the production in every round
+        while (number_of_added_elements < round % (number_of_elements / 2))
+        {
+            std::this_thread::yield();
+        }
+        producer_consumer.signal_pushed_last_element();
+        for (std::thread& producer_thread : producer_threads)
+        {
+            producer_thread.join();
+        }
+        for (std::thread& consumer_thread : consumer_threads)
+        {
+            consumer_thread.join();
+        }
+
+        for (std::int32_t element = 0; element < number_of_elements; ++element)
+        {
+            ASSERT_EQ(occurrences_per_element[element], added_per_element[element]) << "round " << round << ", element " << element;
+        }
+    }
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, capacity_rounded_up_to_power_of_two)
+{
+    ASSERT_EQ(LockFreeProducerConsumer<std::int32_t>(0).capacity(), 2u);
+    ASSERT_EQ(LockFreeProducerConsumer<std::int32_t>(1).capacity(), 2u);
+    ASSERT_EQ(LockFreeProducerConsumer<std::int32_t>(8).capacity(), 8u);
+    ASSERT_EQ(LockFreeProducerConsumer<std::int32_t>(9).capacity(), 16u);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, try_add_and_try_get)
+{
+    LockFreeProducerConsumer<std::int32_t> producer_consumer(4);
+
+    std::int32_t element = 0;
+    ASSERT_FALSE(producer_consumer.try_get_next_element(element));
+    for (std::int32_t i = 0; i < 4; ++i)
+    {
+        element = i;
+        ASSERT_TRUE(producer_consumer.try_add_new_element(element));
+    }
+    element = 4;
+    ASSERT_FALSE(producer_consumer.try_add_new_element(element));
+    for (std::int32_t i = 0; i < 4; ++i)
+    {
+        ASSERT_TRUE(producer_consumer.try_get_next_element(element));
+        ASSERT_EQ(element, i);
+    }
+    ASSERT_FALSE(producer_consumer.try_get_next_element(element));
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, producer_waits_if_full)
+{
+    LockFreeProducerConsumer<std::int32_t> producer_consumer(2);
+
+    producer_consumer.add_new_element(0);
+    producer_consumer.add_new_element(1);
+
+    std::atomic<bool> third_element_added(false);
+    std::thread producer([&producer_consumer, &third_element_added]() {
+        producer_consumer.add_new_element(2); // blocks until an element gets consumed
+        third_element_added = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(third_element_added);
+
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 0);
+    producer.join();
+    ASSERT_TRUE(third_element_added);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 1);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 2);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, consumer_wakes_up_on_signal)
+{
+    LockFreeProducerConsumer<std::int32_t> producer_consumer;
+
+    std::atomic<bool> consumer_finished(false);
+    std::thread consumer([&producer_consumer, &consumer_finished]() {
+        ASSERT_EQ(producer_consumer.get_next_element().value(), 5);
+        ASSERT_FALSE(producer_consumer.get_next_element()); // blocks until signal_pushed_last_element()
+        consumer_finished = true;
+    });
+
+    producer_consumer.add_new_element(5);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(consumer_finished);
+    producer_consumer.signal_pushed_last_element();
+    consumer.join();
+    ASSERT_TRUE(consumer_finished);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, signal_while_producer_waits)
+{
+    LockFreeProducerConsumer<std::int32_t> producer_consumer(2);
+
+    producer_consumer.add_new_element(0);
+    producer_consumer.add_new_element(1);
+
+    std::atomic<bool> producer_threw(false);
+    std::thread producer([&producer_consumer, &producer_threw]() {
+        try
+        {
+            producer_consumer.add_new_element(2);
+        }
+        catch (const std::logic_error&)
+        {
+            producer_threw = true;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    producer_consumer.signal_pushed_last_element();
+    producer.join();
+    ASSERT_TRUE(producer_threw);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 0);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 1);
+    ASSERT_FALSE(producer_consumer.get_next_element());
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, add_after_last)
+{
+    LockFreeProducerConsumer<std::int32_t> producer_consumer;
+
+    producer_consumer.add_new_element(5);
+    producer_consumer.signal_pushed_last_element();
+    ASSERT_THROW(producer_consumer.add_new_element(10), std::logic_error);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, multiple_signals)
+{
+    LockFreeProducerConsumer<std::int32_t> producer_consumer;
+
+    producer_consumer.add_new_element(5);
+    producer_consumer.signal_pushed_last_element();
+    ASSERT_THROW(producer_consumer.signal_pushed_last_element(), std::logic_error);
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, signal_on_empty)
+{
+    LockFreeProducerConsumer<std::int32_t> producer_consumer;
+
+    producer_consumer.signal_pushed_last_element();
+    ASSERT_FALSE(producer_consumer.get_next_element());
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, rvalue_and_lvalue)
+{
+    LockFreeProducerConsumer<std::vector<std::int32_t>> producer_consumer;
+
+    std::vector<std::int32_t> vect_0({0, 1, 2});
+    producer_consumer.add_new_element(vect_0);
+    producer_consumer.add_new_element({3, 4, 5});
+    ASSERT_EQ(producer_consumer.get_next_element().value(), vect_0);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), std::vector<std::int32_t>({3, 4, 5}));
+}
+
+TEST(TestUtilsLockFreeProducerConsumer, move_only_type_and_destruction_of_remaining_elements)
+{
+    auto counter = std::make_shared<std::int32_t>(0);
+    {
+        LockFreeProducerConsumer<std::unique_ptr<std::shared_ptr<std::int32_t>>> producer_consumer(8);
+        for (std::int32_t i = 0; i < 5; ++i)
+        {
+            producer_consumer.add_new_element(std::unique_ptr<std::shared_ptr<std::int32_t>>(new std::shared_ptr<std::int32_t>(counter)));
+        }
+        ASSERT_EQ(counter.use_count(), 6);
+        producer_consumer.get_next_element();
+        ASSERT_EQ(counter.use_count(), 5);
+    }
+    // remaining elements are destroyed together with the queue
+    ASSERT_EQ(counter.use_count(), 1);
+}
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,200 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+TEST(TestUtilsThreadPool, number_of_threads)
+{
+    ThreadPool thread_pool_3(3);
+    ASSERT_EQ(thread_pool_3.number_of_threads(), 3);
+
+    ThreadPool thread_pool_default;
+    ASSERT_GE(thread_pool_default.number_of_threads(), 1);
+
+    ASSERT_THROW(ThreadPool(-1), std::invalid_argument);
+}
+
+TEST(TestUtilsThreadPool, submit_returns_values)
+{
+    ThreadPool thread_pool(4);
+
+    std::vector<std::future<std::int64_t>> futures;
+    for (std::int64_t i = 0; i < 1000; ++i)
+    {
+        futures.push_back(thread_pool.submit([](const std::int64_t val) { return val * val; }, i));
+    }
+    for (std::int64_t i = 0; i < 1000; ++i)
+    {
+        ASSERT_EQ(futures[i].get(), i * i);
+    }
+}
+
+TEST(TestUtilsThreadPool, submit_with_reference_argument)
+{
+    ThreadPool thread_pool(2);
+
+    std::string str = "abc";
+    thread_pool.submit([](std::string& s) { s += "def"; }, std::ref(str)).get();
+    ASSERT_EQ(str, "abcdef");
+}
+
+TEST(TestUtilsThreadPool, submit_propagates_exception)
+{
+    ThreadPool thread_pool(2);
+
+    std::future<void> future = thread_pool.submit([]() { throw std::runtime_error("task failed"); });
+    ASSERT_THROW(future.get(), std::runtime_error);
+}
+
+TEST(TestUtilsThreadPool, destructor_executes_submitted_tasks)
+{
+    std::atomic<std::int32_t> number_of_executed_tasks(0);
+    {
+        ThreadPool thread_pool(2);
+        for (std::int32_t i = 0; i < 100; ++i)
+        {
+            thread_pool.submit_detached([&number_of_executed_tasks]() { ++number_of_executed_tasks; });
+        }
+    }
+    ASSERT_EQ(number_of_executed_tasks, 100);
+}
+
+TEST(TestUtilsThreadPool, cpu_affinity)
+{
+    ThreadPool thread_pool(4, {0});
+
+    std::atomic<std::int32_t> number_of_executed_tasks(0);
+    TaskGroup task_group(thread_pool);
+    for (std::int32_t i = 0; i < 100; ++i)
+    {
+        task_group.run([&number_of_executed_tasks]() { ++number_of_executed_tasks; });
+    }
+    task_group.wait();
+    ASSERT_EQ(number_of_executed_tasks, 100);
+}
+
+TEST(TestUtilsThreadPool, task_group_waits_for_all_tasks)
+{
+    ThreadPool thread_pool(4);
+
+    std::vector<std::int32_t> results(10'000, 0);
+    TaskGroup task_group(thread_pool);
+    for (std::int32_t i = 0; i < static_cast<std::int32_t>(results.size()); ++i)
+    {
+        task_group.run([&results, i]() { results[i] = i + 1; });
+    }
+    task_group.wait();
+
+    for (std::int32_t i = 0; i < static_cast<std::int32_t>(results.size()); ++i)
+    {
+        ASSERT_EQ(results[i], i + 1);
+    }
+}
+
+TEST(TestUtilsThreadPool, task_group_rethrows_first_exception)
+{
+    ThreadPool thread_pool(2);
+
+    std::atomic<std::int32_t> number_of_executed_tasks(0);
+    TaskGroup task_group(thread_pool);
+    for (std::int32_t i = 0; i < 10; ++i)
+    {
+        task_group.run([&number_of_executed_tasks, i]() {
+            ++number_of_executed_tasks;
+            if (i == 5)
+            {
+                throw std::runtime_error("task failed");
+            }
+        });
+    }
+    ASSERT_THROW(task_group.wait(), std::runtime_error);
+    // other tasks are not cancelled
+    ASSERT_EQ(number_of_executed_tasks, 10);
+
+    // group can be reused after wait()
+    task_group.run([&number_of_executed_tasks]() { ++number_of_executed_tasks; });
+    task_group.wait();
+    ASSERT_EQ(number_of_executed_tasks, 11);
+}
+
+TEST(TestUtilsThreadPool, task_group_waited_for_inside_of_pool_task)
+{
+    // every pool thread waits for a nested group, this would deadlock if wait() did not execute tasks of its group itself
+    ThreadPool thread_pool(2);
+
+    std::atomic<std::int32_t> number_of_executed_tasks(0);
+    TaskGroup outer_task_group(thread_pool);
+    for (std::int32_t i = 0; i < 4; ++i)
+    {
+        outer_task_group.run([&thread_pool, &number_of_executed_tasks]() {
+            TaskGroup inner_task_group(thread_pool);
+            for (std::int32_t j = 0; j < 10; ++j)
+            {
+                inner_task_group.run([&number_of_executed_tasks]() { ++number_of_executed_tasks; });
+            }
+            inner_task_group.wait();
+        });
+    }
+    outer_task_group.wait();
+    ASSERT_EQ(number_of_executed_tasks, 40);
+}
+
+TEST(TestUtilsThreadPool, task_group_tasks_add_tasks_to_their_group)
+{
+    ThreadPool thread_pool(3);
+
+    std::atomic<std::int32_t> number_of_executed_tasks(0);
+    TaskGroup task_group(thread_pool);
+    std::function<void(std::int32_t)> spawn = [&task_group, &number_of_executed_tasks, &spawn](const std::int32_t depth) {
+        ++number_of_executed_tasks;
+        if (depth > 0)
+        {
+            task_group.run([&spawn, depth]() { spawn(depth - 1); });
+            task_group.run([&spawn, depth]() { spawn(depth - 1); });
+        }
+    };
+    task_group.run([&spawn]() { spawn(10); });
+    task_group.wait();
+    ASSERT_EQ(number_of_executed_tasks, (1 << 11) - 1);
+}
+
+TEST(TestUtilsThreadPool, global_thread_pool)
+{
+    ThreadPool& thread_pool = get_global_thread_pool();
+    ASSERT_EQ(&thread_pool, &get_global_thread_pool());
+    ASSERT_EQ(thread_pool.submit([]() { return 5; }).get(), 5);
+    ASSERT_THROW(initialize_global_thread_pool(2), std::logic_error);
+}
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
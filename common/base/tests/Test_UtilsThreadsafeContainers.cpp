@@ -19,6 +19,8 @@
 #include <claraparabricks/genomeworks/utils/threadsafe_containers.hpp>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 #include <cstdint>
 #include <numeric>
@@ -94,7 +96,8 @@ TEST(TestUtilsThreadsafeContainers, test_threadsafe_data_provider_no_data)
 void test_test_threadsafe_producer_consumer(const std::int32_t number_of_elements,
                                             const std::int32_t number_of_producers,
                                             const std::int32_t number_of_consumers,
-                                            const std::int32_t producers_sleep_for_ms) // give consumers some time to empty the queue)
+                                            const std::int32_t producers_sleep_for_ms, // give consumers some time to empty the queue)
+                                            const std::int64_t max_number_of_elements = 0)
 {
     ASSERT_GT(number_of_elements, 0);
     ASSERT_GT(number_of_producers, 0);
@@ -104,7 +107,7 @@ void test_test_threadsafe_producer_consumer(const std::int32_t number_of_element
     const std::int32_t producers_sleep_after           = number_of_elements_per_producer / 10 * 3;
     ASSERT_GT(number_of_elements_per_producer, producers_sleep_after);
 
-    ThreadsafeProducerConsumer<std::int32_t> producer_consumer;
+    ThreadsafeProducerConsumer<std::int32_t> producer_consumer(max_number_of_elements);
 
     std::mutex occurrences_per_element_mutex; // using mutex instead of atomic as the test was failining when using more than 1'000'000 atomics
     std::vector<std::int32_t> occurrences_per_element(number_of_elements, 0);
@@ -170,6 +173,13 @@ void test_test_threadsafe_producer_consumer(const std::int32_t number_of_element
                             [](const std::int32_t val) {
                                 return val == 1;
                             }));
+
+    const ThreadsafeProducerConsumerStatistics statistics = producer_consumer.get_statistics();
+    ASSERT_EQ(statistics.number_of_added_elements, number_of_elements_per_producer * number_of_producers);
+    if (max_number_of_elements > 0)
+    {
+        ASSERT_LE(statistics.max_number_of_elements, max_number_of_elements);
+    }
 }
 
 TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_single_producer_single_consumer)
@@ -243,6 +253,143 @@ TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_signal_on_
     ASSERT_FALSE(val);
 }
 
+TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_bounded_multiple_producers_multiple_consumers)
+{
+    const std::int32_t number_of_elements     = 1'000'000;
+    const std::int32_t number_of_producers    = 10;
+    const std::int32_t number_of_consumers    = 5;
+    const std::int32_t producers_sleep_for_ms = 100;
+    const std::int64_t max_number_of_elements = 100;
+
+    test_test_threadsafe_producer_consumer(number_of_elements,
+                                           number_of_producers,
+                                           number_of_consumers,
+                                           producers_sleep_for_ms,
+                                           max_number_of_elements);
+}
+
+TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_bounded_by_number_of_elements)
+{
+    ThreadsafeProducerConsumer<std::int32_t> producer_consumer(2);
+
+    producer_consumer.add_new_element(0);
+    producer_consumer.add_new_element(1);
+
+    std::atomic<bool> third_element_added(false);
+    std::thread producer([&producer_consumer, &third_element_added]() {
+        producer_consumer.add_new_element(2); // blocks until an element gets consumed
+        third_element_added = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(third_element_added);
+
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 0);
+    producer.join();
+    ASSERT_TRUE(third_element_added);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 1);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 2);
+
+    const ThreadsafeProducerConsumerStatistics statistics = producer_consumer.get_statistics();
+    ASSERT_EQ(statistics.number_of_added_elements, 3);
+    ASSERT_EQ(statistics.max_number_of_elements, 2);
+    ASSERT_EQ(statistics.number_of_producer_waits, 1);
+    ASSERT_GT(statistics.producer_wait_time.count(), 0);
+}
+
+TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_bounded_by_number_of_bytes)
+{
+    ThreadsafeProducerConsumer<std::vector<std::int32_t>> producer_consumer(0,
+                                                                            10 * sizeof(std::int32_t),
+                                                                            [](const std::vector<std::int32_t>& element) {
+                                                                                return static_cast<std::int64_t>(element.size() * sizeof(std::int32_t));
+                                                                            });
+
+    // element larger than the limit is accepted if the queue is empty
+    producer_consumer.add_new_element(std::vector<std::int32_t>(20, 0));
+
+    std::atomic<bool> second_element_added(false);
+    std::thread producer([&producer_consumer, &second_element_added]() {
+        producer_consumer.add_new_element(std::vector<std::int32_t>(6, 1)); // blocks until the first element gets consumed
+        producer_consumer.add_new_element(std::vector<std::int32_t>(4, 2)); // fits together with the second element
+        second_element_added = true;
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ASSERT_FALSE(second_element_added);
+
+    ASSERT_EQ(producer_consumer.get_next_element().value().size(), 20u);
+    producer.join();
+    ASSERT_TRUE(second_element_added);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), std::vector<std::int32_t>(6, 1));
+    ASSERT_EQ(producer_consumer.get_next_element().value(), std::vector<std::int32_t>(4, 2));
+
+    const ThreadsafeProducerConsumerStatistics statistics = producer_consumer.get_statistics();
+    ASSERT_EQ(statistics.number_of_added_elements, 3);
+    ASSERT_EQ(statistics.max_number_of_bytes, static_cast<std::int64_t>(20 * sizeof(std::int32_t)));
+    ASSERT_EQ(statistics.number_of_producer_waits, 1);
+}
+
+TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_try_add_new_element)
+{
+    ThreadsafeProducerConsumer<std::vector<std::int32_t>> producer_consumer(2);
+
+    std::vector<std::int32_t> element({0, 1});
+    ASSERT_TRUE(producer_consumer.try_add_new_element(element));
+    element = {2, 3};
+    ASSERT_TRUE(producer_consumer.try_add_new_element(element));
+    element = {4, 5};
+    ASSERT_FALSE(producer_consumer.try_add_new_element(element));
+    ASSERT_EQ(element, std::vector<std::int32_t>({4, 5})); // not moved from if not added
+
+    ASSERT_EQ(producer_consumer.get_next_element().value(), std::vector<std::int32_t>({0, 1}));
+    ASSERT_TRUE(producer_consumer.try_add_new_element(element));
+    ASSERT_EQ(producer_consumer.get_next_element().value(), std::vector<std::int32_t>({2, 3}));
+    ASSERT_EQ(producer_consumer.get_next_element().value(), std::vector<std::int32_t>({4, 5}));
+
+    const ThreadsafeProducerConsumerStatistics statistics = producer_consumer.get_statistics();
+    ASSERT_EQ(statistics.number_of_added_elements, 3);
+    ASSERT_EQ(statistics.number_of_rejected_elements, 1);
+    ASSERT_EQ(statistics.number_of_producer_waits, 0);
+
+    producer_consumer.signal_pushed_last_element();
+    ASSERT_THROW(producer_consumer.try_add_new_element(element), std::logic_error);
+}
+
+TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_signal_while_producer_waits)
+{
+    ThreadsafeProducerConsumer<std::int32_t> producer_consumer(1);
+
+    producer_consumer.add_new_element(0);
+
+    std::atomic<bool> producer_threw(false);
+    std::thread producer([&producer_consumer, &producer_threw]() {
+        try
+        {
+            producer_consumer.add_new_element(1);
+        }
+        catch (const std::logic_error&)
+        {
+            producer_threw = true;
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    producer_consumer.signal_pushed_last_element();
+    producer.join();
+    ASSERT_TRUE(producer_threw);
+    ASSERT_EQ(producer_consumer.get_next_element().value(), 0);
+    ASSERT_FALSE(producer_consumer.get_next_element());
+}
+
+TEST(TestUtilsThreadsafeContainers, test_threadsafe_producer_consumer_invalid_limits)
+{
+    using producer_consumer_t = ThreadsafeProducerConsumer<std::int32_t>;
+    ASSERT_THROW(producer_consumer_t(-1), std::invalid_argument);
+    ASSERT_THROW(producer_consumer_t(0, -1), std::invalid_argument);
+    ASSERT_THROW(producer_consumer_t(0, 100), std::invalid_argument); // byte limit without size function
+}
+
 } // namespace genomeworks
 
 } // namespace claraparabricks
@@ -69,6 +69,24 @@ std::unique_ptr<FastaParser> create_kseq_fasta_parser(const std::string& fasta_f
                                                       number_of_basepairs_t min_sequence_length = 0,
                                                       bool shuffle                              = true);
 
+/// \brief A builder function that returns a FASTA parser object which parses FASTA or FASTQ content already loaded in host memory.
+///
+/// Reads are kept in the order they appear in the input.
+///
+/// \param fasta_content Content of a FASTA or FASTQ file, not compressed.
+/// \param min_sequence_length Minimum length a sequence needs to be to be parsed. Shorter sequences are ignored.
+///
+/// \return A unique pointer to a constructed parser object.
+std::unique_ptr<FastaParser> create_string_fasta_parser(const std::string& fasta_content,
+                                                        number_of_basepairs_t min_sequence_length = 0);
+
+/// \brief A builder function that returns a FASTA parser object which serves sequences that have already been parsed.
+///
+/// \param sequences Sequences in the order they should be returned in.
+///
+/// \return A unique pointer to a constructed parser object.
+std::unique_ptr<FastaParser> create_fasta_parser_from_sequences(std::vector<FastaSequence> sequences);
+
 } // namespace io
 
 } // namespace genomeworks
@@ -15,10 +15,12 @@
 */
 
 #include "kseqpp_fasta_parser.hpp"
+#include "string_fasta_parser.hpp"
 
 #include <claraparabricks/genomeworks/io/fasta_parser.hpp>
 
 #include <memory>
+#include <utility>
 
 namespace claraparabricks
 {
@@ -38,6 +40,18 @@ std::unique_ptr<FastaParser> create_kseq_fasta_parser(const std::string& fasta_f
                                                shuffle);
 }
 
+std::unique_ptr<FastaParser> create_string_fasta_parser(const std::string& fasta_content,
+                                                        const number_of_basepairs_t min_sequence_length)
+{
+    return std::make_unique<FastaParserString>(fasta_content,
+                                               min_sequence_length);
+}
+
+std::unique_ptr<FastaParser> create_fasta_parser_from_sequences(std::vector<FastaSequence> sequences)
+{
+    return std::make_unique<FastaParserString>(std::move(sequences));
+}
+
 } // namespace io
 
 } // namespace genomeworks
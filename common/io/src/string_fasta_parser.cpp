@@ -0,0 +1,147 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "string_fasta_parser.hpp"
+
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace io
+{
+
+namespace
+{
+
+/// \brief removes trailing '\r' left by files with Windows line endings
+/// \param line
+void remove_carriage_return(std::string& line)
+{
+    if (!line.empty() && line.back() == '\r')
+    {
+        line.pop_back();
+    }
+}
+
+/// \brief returns the name of the read, i.e. header line without the leading '>' or '@' and without the comment
+/// \param header_line
+/// \return name of the read
+std::string get_name_from_header(const std::string& header_line)
+{
+    const std::size_t name_end = header_line.find_first_of(" \t", 1);
+    return header_line.substr(1, name_end == std::string::npos ? std::string::npos : name_end - 1);
+}
+
+} // namespace
+
+FastaParserString::FastaParserString(const std::string& fasta_content,
+                                     const number_of_basepairs_t min_sequence_length)
+{
+    std::istringstream input(fasta_content);
+    std::string line;
+
+    // skip empty lines before the first record
+    while (std::getline(input, line))
+    {
+        remove_carriage_return(line);
+        if (!line.empty())
+        {
+            break;
+        }
+    }
+
+    while (!line.empty())
+    {
+        const char record_type = line.front();
+        if (record_type != '>' && record_type != '@')
+        {
+            throw std::invalid_argument("Error: expected FASTA or FASTQ header, got line: " + line);
+        }
+
+        FastaSequence read = {get_name_from_header(line), ""};
+        line.clear();
+
+        // sequence can span multiple lines, it ends with the next header (FASTA) or with '+' line (FASTQ)
+        while (std::getline(input, line))
+        {
+            remove_carriage_return(line);
+            if (!line.empty() && (line.front() == '>' || (record_type == '@' && line.front() == '+')))
+            {
+                break;
+            }
+            read.seq += line;
+            line.clear();
+        }
+
+        if (record_type == '@')
+        {
+            if (line.empty() || line.front() != '+')
+            {
+                throw std::invalid_argument("Error: FASTQ record " + read.name + " has no quality line");
+            }
+            // skip quality values, they can also span multiple lines but they have the same length as the sequence
+            std::string quality;
+            while (get_size(quality) < get_size(read.seq) && std::getline(input, line))
+            {
+                remove_carriage_return(line);
+                quality += line;
+            }
+            line.clear();
+            while (std::getline(input, line))
+            {
+                remove_carriage_return(line);
+                if (!line.empty())
+                {
+                    break;
+                }
+            }
+        }
+
+        if (get_size<number_of_basepairs_t>(read.seq) >= min_sequence_length)
+        {
+            reads_.push_back(std::move(read));
+        }
+    }
+}
+
+FastaParserString::FastaParserString(std::vector<FastaSequence> sequences)
+    : reads_(std::move(sequences))
+{
+}
+
+number_of_reads_t FastaParserString::get_num_seqences() const
+{
+    return reads_.size();
+}
+
+const FastaSequence& FastaParserString::get_sequence_by_id(const read_id_t sequence_id) const
+{
+    return reads_[sequence_id];
+}
+
+} // namespace io
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,243 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "edit_distance_cpu.hpp"
+#include "myers_alignment_cpu.hpp"
+#include "myers_cpu.hpp"
+#include "needleman_wunsch_cpu.hpp"
+#include "smith_waterman_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <benchmark/benchmark.h>
+#include <random>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+std::vector<std::pair<std::string, std::string>> generate_sequence_pairs(const int32_t number_of_pairs, const int32_t genome_size)
+{
+    std::minstd_rand rng(1);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int32_t i = 0; i < number_of_pairs; ++i)
+    {
+        std::string genome_1 = genomeutils::generate_random_genome(genome_size, rng);
+        std::string genome_2 = genomeutils::generate_random_sequence(genome_1, rng, genome_size / 30, genome_size / 30, genome_size / 30); // 3*x/30 = 10% difference
+        pairs.emplace_back(std::move(genome_1), std::move(genome_2));
+    }
+    return pairs;
+}
+
+} // namespace
+
+static void BM_EditDistanceCPUReference(benchmark::State& state)
+{
+    const std::vector<std::pair<std::string, std::string>> pairs = generate_sequence_pairs(state.range(0), state.range(1));
+    for (auto _ : state)
+    {
+        for (const auto& pair : pairs)
+        {
+            benchmark::DoNotOptimize(myers_compute_edit_distance(pair.second, pair.first));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * get_size(pairs));
+}
+
+template <InstructionSet instruction_set>
+static void BM_EditDistanceCPU(benchmark::State& state)
+{
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        state.SkipWithError("Instruction set is not supported on this machine, skipping");
+        return;
+    }
+    const std::vector<std::pair<std::string, std::string>> pairs = generate_sequence_pairs(state.range(0), state.range(1));
+    std::vector<EditDistanceInput> inputs;
+    for (const auto& pair : pairs)
+    {
+        inputs.push_back({pair.first.data(), get_size<int32_t>(pair.first), pair.second.data(), get_size<int32_t>(pair.second)});
+    }
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(myers_compute_edit_distances_cpu(inputs, instruction_set));
+    }
+    state.SetItemsProcessed(state.iterations() * get_size(pairs));
+}
+
+static void BM_BoundedEditDistanceCPU(benchmark::State& state)
+{
+    const std::vector<std::pair<std::string, std::string>> pairs = generate_sequence_pairs(state.range(0), state.range(1));
+    const int32_t max_distance                                   = state.range(2);
+    for (auto _ : state)
+    {
+        for (const auto& pair : pairs)
+        {
+            benchmark::DoNotOptimize(myers_compute_bounded_edit_distance_cpu(pair.first.data(), get_size<int32_t>(pair.first), pair.second.data(), get_size<int32_t>(pair.second), max_distance));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * get_size(pairs));
+}
+
+static void BM_MyersAlignmentCPU(benchmark::State& state)
+{
+    const std::vector<std::pair<std::string, std::string>> pairs = generate_sequence_pairs(state.range(0), state.range(1));
+    for (auto _ : state)
+    {
+        for (const auto& pair : pairs)
+        {
+            benchmark::DoNotOptimize(myers_compute_alignment_cpu(pair.first.data(), get_size<int32_t>(pair.first), pair.second.data(), get_size<int32_t>(pair.second)));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * get_size(pairs));
+}
+
+template <InstructionSet instruction_set>
+static void BM_NeedlemanWunschAlignmentCPU(benchmark::State& state)
+{
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        state.SkipWithError("Instruction set is not supported on this machine, skipping");
+        return;
+    }
+    const std::vector<std::pair<std::string, std::string>> pairs = generate_sequence_pairs(state.range(0), state.range(1));
+    for (auto _ : state)
+    {
+        for (const auto& pair : pairs)
+        {
+            benchmark::DoNotOptimize(needleman_wunsch_compute_alignment_cpu(pair.first.data(), get_size<int32_t>(pair.first), pair.second.data(), get_size<int32_t>(pair.second), instruction_set));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * get_size(pairs));
+}
+
+static void BM_HirschbergMyersAlignmentCPU(benchmark::State& state)
+{
+    const std::vector<std::pair<std::string, std::string>> pairs = generate_sequence_pairs(1, state.range(0));
+    ThreadPool thread_pool(state.range(1));
+    for (auto _ : state)
+    {
+        for (const auto& pair : pairs)
+        {
+            benchmark::DoNotOptimize(hirschberg_myers_compute_alignment_cpu(pair.first.data(), get_size<int32_t>(pair.first), pair.second.data(), get_size<int32_t>(pair.second), thread_pool));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * get_size(pairs));
+}
+
+template <InstructionSet instruction_set>
+static void BM_SmithWatermanScoreCPU(benchmark::State& state)
+{
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        state.SkipWithError("Instruction set is not supported on this machine, skipping");
+        return;
+    }
+    const std::vector<std::pair<std::string, std::string>> pairs = generate_sequence_pairs(state.range(0), state.range(1));
+    const AffineGapScores scores;
+    for (auto _ : state)
+    {
+        for (const auto& pair : pairs)
+        {
+            benchmark::DoNotOptimize(smith_waterman_compute_score_cpu(pair.first.data(), get_size<int32_t>(pair.first), pair.second.data(), get_size<int32_t>(pair.second), scores, instruction_set));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * get_size(pairs));
+}
+
+// the reference implementation is limited to shorter sequences as it is orders of magnitude slower
+BENCHMARK(BM_EditDistanceCPUReference)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 64}, {128, 1024}});
+
+BENCHMARK_TEMPLATE(BM_EditDistanceCPU, InstructionSet::scalar)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 64}, {128, 8192}});
+
+BENCHMARK_TEMPLATE(BM_EditDistanceCPU, InstructionSet::avx2)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 64}, {128, 8192}});
+
+BENCHMARK_TEMPLATE(BM_EditDistanceCPU, InstructionSet::avx512)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 64}, {128, 8192}});
+
+BENCHMARK(BM_MyersAlignmentCPU)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{4, 4}, {1024, 32768}});
+
+BENCHMARK_TEMPLATE(BM_NeedlemanWunschAlignmentCPU, InstructionSet::scalar)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{4, 4}, {1024, 32768}});
+
+BENCHMARK_TEMPLATE(BM_NeedlemanWunschAlignmentCPU, InstructionSet::avx2)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{4, 4}, {1024, 32768}});
+
+BENCHMARK_TEMPLATE(BM_NeedlemanWunschAlignmentCPU, InstructionSet::avx512)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{4, 4}, {1024, 32768}});
+
+// a single long alignment split into tasks, ranges are the sequence length and the number of threads
+BENCHMARK(BM_HirschbergMyersAlignmentCPU)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime()
+    ->RangeMultiplier(16)
+    ->Ranges({{1 << 16, 1 << 20}, {1, 16}});
+
+BENCHMARK_TEMPLATE(BM_SmithWatermanScoreCPU, InstructionSet::scalar)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 64}, {128, 8192}});
+
+BENCHMARK_TEMPLATE(BM_SmithWatermanScoreCPU, InstructionSet::avx2)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 64}, {128, 8192}});
+
+BENCHMARK_TEMPLATE(BM_SmithWatermanScoreCPU, InstructionSet::avx512)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(8)
+    ->Ranges({{64, 64}, {128, 8192}});
+
+// sequences differ by ~10%, i.e. small max_distance values terminate early and large ones compute the full band
+BENCHMARK(BM_BoundedEditDistanceCPU)
+    ->Unit(benchmark::kMillisecond)
+    ->Ranges({{64, 64}, {1024, 8192}, {16, 1024}});
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
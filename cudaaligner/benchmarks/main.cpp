@@ -161,6 +161,80 @@ static void BM_SingleBatchAlignment(benchmark::State& state)
     }
 }
 
+// Adds alignments of simulated reads with the given identity in permille to aligner,
+// the differences are split equally into mismatches, insertions and deletions
+static void add_alignments_with_identity(Aligner& aligner, const int32_t alignments_per_batch, const int32_t genome_size, const int32_t identity_permille)
+{
+    std::minstd_rand rng(1);
+    const int32_t errors_per_type = (1000 - identity_permille) * genome_size / 3000;
+    for (int32_t i = 0; i < alignments_per_batch; i++)
+    {
+        std::string genome_1 = genomeworks::genomeutils::generate_random_genome(genome_size, rng);
+        std::string genome_2 = genomeworks::genomeutils::generate_random_sequence(genome_1, rng, errors_per_type, errors_per_type, errors_per_type);
+        if (get_size(genome_2) > genome_size)
+        {
+            genome_2.resize(genome_size);
+        }
+        aligner.add_alignment(genome_1.c_str(), genome_1.length(),
+                              genome_2.c_str(), genome_2.length());
+    }
+}
+
+static void BM_MyersBandedByIdentity(benchmark::State& state)
+{
+    const std::size_t max_gpu_memory = cudautils::find_largest_contiguous_device_memory_section();
+    CudaStream stream;
+    DefaultDeviceAllocator allocator   = create_default_device_allocator(max_gpu_memory);
+    const int32_t alignments_per_batch = state.range(0);
+    const int32_t genome_size          = state.range(1);
+    const int32_t identity_permille    = state.range(2);
+
+    std::unique_ptr<Aligner> aligner;
+    try
+    {
+        aligner = create_aligner_tmp_dispatch<AlignerGlobalMyersBanded>(genome_size, alignments_per_batch, allocator, stream.get(), 0);
+        add_alignments_with_identity(*aligner, alignments_per_batch, genome_size, identity_permille);
+    }
+    catch (device_memory_allocation_exception const& e)
+    {
+        state.SkipWithError("Could not allocate enough memory for config, skipping");
+    }
+
+    for (auto _ : state)
+    {
+        aligner->align_all();
+        aligner->sync_alignments();
+    }
+}
+
+template <WavefrontMemoryMode memory_mode>
+static void BM_WavefrontByIdentity(benchmark::State& state)
+{
+    const int32_t alignments_per_batch = state.range(0);
+    const int32_t genome_size          = state.range(1);
+    const int32_t identity_permille    = state.range(2);
+
+    std::unique_ptr<Aligner> aligner = create_wavefront_aligner(genome_size, genome_size, alignments_per_batch, WavefrontPenalties(), memory_mode);
+    add_alignments_with_identity(*aligner, alignments_per_batch, genome_size, identity_permille);
+
+    for (auto _ : state)
+    {
+        aligner->align_all();
+        aligner->sync_alignments();
+    }
+}
+
+static void identity_benchmark_arguments(benchmark::internal::Benchmark* b)
+{
+    for (const int32_t genome_size : {1000, 10000})
+    {
+        for (const int32_t identity_permille : {900, 950, 990, 999})
+        {
+            b->Args({256, genome_size, identity_permille});
+        }
+    }
+}
+
 // Register the functions as a benchmark
 BENCHMARK(BM_SingleAlignment)
     ->Unit(benchmark::kMillisecond)
@@ -187,6 +261,18 @@ BENCHMARK_TEMPLATE(BM_SingleBatchAlignment, AlignerGlobalHirschbergMyers)
     ->RangeMultiplier(4)
     ->Ranges({{32, 1024}, {512, 65536}});
 
+BENCHMARK(BM_MyersBandedByIdentity)
+    ->Unit(benchmark::kMillisecond)
+    ->Apply(identity_benchmark_arguments);
+
+BENCHMARK_TEMPLATE(BM_WavefrontByIdentity, WavefrontMemoryMode::full)
+    ->Unit(benchmark::kMillisecond)
+    ->Apply(identity_benchmark_arguments);
+
+BENCHMARK_TEMPLATE(BM_WavefrontByIdentity, WavefrontMemoryMode::bidirectional)
+    ->Unit(benchmark::kMillisecond)
+    ->Apply(identity_benchmark_arguments);
+
 } // namespace cudaaligner
 
 } // namespace genomeworks
@@ -18,6 +18,7 @@
 
 #include <claraparabricks/genomeworks/cudaaligner/cudaaligner.hpp>
 #include <claraparabricks/genomeworks/utils/allocator.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
 
 #include <memory>
 #include <vector>
@@ -34,6 +35,7 @@ namespace cudaaligner
 
 // Forward declaration of Alignment class.
 class Alignment;
+class RunLengthAlignments;
 
 /// \addtogroup cudaaligner
 /// \{
@@ -78,10 +80,56 @@ public:
     /// \return Vector of Alignments.
     virtual const std::vector<std::shared_ptr<Alignment>>& get_alignments() const = 0;
 
+    /// \brief Select how the results of the alignments are returned.
+    ///
+    /// AlignmentResultsMode::alignment_objects (default) returns the results through get_alignments().
+    /// AlignmentResultsMode::run_length returns them through get_run_length_alignments() instead,
+    /// which does not keep copies of the sequences and stores all alignments of a batch in one arena.
+    /// The mode can only be changed while no alignments are added.
+    ///
+    /// \param mode Results mode
+    /// \return success, or generic_error if the aligner holds alignments or does not support the mode
+    virtual StatusType set_results_mode(AlignmentResultsMode mode) = 0;
+
+    /// \brief Return the computed alignments in AlignmentResultsMode::run_length.
+    ///
+    /// The alignments are in the order they were added and valid until reset().
+    ///
+    /// \return Run-length encoded alignments, empty in AlignmentResultsMode::alignment_objects.
+    virtual const RunLengthAlignments& get_run_length_alignments() const = 0;
+
     /// \brief Reset aligner object.
     virtual void reset() = 0;
 };
 
+/// BandRetryStatistics - Realignments of the last batch of an AdaptiveBandAligner.
+struct BandRetryStatistics
+{
+    /// \brief number of alignments in the batch
+    int32_t number_of_alignments = 0;
+    /// \brief number of alignments which left the initial band and were realigned at least once
+    int32_t number_of_retried_alignments = 0;
+    /// \brief total number of realignments, an alignment realigned with several bands is counted for each of them
+    int32_t number_of_retries = 0;
+    /// \brief number of times the band was doubled
+    int32_t number_of_rounds = 0;
+    /// \brief number of alignments which still left the largest band, i.e. are not optimal
+    int32_t number_of_failed_alignments = 0;
+};
+
+/// \class AdaptiveBandAligner
+/// Banded Aligner which widens the band of alignments leaving it
+///
+/// align_all() first computes all alignments with a small initial band. Alignments whose optimal path leaves the band
+/// are realigned with a doubled band until they fit or the maximal band is reached. Checking the results of every round
+/// requires align_all() to wait for the GPU, i.e. unlike other Aligners it blocks until the alignments are computed.
+class AdaptiveBandAligner : public Aligner
+{
+public:
+    /// \brief Return the statistics of the realignments of the last align_all() call.
+    virtual BandRetryStatistics get_band_retry_statistics() const = 0;
+};
+
 /// \brief Created Aligner object - DEPRECATED API
 ///
 /// \param max_query_length Maximum length of query string
@@ -108,6 +156,18 @@ std::unique_ptr<Aligner> create_aligner(int32_t max_query_length, int32_t max_ta
 /// \return Unique pointer to Aligner object
 std::unique_ptr<Aligner> create_aligner(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type, cudaStream_t stream, int32_t device_id, int64_t max_device_memory_allocator_caching_size = -1);
 
+/// \brief Computes the device memory an Aligner created by create_aligner(max_query_length, max_target_length, max_alignments, type, ...) allocates
+///
+/// Allows to choose the number of alignments per batch for the available device memory.
+///
+/// \param max_query_length Maximum length of query string
+/// \param max_target_length Maximum length of target string
+/// \param max_alignments Maximum number of alignments to be performed
+/// \param type Type of aligner
+///
+/// \return Device memory in bytes, not including the overhead of the allocator
+int64_t calc_aligner_device_memory(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type);
+
 /// \brief Created Aligner object
 ///
 /// \param type Type of aligner to construct
@@ -130,6 +190,119 @@ std::unique_ptr<Aligner> create_aligner(AlignmentType type, int32_t max_bandwidt
 ///
 /// \return Unique pointer to Aligner object
 std::unique_ptr<Aligner> create_aligner(AlignmentType type, int32_t max_bandwidth, cudaStream_t stream, int32_t device_id, int64_t max_device_memory = -1);
+
+/// \brief Created AdaptiveBandAligner object
+///
+/// \param type Type of aligner to construct
+/// \param initial_bandwidth Bandwidth of the first attempt of all alignments, should cover the common case
+/// \param max_bandwidth Largest bandwidth alignments leaving the band are realigned with
+/// \param stream CUDA Stream used for GPU interaction of the object
+/// \param device_id GPU device ID to run all CUDA operations on
+/// \param allocator Allocator to use for internal device memory allocations
+/// \param max_device_memory Maximum amount of device memory to use from passed in allocator in bytes (-1 for all available memory)
+///
+/// \return Unique pointer to AdaptiveBandAligner object
+std::unique_ptr<AdaptiveBandAligner> create_adaptive_band_aligner(AlignmentType type, int32_t initial_bandwidth, int32_t max_bandwidth, cudaStream_t stream, int32_t device_id, DefaultDeviceAllocator allocator, int64_t max_device_memory);
+
+/// \brief Created AdaptiveBandAligner object
+///
+/// \param type Type of aligner to construct
+/// \param initial_bandwidth Bandwidth of the first attempt of all alignments, should cover the common case
+/// \param max_bandwidth Largest bandwidth alignments leaving the band are realigned with
+/// \param stream CUDA Stream used for GPU interaction of the object
+/// \param device_id GPU device ID to run all CUDA operations on
+/// \param max_device_memory Maximum amount of device memory used in bytes (-1 (default) for all available memory).
+///
+/// \return Unique pointer to AdaptiveBandAligner object
+std::unique_ptr<AdaptiveBandAligner> create_adaptive_band_aligner(AlignmentType type, int32_t initial_bandwidth, int32_t max_bandwidth, cudaStream_t stream, int32_t device_id, int64_t max_device_memory = -1);
+
+/// \brief Created Aligner object which computes the alignments on the CPU
+///
+/// The alignments of a batch are computed in parallel as tasks of thread_pool,
+/// align_all() returns as soon as the tasks are submitted and sync_alignments() waits for them.
+///
+/// \param max_query_length Maximum length of query string
+/// \param max_target_length Maximum length of target string
+/// \param max_alignments Maximum number of alignments to be performed
+/// \param type Type of aligner to construct, global_alignment, semi_global_alignment or extension_alignment
+/// \param thread_pool Thread pool to run the alignments on, has to outlive the aligner. Defaults to the process-wide thread pool.
+/// \param x_drop Extension alignments stop once the score drops more than x_drop below the best score seen (match +1, mismatch and gaps -1). Ignored for other types.
+///
+/// \return Unique pointer to Aligner object
+/// \throw std::runtime_error for other types, affine gap and local aligners are created with the overload taking AffineGapScores
+std::unique_ptr<Aligner> create_cpu_aligner(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type, ThreadPool& thread_pool = get_global_thread_pool(), int32_t x_drop = 50);
+
+/// \brief Created Aligner object which computes the alignments on the CPU with the given memory mode
+///
+/// CpuAlignmentMemoryMode::full creates the same aligner as the overload without memory_mode.
+/// With CpuAlignmentMemoryMode::linear the score matrices are computed by anti-diagonals in SIMD lanes and the traceback uses
+/// Hirschberg's divide and conquer, so the memory of an alignment is linear in the sequence lengths and long alignments run within cache-sized working sets.
+/// The alignments of a batch are computed in parallel as tasks of thread_pool,
+/// align_all() returns as soon as the tasks are submitted and sync_alignments() waits for them.
+///
+/// \param max_query_length Maximum length of query string
+/// \param max_target_length Maximum length of target string
+/// \param max_alignments Maximum number of alignments to be performed
+/// \param type Type of aligner to construct, only global_alignment for CpuAlignmentMemoryMode::linear
+/// \param memory_mode Memory mode of the alignments
+/// \param thread_pool Thread pool to run the alignments on, has to outlive the aligner. Defaults to the process-wide thread pool.
+///
+/// \return Unique pointer to Aligner object
+/// \throw std::runtime_error if type is not implemented for memory_mode
+std::unique_ptr<Aligner> create_cpu_aligner(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type, CpuAlignmentMemoryMode memory_mode, ThreadPool& thread_pool = get_global_thread_pool());
+
+/// \brief Created Aligner object which computes affine gap or local alignments on the CPU
+///
+/// Local alignments report the aligned substrings through Alignment::get_aligned_interval(),
+/// use compute_local_alignment_scores() to screen pairs by their score without computing the alignments.
+/// The alignments of a batch are computed in parallel as tasks of thread_pool,
+/// align_all() returns as soon as the tasks are submitted and sync_alignments() waits for them.
+///
+/// \param max_query_length Maximum length of query string
+/// \param max_target_length Maximum length of target string
+/// \param max_alignments Maximum number of alignments to be performed
+/// \param type Type of aligner to construct, global_affine_alignment, semi_global_affine_alignment or local_alignment
+/// \param scores Scoring scheme. Gap scores have to be non-positive, mismatch must not exceed match and all scores have to be within [-1000, 1000].
+/// \param max_bandwidth If non-negative, global alignments only consider diagonals at most max_bandwidth away from the diagonals of the corners of the DP matrix. Ignored for semi-global alignments.
+/// \param thread_pool Thread pool to run the alignments on, has to outlive the aligner. Defaults to the process-wide thread pool.
+///
+/// \return Unique pointer to Aligner object
+std::unique_ptr<Aligner> create_cpu_aligner(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type, const AffineGapScores& scores, int32_t max_bandwidth = -1, ThreadPool& thread_pool = get_global_thread_pool());
+
+/// \brief Created Aligner object which computes global alignments with the wavefront algorithm (WFA) on the CPU
+///
+/// The run time depends on the penalty of the alignment and is low for sequences of high identity.
+/// The alignments of a batch are computed in parallel as tasks of thread_pool,
+/// align_all() returns as soon as the tasks are submitted and sync_alignments() waits for them.
+///
+/// \param max_query_length Maximum length of query string
+/// \param max_target_length Maximum length of target string
+/// \param max_alignments Maximum number of alignments to be performed
+/// \param penalties Penalties of mismatches and gaps. Mismatch and gap extension penalties have to be positive, the gap opening penalty non-negative. {1, 0, 1} computes edit distance alignments.
+/// \param memory_mode WavefrontMemoryMode::bidirectional needs memory linear in the penalty of the alignment, WavefrontMemoryMode::full quadratic memory but less time.
+/// \param thread_pool Thread pool to run the alignments on, has to outlive the aligner. Defaults to the process-wide thread pool.
+///
+/// \return Unique pointer to Aligner object
+std::unique_ptr<Aligner> create_wavefront_aligner(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, const WavefrontPenalties& penalties = WavefrontPenalties(),
+                                                  WavefrontMemoryMode memory_mode = WavefrontMemoryMode::full, ThreadPool& thread_pool = get_global_thread_pool());
+
+/// \brief Created Aligner object which computes global alignments with unit costs on the CPU, splitting each alignment into tasks
+///
+/// Each alignment is divided recursively with Hirschberg's algorithm, using Myers' bit-parallel algorithm for the last rows of
+/// every split, and the two subproblems of each split are run as tasks of thread_pool down to tiles which are aligned with full Myers matrices.
+/// A single long alignment (e.g. 1 Mbp) therefore keeps all threads of the pool busy while its memory stays linear in the sequence lengths.
+/// align_all() returns as soon as the tasks are submitted and sync_alignments() waits for them.
+/// Only characters from the alphabet [ACGT] are guaranteed to provide correct results, all other characters are treated as mismatches.
+///
+/// \param max_query_length Maximum length of query string
+/// \param max_target_length Maximum length of target string
+/// \param max_alignments Maximum number of alignments to be performed
+/// \param thread_pool Thread pool to run the alignments on, has to outlive the aligner. Defaults to the process-wide thread pool.
+/// \param max_tile_cells Maximum number of cells of the subproblems aligned with a full Myers matrix, has to be positive
+///
+/// \return Unique pointer to Aligner object
+std::unique_ptr<Aligner> create_hirschberg_myers_cpu_aligner(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments,
+                                                             ThreadPool& thread_pool = get_global_thread_pool(), int64_t max_tile_cells = 1 << 22);
 /// \}
 } // namespace cudaaligner
 
@@ -46,6 +46,19 @@ typedef struct FormattedAlignment
     uint32_t linebreak_after = 80;
 } FormattedAlignment;
 
+/// AlignedInterval - Half-open intervals of query and target covered by an alignment.
+struct AlignedInterval
+{
+    /// \brief position of the first aligned base of the query
+    int32_t query_start;
+    /// \brief position past the last aligned base of the query
+    int32_t query_end;
+    /// \brief position of the first aligned base of the target
+    int32_t target_start;
+    /// \brief position past the last aligned base of the target
+    int32_t target_end;
+};
+
 /// \brief Write FormattedAlignment struct content to output stream
 ///
 /// \return ostream
@@ -100,6 +113,13 @@ public:
     /// \return the number of edits of the found alignment
     virtual int32_t get_edit_distance() const = 0;
 
+    /// \brief Returns the parts of query and target covered by the alignment
+    ///
+    /// For global alignments these are the full sequences. get_alignment(), convert_to_cigar() and format_alignment()
+    /// describe only the covered parts.
+    /// \return aligned intervals of query and target
+    virtual AlignedInterval get_aligned_interval() const = 0;
+
     /// \brief Print formatted alignment to stderr.
     virtual FormattedAlignment format_alignment(int32_t maximal_line_length = 80) const = 0;
 };
@@ -0,0 +1,153 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+/// \addtogroup cudaaligner
+/// \{
+
+/// AsyncAligner - Asynchronous front end for Aligners.
+///
+/// Alignments are submitted one by one and queued. Each of several engines owns an Aligner, takes a batch
+/// of queued alignments, aligns it and hands out the results, so one engine fills its batch while others
+/// are aligning (double buffering with two engines). Submitting blocks while too many alignments are queued.
+/// Engines do not own threads, an engine runs as a task of a ThreadPool while there are batches to align.
+/// Works with every Aligner, e.g. from create_aligner() (with a separate CUDA stream per engine) or create_cpu_aligner().
+class AsyncAligner
+{
+public:
+    /// \brief Creates the Aligner of one engine, the Aligners must accept batch_size alignments
+    using AlignerFactory = std::function<std::unique_ptr<Aligner>()>;
+
+    /// \brief Called with the result of a submitted alignment by an engine, alignment is nullptr unless status is StatusType::success.
+    /// Callbacks of different alignments can be called concurrently and must not throw.
+    using CompletionCallback = std::function<void(StatusType status, std::shared_ptr<Alignment> alignment)>;
+
+    /// \brief Constructor, creates the Aligners of the engines
+    /// \param create_aligner Called number_of_engines times to create the Aligners
+    /// \param batch_size Maximum number of alignments aligned together by one engine
+    /// \param number_of_engines Number of batches which are filled or aligned concurrently, 2 for double buffering
+    /// \param max_queued_alignments Submitting blocks while this many alignments are queued and not yet taken by an engine, -1 for 2 * batch_size * number_of_engines
+    /// \param thread_pool Thread pool to run the engines on, has to outlive the AsyncAligner. Defaults to the process-wide thread pool.
+    ///                    submit() must not be called from its tasks, as it can block until an engine makes space in the queue.
+    AsyncAligner(const AlignerFactory& create_aligner, int32_t batch_size, int32_t number_of_engines = 2, int32_t max_queued_alignments = -1, ThreadPool& thread_pool = get_global_thread_pool());
+
+    /// \brief Destructor, waits for all submitted alignments
+    ~AsyncAligner();
+
+    AsyncAligner(const AsyncAligner&) = delete;
+    AsyncAligner& operator=(const AsyncAligner&) = delete;
+
+    /// \brief Queues an alignment, the sequences are copied
+    /// \param query Query string
+    /// \param query_length Query string length
+    /// \param target Target string
+    /// \param target_length Target string length
+    /// \param reverse_complement_query Reverse complement the query string
+    /// \param reverse_complement_target Reverse complement the target string
+    /// \param callback Called with the result once the alignment is computed
+    void submit(const char* query, int32_t query_length, const char* target, int32_t target_length,
+                bool reverse_complement_query, bool reverse_complement_target, CompletionCallback callback);
+
+    /// \brief Queues an alignment, the sequences are copied
+    /// \param query Query string
+    /// \param query_length Query string length
+    /// \param target Target string
+    /// \param target_length Target string length
+    /// \param reverse_complement_query Reverse complement the query string
+    /// \param reverse_complement_target Reverse complement the target string
+    /// \return future of the alignment, holds a std::runtime_error if the alignment failed
+    std::future<std::shared_ptr<Alignment>> submit(const char* query, int32_t query_length, const char* target, int32_t target_length,
+                                                   bool reverse_complement_query = false, bool reverse_complement_target = false);
+
+    /// \brief Lets the engines take all queued alignments, even if they do not fill a whole batch
+    void flush();
+
+    /// \brief Flushes and blocks until all submitted alignments are completed
+    void wait();
+
+private:
+    struct Request
+    {
+        std::string query;
+        std::string target;
+        bool reverse_complement_query;
+        bool reverse_complement_target;
+        CompletionCallback callback;
+    };
+
+    /// \brief returns whether an engine can take a batch, mutex_ has to be locked
+    bool is_batch_available() const;
+
+    /// \brief returns the Aligner of an idle engine if there is a batch for it, nullptr otherwise, mutex_ has to be locked
+    Aligner* take_idle_engine();
+
+    /// \brief runs an engine with the given Aligner as a task of engines_
+    void start_engine(Aligner* aligner);
+
+    /// \brief aligns batches while they are available, then makes the engine idle again
+    void run_engine(Aligner& aligner);
+
+    void align_batch(Aligner& aligner, std::vector<Request>& batch);
+
+    int32_t batch_size_;
+    int32_t max_queued_alignments_;
+    std::vector<std::unique_ptr<Aligner>> aligners_;
+    std::vector<Aligner*> idle_aligners_;
+
+    std::mutex mutex_;
+    std::condition_variable space_available_;
+    std::condition_variable requests_completed_;
+    std::deque<Request> queue_;
+    int64_t submitted_requests_ = 0;
+    int64_t taken_requests_     = 0;
+    int64_t flushed_requests_   = 0;
+    int64_t completed_requests_ = 0;
+
+    // declared last, so that running engines are waited for before anything they use is destroyed
+    TaskGroup engines_;
+};
+
+/// \}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
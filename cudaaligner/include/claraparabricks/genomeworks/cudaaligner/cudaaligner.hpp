@@ -45,7 +45,61 @@ enum StatusType
 enum AlignmentType
 {
     global_alignment = 0,
-    unset
+    unset,
+    semi_global_alignment,        // query aligned end-to-end, gaps before and after the aligned part of the target are free
+    extension_alignment,          // prefixes of query and target aligned from their first bases, extension stops with an X-drop criterion
+    global_affine_alignment,      // like global_alignment, but maximizing an AffineGapScores score instead of minimizing edits
+    semi_global_affine_alignment, // like semi_global_alignment, but maximizing an AffineGapScores score instead of minimizing edits
+    local_alignment               // best-scoring pair of substrings of query and target under an AffineGapScores score (Smith-Waterman)
+};
+
+/// AffineGapScores - Scoring scheme of affine gap alignments.
+///
+/// A gap of length l scores gap_open + l * gap_extend.
+struct AffineGapScores
+{
+    /// \brief score of aligned identical bases
+    int32_t match = 2;
+    /// \brief score of aligned different bases
+    int32_t mismatch = -4;
+    /// \brief score for opening a gap, non-positive
+    int32_t gap_open = -4;
+    /// \brief score for each base of a gap, non-positive
+    int32_t gap_extend = -2;
+};
+
+/// WavefrontPenalties - Penalties of wavefront alignments, matches are free.
+///
+/// A gap of length l costs gap_open + l * gap_extend. WavefrontPenalties{1, 0, 1} yields edit distance alignments.
+struct WavefrontPenalties
+{
+    /// \brief penalty of aligned different bases, positive
+    int32_t mismatch = 4;
+    /// \brief penalty for opening a gap, non-negative
+    int32_t gap_open = 6;
+    /// \brief penalty for each base of a gap, positive
+    int32_t gap_extend = 2;
+};
+
+/// WavefrontMemoryMode - Trade-off between memory usage and speed of wavefront alignments.
+enum class WavefrontMemoryMode
+{
+    full = 0,     // all wavefronts are kept for the traceback, O(s^2) memory for an alignment with penalty s
+    bidirectional // alignments are split recursively where forward and reverse wavefronts meet (BiWFA), O(s) memory
+};
+
+/// CpuAlignmentMemoryMode - Trade-off between memory usage and speed of global alignments on the CPU.
+enum class CpuAlignmentMemoryMode
+{
+    full = 0, // Myers' bit-parallel algorithm keeps its whole matrix for the traceback, O(n * m) memory
+    linear    // anti-diagonal Needleman-Wunsch in SIMD lanes with Hirschberg's traceback, O(n + m) memory
+};
+
+/// AlignmentResultsMode - Representation of the results of an Aligner.
+enum class AlignmentResultsMode
+{
+    alignment_objects = 0, // one Alignment object per alignment, see Aligner::get_alignments()
+    run_length             // run-length encoded alignments in one arena, see Aligner::get_run_length_alignments()
 };
 
 /// AlignmentState - Enum for encoding each position in alignment.
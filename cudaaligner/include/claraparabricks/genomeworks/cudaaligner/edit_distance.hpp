@@ -0,0 +1,62 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// \addtogroup cudaaligner
+/// \{
+
+/// Value returned by compute_edit_distances() for pairs whose edit distance is larger than max_distance
+constexpr int32_t edit_distance_exceeds_max = -1;
+
+/// \brief Computes global edit distances of pairs of sequences on the CPU without computing the alignments
+///
+/// With max_distance >= 0 only edit distances up to max_distance are computed exactly. Each pair is processed with a
+/// banded Myers bit-vector algorithm restricted to the diagonals an alignment with at most max_distance edits can use,
+/// and the computation of a pair stops as soon as all cells of a column exceed max_distance.
+/// With max_distance < 0 all edit distances are computed exactly. Pairs are distributed over the tasks of thread_pool.
+/// Only strings with characters from the alphabet [ACGT] are guaranteed to provide correct results.
+///
+/// \param pairs Pairs of query and target strings
+/// \param max_distance Largest edit distance of interest, negative for no limit
+/// \param thread_pool Thread pool to run the computation on. Defaults to the process-wide thread pool.
+/// \return Edit distances in the order of pairs, edit_distance_exceeds_max for pairs whose edit distance exceeds max_distance
+std::vector<int32_t> compute_edit_distances(const std::vector<std::pair<std::string, std::string>>& pairs,
+                                            int32_t max_distance,
+                                            ThreadPool& thread_pool = get_global_thread_pool());
+
+/// \}
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,73 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/cudaaligner.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// \addtogroup cudaaligner
+/// \{
+
+/// LocalAlignmentScore - Score and end of the best local alignment of two sequences.
+///
+/// The end is the first cell of the score matrix which reaches the score, columns (target positions) first.
+/// Both ends are 0 if no pair of substrings has a positive score.
+struct LocalAlignmentScore
+{
+    /// \brief score of the best local alignment, non-negative
+    int32_t score;
+    /// \brief position past the last aligned base of the query
+    int32_t query_end;
+    /// \brief position past the last aligned base of the target
+    int32_t target_end;
+};
+
+/// \brief Computes Smith-Waterman scores of pairs of sequences on the CPU without computing the alignments
+///
+/// Intended for screening, e.g. for adapters or chimeric reads, before aligning the interesting pairs with
+/// an AlignmentType::local_alignment aligner. Each pair is scored with a striped SIMD kernel in memory linear
+/// in the query length, pairs are distributed over the tasks of thread_pool.
+///
+/// \param pairs Pairs of query and target strings
+/// \param scores Scoring scheme. Gap scores have to be non-positive, mismatch must not exceed match and all scores have to be within [-1000, 1000].
+/// \param thread_pool Thread pool to run the computation on. Defaults to the process-wide thread pool.
+/// \return Scores and ends of the best local alignments in the order of pairs
+std::vector<LocalAlignmentScore> compute_local_alignment_scores(const std::vector<std::pair<std::string, std::string>>& pairs,
+                                                                const AffineGapScores& scores = AffineGapScores(),
+                                                                ThreadPool& thread_pool       = get_global_thread_pool());
+
+/// \}
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,175 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+#include <claraparabricks/genomeworks/cudaaligner/cudaaligner.hpp>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+/// \addtogroup cudaaligner
+/// \{
+
+/// RunLengthAlignments - Alignments of a batch as run-length encoded AlignmentStates in a single arena.
+///
+/// Every run of equal AlignmentStates is one uint32_t (length << 2 | state), all runs of all alignments are
+/// stored in one vector. Unlike Alignment objects no copies of the sequences are kept, which makes the
+/// results of long alignments much smaller. CIGAR strings are produced directly from the runs.
+class RunLengthAlignments
+{
+public:
+    /// \brief Longest run which fits into one encoded run, longer runs are split
+    static constexpr int32_t max_run_length = (1 << 30) - 1;
+
+    /// \brief Encodes a run of AlignmentStates
+    static uint32_t encode_run(const AlignmentState state, const int32_t length)
+    {
+        assert(length > 0 && length <= max_run_length);
+        return static_cast<uint32_t>(length) << 2 | static_cast<uint32_t>(state);
+    }
+
+    /// \brief Returns the AlignmentState of an encoded run
+    static AlignmentState get_run_state(const uint32_t run)
+    {
+        return static_cast<AlignmentState>(run & 3u);
+    }
+
+    /// \brief Returns the length of an encoded run
+    static int32_t get_run_length(const uint32_t run)
+    {
+        return static_cast<int32_t>(run >> 2);
+    }
+
+    /// \brief Returns the number of alignments
+    int32_t size() const
+    {
+        return static_cast<int32_t>(statuses_.size());
+    }
+
+    /// \brief Returns the status of alignment i, only successful alignments have runs
+    StatusType get_status(const int32_t i) const
+    {
+        return statuses_[i];
+    }
+
+    /// \brief Returns if alignment i is optimal or an approximation
+    bool is_optimal(const int32_t i) const
+    {
+        return optimal_[i] != 0;
+    }
+
+    /// \brief Returns the parts of query and target covered by alignment i, see Alignment::get_aligned_interval()
+    const AlignedInterval& get_aligned_interval(const int32_t i) const
+    {
+        return intervals_[i];
+    }
+
+    /// \brief Returns a pointer to the first encoded run of alignment i
+    const uint32_t* runs_begin(const int32_t i) const
+    {
+        return runs_.data() + run_offsets_[i];
+    }
+
+    /// \brief Returns a pointer past the last encoded run of alignment i
+    const uint32_t* runs_end(const int32_t i) const
+    {
+        return runs_.data() + run_offsets_[i + 1];
+    }
+
+    /// \brief Returns the number of encoded runs of alignment i
+    int32_t get_number_of_runs(const int32_t i) const
+    {
+        return static_cast<int32_t>(run_offsets_[i + 1] - run_offsets_[i]);
+    }
+
+    /// \brief Expands alignment i into one AlignmentState per column
+    std::vector<AlignmentState> get_alignment(int32_t i) const;
+
+    /// \brief Returns the number of mismatches, insertions and deletions of alignment i
+    int32_t get_edit_distance(int32_t i) const;
+
+    /// \brief Converts alignment i to CIGAR format with M, I and D states, like Alignment::convert_to_cigar()
+    std::string convert_to_cigar(int32_t i) const;
+
+    /// \brief Converts alignment i to extended CIGAR format, which distinguishes matches (=) and mismatches (X)
+    std::string convert_to_extended_cigar(int32_t i) const;
+
+    /// \brief Appends an alignment
+    /// \param first iterator to the first AlignmentState, its value type has to be convertible to AlignmentState
+    /// \param last iterator past the last AlignmentState
+    /// \param is_optimal whether the alignment is optimal
+    /// \param interval parts of query and target covered by the alignment
+    template <typename Iterator>
+    void add_alignment(Iterator first, const Iterator last, const bool is_optimal, const AlignedInterval& interval)
+    {
+        AlignmentState state = AlignmentState::match;
+        int32_t length       = 0;
+        for (; first != last; ++first)
+        {
+            const AlignmentState s = static_cast<AlignmentState>(*first);
+            if (length > 0 && (s != state || length == max_run_length))
+            {
+                runs_.push_back(encode_run(state, length));
+                length = 0;
+            }
+            state = s;
+            ++length;
+        }
+        if (length > 0)
+        {
+            runs_.push_back(encode_run(state, length));
+        }
+        run_offsets_.push_back(static_cast<int64_t>(runs_.size()));
+        statuses_.push_back(StatusType::success);
+        optimal_.push_back(is_optimal ? 1 : 0);
+        intervals_.push_back(interval);
+    }
+
+    /// \brief Appends an alignment without runs, e.g. one which failed
+    /// \param status status of the alignment
+    void add_empty_alignment(StatusType status);
+
+    /// \brief Removes all alignments, keeps the memory of the arena
+    void clear();
+
+private:
+    std::vector<uint32_t> runs_;
+    std::vector<int64_t> run_offsets_ = std::vector<int64_t>(1, 0);
+    std::vector<StatusType> statuses_;
+    std::vector<int8_t> optimal_;
+    std::vector<AlignedInterval> intervals_;
+};
+
+/// \}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
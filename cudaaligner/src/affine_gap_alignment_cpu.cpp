@@ -0,0 +1,484 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "affine_gap_alignment_cpu.hpp"
+#include "simd_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+constexpr int32_t max_abs_score = 1000;
+
+// difference used for gaps entering the band from outside, far below any difference reachable with valid scores
+constexpr int16_t out_of_band = -8192;
+
+// traceback byte of cell (i,j): source of H(i,j) in the lowest two bits and whether the gaps leaving the cell are extended
+constexpr int16_t from_diagonal      = 0;
+constexpr int16_t from_deletion      = 1; // H(i,j) == E(i,j), gap in the target
+constexpr int16_t from_insertion     = 2; // H(i,j) == F(i,j), gap in the query
+constexpr int16_t source_mask        = 3;
+constexpr int16_t deletion_extended  = 4; // E(i+1,j) extends E(i,j)
+constexpr int16_t insertion_extended = 8; // F(i,j+1) extends F(i,j)
+
+/// AffineGapProblem - sequences padded for full-width vector loads and the band of diagonals to compute
+struct AffineGapProblem
+{
+    std::vector<char> reversed_query;
+    std::vector<char> target;
+    int32_t query_length;
+    int32_t target_length;
+    int16_t match;
+    int16_t mismatch;
+    int16_t gap_open;
+    int16_t gap_extend;
+    bool semi_global;
+    int32_t band_begin; // smallest j - i of computed cells
+    int32_t band_end;   // largest j - i of computed cells
+};
+
+/// TracebackMatrix - traceback bytes of the computed cells, stored by anti-diagonal
+class TracebackMatrix
+{
+public:
+    /// \brief Constructor
+    /// \param max_cells upper bound of the number of cells which will be added including padding, avoids reallocations
+    TracebackMatrix(const int32_t query_length, const int32_t target_length, const int64_t max_cells)
+        : cells_(max_cells)
+        , offsets_(query_length + target_length + 2, 0)
+        , first_columns_(query_length + target_length + 1, 0)
+    {
+    }
+
+    /// \brief reserves the cells [first_column, last_column] of anti-diagonal r plus padding, returns a pointer to the first one
+    int8_t* add_diagonal(const int32_t r, const int32_t first_column, const int32_t last_column, const int32_t padding)
+    {
+        first_columns_[r]  = first_column;
+        offsets_[r + 1]    = offsets_[r] + std::max(last_column - first_column + 1, 0);
+        const int64_t size = offsets_[r + 1] + padding;
+        if (get_size<int64_t>(cells_) < size)
+        {
+            cells_.resize(std::max(size, 2 * get_size<int64_t>(cells_)));
+        }
+        return cells_.data() + offsets_[r];
+    }
+
+    int8_t get(const int32_t i, const int32_t j) const
+    {
+        const int32_t r = i + j;
+        assert(j >= first_columns_[r] && offsets_[r] + j - first_columns_[r] < offsets_[r + 1]);
+        return cells_[offsets_[r] + j - first_columns_[r]];
+    }
+
+private:
+    std::vector<int8_t> cells_;
+    std::vector<int64_t> offsets_;
+    std::vector<int32_t> first_columns_;
+};
+
+GW_CUDAALIGNER_BEGIN_SIMD_KERNELS
+
+/// VectorTypes - GCC vector types of NumberOfLanes 16-bit differences and of NumberOfLanes bytes
+template <int32_t NumberOfLanes>
+struct VectorTypes;
+
+template <>
+struct VectorTypes<8>
+{
+    typedef int16_t vector_t __attribute__((vector_size(16)));
+    typedef int8_t byte_vector_t __attribute__((vector_size(8)));
+};
+
+template <>
+struct VectorTypes<16>
+{
+    typedef int16_t vector_t __attribute__((vector_size(32)));
+    typedef int8_t byte_vector_t __attribute__((vector_size(16)));
+};
+
+template <>
+struct VectorTypes<32>
+{
+    typedef int16_t vector_t __attribute__((vector_size(64)));
+    typedef int8_t byte_vector_t __attribute__((vector_size(32)));
+};
+
+/// \brief converts each lane of a vector to the lane type of To
+template <typename From, typename To>
+__attribute__((always_inline)) inline void convert_lanes(const From& from, To& to)
+{
+    to = __builtin_convertvector(from, To);
+}
+
+/// \brief fills the traceback matrix processing NumberOfLanes cells of an anti-diagonal at once
+///
+/// Query bases are rows i, target bases columns j. With u(i,j) = H(i,j) - H(i-1,j), v(i,j) = H(i,j) - H(i,j-1),
+/// x(i,j) = E(i+1,j) - H(i,j), y(i,j) = F(i,j+1) - H(i,j) and z(i,j) = H(i,j) - H(i-1,j-1):
+///   z(i,j) = max(s(i,j), x(i-1,j) + v(i-1,j), y(i,j-1) + u(i,j-1))
+///   u(i,j) = z(i,j) - v(i-1,j),                      v(i,j) = z(i,j) - u(i,j-1)
+///   x(i,j) = max(x(i-1,j) - u(i,j), open) + extend,  y(i,j) = max(y(i,j-1) - v(i,j), open) + extend
+/// All values of anti-diagonal r only depend on anti-diagonal r-1, the arrays are indexed by column.
+/// If semi-global, last_row receives H(query_length, j).
+template <int32_t NumberOfLanes>
+__attribute__((always_inline)) inline void affine_gap_compute_traceback_lanes(const AffineGapProblem& problem, TracebackMatrix& traceback, std::vector<int32_t>& last_row)
+{
+    using vector_t      = typename VectorTypes<NumberOfLanes>::vector_t;
+    using byte_vector_t = typename VectorTypes<NumberOfLanes>::byte_vector_t;
+
+    const int32_t m         = problem.query_length;
+    const int32_t n         = problem.target_length;
+    const int16_t open      = problem.gap_open;
+    const int16_t extend    = problem.gap_extend;
+    const int16_t new_gap   = open + extend;
+    const vector_t zero     = {};
+    const vector_t match    = zero + problem.match;
+    const vector_t mismatch = zero + problem.mismatch;
+    const vector_t open_v   = zero + open;
+    const vector_t extend_v = zero + extend;
+
+    const int32_t array_size  = n + 1 + NumberOfLanes;
+    std::vector<int16_t> u[2] = {std::vector<int16_t>(array_size, 0), std::vector<int16_t>(array_size, 0)};
+    std::vector<int16_t> v[2] = {std::vector<int16_t>(array_size, 0), std::vector<int16_t>(array_size, 0)};
+    std::vector<int16_t> x[2] = {std::vector<int16_t>(array_size, 0), std::vector<int16_t>(array_size, 0)};
+    std::vector<int16_t> y[2] = {std::vector<int16_t>(array_size, 0), std::vector<int16_t>(array_size, 0)};
+
+    int32_t last_row_score = open + m * extend;
+    if (problem.semi_global)
+    {
+        last_row.assign(n + 1, 0);
+        last_row[0] = last_row_score;
+    }
+
+    for (int32_t r = 2; r <= m + n; ++r)
+    {
+        const int32_t previous = r % 2;
+        const int32_t current  = 1 - previous;
+        // columns j of the computed cells (r - j, j), the band limits 2j - r to [band_begin, band_end]
+        const int32_t first_column = std::max({1, r - m, (r + problem.band_begin + 1) / 2});
+        const int32_t last_column  = std::min({n, r - 1, (r + problem.band_end) / 2});
+        int8_t* const cells        = traceback.add_diagonal(r, first_column, last_column, NumberOfLanes);
+        if (first_column > last_column)
+        {
+            continue;
+        }
+
+        // the cell above the last cell and the cell left of the first cell are either outside the band or on the border of the matrix
+        if (last_column - (r - last_column) + 1 > problem.band_end)
+        {
+            x[previous][last_column] = out_of_band;
+            v[previous][last_column] = 0;
+        }
+        else if (last_column == r - 1)
+        {
+            x[previous][last_column] = new_gap;
+            v[previous][last_column] = problem.semi_global ? 0 : (last_column == 1 ? new_gap : extend);
+        }
+        if (first_column - 1 - (r - first_column) < problem.band_begin)
+        {
+            y[previous][first_column - 1] = out_of_band;
+            u[previous][first_column - 1] = 0;
+        }
+        else if (first_column == 1)
+        {
+            y[previous][0] = new_gap;
+            u[previous][0] = r == 2 ? new_gap : extend;
+        }
+
+        for (int32_t j = first_column; j <= last_column; j += NumberOfLanes)
+        {
+            vector_t u_left, v_above, x_above, y_left;
+            byte_vector_t query_bases, target_bases;
+            std::memcpy(&u_left, &u[previous][j - 1], sizeof(vector_t));
+            std::memcpy(&y_left, &y[previous][j - 1], sizeof(vector_t));
+            std::memcpy(&v_above, &v[previous][j], sizeof(vector_t));
+            std::memcpy(&x_above, &x[previous][j], sizeof(vector_t));
+            std::memcpy(&query_bases, &problem.reversed_query[m - r + j], sizeof(byte_vector_t));
+            std::memcpy(&target_bases, &problem.target[j - 1], sizeof(byte_vector_t));
+
+            const byte_vector_t equal_bases = query_bases == target_bases;
+            vector_t is_match;
+            convert_lanes(equal_bases, is_match);
+            vector_t z      = is_match ? match : mismatch;
+            vector_t source = zero;
+
+            const vector_t deletion      = x_above + v_above;
+            const vector_t take_deletion = deletion > z;
+            z                            = take_deletion ? deletion : z;
+            source                       = take_deletion ? zero + from_deletion : source;
+
+            const vector_t insertion      = y_left + u_left;
+            const vector_t take_insertion = insertion > z;
+            z                             = take_insertion ? insertion : z;
+            source                        = take_insertion ? zero + from_insertion : source;
+
+            const vector_t u_new = z - v_above;
+            const vector_t v_new = z - u_left;
+
+            const vector_t deletion_gap    = x_above - u_new;
+            const vector_t extend_deletion = deletion_gap > open_v;
+            const vector_t x_new           = (extend_deletion ? deletion_gap : open_v) + extend_v;
+
+            const vector_t insertion_gap    = y_left - v_new;
+            const vector_t extend_insertion = insertion_gap > open_v;
+            const vector_t y_new            = (extend_insertion ? insertion_gap : open_v) + extend_v;
+
+            source = source | (extend_deletion & deletion_extended) | (extend_insertion & insertion_extended);
+
+            std::memcpy(&u[current][j], &u_new, sizeof(vector_t));
+            std::memcpy(&v[current][j], &v_new, sizeof(vector_t));
+            std::memcpy(&x[current][j], &x_new, sizeof(vector_t));
+            std::memcpy(&y[current][j], &y_new, sizeof(vector_t));
+            byte_vector_t source_bytes;
+            convert_lanes(source, source_bytes);
+            std::memcpy(cells + (j - first_column), &source_bytes, sizeof(byte_vector_t));
+        }
+
+        if (problem.semi_global && r - m >= first_column && r - m <= last_column)
+        {
+            last_row_score += v[current][r - m];
+            last_row[r - m] = last_row_score;
+        }
+    }
+}
+
+GW_CUDAALIGNER_END_SIMD_KERNELS
+
+void affine_gap_compute_traceback_baseline(const AffineGapProblem& problem, TracebackMatrix& traceback, std::vector<int32_t>& last_row)
+{
+    affine_gap_compute_traceback_lanes<8>(problem, traceback, last_row);
+}
+
+#ifdef GW_CUDAALIGNER_X86_SIMD
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+void affine_gap_compute_traceback_avx2(const AffineGapProblem& problem, TracebackMatrix& traceback, std::vector<int32_t>& last_row)
+{
+    affine_gap_compute_traceback_lanes<16>(problem, traceback, last_row);
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512bw")
+
+void affine_gap_compute_traceback_avx512(const AffineGapProblem& problem, TracebackMatrix& traceback, std::vector<int32_t>& last_row)
+{
+    affine_gap_compute_traceback_lanes<32>(problem, traceback, last_row);
+}
+
+#pragma GCC pop_options
+#endif
+
+std::vector<AlignmentState> affine_gap_backtrace(const TracebackMatrix& traceback, const AffineGapProblem& problem, int32_t j, int32_t& target_start)
+{
+    enum class Matrix
+    {
+        h,
+        e,
+        f
+    };
+
+    const int32_t m = problem.query_length;
+    int32_t i       = m;
+    std::vector<AlignmentState> path;
+    path.reserve(i + j);
+
+    Matrix matrix = Matrix::h;
+    while (i > 0 && j > 0)
+    {
+        if (matrix == Matrix::h)
+        {
+            const int8_t source = traceback.get(i, j) & source_mask;
+            if (source == from_diagonal)
+            {
+                path.push_back(problem.reversed_query[m - i] == problem.target[j - 1] ? AlignmentState::match : AlignmentState::mismatch);
+                --i;
+                --j;
+                continue;
+            }
+            matrix = source == from_deletion ? Matrix::e : Matrix::f;
+        }
+        if (matrix == Matrix::e)
+        {
+            path.push_back(AlignmentState::deletion);
+            --i;
+            if (i == 0 || !(traceback.get(i, j) & deletion_extended))
+            {
+                matrix = Matrix::h;
+            }
+        }
+        else
+        {
+            path.push_back(AlignmentState::insertion);
+            --j;
+            if (j == 0 || !(traceback.get(i, j) & insertion_extended))
+            {
+                matrix = Matrix::h;
+            }
+        }
+    }
+    path.insert(path.end(), i, AlignmentState::deletion);
+    if (!problem.semi_global)
+    {
+        path.insert(path.end(), j, AlignmentState::insertion);
+        j = 0;
+    }
+    target_start = j;
+
+    std::reverse(begin(path), end(path));
+    return path;
+}
+
+} // namespace
+
+void validate_affine_gap_scores(const AffineGapScores& scores)
+{
+    if (scores.gap_open > 0 || scores.gap_extend > 0)
+    {
+        throw std::invalid_argument("Affine gap scores must be non-positive.");
+    }
+    if (scores.mismatch > scores.match)
+    {
+        throw std::invalid_argument("Mismatch score must not exceed match score.");
+    }
+    if (std::abs(scores.match) > max_abs_score || std::abs(scores.mismatch) > max_abs_score || std::abs(scores.gap_open) > max_abs_score || std::abs(scores.gap_extend) > max_abs_score)
+    {
+        throw std::invalid_argument("Affine gap alignment scores must not exceed 1000 in magnitude.");
+    }
+}
+
+std::vector<AlignmentState> affine_gap_compute_alignment_cpu(const char* query, const int32_t query_length,
+                                                             const char* target, const int32_t target_length,
+                                                             const AffineGapScores& scores,
+                                                             const bool semi_global,
+                                                             const int32_t max_bandwidth,
+                                                             AlignedInterval& aligned_interval,
+                                                             const InstructionSet instruction_set)
+{
+    throw_on_negative(query_length, "query_length must be non-negative.");
+    throw_on_negative(target_length, "target_length must be non-negative.");
+    validate_affine_gap_scores(scores);
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        throw std::invalid_argument("Requested instruction set is not supported on this machine.");
+    }
+
+    if (query_length == 0)
+    {
+        aligned_interval = {0, 0, 0, semi_global ? 0 : target_length};
+        return std::vector<AlignmentState>(semi_global ? 0 : target_length, AlignmentState::insertion);
+    }
+    if (target_length == 0)
+    {
+        aligned_interval = {0, query_length, 0, 0};
+        return std::vector<AlignmentState>(query_length, AlignmentState::deletion);
+    }
+
+    constexpr int32_t padding = 32; // largest number of lanes
+    AffineGapProblem problem;
+    problem.reversed_query.assign(query_length + padding, '\0');
+    std::reverse_copy(query, query + query_length, begin(problem.reversed_query));
+    problem.target.assign(target_length + padding, '\0');
+    std::copy(target, target + target_length, begin(problem.target));
+    problem.query_length  = query_length;
+    problem.target_length = target_length;
+    problem.match         = static_cast<int16_t>(scores.match);
+    problem.mismatch      = static_cast<int16_t>(scores.mismatch);
+    problem.gap_open      = static_cast<int16_t>(scores.gap_open);
+    problem.gap_extend    = static_cast<int16_t>(scores.gap_extend);
+    problem.semi_global   = semi_global;
+    if (max_bandwidth < 0 || semi_global)
+    {
+        problem.band_begin = -query_length;
+        problem.band_end   = target_length;
+    }
+    else
+    {
+        problem.band_begin = std::min(0, target_length - query_length) - max_bandwidth;
+        problem.band_end   = std::max(0, target_length - query_length) + max_bandwidth;
+    }
+
+    const int64_t band_cells = static_cast<int64_t>(query_length) * std::min(target_length, problem.band_end - problem.band_begin + 1);
+    TracebackMatrix traceback(query_length, target_length, band_cells + padding);
+    std::vector<int32_t> last_row;
+    switch (instruction_set)
+    {
+#ifdef GW_CUDAALIGNER_X86_SIMD
+    case InstructionSet::avx512:
+        if (__builtin_cpu_supports("avx512bw"))
+        {
+            affine_gap_compute_traceback_avx512(problem, traceback, last_row);
+            break;
+        }
+        affine_gap_compute_traceback_avx2(problem, traceback, last_row);
+        break;
+    case InstructionSet::avx2: affine_gap_compute_traceback_avx2(problem, traceback, last_row); break;
+#endif
+    default: affine_gap_compute_traceback_baseline(problem, traceback, last_row); break;
+    }
+
+    // semi-global alignments end in the leftmost column with the largest score in the last row
+    const int32_t target_end = semi_global ? static_cast<int32_t>(std::max_element(begin(last_row), end(last_row)) - begin(last_row)) : target_length;
+
+    int32_t target_start                  = 0;
+    std::vector<AlignmentState> alignment = affine_gap_backtrace(traceback, problem, target_end, target_start);
+    aligned_interval                      = {0, query_length, target_start, target_end};
+    return alignment;
+}
+
+int32_t compute_affine_gap_score(const std::vector<AlignmentState>& alignment, const AffineGapScores& scores)
+{
+    int32_t score                 = 0;
+    AlignmentState previous_state = AlignmentState::match;
+    for (const AlignmentState s : alignment)
+    {
+        switch (s)
+        {
+        case AlignmentState::match: score += scores.match; break;
+        case AlignmentState::mismatch: score += scores.mismatch; break;
+        default:
+            score += (s == previous_state ? 0 : scores.gap_open) + scores.gap_extend;
+            break;
+        }
+        previous_state = s;
+    }
+    return score;
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,78 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include "edit_distance_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// \brief Checks that scores can be used by affine_gap_compute_alignment_cpu
+/// \param scores
+/// \throw std::invalid_argument if a gap score is positive, mismatch exceeds match or a score exceeds 1000 in magnitude
+void validate_affine_gap_scores(const AffineGapScores& scores);
+
+/// \brief Computes an optimal affine gap alignment on the CPU
+///
+/// Uses the difference recurrence of Suzuki and Kasahara: instead of the scores themselves, only the differences between
+/// neighbouring cells are computed, which are bounded by the scoring scheme independently of the sequence lengths.
+/// The cells of one anti-diagonal do not depend on each other and are processed in SIMD lanes of 16-bit differences
+/// (8 lanes for InstructionSet::scalar using the baseline 128-bit vectors, 16 lanes for AVX2, 32 lanes for AVX-512 if AVX-512BW is available).
+/// The traceback keeps one byte per computed cell.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param scores Scoring scheme, see validate_affine_gap_scores
+/// \param semi_global If true, gaps before and after the aligned part of the target are free, otherwise the alignment is global
+/// \param max_bandwidth If non-negative, only diagonals at most max_bandwidth away from the diagonals of the corners of the matrix are computed. Ignored for semi-global alignments.
+/// \param aligned_interval output, aligned intervals of query (always the full query) and target
+/// \param instruction_set instruction set to use, throws if it is not supported on this machine
+/// \return sequence of AlignmentStates of the aligned intervals
+/// \throw std::invalid_argument if instruction_set is not supported or scores are invalid
+std::vector<AlignmentState> affine_gap_compute_alignment_cpu(const char* query, int32_t query_length,
+                                                             const char* target, int32_t target_length,
+                                                             const AffineGapScores& scores,
+                                                             bool semi_global,
+                                                             int32_t max_bandwidth,
+                                                             AlignedInterval& aligned_interval,
+                                                             InstructionSet instruction_set = get_best_supported_instruction_set());
+
+/// \brief Computes the affine gap score of an alignment
+/// \param alignment sequence of AlignmentStates
+/// \param scores Scoring scheme
+/// \return score
+int32_t compute_affine_gap_score(const std::vector<AlignmentState>& alignment, const AffineGapScores& scores);
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -16,6 +16,10 @@
 
 #include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
 
+#include "aligner_cpu.hpp"
+#include "aligner_wavefront_cpu.hpp"
+#include "aligner_needleman_wunsch_cpu.hpp"
+#include "aligner_hirschberg_myers_cpu.hpp"
 #include "aligner_global_hirschberg_myers.hpp"
 #include "aligner_global_myers_banded.hpp"
 
@@ -28,6 +32,34 @@ namespace genomeworks
 namespace cudaaligner
 {
 
+namespace
+{
+
+DefaultDeviceAllocator create_aligner_allocator(int64_t max_device_memory)
+{
+    if (max_device_memory < -1)
+    {
+        throw std::invalid_argument("max_device_memory has to be either -1 (=all available GPU memory) or greater or equal than 0.");
+    }
+#ifdef GW_ENABLE_CACHING_ALLOCATOR
+    // uses CachingDeviceAllocator
+    if (max_device_memory == -1)
+    {
+        max_device_memory = claraparabricks::genomeworks::cudautils::find_largest_contiguous_device_memory_section();
+        if (max_device_memory == 0)
+        {
+            throw std::runtime_error("No memory available for caching");
+        }
+    }
+    return claraparabricks::genomeworks::DefaultDeviceAllocator(max_device_memory);
+#else
+    // uses CudaMallocAllocator
+    return claraparabricks::genomeworks::DefaultDeviceAllocator();
+#endif
+}
+
+} // namespace
+
 std::unique_ptr<Aligner> create_aligner(
     int32_t max_query_length, int32_t max_target_length,
     int32_t max_alignments, AlignmentType type,
@@ -70,6 +102,21 @@ std::unique_ptr<Aligner> create_aligner(
     return create_aligner(max_query_length, max_target_length, max_alignments, type, allocator, stream, device_id);
 }
 
+int64_t calc_aligner_device_memory(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type)
+{
+    throw_on_negative(max_query_length, "max_query_length must be non-negative.");
+    throw_on_negative(max_target_length, "max_target_length must be non-negative.");
+    throw_on_negative(max_alignments, "max_alignments must be non-negative.");
+    if (type == AlignmentType::global_alignment)
+    {
+        return AlignerGlobalHirschbergMyers::calc_device_memory(max_query_length, max_target_length, max_alignments);
+    }
+    else
+    {
+        throw std::runtime_error("Aligner for specified type not implemented yet.");
+    }
+}
+
 std::unique_ptr<Aligner> create_aligner(
     const AlignmentType type,
     const int32_t max_bandwidth,
@@ -95,26 +142,125 @@ std::unique_ptr<Aligner> create_aligner(
     const int32_t device_id,
     int64_t max_device_memory)
 {
-    if (max_device_memory < -1)
+    return create_aligner(type, max_bandwidth, stream, device_id, create_aligner_allocator(max_device_memory), -1);
+}
+
+std::unique_ptr<AdaptiveBandAligner> create_adaptive_band_aligner(
+    const AlignmentType type,
+    const int32_t initial_bandwidth,
+    const int32_t max_bandwidth,
+    cudaStream_t stream,
+    const int32_t device_id,
+    DefaultDeviceAllocator allocator,
+    const int64_t max_device_memory)
+{
+    if (initial_bandwidth < 1 || initial_bandwidth > max_bandwidth)
     {
-        throw std::invalid_argument("max_device_memory has to be either -1 (=all available GPU memory) or greater or equal than 0.");
+        throw std::invalid_argument("initial_bandwidth has to be positive and must not exceed max_bandwidth.");
     }
-#ifdef GW_ENABLE_CACHING_ALLOCATOR
-    // uses CachingDeviceAllocator
-    if (max_device_memory == -1)
+    if (type == AlignmentType::global_alignment)
     {
-        max_device_memory = claraparabricks::genomeworks::cudautils::find_largest_contiguous_device_memory_section();
-        if (max_device_memory == 0)
-        {
-            throw std::runtime_error("No memory available for caching");
-        }
+        return std::make_unique<AlignerGlobalMyersBanded>(max_device_memory, max_bandwidth, allocator, stream, device_id, initial_bandwidth);
     }
-    claraparabricks::genomeworks::DefaultDeviceAllocator allocator(max_device_memory);
-#else
-    // uses CudaMallocAllocator
-    claraparabricks::genomeworks::DefaultDeviceAllocator allocator;
-#endif
-    return create_aligner(type, max_bandwidth, stream, device_id, allocator, -1);
+    else
+    {
+        throw std::runtime_error("Aligner for specified type not implemented yet.");
+    }
+}
+
+std::unique_ptr<AdaptiveBandAligner> create_adaptive_band_aligner(
+    const AlignmentType type,
+    const int32_t initial_bandwidth,
+    const int32_t max_bandwidth,
+    cudaStream_t stream,
+    const int32_t device_id,
+    int64_t max_device_memory)
+{
+    return create_adaptive_band_aligner(type, initial_bandwidth, max_bandwidth, stream, device_id, create_aligner_allocator(max_device_memory), -1);
+}
+
+std::unique_ptr<Aligner> create_cpu_aligner(
+    const int32_t max_query_length,
+    const int32_t max_target_length,
+    const int32_t max_alignments,
+    const AlignmentType type,
+    ThreadPool& thread_pool,
+    const int32_t x_drop)
+{
+    if (type == AlignmentType::global_alignment || type == AlignmentType::semi_global_alignment || type == AlignmentType::extension_alignment)
+    {
+        return std::make_unique<AlignerCPU>(max_query_length, max_target_length, max_alignments, type, thread_pool, x_drop);
+    }
+    else
+    {
+        throw std::runtime_error("Aligner for specified type not implemented yet.");
+    }
+}
+
+std::unique_ptr<Aligner> create_cpu_aligner(
+    const int32_t max_query_length,
+    const int32_t max_target_length,
+    const int32_t max_alignments,
+    const AlignmentType type,
+    const CpuAlignmentMemoryMode memory_mode,
+    ThreadPool& thread_pool)
+{
+    if (memory_mode == CpuAlignmentMemoryMode::full)
+    {
+        return create_cpu_aligner(max_query_length, max_target_length, max_alignments, type, thread_pool);
+    }
+    else if (type == AlignmentType::global_alignment)
+    {
+        return std::make_unique<AlignerNeedlemanWunschCPU>(max_query_length, max_target_length, max_alignments, thread_pool);
+    }
+    else
+    {
+        throw std::runtime_error("Aligner for specified type not implemented yet.");
+    }
+}
+
+std::unique_ptr<Aligner> create_cpu_aligner(
+    const int32_t max_query_length,
+    const int32_t max_target_length,
+    const int32_t max_alignments,
+    const AlignmentType type,
+    const AffineGapScores& scores,
+    const int32_t max_bandwidth,
+    ThreadPool& thread_pool)
+{
+    if (type == AlignmentType::global_affine_alignment || type == AlignmentType::semi_global_affine_alignment || type == AlignmentType::local_alignment)
+    {
+        return std::make_unique<AlignerCPU>(max_query_length, max_target_length, max_alignments, type, thread_pool, 0, scores, max_bandwidth);
+    }
+    else
+    {
+        throw std::runtime_error("Aligner for specified type not implemented yet.");
+    }
+}
+
+std::unique_ptr<Aligner> create_wavefront_aligner(
+    const int32_t max_query_length,
+    const int32_t max_target_length,
+    const int32_t max_alignments,
+    const WavefrontPenalties& penalties,
+    const WavefrontMemoryMode memory_mode,
+    ThreadPool& thread_pool)
+{
+    return std::make_unique<AlignerWavefrontCPU>(max_query_length, max_target_length, max_alignments, penalties, memory_mode, thread_pool);
+}
+
+std::unique_ptr<Aligner> create_hirschberg_myers_cpu_aligner(
+    const int32_t max_query_length,
+    const int32_t max_target_length,
+    const int32_t max_alignments,
+    ThreadPool& thread_pool,
+    const int64_t max_tile_cells)
+{
+    if (max_tile_cells <= 0)
+    {
+        throw std::invalid_argument("max_tile_cells has to be positive.");
+    }
+    return std::make_unique<AlignerHirschbergMyersCPU>(max_query_length, max_target_length, max_alignments, thread_pool, max_tile_cells);
 }
 
 } // namespace cudaaligner
@@ -0,0 +1,206 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "aligner_cpu.hpp"
+#include "affine_gap_alignment_cpu.hpp"
+#include "alignment_impl.hpp"
+#include "myers_alignment_cpu.hpp"
+#include "smith_waterman_cpu.hpp"
+#include "xdrop_extension_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+#include <claraparabricks/genomeworks/logging/logging.hpp>
+
+#include <exception>
+#include <string>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+void compute_typed_alignment(AlignmentImpl* const alignment, const AlignmentType type, const int32_t x_drop, const AffineGapScores& affine_gap_scores, const int32_t max_bandwidth)
+{
+    const std::string& query    = alignment->get_query_sequence();
+    const std::string& target   = alignment->get_target_sequence();
+    const int32_t query_length  = get_size<int32_t>(query);
+    const int32_t target_length = get_size<int32_t>(target);
+    AlignedInterval interval    = {0, query_length, 0, target_length};
+    std::vector<AlignmentState> path;
+    switch (type)
+    {
+    case AlignmentType::semi_global_alignment:
+        path = myers_compute_semi_global_alignment_cpu(query.data(), query_length, target.data(), target_length, interval);
+        break;
+    case AlignmentType::extension_alignment:
+        path = xdrop_extend_cpu(query.data(), query_length, target.data(), target_length, x_drop, interval);
+        break;
+    case AlignmentType::global_affine_alignment:
+    case AlignmentType::semi_global_affine_alignment:
+        path = affine_gap_compute_alignment_cpu(query.data(), query_length, target.data(), target_length, affine_gap_scores,
+                                                type == AlignmentType::semi_global_affine_alignment, max_bandwidth, interval);
+        break;
+    case AlignmentType::local_alignment:
+        path = smith_waterman_compute_alignment_cpu(query.data(), query_length, target.data(), target_length, affine_gap_scores, interval);
+        break;
+    default:
+        path = myers_compute_alignment_cpu(query.data(), query_length, target.data(), target_length);
+        break;
+    }
+    // a banded alignment is only guaranteed to be optimal among the alignments within the band
+    const bool is_optimal = type != AlignmentType::global_affine_alignment || max_bandwidth < 0;
+    alignment->set_aligned_interval(interval);
+    alignment->set_alignment(path, is_optimal);
+    alignment->set_status(StatusType::success);
+}
+
+} // namespace
+
+AlignerCPU::AlignerCPU(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type, ThreadPool& thread_pool, int32_t x_drop,
+                       const AffineGapScores& affine_gap_scores, int32_t max_bandwidth)
+    : max_query_length_(throw_on_negative(max_query_length, "max_query_length must be non-negative."))
+    , max_target_length_(throw_on_negative(max_target_length, "max_target_length must be non-negative."))
+    , max_alignments_(throw_on_negative(max_alignments, "max_alignments must be non-negative."))
+    , type_(type)
+    , x_drop_(throw_on_negative(x_drop, "x_drop must be non-negative."))
+    , affine_gap_scores_(affine_gap_scores)
+    , max_bandwidth_(max_bandwidth)
+    , alignments_()
+    , alignment_tasks_(thread_pool)
+{
+    if (max_alignments < 1)
+    {
+        throw std::runtime_error("Max alignments must be at least 1.");
+    }
+    if (type == AlignmentType::unset)
+    {
+        throw std::runtime_error("Aligner for specified type not implemented yet.");
+    }
+    validate_affine_gap_scores(affine_gap_scores);
+}
+
+AlignerCPU::~AlignerCPU()
+{
+    // tasks hold raw pointers to the alignments, make sure none of them is still running
+    try
+    {
+        alignment_tasks_.wait();
+    }
+    catch (...)
+    {
+    }
+}
+
+StatusType AlignerCPU::add_alignment(const char* query, int32_t query_length, const char* target, int32_t target_length, bool reverse_complement_query, bool reverse_complement_target)
+{
+    if (query_length < 0 || target_length < 0)
+    {
+        GW_LOG_DEBUG("{}", "Negative target or query length is not allowed.");
+        return StatusType::generic_error;
+    }
+
+    if (num_alignments() >= max_alignments_)
+    {
+        GW_LOG_DEBUG("{} {}", "Exceeded maximum number of alignments allowed : ", max_alignments_);
+        return StatusType::exceeded_max_alignments;
+    }
+
+    if (query_length > max_query_length_)
+    {
+        GW_LOG_DEBUG("{} {}", "Exceeded maximum length of query allowed : ", max_query_length_);
+        return StatusType::exceeded_max_length;
+    }
+
+    if (target_length > max_target_length_)
+    {
+        GW_LOG_DEBUG("{} {}", "Exceeded maximum length of target allowed : ", max_target_length_);
+        return StatusType::exceeded_max_length;
+    }
+
+    std::string query_sequence(query_length, '\0');
+    std::string target_sequence(target_length, '\0');
+    genomeutils::copy_sequence(query, query_length, &query_sequence[0], reverse_complement_query);
+    genomeutils::copy_sequence(target, target_length, &target_sequence[0], reverse_complement_target);
+
+    std::shared_ptr<AlignmentImpl> alignment = std::make_shared<AlignmentImpl>(query_sequence.data(),
+                                                                               query_length,
+                                                                               target_sequence.data(),
+                                                                               target_length);
+    alignment->set_alignment_type(type_);
+    alignments_.push_back(alignment);
+
+    return StatusType::success;
+}
+
+StatusType AlignerCPU::align_all()
+{
+    for (const std::shared_ptr<Alignment>& alignment : alignments_)
+    {
+        AlignmentImpl* const alignment_impl = dynamic_cast<AlignmentImpl*>(alignment.get());
+        alignment_tasks_.run([this, alignment_impl]() {
+            compute_alignment(alignment_impl);
+        });
+    }
+    return StatusType::success;
+}
+
+void AlignerCPU::compute_alignment(AlignmentImpl* const alignment) const
+{
+    compute_typed_alignment(alignment, type_, x_drop_, affine_gap_scores_, max_bandwidth_);
+}
+
+StatusType AlignerCPU::sync_alignments()
+{
+    try
+    {
+        alignment_tasks_.wait();
+    }
+    catch (const std::exception& e)
+    {
+        GW_LOG_ERROR("{} {}", "Could not compute alignments:", e.what());
+        return StatusType::generic_error;
+    }
+    return StatusType::success;
+}
+
+StatusType AlignerCPU::set_results_mode(AlignmentResultsMode mode)
+{
+    if (mode != AlignmentResultsMode::alignment_objects)
+    {
+        GW_LOG_DEBUG("{}", "The CPU aligners only support AlignmentResultsMode::alignment_objects.");
+        return StatusType::generic_error;
+    }
+    return StatusType::success;
+}
+
+void AlignerCPU::reset()
+{
+    alignment_tasks_.wait();
+    alignments_.clear();
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
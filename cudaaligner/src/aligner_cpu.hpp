@@ -0,0 +1,109 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
+#include <claraparabricks/genomeworks/cudaaligner/run_length_alignments.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+class AlignmentImpl;
+
+/// AlignerCPU - computes global, semi-global, extension, affine gap or local alignments on the CPU
+///
+/// Each alignment is computed by a separate task of the given thread pool. Global and semi-global alignments
+/// use Myers' bit-parallel algorithm and a traceback, extension alignments an X-drop dynamic program,
+/// affine gap alignments an anti-diagonal SIMD dynamic program and local alignments a striped Smith-Waterman kernel.
+/// align_all() only submits the tasks, sync_alignments() waits for them and takes part in executing them.
+/// Only AlignmentResultsMode::alignment_objects is supported.
+class AlignerCPU : public Aligner
+{
+public:
+    /// \brief Constructor
+    /// \param max_query_length Maximum length of query string
+    /// \param max_target_length Maximum length of target string
+    /// \param max_alignments Maximum number of alignments to be performed
+    /// \param type Type of the alignments to compute
+    /// \param thread_pool Pool to run the alignments on, has to outlive the aligner
+    /// \param x_drop X-drop threshold of extension alignments, ignored for other types
+    /// \param affine_gap_scores Scoring scheme of affine gap and local alignments, ignored for other types
+    /// \param max_bandwidth Band of global affine gap alignments, negative for no band, ignored for other types
+    AlignerCPU(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, AlignmentType type, ThreadPool& thread_pool, int32_t x_drop,
+               const AffineGapScores& affine_gap_scores = AffineGapScores(), int32_t max_bandwidth = -1);
+    ~AlignerCPU() override;
+    AlignerCPU(const AlignerCPU&) = delete;
+    AlignerCPU& operator=(const AlignerCPU&) = delete;
+
+    StatusType align_all() override;
+
+    StatusType sync_alignments() override;
+
+    StatusType add_alignment(const char* query, int32_t query_length, const char* target, int32_t target_length,
+                             bool reverse_complement_query, bool reverse_complement_target) override;
+
+    const std::vector<std::shared_ptr<Alignment>>& get_alignments() const override
+    {
+        return alignments_;
+    }
+
+    StatusType set_results_mode(AlignmentResultsMode mode) override;
+
+    const RunLengthAlignments& get_run_length_alignments() const override
+    {
+        return run_length_alignments_;
+    }
+
+    int32_t num_alignments() const
+    {
+        return get_size<int32_t>(alignments_);
+    }
+
+    void reset() override;
+
+protected:
+    /// \brief Computes one alignment, called concurrently from the threads of the pool.
+    /// Derived classes overriding it have to wait for the running alignments in their destructor.
+    /// \param alignment Alignment to compute
+    virtual void compute_alignment(AlignmentImpl* alignment) const;
+
+private:
+    int32_t max_query_length_;
+    int32_t max_target_length_;
+    int32_t max_alignments_;
+    AlignmentType type_;
+    int32_t x_drop_;
+    AffineGapScores affine_gap_scores_;
+    int32_t max_bandwidth_;
+    std::vector<std::shared_ptr<Alignment>> alignments_;
+    RunLengthAlignments run_length_alignments_;
+    TaskGroup alignment_tasks_;
+};
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -25,6 +25,7 @@
 
 #include <cstring>
 #include <algorithm>
+#include <iterator>
 #include <cuda_runtime_api.h>
 
 namespace claraparabricks
@@ -51,6 +52,8 @@ AlignerGlobal::AlignerGlobal(int32_t max_query_length, int32_t max_target_length
     : max_query_length_(throw_on_negative(max_query_length, "max_query_length must be non-negative."))
     , max_target_length_(throw_on_negative(max_target_length, "max_target_length must be non-negative."))
     , max_alignments_(throw_on_negative(max_alignments, "max_alignments must be non-negative."))
+    , num_alignments_(0)
+    , results_mode_(AlignmentResultsMode::alignment_objects)
     , alignments_()
     , sequences_h_(2 * std::max(max_query_length, max_target_length) * max_alignments)
     , sequence_lengths_h_(2 * max_alignments)
@@ -75,6 +78,13 @@ AlignerGlobal::AlignerGlobal(int32_t max_query_length, int32_t max_target_length
     GW_CU_CHECK_ERR(cudaMemsetAsync(result_lengths_d_.data(), 0, sizeof(char) * result_lengths_d_.size(), stream));
 }
 
+int64_t AlignerGlobal::calc_buffer_device_memory(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments)
+{
+    const int64_t sequences_size = 2 * static_cast<int64_t>(std::max(max_query_length, max_target_length)) * sizeof(char);
+    const int64_t results_size   = static_cast<int64_t>(calc_max_result_length(max_query_length, max_target_length)) * sizeof(int8_t);
+    return max_alignments * (sequences_size + 2 * sizeof(int32_t) + results_size + sizeof(int32_t));
+}
+
 StatusType AlignerGlobal::add_alignment(const char* query, int32_t query_length, const char* target, int32_t target_length, bool reverse_complement_query, bool reverse_complement_target)
 {
     if (query_length < 0 || target_length < 0)
@@ -84,7 +94,7 @@ StatusType AlignerGlobal::add_alignment(const char* query, int32_t query_length,
     }
 
     int32_t const max_alignment_length = std::max(max_query_length_, max_target_length_);
-    int32_t const num_alignments       = get_size(alignments_);
+    int32_t const num_alignments       = num_alignments_;
     if (num_alignments >= max_alignments_)
     {
         GW_LOG_DEBUG("{} {}", "Exceeded maximum number of alignments allowed : ", max_alignments_);
@@ -128,19 +138,35 @@ StatusType AlignerGlobal::add_alignment(const char* query, int32_t query_length,
     sequence_lengths_h_[2 * num_alignments]     = query_length;
     sequence_lengths_h_[2 * num_alignments + 1] = target_length;
 
-    std::shared_ptr<AlignmentImpl> alignment = std::make_shared<AlignmentImpl>(&sequences_h_[(2 * num_alignments) * max_alignment_length],
-                                                                               query_length,
-                                                                               &sequences_h_[(2 * num_alignments + 1) * max_alignment_length],
-                                                                               target_length);
-    alignment->set_alignment_type(AlignmentType::global_alignment);
-    alignments_.push_back(alignment);
+    ++num_alignments_;
+
+    if (results_mode_ == AlignmentResultsMode::alignment_objects)
+    {
+        std::shared_ptr<AlignmentImpl> alignment = std::make_shared<AlignmentImpl>(&sequences_h_[(2 * num_alignments) * max_alignment_length],
+                                                                                   query_length,
+                                                                                   &sequences_h_[(2 * num_alignments + 1) * max_alignment_length],
+                                                                                   target_length);
+        alignment->set_alignment_type(AlignmentType::global_alignment);
+        alignments_.push_back(alignment);
+    }
 
     return StatusType::success;
 }
 
+StatusType AlignerGlobal::set_results_mode(AlignmentResultsMode mode)
+{
+    if (num_alignments_ != 0)
+    {
+        GW_LOG_DEBUG("{}", "The results mode can only be changed while the aligner holds no alignments.");
+        return StatusType::generic_error;
+    }
+    results_mode_ = mode;
+    return StatusType::success;
+}
+
 StatusType AlignerGlobal::align_all()
 {
-    const int32_t num_alignments = get_size(alignments_);
+    const int32_t num_alignments = num_alignments_;
     if (num_alignments == 0)
         return StatusType::success;
     scoped_device_switch dev(device_id_);
@@ -182,8 +208,30 @@ StatusType AlignerGlobal::sync_alignments()
     scoped_device_switch dev(device_id_);
     GW_CU_CHECK_ERR(cudaStreamSynchronize(stream_));
 
-    const int32_t n_alignments      = get_size(alignments_);
+    const int32_t n_alignments      = num_alignments_;
     const int32_t max_result_length = calc_max_result_length(max_query_length_, max_target_length_);
+    if (results_mode_ == AlignmentResultsMode::run_length)
+    {
+        // The results are stored in reverse order, they are encoded without expanding them first.
+        run_length_alignments_.clear();
+        for (int32_t i = 0; i < n_alignments; ++i)
+        {
+            assert(std::abs(result_lengths_h_[i]) < max_result_length);
+            const int8_t* r_begin = results_h_.data() + i * max_result_length;
+            const int8_t* r_end   = r_begin + std::abs(result_lengths_h_[i]);
+            if (r_begin != r_end || (sequence_lengths_h_[2 * i] == 0 && sequence_lengths_h_[2 * i + 1] == 0))
+            {
+                const AlignedInterval interval{0, sequence_lengths_h_[2 * i], 0, sequence_lengths_h_[2 * i + 1]};
+                run_length_alignments_.add_alignment(std::reverse_iterator<const int8_t*>(r_end), std::reverse_iterator<const int8_t*>(r_begin), result_lengths_h_[i] >= 0, interval);
+            }
+            else
+            {
+                run_length_alignments_.add_empty_alignment(StatusType::uninitialized);
+            }
+        }
+        return StatusType::success;
+    }
+
     std::vector<AlignmentState> al_state;
     for (int32_t i = 0; i < n_alignments; ++i)
     {
@@ -206,7 +254,9 @@ StatusType AlignerGlobal::sync_alignments()
 
 void AlignerGlobal::reset()
 {
+    num_alignments_ = 0;
     alignments_.clear();
+    run_length_alignments_.clear();
 }
 } // namespace cudaaligner
 
@@ -19,6 +19,7 @@
 #include "ukkonen_gpu.cuh"
 
 #include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
+#include <claraparabricks/genomeworks/cudaaligner/run_length_alignments.hpp>
 #include <claraparabricks/genomeworks/utils/allocator.hpp>
 #include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
 #include <claraparabricks/genomeworks/utils/device_buffer.hpp>
@@ -51,9 +52,16 @@ public:
         return alignments_;
     }
 
+    virtual StatusType set_results_mode(AlignmentResultsMode mode) override;
+
+    virtual const RunLengthAlignments& get_run_length_alignments() const override
+    {
+        return run_length_alignments_;
+    }
+
     virtual int32_t num_alignments() const
     {
-        return get_size(alignments_);
+        return num_alignments_;
     }
 
     virtual void reset() override;
@@ -68,13 +76,24 @@ public:
         return max_query_length_;
     }
 
+protected:
+    /// \brief Computes the device memory of the sequence and result buffers allocated by the constructor
+    /// \param max_query_length Maximum length of query string
+    /// \param max_target_length Maximum length of target string
+    /// \param max_alignments Maximum number of alignments
+    /// \return memory in bytes
+    static int64_t calc_buffer_device_memory(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments);
+
 private:
     virtual void run_alignment(int8_t* results_d, int32_t* result_lengths, int32_t max_result_length, const char* sequences_d, int32_t* sequence_lengths_d, int32_t* sequence_lengths_h, int32_t max_sequence_length, int32_t num_alignments, cudaStream_t stream) = 0;
 
     int32_t max_query_length_;
     int32_t max_target_length_;
     int32_t max_alignments_;
+    int32_t num_alignments_;
+    AlignmentResultsMode results_mode_;
     std::vector<std::shared_ptr<Alignment>> alignments_;
+    RunLengthAlignments run_length_alignments_;
 
     device_buffer<char> sequences_d_;
     pinned_host_vector<char> sequences_h_;
@@ -57,6 +57,21 @@ AlignerGlobalHirschbergMyers::AlignerGlobalHirschbergMyers(int32_t max_query_len
     workspace_ = std::make_unique<Workspace>(max_alignments, ceiling_divide<int32_t>(max_query_length, sizeof(hirschbergmyers::WordType)), max_target_length, hirschberg_myers_switch_to_myers_size, allocator, stream);
 }
 
+int64_t AlignerGlobalHirschbergMyers::calc_device_memory(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments)
+{
+    // mirrors the allocations of the constructors of AlignerGlobal and Workspace
+    const int64_t n_alignments         = max_alignments;
+    const int64_t max_n_words          = ceiling_divide<int32_t>(max_query_length, sizeof(hirschbergmyers::WordType));
+    const int64_t myers_words          = max_n_words * (hirschberg_myers_switch_to_myers_size + 1);
+    const int64_t scores_per_alignment = std::max(myers_words, 2 * (static_cast<int64_t>(max_target_length) + 1));
+    const int64_t matrix_offsets       = (n_alignments + 1) * sizeof(ptrdiff_t);
+    const int64_t stackbuffer          = n_alignments * hirschberg_myers_stackbuffer_size * sizeof(hirschbergmyers::query_target_range);
+    const int64_t pvs_and_mvs          = 2 * (n_alignments * myers_words * sizeof(hirschbergmyers::WordType) + matrix_offsets);
+    const int64_t scores               = n_alignments * scores_per_alignment * sizeof(int32_t) + matrix_offsets;
+    const int64_t query_patterns       = n_alignments * max_n_words * 8 * sizeof(hirschbergmyers::WordType) + matrix_offsets;
+    return calc_buffer_device_memory(max_query_length, max_target_length, max_alignments) + stackbuffer + pvs_and_mvs + scores + query_patterns;
+}
+
 AlignerGlobalHirschbergMyers::~AlignerGlobalHirschbergMyers()
 {
     // Keep empty destructor to keep Workspace type incomplete in the .hpp file.
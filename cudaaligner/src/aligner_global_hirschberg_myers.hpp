@@ -33,6 +33,13 @@ public:
     AlignerGlobalHirschbergMyers(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, DefaultDeviceAllocator allocator, cudaStream_t stream, int32_t device_id);
     virtual ~AlignerGlobalHirschbergMyers();
 
+    /// \brief Computes the device memory an aligner constructed with the same arguments allocates
+    /// \param max_query_length Maximum length of query string
+    /// \param max_target_length Maximum length of target string
+    /// \param max_alignments Maximum number of alignments
+    /// \return memory in bytes, not including the overhead of the allocator
+    static int64_t calc_device_memory(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments);
+
 private:
     struct Workspace;
 
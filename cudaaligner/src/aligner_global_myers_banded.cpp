@@ -25,6 +25,10 @@
 #include <claraparabricks/genomeworks/utils/mathutils.hpp>
 #include <claraparabricks/genomeworks/utils/pinned_host_vector.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
 namespace claraparabricks
 {
 
@@ -103,6 +107,8 @@ struct AlignerGlobalMyersBanded::InternalData
         , results_d(mem.results_memory / sizeof(char), allocator, stream)
         , result_starts_d(n_alignments_initial + 1, allocator, stream)
         , result_lengths_d(n_alignments_initial, allocator, stream)
+        , retry_ids_h()
+        , retry_ids_d(0, allocator, stream)
         , pvs(mem.pmvs_matrix_memory / sizeof(WordType), allocator, stream)
         , mvs(mem.pmvs_matrix_memory / sizeof(WordType), allocator, stream)
         , scores(mem.score_matrix_memory / sizeof(int32_t), allocator, stream)
@@ -123,29 +129,39 @@ struct AlignerGlobalMyersBanded::InternalData
     device_buffer<int8_t> results_d;
     device_buffer<int64_t> result_starts_d;
     device_buffer<int32_t> result_lengths_d;
+    pinned_host_vector<int32_t> retry_ids_h;
+    device_buffer<int32_t> retry_ids_d;
     batched_device_matrices<WordType> pvs;
     batched_device_matrices<WordType> mvs;
     batched_device_matrices<int32_t> scores;
     batched_device_matrices<WordType> query_patterns;
 };
 
-AlignerGlobalMyersBanded::AlignerGlobalMyersBanded(int64_t max_device_memory, int32_t max_bandwidth, DefaultDeviceAllocator allocator, cudaStream_t stream, int32_t device_id)
+AlignerGlobalMyersBanded::AlignerGlobalMyersBanded(int64_t max_device_memory, int32_t max_bandwidth, DefaultDeviceAllocator allocator, cudaStream_t stream, int32_t device_id, int32_t initial_bandwidth)
     : data_()
     , stream_(stream)
     , device_id_(device_id)
     , max_bandwidth_(max_bandwidth)
+    , initial_bandwidth_(initial_bandwidth > 0 ? std::min(initial_bandwidth, max_bandwidth) : max_bandwidth)
+    , band_retry_statistics_()
+    , results_mode_(AlignmentResultsMode::alignment_objects)
     , alignments_()
 {
     if (max_bandwidth % (sizeof(WordType) * CHAR_BIT) == 1)
     {
         throw std::invalid_argument("Invalid max_bandwidth value. Please change it by +/-1.");
     }
+    if (initial_bandwidth_ % (sizeof(WordType) * CHAR_BIT) == 1)
+    {
+        throw std::invalid_argument("Invalid initial_bandwidth value. Please change it by +/-1.");
+    }
     if (max_device_memory < 0)
     {
         max_device_memory = get_size_of_largest_free_memory_block(allocator);
     }
     scoped_device_switch dev(device_id);
-    const memory_distribution mem = split_available_memory(max_device_memory, max_bandwidth);
+    // the memory is split for the common case, realignments with wider bands are computed in smaller groups
+    const memory_distribution mem = split_available_memory(max_device_memory, initial_bandwidth_);
     data_                         = std::make_unique<AlignerGlobalMyersBanded::InternalData>(mem, n_alignments_initial_parameter, allocator, stream_);
     data_->seq_starts_h.push_back(0);
     data_->result_starts_h.push_back(0);
@@ -184,7 +200,7 @@ StatusType AlignerGlobalMyersBanded::add_alignment(const char* query, int32_t qu
     assert(mvs.number_of_matrices() == scores.number_of_matrices());
     assert(query_patterns.number_of_matrices() == scores.number_of_matrices());
 
-    const int64_t matrix_size        = compute_matrix_size_for_alignment(query_length, target_length, max_bandwidth_);
+    const int64_t matrix_size        = compute_matrix_size_for_alignment(query_length, target_length, initial_bandwidth_);
     const int32_t n_words_query      = ceiling_divide(query_length, word_size);
     const int32_t query_pattern_size = n_words_query * 4;
 
@@ -217,15 +233,18 @@ StatusType AlignerGlobalMyersBanded::add_alignment(const char* query, int32_t qu
     success      = success && scores.append_matrix(matrix_size);
     success      = success && query_patterns.append_matrix(query_pattern_size);
 
-    try
+    if (results_mode_ == AlignmentResultsMode::alignment_objects)
     {
-        std::shared_ptr<AlignmentImpl> alignment = std::make_shared<AlignmentImpl>(query, query_length, target, target_length);
-        alignment->set_alignment_type(AlignmentType::global_alignment);
-        alignments_.push_back(alignment);
-    }
-    catch (...)
-    {
-        success = false;
+        try
+        {
+            std::shared_ptr<AlignmentImpl> alignment = std::make_shared<AlignmentImpl>(query, query_length, target, target_length);
+            alignment->set_alignment_type(AlignmentType::global_alignment);
+            alignments_.push_back(alignment);
+        }
+        catch (...)
+        {
+            success = false;
+        }
     }
 
     if (!success)
@@ -238,10 +257,20 @@ StatusType AlignerGlobalMyersBanded::add_alignment(const char* query, int32_t qu
     return StatusType::success;
 }
 
+StatusType AlignerGlobalMyersBanded::set_results_mode(AlignmentResultsMode mode)
+{
+    if (!alignments_.empty() || run_length_alignments_.size() != 0 || get_size(data_->result_starts_h) != 1)
+    {
+        return StatusType::generic_error;
+    }
+    results_mode_ = mode;
+    return StatusType::success;
+}
+
 StatusType AlignerGlobalMyersBanded::align_all()
 {
     using cudautils::device_copy_n;
-    const auto n_alignments = get_size(alignments_);
+    const auto n_alignments = get_size(data_->result_starts_h) - 1;
     if (n_alignments == 0)
         return StatusType::success;
 
@@ -283,24 +312,156 @@ StatusType AlignerGlobalMyersBanded::align_all()
     device_copy_n(result_starts_h.data(), n_alignments + 1, result_starts_d.data(), stream_);
 
     myers_banded_gpu(results_d.data(), result_lengths_d.data(), result_starts_d.data(),
-                     seq_d.data(), seq_starts_d.data(), n_alignments, max_bandwidth_,
+                     seq_d.data(), seq_starts_d.data(), n_alignments, nullptr, initial_bandwidth_,
                      data_->pvs, data_->mvs, data_->scores, data_->query_patterns,
                      stream_);
 
     result_lengths_h.clear();
     result_lengths_h.resize(n_alignments);
 
+    band_retry_statistics_                      = BandRetryStatistics();
+    band_retry_statistics_.number_of_alignments = n_alignments;
+    if (initial_bandwidth_ < max_bandwidth_)
+    {
+        realign_outside_band(n_alignments);
+    }
+
     device_copy_n(results_d.data(), result_starts_h.back(), results_h.data(), stream_);
     device_copy_n(result_lengths_d.data(), n_alignments, result_lengths_h.data(), stream_);
 
     return StatusType::success;
 }
 
+void AlignerGlobalMyersBanded::realign_outside_band(const int32_t n_alignments)
+{
+    using cudautils::device_copy_n;
+    const auto& seq_starts_h                          = data_->seq_starts_h;
+    auto& result_lengths_h                            = data_->result_lengths_h;
+    auto& result_lengths_d                            = data_->result_lengths_d;
+    auto& retry_ids_h                                 = data_->retry_ids_h;
+    auto& retry_ids_d                                 = data_->retry_ids_d;
+    batched_device_matrices<WordType>& pvs            = data_->pvs;
+    batched_device_matrices<WordType>& mvs            = data_->mvs;
+    batched_device_matrices<int32_t>& scores          = data_->scores;
+    batched_device_matrices<WordType>& query_patterns = data_->query_patterns;
+
+    // a positive length marks an optimal alignment, an empty result of non-empty sequences
+    // an alignment whose length difference alone exceeds the band
+    auto is_outside_band = [&seq_starts_h, &result_lengths_h](const int32_t i) {
+        return result_lengths_h[i] < 0 || (result_lengths_h[i] == 0 && seq_starts_h[2 * i + 2] != seq_starts_h[2 * i]);
+    };
+
+    device_copy_n(result_lengths_d.data(), n_alignments, result_lengths_h.data(), stream_);
+    GW_CU_CHECK_ERR(cudaStreamSynchronize(stream_));
+
+    std::vector<int32_t> failed;
+    for (int32_t i = 0; i < n_alignments; ++i)
+    {
+        if (is_outside_band(i))
+        {
+            failed.push_back(i);
+        }
+    }
+    band_retry_statistics_.number_of_retried_alignments = get_size<int32_t>(failed);
+
+    int32_t bandwidth = initial_bandwidth_;
+    std::vector<int32_t> still_failed;
+    while (!failed.empty() && bandwidth < max_bandwidth_)
+    {
+        // a doubled bandwidth is even and therefore never one bit into the last word
+        bandwidth = std::min(2 * bandwidth, max_bandwidth_);
+        ++band_retry_statistics_.number_of_rounds;
+        still_failed.clear();
+        auto next = begin(failed);
+        while (next != end(failed))
+        {
+            // realign as many of the failed alignments at once as the matrices can hold
+            pvs.clear();
+            mvs.clear();
+            scores.clear();
+            query_patterns.clear();
+            retry_ids_h.clear();
+            for (; next != end(failed); ++next)
+            {
+                const int32_t query_length       = static_cast<int32_t>(seq_starts_h[2 * *next + 1] - seq_starts_h[2 * *next]);
+                const int32_t target_length      = static_cast<int32_t>(seq_starts_h[2 * *next + 2] - seq_starts_h[2 * *next + 1]);
+                const int64_t matrix_size        = compute_matrix_size_for_alignment(query_length, target_length, bandwidth);
+                const int32_t query_pattern_size = ceiling_divide(query_length, word_size) * 4;
+                if (matrix_size > scores.remaining_free_matrix_elements() || query_pattern_size > query_patterns.remaining_free_matrix_elements())
+                {
+                    break;
+                }
+                pvs.append_matrix(matrix_size);
+                mvs.append_matrix(matrix_size);
+                scores.append_matrix(matrix_size);
+                query_patterns.append_matrix(query_pattern_size);
+                retry_ids_h.push_back(*next);
+            }
+            if (retry_ids_h.empty())
+            {
+                // the matrices of this alignment do not fit into the device memory on their own
+                still_failed.push_back(*next);
+                ++next;
+                continue;
+            }
+
+            const int32_t n_retries = get_size<int32_t>(retry_ids_h);
+            pvs.construct_device_matrices_async(stream_);
+            mvs.construct_device_matrices_async(stream_);
+            scores.construct_device_matrices_async(stream_);
+            query_patterns.construct_device_matrices_async(stream_);
+            if (get_size(retry_ids_d) < n_retries)
+            {
+                retry_ids_d.clear_and_resize(n_retries);
+            }
+            device_copy_n(retry_ids_h.data(), n_retries, retry_ids_d.data(), stream_);
+
+            // the kernel overwrites the paths and lengths of the realigned alignments only
+            myers_banded_gpu(data_->results_d.data(), result_lengths_d.data(), data_->result_starts_d.data(),
+                             data_->seq_d.data(), data_->seq_starts_d.data(), n_retries, retry_ids_d.data(), bandwidth,
+                             pvs, mvs, scores, query_patterns,
+                             stream_);
+            band_retry_statistics_.number_of_retries += n_retries;
+
+            device_copy_n(result_lengths_d.data(), n_alignments, result_lengths_h.data(), stream_);
+            GW_CU_CHECK_ERR(cudaStreamSynchronize(stream_));
+            std::copy_if(begin(retry_ids_h), end(retry_ids_h), std::back_inserter(still_failed), is_outside_band);
+        }
+        failed.swap(still_failed);
+    }
+    band_retry_statistics_.number_of_failed_alignments = get_size<int32_t>(failed);
+}
+
 StatusType AlignerGlobalMyersBanded::sync_alignments()
 {
     scoped_device_switch dev(device_id_);
     GW_CU_CHECK_ERR(cudaStreamSynchronize(stream_));
 
+    if (results_mode_ == AlignmentResultsMode::run_length)
+    {
+        // The results are stored in reverse order, they are encoded without expanding them first.
+        const int32_t n_alignments = get_size<int32_t>(data_->result_starts_h) - 1;
+        run_length_alignments_.clear();
+        for (int32_t i = 0; i < n_alignments; ++i)
+        {
+            const int8_t* r_begin       = data_->results_h.data() + data_->result_starts_h[i];
+            const int8_t* r_end         = r_begin + std::abs(data_->result_lengths_h[i]);
+            const int32_t query_length  = static_cast<int32_t>(data_->seq_starts_h[2 * i + 1] - data_->seq_starts_h[2 * i]);
+            const int32_t target_length = static_cast<int32_t>(data_->seq_starts_h[2 * i + 2] - data_->seq_starts_h[2 * i + 1]);
+            if (r_begin != r_end || (query_length == 0 && target_length == 0))
+            {
+                const AlignedInterval interval{0, query_length, 0, target_length};
+                run_length_alignments_.add_alignment(std::reverse_iterator<const int8_t*>(r_end), std::reverse_iterator<const int8_t*>(r_begin), data_->result_lengths_h[i] >= 0, interval);
+            }
+            else
+            {
+                run_length_alignments_.add_empty_alignment(StatusType::uninitialized);
+            }
+        }
+        reset_data();
+        return StatusType::success;
+    }
+
     const int32_t n_alignments = get_size<int32_t>(alignments_);
     std::vector<AlignmentState> al_state;
     for (int32_t i = 0; i < n_alignments; ++i)
@@ -326,6 +487,7 @@ void AlignerGlobalMyersBanded::reset()
 {
     reset_data();
     alignments_.clear();
+    run_length_alignments_.clear();
 }
 
 void AlignerGlobalMyersBanded::reset_data()
@@ -27,10 +27,17 @@ namespace genomeworks
 namespace cudaaligner
 {
 
-class AlignerGlobalMyersBanded : public Aligner
+class AlignerGlobalMyersBanded : public AdaptiveBandAligner
 {
 public:
-    AlignerGlobalMyersBanded(int64_t max_device_memory, int32_t max_bandwidth, DefaultDeviceAllocator allocator, cudaStream_t stream, int32_t device_id);
+    /// \brief Constructor
+    /// \param max_device_memory Maximum amount of device memory to use from allocator in bytes, -1 for all available memory
+    /// \param max_bandwidth Maximum bandwidth of the Ukkonen band
+    /// \param allocator Allocator to use for internal device memory allocations
+    /// \param stream CUDA Stream used for GPU interaction of the object
+    /// \param device_id GPU device ID to run all CUDA operations on
+    /// \param initial_bandwidth If positive, alignments are first computed with this bandwidth and realigned with doubled bands up to max_bandwidth if they leave it
+    AlignerGlobalMyersBanded(int64_t max_device_memory, int32_t max_bandwidth, DefaultDeviceAllocator allocator, cudaStream_t stream, int32_t device_id, int32_t initial_bandwidth = -1);
     ~AlignerGlobalMyersBanded() override;
 
     StatusType align_all() override;
@@ -44,15 +51,34 @@ public:
         return alignments_;
     }
 
+    StatusType set_results_mode(AlignmentResultsMode mode) override;
+
+    const RunLengthAlignments& get_run_length_alignments() const override
+    {
+        return run_length_alignments_;
+    }
+
+    BandRetryStatistics get_band_retry_statistics() const override
+    {
+        return band_retry_statistics_;
+    }
+
 private:
     void reset_data();
 
+    /// \brief Realigns the alignments of the last run which left the initial band with doubled bands, waits for the GPU
+    void realign_outside_band(int32_t n_alignments);
+
     struct InternalData;
     std::unique_ptr<InternalData> data_;
     cudaStream_t stream_;
     int32_t device_id_;
     int32_t max_bandwidth_;
+    int32_t initial_bandwidth_;
+    BandRetryStatistics band_retry_statistics_;
+    AlignmentResultsMode results_mode_;
     std::vector<std::shared_ptr<Alignment>> alignments_;
+    RunLengthAlignments run_length_alignments_;
 };
 
 } // namespace cudaaligner
@@ -0,0 +1,62 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include "aligner_cpu.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// AlignerHirschbergMyersCPU - computes global alignments with unit costs on the CPU, each alignment split into tasks
+///
+/// The alignments are divided recursively with Hirschberg's algorithm, the last rows of each split are computed with
+/// Myers' bit-parallel algorithm and the subproblems run as tasks of the thread pool. This way a single long alignment
+/// uses all threads of the pool with memory linear in its length. See hirschberg_myers_compute_alignment_cpu.
+class AlignerHirschbergMyersCPU : public AlignerCPU
+{
+public:
+    /// \brief Constructor
+    /// \param max_query_length Maximum length of query string
+    /// \param max_target_length Maximum length of target string
+    /// \param max_alignments Maximum number of alignments to be performed
+    /// \param thread_pool Pool to run the alignments and their subproblems on, has to outlive the aligner
+    /// \param max_tile_cells Maximum number of cells of the subproblems aligned with a full Myers matrix
+    AlignerHirschbergMyersCPU(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, ThreadPool& thread_pool, int64_t max_tile_cells);
+    ~AlignerHirschbergMyersCPU() override;
+    AlignerHirschbergMyersCPU(const AlignerHirschbergMyersCPU&)            = delete;
+    AlignerHirschbergMyersCPU& operator=(const AlignerHirschbergMyersCPU&) = delete;
+
+protected:
+    void compute_alignment(AlignmentImpl* alignment) const override;
+
+private:
+    ThreadPool& thread_pool_;
+    int64_t max_tile_cells_;
+};
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
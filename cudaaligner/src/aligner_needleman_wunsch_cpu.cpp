@@ -0,0 +1,65 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "aligner_needleman_wunsch_cpu.hpp"
+#include "alignment_impl.hpp"
+#include "needleman_wunsch_cpu.hpp"
+
+#include <string>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+AlignerNeedlemanWunschCPU::AlignerNeedlemanWunschCPU(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, ThreadPool& thread_pool)
+    : AlignerCPU(max_query_length, max_target_length, max_alignments, AlignmentType::global_alignment, thread_pool, 0)
+{
+}
+
+AlignerNeedlemanWunschCPU::~AlignerNeedlemanWunschCPU()
+{
+    // the running tasks call compute_alignment of this class, they have to finish before its destruction
+    try
+    {
+        sync_alignments();
+    }
+    catch (...)
+    {
+    }
+}
+
+void AlignerNeedlemanWunschCPU::compute_alignment(AlignmentImpl* const alignment) const
+{
+    const std::string& query    = alignment->get_query_sequence();
+    const std::string& target   = alignment->get_target_sequence();
+    const int32_t query_length  = get_size<int32_t>(query);
+    const int32_t target_length = get_size<int32_t>(target);
+    alignment->set_aligned_interval({0, query_length, 0, target_length});
+    alignment->set_alignment(needleman_wunsch_compute_alignment_cpu(query.data(), query_length, target.data(), target_length), true);
+    alignment->set_status(StatusType::success);
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
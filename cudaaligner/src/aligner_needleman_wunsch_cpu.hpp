@@ -0,0 +1,56 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include "aligner_cpu.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// AlignerNeedlemanWunschCPU - computes global alignments with unit costs on the CPU in linear memory
+///
+/// The score matrices are computed by anti-diagonals in SIMD lanes and the alignment is split recursively
+/// with Hirschberg's algorithm, which keeps the working set of long alignments small. See needleman_wunsch_compute_alignment_cpu.
+class AlignerNeedlemanWunschCPU : public AlignerCPU
+{
+public:
+    /// \brief Constructor
+    /// \param max_query_length Maximum length of query string
+    /// \param max_target_length Maximum length of target string
+    /// \param max_alignments Maximum number of alignments to be performed
+    /// \param thread_pool Pool to run the alignments on, has to outlive the aligner
+    AlignerNeedlemanWunschCPU(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments, ThreadPool& thread_pool);
+    ~AlignerNeedlemanWunschCPU() override;
+    AlignerNeedlemanWunschCPU(const AlignerNeedlemanWunschCPU&) = delete;
+    AlignerNeedlemanWunschCPU& operator=(const AlignerNeedlemanWunschCPU&) = delete;
+
+protected:
+    void compute_alignment(AlignmentImpl* alignment) const override;
+};
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,63 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include "aligner_cpu.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// AlignerWavefrontCPU - computes global alignments with the wavefront algorithm (WFA) on the CPU
+///
+/// The run time grows with the penalty of the alignment instead of the product of the sequence lengths,
+/// which makes it fast for reads of high identity. See wavefront_compute_alignment_cpu.
+class AlignerWavefrontCPU : public AlignerCPU
+{
+public:
+    /// \brief Constructor
+    /// \param max_query_length Maximum length of query string
+    /// \param max_target_length Maximum length of target string
+    /// \param max_alignments Maximum number of alignments to be performed
+    /// \param penalties Penalties of mismatches and gaps
+    /// \param memory_mode Whether to keep all wavefronts or to use the bidirectional algorithm (BiWFA)
+    /// \param thread_pool Pool to run the alignments on, has to outlive the aligner
+    AlignerWavefrontCPU(int32_t max_query_length, int32_t max_target_length, int32_t max_alignments,
+                        const WavefrontPenalties& penalties, WavefrontMemoryMode memory_mode, ThreadPool& thread_pool);
+    ~AlignerWavefrontCPU() override;
+    AlignerWavefrontCPU(const AlignerWavefrontCPU&) = delete;
+    AlignerWavefrontCPU& operator=(const AlignerWavefrontCPU&) = delete;
+
+protected:
+    void compute_alignment(AlignmentImpl* alignment) const override;
+
+private:
+    WavefrontPenalties penalties_;
+    WavefrontMemoryMode memory_mode_;
+};
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
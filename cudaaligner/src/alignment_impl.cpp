@@ -53,6 +53,7 @@ AlignmentImpl::AlignmentImpl(const char* query, int32_t query_length, const char
     , status_(StatusType::uninitialized)
     , type_(AlignmentType::unset)
     , alignment_()
+    , aligned_interval_{0, query_length, 0, target_length}
     , is_optimal_(false)
 {
     // Initialize Alignment object.
@@ -93,8 +94,8 @@ int32_t AlignmentImpl::get_edit_distance() const
 
 FormattedAlignment AlignmentImpl::format_alignment(int32_t maximal_line_length) const
 {
-    int64_t t_pos = 0;
-    int64_t q_pos = 0;
+    int64_t t_pos = aligned_interval_.target_start;
+    int64_t q_pos = aligned_interval_.query_start;
     FormattedAlignment ret_formatted_alignment;
     ret_formatted_alignment.linebreak_after = (maximal_line_length < 0) ? 0 : maximal_line_length;
 
@@ -106,6 +106,21 @@ public:
         return alignment_;
     }
 
+    /// \brief Set the parts of query and target covered by the alignment
+    /// \param aligned_interval aligned intervals of query and target
+    virtual void set_aligned_interval(const AlignedInterval& aligned_interval)
+    {
+        aligned_interval_ = aligned_interval;
+    }
+
+    /// \brief Returns the parts of query and target covered by the alignment
+    ///
+    /// \return aligned intervals of query and target
+    AlignedInterval get_aligned_interval() const override
+    {
+        return aligned_interval_;
+    }
+
     /// \brief Get the edit distance corrsponding to the alignment
     ///
     /// Returns the number of edits of the found alignment.
@@ -123,6 +138,7 @@ private:
     StatusType status_;
     AlignmentType type_;
     std::vector<AlignmentState> alignment_;
+    AlignedInterval aligned_interval_;
     bool is_optimal_;
 };
 } // namespace cudaaligner
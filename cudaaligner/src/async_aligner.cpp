@@ -0,0 +1,259 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <claraparabricks/genomeworks/cudaaligner/async_aligner.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+AsyncAligner::AsyncAligner(const AlignerFactory& create_aligner, const int32_t batch_size, const int32_t number_of_engines, const int32_t max_queued_alignments, ThreadPool& thread_pool)
+    : batch_size_(batch_size)
+    , max_queued_alignments_(max_queued_alignments == -1 ? 2 * batch_size * number_of_engines : max_queued_alignments)
+    , engines_(thread_pool)
+{
+    if (batch_size < 1 || number_of_engines < 1)
+    {
+        throw std::invalid_argument("batch_size and number_of_engines must be positive.");
+    }
+    if (max_queued_alignments_ < 1)
+    {
+        throw std::invalid_argument("max_queued_alignments must be either -1 or positive.");
+    }
+    for (int32_t i = 0; i < number_of_engines; ++i)
+    {
+        aligners_.push_back(create_aligner());
+    }
+    // engines are started once there are batches for them
+    for (std::unique_ptr<Aligner>& aligner : aligners_)
+    {
+        idle_aligners_.push_back(aligner.get());
+    }
+}
+
+AsyncAligner::~AsyncAligner()
+{
+    wait();
+}
+
+void AsyncAligner::submit(const char* query, const int32_t query_length, const char* target, const int32_t target_length,
+                          const bool reverse_complement_query, const bool reverse_complement_target, CompletionCallback callback)
+{
+    if (query_length < 0 || target_length < 0)
+    {
+        callback(StatusType::generic_error, nullptr);
+        return;
+    }
+    Request request{std::string(query, query_length), std::string(target, target_length), reverse_complement_query, reverse_complement_target, std::move(callback)};
+    Aligner* idle_engine = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        // backpressure, the engines take requests from the queue
+        space_available_.wait(lock, [this]() { return get_size<int64_t>(queue_) < max_queued_alignments_; });
+        queue_.push_back(std::move(request));
+        ++submitted_requests_;
+        idle_engine = take_idle_engine();
+    }
+    if (idle_engine != nullptr)
+    {
+        start_engine(idle_engine);
+    }
+}
+
+std::future<std::shared_ptr<Alignment>> AsyncAligner::submit(const char* query, const int32_t query_length, const char* target, const int32_t target_length,
+                                                             const bool reverse_complement_query, const bool reverse_complement_target)
+{
+    // std::function requires copyable callables
+    std::shared_ptr<std::promise<std::shared_ptr<Alignment>>> promise = std::make_shared<std::promise<std::shared_ptr<Alignment>>>();
+    std::future<std::shared_ptr<Alignment>> future                    = promise->get_future();
+    submit(query, query_length, target, target_length, reverse_complement_query, reverse_complement_target,
+           [promise](const StatusType status, std::shared_ptr<Alignment> alignment) {
+               if (status == StatusType::success)
+               {
+                   promise->set_value(std::move(alignment));
+               }
+               else
+               {
+                   promise->set_exception(std::make_exception_ptr(std::runtime_error("Experienced error type " + std::to_string(status))));
+               }
+           });
+    return future;
+}
+
+void AsyncAligner::flush()
+{
+    Aligner* idle_engine = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushed_requests_ = submitted_requests_;
+        idle_engine       = take_idle_engine();
+    }
+    if (idle_engine != nullptr)
+    {
+        start_engine(idle_engine);
+    }
+}
+
+void AsyncAligner::wait()
+{
+    flush();
+    // engine tasks which have not been picked up by the thread pool yet are run by this thread
+    engines_.wait();
+    std::unique_lock<std::mutex> lock(mutex_);
+    requests_completed_.wait(lock, [this]() { return completed_requests_ == submitted_requests_; });
+}
+
+bool AsyncAligner::is_batch_available() const
+{
+    // partial batches are only taken if they were flushed or if the queue is full
+    const int64_t queued_requests = get_size<int64_t>(queue_);
+    return queued_requests >= std::min<int64_t>(batch_size_, max_queued_alignments_) || (queued_requests > 0 && taken_requests_ < flushed_requests_);
+}
+
+Aligner* AsyncAligner::take_idle_engine()
+{
+    if (idle_aligners_.empty() || !is_batch_available())
+    {
+        return nullptr;
+    }
+    Aligner* const aligner = idle_aligners_.back();
+    idle_aligners_.pop_back();
+    return aligner;
+}
+
+void AsyncAligner::start_engine(Aligner* const aligner)
+{
+    engines_.run([this, aligner]() { run_engine(*aligner); });
+}
+
+void AsyncAligner::run_engine(Aligner& aligner)
+{
+    std::vector<Request> batch;
+    batch.reserve(batch_size_);
+    while (true)
+    {
+        Aligner* idle_engine = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!is_batch_available())
+            {
+                // submit() and flush() start an engine for the next batch
+                idle_aligners_.push_back(&aligner);
+                return;
+            }
+            const int32_t n_requests = static_cast<int32_t>(std::min<std::size_t>(batch_size_, queue_.size()));
+            std::move(std::begin(queue_), std::begin(queue_) + n_requests, std::back_inserter(batch));
+            queue_.erase(std::begin(queue_), std::begin(queue_) + n_requests);
+            taken_requests_ += n_requests;
+            // the remaining requests might be enough for another engine
+            idle_engine = take_idle_engine();
+        }
+        if (idle_engine != nullptr)
+        {
+            start_engine(idle_engine);
+        }
+        space_available_.notify_all();
+
+        align_batch(aligner, batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            completed_requests_ += get_size<int64_t>(batch);
+        }
+        requests_completed_.notify_all();
+        batch.clear();
+    }
+}
+
+void AsyncAligner::align_batch(Aligner& aligner, std::vector<Request>& batch)
+{
+    // requests which were added to the aligner, in the order of its alignments
+    std::vector<Request*> added_requests;
+    added_requests.reserve(batch.size());
+    // every callback is called exactly once, requests before next_request were added or reported
+    // and added requests before next_added_request were reported
+    std::size_t next_request       = 0;
+    std::size_t next_added_request = 0;
+    try
+    {
+        while (next_request < batch.size())
+        {
+            Request& request        = batch[next_request];
+            const StatusType status = aligner.add_alignment(request.query.data(), get_size<int32_t>(request.query),
+                                                            request.target.data(), get_size<int32_t>(request.target),
+                                                            request.reverse_complement_query, request.reverse_complement_target);
+            ++next_request;
+            if (status == StatusType::success)
+            {
+                added_requests.push_back(&request);
+            }
+            else
+            {
+                request.callback(status, nullptr);
+            }
+        }
+        if (!added_requests.empty())
+        {
+            aligner.align_all();
+            aligner.sync_alignments();
+            const std::vector<std::shared_ptr<Alignment>>& alignments = aligner.get_alignments();
+            while (next_added_request < added_requests.size())
+            {
+                const std::size_t i     = next_added_request++;
+                const StatusType status = alignments[i]->get_status();
+                added_requests[i]->callback(status, status == StatusType::success ? alignments[i] : nullptr);
+            }
+        }
+        aligner.reset();
+    }
+    catch (...)
+    {
+        // the aligner failed, the requests which have not been reported yet are reported as failed
+        for (; next_added_request < added_requests.size(); ++next_added_request)
+        {
+            added_requests[next_added_request]->callback(StatusType::generic_error, nullptr);
+        }
+        for (; next_request < batch.size(); ++next_request)
+        {
+            batch[next_request].callback(StatusType::generic_error, nullptr);
+        }
+        try
+        {
+            aligner.reset();
+        }
+        catch (...)
+        {
+            // the engine keeps running, if the aligner stays broken the following batches fail as well
+        }
+    }
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,81 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "edit_distance_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/edit_distance.hpp>
+#include <claraparabricks/genomeworks/utils/mathutils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+std::vector<int32_t> compute_edit_distances(const std::vector<std::pair<std::string, std::string>>& pairs,
+                                            const int32_t max_distance,
+                                            ThreadPool& thread_pool)
+{
+    const int32_t number_of_pairs = get_size<int32_t>(pairs);
+    std::vector<int32_t> distances(number_of_pairs);
+
+    // a few chunks per thread balance the load between threads without paying the task overhead for every pair
+    const int32_t number_of_chunks = std::max(1, std::min(number_of_pairs, 4 * thread_pool.number_of_threads()));
+    const int32_t chunk_size       = ceiling_divide(number_of_pairs, number_of_chunks);
+
+    TaskGroup tasks(thread_pool);
+    for (int32_t chunk_begin = 0; chunk_begin < number_of_pairs; chunk_begin += chunk_size)
+    {
+        const int32_t chunk_end = std::min(chunk_begin + chunk_size, number_of_pairs);
+        tasks.run([&pairs, &distances, max_distance, chunk_begin, chunk_end]() {
+            if (max_distance < 0)
+            {
+                std::vector<EditDistanceInput> inputs;
+                inputs.reserve(chunk_end - chunk_begin);
+                for (int32_t i = chunk_begin; i < chunk_end; ++i)
+                {
+                    inputs.push_back({pairs[i].first.data(), get_size<int32_t>(pairs[i].first), pairs[i].second.data(), get_size<int32_t>(pairs[i].second)});
+                }
+                const std::vector<int32_t> chunk_distances = myers_compute_edit_distances_cpu(inputs);
+                std::copy(std::begin(chunk_distances), std::end(chunk_distances), std::begin(distances) + chunk_begin);
+            }
+            else
+            {
+                for (int32_t i = chunk_begin; i < chunk_end; ++i)
+                {
+                    distances[i] = myers_compute_bounded_edit_distance_cpu(pairs[i].first.data(), get_size<int32_t>(pairs[i].first),
+                                                                           pairs[i].second.data(), get_size<int32_t>(pairs[i].second),
+                                                                           max_distance);
+                }
+            }
+        });
+    }
+    tasks.wait();
+
+    return distances;
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
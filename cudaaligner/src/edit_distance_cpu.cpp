@@ -0,0 +1,437 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "edit_distance_cpu.hpp"
+#include "simd_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/mathutils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#ifdef GW_CUDAALIGNER_X86_SIMD
+#include <immintrin.h>
+#endif
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+using WordType = uint64_t;
+
+constexpr int32_t word_size = sizeof(WordType) * CHAR_BIT;
+
+/// ScalarLanes - one lane, implemented with plain 64-bit integer operations
+struct ScalarLanes
+{
+    using vector_t                           = WordType;
+    static constexpr int32_t number_of_lanes = 1;
+
+    static vector_t set1(const WordType x) { return x; }
+    static vector_t load(const WordType* p) { return *p; }
+    static void store(WordType* p, const vector_t v) { *p = v; }
+    static vector_t gather(const std::array<const WordType*, number_of_lanes>& p, const int32_t w) { return p[0][w]; }
+    static vector_t bit_and(const vector_t a, const vector_t b) { return a & b; }
+    static vector_t bit_or(const vector_t a, const vector_t b) { return a | b; }
+    static vector_t bit_xor(const vector_t a, const vector_t b) { return a ^ b; }
+    static vector_t and_not(const vector_t a, const vector_t b) { return ~a & b; }
+    static vector_t add(const vector_t a, const vector_t b) { return a + b; }
+    static vector_t sub(const vector_t a, const vector_t b) { return a - b; }
+    static vector_t shift_left_1(const vector_t a) { return a << 1; }
+    static vector_t shift_right_63(const vector_t a) { return a >> 63; }
+    static vector_t equal_zero(const vector_t a) { return a == 0 ? ~WordType(0) : 0; }
+    static vector_t greater_than(const vector_t a, const vector_t b) { return static_cast<int64_t>(a) > static_cast<int64_t>(b) ? ~WordType(0) : 0; }
+};
+
+GW_CUDAALIGNER_BEGIN_SIMD_KERNELS
+
+/// \brief advances one block of Myers bit-vectors in every lane by one target character
+///
+/// carry is the horizontal difference (-1, 0 or 1) below the previous block on input and below this block on output, stored as 64-bit two's complement.
+/// Vectors are only passed by reference, so the function can be inlined into kernels compiled for wider instruction sets without changing their ABI.
+template <typename Lanes>
+__attribute__((always_inline)) inline void myers_advance_block_lanes(const typename Lanes::vector_t& hmask,
+                                                                     const typename Lanes::vector_t& eq_in,
+                                                                     typename Lanes::vector_t& carry,
+                                                                     typename Lanes::vector_t& pv,
+                                                                     typename Lanes::vector_t& mv)
+{
+    using vector_t       = typename Lanes::vector_t;
+    const vector_t ones  = Lanes::set1(~WordType(0));
+    const vector_t hin_n = Lanes::shift_right_63(carry);                                 // 1 where carry < 0
+    const vector_t hin_p = Lanes::bit_xor(Lanes::bit_and(carry, Lanes::set1(1)), hin_n); // 1 where carry > 0
+
+    const vector_t xv = Lanes::bit_or(eq_in, mv);
+    const vector_t eq = Lanes::bit_or(eq_in, hin_n);
+    const vector_t xh = Lanes::bit_or(Lanes::bit_xor(Lanes::add(Lanes::bit_and(eq, pv), pv), pv), eq);
+    vector_t ph       = Lanes::bit_or(mv, Lanes::and_not(Lanes::bit_or(xh, pv), ones));
+    vector_t mh       = Lanes::bit_and(pv, xh);
+
+    // (ph != 0) - (mh != 0) == (mh == 0) - (ph == 0) with comparisons returning -1 for true
+    carry = Lanes::sub(Lanes::equal_zero(Lanes::bit_and(ph, hmask)), Lanes::equal_zero(Lanes::bit_and(mh, hmask)));
+
+    ph = Lanes::bit_or(Lanes::shift_left_1(ph), hin_p);
+    mh = Lanes::bit_or(Lanes::shift_left_1(mh), hin_n);
+
+    pv = Lanes::bit_or(mh, Lanes::and_not(Lanes::bit_or(xv, ph), ones));
+    mv = Lanes::bit_and(ph, xv);
+}
+
+/// \brief computes edit distances of inputs[order[0..n)] processing Lanes::number_of_lanes pairs at once
+///
+/// Pairs processed together are consecutive in order, so order should group pairs of similar lengths.
+/// All queries have to be non-empty.
+template <typename Lanes>
+__attribute__((always_inline)) inline void myers_compute_edit_distances_lanes(const std::vector<EditDistanceInput>& inputs,
+                                               const std::vector<int32_t>& order,
+                                               std::vector<int32_t>& distances)
+{
+    using vector_t            = typename Lanes::vector_t;
+    constexpr int32_t n_lanes = Lanes::number_of_lanes;
+
+    // all per-word data is stored interleaved by lane, i.e. data[w * n_lanes + lane]
+    std::vector<WordType> peq;
+    std::vector<WordType> pv;
+    std::vector<WordType> mv;
+    std::vector<WordType> hmask;
+    std::vector<WordType> last_word_mask;
+    std::array<WordType, n_lanes> target_lengths;
+    std::array<WordType, n_lanes> scores;
+    std::array<const WordType*, n_lanes> eq;
+
+    const int32_t number_of_pairs = get_size<int32_t>(order);
+    for (int32_t group_begin = 0; group_begin < number_of_pairs; group_begin += n_lanes)
+    {
+        const int32_t group_size = std::min(n_lanes, number_of_pairs - group_begin);
+
+        int32_t n_words           = 0;
+        int32_t max_target_length = 0;
+        for (int32_t lane = 0; lane < group_size; ++lane)
+        {
+            const EditDistanceInput& input = inputs[order[group_begin + lane]];
+            n_words                        = std::max(n_words, ceiling_divide(input.query_length, word_size));
+            max_target_length              = std::max(max_target_length, input.target_length);
+        }
+
+        // peq of each lane is stored separately as pattern-major matrix, the last pattern never matches
+        peq.assign(static_cast<size_t>(n_lanes) * number_of_myers_patterns * n_words, 0);
+        pv.assign(static_cast<size_t>(n_words) * n_lanes, ~WordType(0));
+        mv.assign(static_cast<size_t>(n_words) * n_lanes, 0);
+        hmask.assign(static_cast<size_t>(n_words) * n_lanes, 0);
+        last_word_mask.assign(static_cast<size_t>(n_words) * n_lanes, 0);
+        target_lengths.fill(0);
+        scores.fill(0);
+        for (int32_t lane = 0; lane < group_size; ++lane)
+        {
+            const EditDistanceInput& input = inputs[order[group_begin + lane]];
+            WordType* const lane_peq       = peq.data() + static_cast<size_t>(lane) * number_of_myers_patterns * n_words;
+            for (int32_t i = 0; i < input.query_length; ++i)
+            {
+                lane_peq[get_myers_pattern_index(input.query[i]) * n_words + i / word_size] |= WordType(1) << (i % word_size);
+            }
+            // the score of the last query row is tracked, it is located in the highest used bit of the lane's last word
+            const int32_t last_word = (input.query_length - 1) / word_size;
+            for (int32_t w = 0; w < last_word; ++w)
+            {
+                hmask[w * n_lanes + lane] = WordType(1) << (word_size - 1);
+            }
+            hmask[last_word * n_lanes + lane]          = WordType(1) << ((input.query_length - 1) % word_size);
+            last_word_mask[last_word * n_lanes + lane] = ~WordType(0);
+            target_lengths[lane]                       = input.target_length;
+            scores[lane]                               = input.query_length;
+        }
+
+        vector_t score                  = Lanes::load(scores.data());
+        const vector_t target_lengths_v = Lanes::load(target_lengths.data());
+        for (int32_t j = 0; j < max_target_length; ++j)
+        {
+            for (int32_t lane = 0; lane < n_lanes; ++lane)
+            {
+                const bool lane_active = lane < group_size && j < inputs[order[group_begin + lane]].target_length;
+                const int32_t pattern  = lane_active ? get_myers_pattern_index(inputs[order[group_begin + lane]].target[j]) : number_of_myers_patterns - 1;
+                eq[lane]               = peq.data() + (static_cast<size_t>(lane) * number_of_myers_patterns + pattern) * n_words;
+            }
+            // lanes whose target has already ended keep computing, but their score is not updated anymore
+            const vector_t active = Lanes::greater_than(target_lengths_v, Lanes::set1(j));
+            vector_t carry        = Lanes::set1(1); // first row of the NW matrix increases by 1 in each column
+            for (int32_t w = 0; w < n_words; ++w)
+            {
+                const vector_t hmask_w = Lanes::load(hmask.data() + w * n_lanes);
+                const vector_t eq_w    = Lanes::gather(eq, w);
+                vector_t pv_w          = Lanes::load(pv.data() + w * n_lanes);
+                vector_t mv_w          = Lanes::load(mv.data() + w * n_lanes);
+                myers_advance_block_lanes<Lanes>(hmask_w, eq_w, carry, pv_w, mv_w);
+                Lanes::store(pv.data() + w * n_lanes, pv_w);
+                Lanes::store(mv.data() + w * n_lanes, mv_w);
+                score = Lanes::add(score, Lanes::bit_and(carry, Lanes::bit_and(Lanes::load(last_word_mask.data() + w * n_lanes), active)));
+            }
+        }
+        Lanes::store(scores.data(), score);
+        for (int32_t lane = 0; lane < group_size; ++lane)
+        {
+            distances[order[group_begin + lane]] = static_cast<int32_t>(static_cast<int64_t>(scores[lane]));
+        }
+    }
+}
+
+GW_CUDAALIGNER_END_SIMD_KERNELS
+
+void myers_compute_edit_distances_scalar(const std::vector<EditDistanceInput>& inputs, const std::vector<int32_t>& order, std::vector<int32_t>& distances)
+{
+    myers_compute_edit_distances_lanes<ScalarLanes>(inputs, order, distances);
+}
+
+#ifdef GW_CUDAALIGNER_X86_SIMD
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+/// Avx2Lanes - four 64-bit lanes
+struct Avx2Lanes
+{
+    using vector_t                           = __m256i;
+    static constexpr int32_t number_of_lanes = 4;
+
+    static vector_t set1(const WordType x) { return _mm256_set1_epi64x(static_cast<int64_t>(x)); }
+    static vector_t load(const WordType* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(WordType* p, const vector_t v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    static vector_t gather(const std::array<const WordType*, number_of_lanes>& p, const int32_t w)
+    {
+        return _mm256_set_epi64x(p[3][w], p[2][w], p[1][w], p[0][w]);
+    }
+    static vector_t bit_and(const vector_t a, const vector_t b) { return _mm256_and_si256(a, b); }
+    static vector_t bit_or(const vector_t a, const vector_t b) { return _mm256_or_si256(a, b); }
+    static vector_t bit_xor(const vector_t a, const vector_t b) { return _mm256_xor_si256(a, b); }
+    static vector_t and_not(const vector_t a, const vector_t b) { return _mm256_andnot_si256(a, b); }
+    static vector_t add(const vector_t a, const vector_t b) { return _mm256_add_epi64(a, b); }
+    static vector_t sub(const vector_t a, const vector_t b) { return _mm256_sub_epi64(a, b); }
+    static vector_t shift_left_1(const vector_t a) { return _mm256_slli_epi64(a, 1); }
+    static vector_t shift_right_63(const vector_t a) { return _mm256_srli_epi64(a, 63); }
+    static vector_t equal_zero(const vector_t a) { return _mm256_cmpeq_epi64(a, _mm256_setzero_si256()); }
+    static vector_t greater_than(const vector_t a, const vector_t b) { return _mm256_cmpgt_epi64(a, b); }
+};
+
+void myers_compute_edit_distances_avx2(const std::vector<EditDistanceInput>& inputs, const std::vector<int32_t>& order, std::vector<int32_t>& distances)
+{
+    myers_compute_edit_distances_lanes<Avx2Lanes>(inputs, order, distances);
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+/// Avx512Lanes - eight 64-bit lanes
+///
+/// Shifts and andnot use their zero-masking variants with a full mask, the unmasked ones trigger false maybe-uninitialized warnings in some GCC versions.
+struct Avx512Lanes
+{
+    using vector_t                           = __m512i;
+    static constexpr int32_t number_of_lanes = 8;
+
+    static vector_t set1(const WordType x) { return _mm512_set1_epi64(static_cast<int64_t>(x)); }
+    static vector_t load(const WordType* p) { return _mm512_loadu_si512(p); }
+    static void store(WordType* p, const vector_t v) { _mm512_storeu_si512(p, v); }
+    static vector_t gather(const std::array<const WordType*, number_of_lanes>& p, const int32_t w)
+    {
+        return _mm512_set_epi64(p[7][w], p[6][w], p[5][w], p[4][w], p[3][w], p[2][w], p[1][w], p[0][w]);
+    }
+    static vector_t bit_and(const vector_t a, const vector_t b) { return _mm512_and_si512(a, b); }
+    static vector_t bit_or(const vector_t a, const vector_t b) { return _mm512_or_si512(a, b); }
+    static vector_t bit_xor(const vector_t a, const vector_t b) { return _mm512_xor_si512(a, b); }
+    static vector_t and_not(const vector_t a, const vector_t b) { return _mm512_maskz_andnot_epi64(0xff, a, b); }
+    static vector_t add(const vector_t a, const vector_t b) { return _mm512_add_epi64(a, b); }
+    static vector_t sub(const vector_t a, const vector_t b) { return _mm512_sub_epi64(a, b); }
+    static vector_t shift_left_1(const vector_t a) { return _mm512_maskz_slli_epi64(0xff, a, 1); }
+    static vector_t shift_right_63(const vector_t a) { return _mm512_maskz_srli_epi64(0xff, a, 63); }
+    static vector_t equal_zero(const vector_t a) { return _mm512_maskz_set1_epi64(_mm512_cmpeq_epi64_mask(a, _mm512_setzero_si512()), -1); }
+    static vector_t greater_than(const vector_t a, const vector_t b) { return _mm512_maskz_set1_epi64(_mm512_cmpgt_epi64_mask(a, b), -1); }
+};
+
+void myers_compute_edit_distances_avx512(const std::vector<EditDistanceInput>& inputs, const std::vector<int32_t>& order, std::vector<int32_t>& distances)
+{
+    myers_compute_edit_distances_lanes<Avx512Lanes>(inputs, order, distances);
+}
+
+#pragma GCC pop_options
+#endif
+
+} // namespace
+
+bool is_instruction_set_supported(const InstructionSet instruction_set)
+{
+    switch (instruction_set)
+    {
+    case InstructionSet::scalar: return true;
+#ifdef GW_CUDAALIGNER_X86_SIMD
+    case InstructionSet::avx2: return __builtin_cpu_supports("avx2");
+    case InstructionSet::avx512: return __builtin_cpu_supports("avx512f");
+#endif
+    default: return false;
+    }
+}
+
+InstructionSet get_best_supported_instruction_set()
+{
+    if (is_instruction_set_supported(InstructionSet::avx512))
+        return InstructionSet::avx512;
+    if (is_instruction_set_supported(InstructionSet::avx2))
+        return InstructionSet::avx2;
+    return InstructionSet::scalar;
+}
+
+std::vector<int32_t> myers_compute_edit_distances_cpu(const std::vector<EditDistanceInput>& inputs, const InstructionSet instruction_set)
+{
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        throw std::invalid_argument("Requested instruction set is not supported on this machine.");
+    }
+
+    std::vector<int32_t> distances(inputs.size());
+
+    // pairs with empty queries are trivial, the rest is sorted by length so that pairs processed together need similar amounts of work
+    std::vector<int32_t> order;
+    order.reserve(inputs.size());
+    for (int32_t i = 0; i < get_size<int32_t>(inputs); ++i)
+    {
+        throw_on_negative(inputs[i].query_length, "query_length must be non-negative.");
+        throw_on_negative(inputs[i].target_length, "target_length must be non-negative.");
+        if (inputs[i].query_length == 0)
+        {
+            distances[i] = inputs[i].target_length;
+        }
+        else
+        {
+            order.push_back(i);
+        }
+    }
+    std::sort(std::begin(order), std::end(order), [&inputs](const int32_t a, const int32_t b) {
+        const int32_t words_a = ceiling_divide(inputs[a].query_length, word_size);
+        const int32_t words_b = ceiling_divide(inputs[b].query_length, word_size);
+        return words_a != words_b ? words_a > words_b : inputs[a].target_length > inputs[b].target_length;
+    });
+
+    switch (instruction_set)
+    {
+#ifdef GW_CUDAALIGNER_X86_SIMD
+    case InstructionSet::avx512: myers_compute_edit_distances_avx512(inputs, order, distances); break;
+    case InstructionSet::avx2: myers_compute_edit_distances_avx2(inputs, order, distances); break;
+#endif
+    default: myers_compute_edit_distances_scalar(inputs, order, distances); break;
+    }
+
+    return distances;
+}
+
+int32_t myers_compute_bounded_edit_distance_cpu(const char* query, const int32_t query_length, const char* target, const int32_t target_length, const int32_t max_distance)
+{
+    throw_on_negative(query_length, "query_length must be non-negative.");
+    throw_on_negative(target_length, "target_length must be non-negative.");
+    throw_on_negative(max_distance, "max_distance must be non-negative.");
+
+    // every alignment needs at least |query_length - target_length| indels
+    const int32_t length_difference = std::abs(query_length - target_length);
+    if (length_difference > max_distance)
+        return edit_distance_exceeds_max;
+    if (query_length == 0)
+        return target_length;
+
+    // cell (i, j) can only be part of an alignment with at most max_distance edits if
+    // |i - j| + |(query_length - target_length) - (i - j)| <= max_distance, i.e. if its diagonal i - j is in [diagonal_min, diagonal_max]
+    const int32_t slack        = (max_distance - length_difference) / 2;
+    const int32_t diagonal_min = std::min(0, query_length - target_length) - slack;
+    const int32_t diagonal_max = std::max(0, query_length - target_length) + slack;
+
+    const int32_t n_words = ceiling_divide(query_length, word_size);
+    std::vector<WordType> peq(static_cast<size_t>(number_of_myers_patterns) * n_words, 0);
+    for (int32_t i = 0; i < query_length; ++i)
+    {
+        peq[get_myers_pattern_index(query[i]) * n_words + i / word_size] |= WordType(1) << (i % word_size);
+    }
+
+    // rows are numbered from 1, row 0 of the NW matrix is implicit, block b covers rows [b * word_size + 1, block_end_row(b)]
+    auto block_end_row = [query_length](const int32_t b) { return std::min((b + 1) * word_size, query_length); };
+    auto row_to_block  = [](const int32_t row) { return (row - 1) / word_size; };
+
+    // pv, mv and score (score of the block's last row) are only valid for blocks intersecting the band of the current column
+    std::vector<WordType> pv(n_words, ~WordType(0));
+    std::vector<WordType> mv(n_words, 0);
+    std::vector<int32_t> score(n_words);
+    int32_t last_block = std::min(query_length, diagonal_max) > 0 ? row_to_block(std::min(query_length, diagonal_max)) : -1;
+    for (int32_t b = 0; b <= last_block; ++b)
+    {
+        score[b] = block_end_row(b);
+    }
+
+    for (int32_t j = 1; j <= target_length; ++j)
+    {
+        const int32_t first_row = std::max(1, j + diagonal_min);
+        const int32_t last_row  = std::min(query_length, j + diagonal_max);
+        assert(first_row <= last_row);
+
+        // blocks entering the band start from an upper bound of their previous column, cells outside of the band
+        // are overestimated, which never underestimates cells inside of the band (Ukkonen)
+        for (int32_t b = last_block + 1; b <= row_to_block(last_row); ++b)
+        {
+            pv[b]    = ~WordType(0);
+            mv[b]    = 0;
+            score[b] = (b == 0 ? j - 1 : score[b - 1]) + block_end_row(b) - b * word_size;
+        }
+        last_block = row_to_block(last_row);
+
+        const WordType* const eq = peq.data() + get_myers_pattern_index(target[j - 1]) * n_words;
+        WordType carry           = 1; // upper bound of the horizontal difference above the first block
+        int32_t lower_bound      = std::numeric_limits<int32_t>::max();
+        for (int32_t b = row_to_block(first_row); b <= last_block; ++b)
+        {
+            const WordType hmask = WordType(1) << ((block_end_row(b) - 1) % word_size);
+            myers_advance_block_lanes<ScalarLanes>(hmask, eq[b], carry, pv[b], mv[b]);
+            score[b] += static_cast<int32_t>(static_cast<int64_t>(carry));
+            // vertical differences are at most 1, so no cell of the block within the band is below this
+            lower_bound = std::min(lower_bound, score[b] - (block_end_row(b) - std::max(b * word_size + 1, first_row)));
+        }
+        if (lower_bound > max_distance)
+            return edit_distance_exceeds_max;
+    }
+
+    assert(last_block == n_words - 1);
+    return score[n_words - 1] <= max_distance ? score[n_words - 1] : edit_distance_exceeds_max;
+}
+
+int32_t myers_compute_edit_distance_cpu(const char* query, const int32_t query_length, const char* target, const int32_t target_length)
+{
+    return myers_compute_edit_distances_cpu({{query, query_length, target, target_length}}, InstructionSet::scalar).front();
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
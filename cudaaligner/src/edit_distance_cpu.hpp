@@ -0,0 +1,120 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/edit_distance.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// number of distinct match patterns of the CPU Myers implementations: A, C, G, T and everything else
+constexpr int32_t number_of_myers_patterns = 5;
+
+/// \brief maps a character to the index of its Myers match pattern, all characters except ACGT share a pattern that never matches
+/// \param x character
+/// \return pattern index in [0, number_of_myers_patterns)
+inline int32_t get_myers_pattern_index(const char x)
+{
+    switch (x)
+    {
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+    default: return number_of_myers_patterns - 1;
+    }
+}
+
+/// EditDistanceInput - pair of sequences whose edit distance should be computed, the sequences are not owned
+struct EditDistanceInput
+{
+    /// query sequence
+    const char* query;
+    /// length of query sequence
+    int32_t query_length;
+    /// target sequence
+    const char* target;
+    /// length of target sequence
+    int32_t target_length;
+};
+
+/// InstructionSet - SIMD instruction sets the CPU edit distance kernel can use
+enum class InstructionSet
+{
+    scalar = 0,
+    avx2,
+    avx512
+};
+
+/// \brief returns the widest instruction set supported by both the binary and the CPU it runs on
+/// \return instruction set
+InstructionSet get_best_supported_instruction_set();
+
+/// \brief returns whether the given instruction set can be used on this machine
+/// \param instruction_set
+/// \return true if supported
+bool is_instruction_set_supported(InstructionSet instruction_set);
+
+/// \brief Computes global edit distances of pairs of sequences on the CPU using Myers' bit-parallel algorithm
+///
+/// The match patterns of each query are computed once upfront. With SIMD instruction sets multiple pairs
+/// of similar length are processed at once, one pair per 64-bit lane (4 lanes for AVX2, 8 lanes for AVX-512).
+/// Only characters from the alphabet [ACGT] are guaranteed to provide correct results, all other characters are treated as mismatches.
+///
+/// \param inputs pairs of sequences
+/// \param instruction_set instruction set to use, throws if it is not supported on this machine
+/// \return edit distances, in the same order as inputs
+/// \throw std::invalid_argument if instruction_set is not supported
+std::vector<int32_t> myers_compute_edit_distances_cpu(const std::vector<EditDistanceInput>& inputs,
+                                                      InstructionSet instruction_set = get_best_supported_instruction_set());
+
+/// \brief Computes global edit distance of one pair of sequences on the CPU if it does not exceed max_distance
+///
+/// Uses Myers' bit-parallel algorithm on the blocks of the query which intersect the band of diagonals an alignment with
+/// at most max_distance edits can use (Ukkonen's cut-off). Blocks outside of the band are never computed, and the
+/// computation stops as soon as a lower bound of all cells of a column exceeds max_distance.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param max_distance largest edit distance of interest, has to be non-negative
+/// \return edit distance or edit_distance_exceeds_max
+int32_t myers_compute_bounded_edit_distance_cpu(const char* query, int32_t query_length, const char* target, int32_t target_length, int32_t max_distance);
+
+/// \brief Computes global edit distance of one pair of sequences on the CPU using Myers' bit-parallel algorithm
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \return edit distance
+int32_t myers_compute_edit_distance_cpu(const char* query, int32_t query_length, const char* target, int32_t target_length);
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
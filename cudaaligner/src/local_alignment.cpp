@@ -0,0 +1,70 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "smith_waterman_cpu.hpp"
+#include "affine_gap_alignment_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/local_alignment.hpp>
+#include <claraparabricks/genomeworks/utils/mathutils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+std::vector<LocalAlignmentScore> compute_local_alignment_scores(const std::vector<std::pair<std::string, std::string>>& pairs,
+                                                                const AffineGapScores& scores,
+                                                                ThreadPool& thread_pool)
+{
+    validate_affine_gap_scores(scores);
+    const int32_t number_of_pairs = get_size<int32_t>(pairs);
+    std::vector<LocalAlignmentScore> results(number_of_pairs);
+
+    // a few chunks per thread balance the load between threads without paying the task overhead for every pair
+    const int32_t number_of_chunks = std::max(1, std::min(number_of_pairs, 4 * thread_pool.number_of_threads()));
+    const int32_t chunk_size       = ceiling_divide(number_of_pairs, number_of_chunks);
+
+    TaskGroup tasks(thread_pool);
+    for (int32_t chunk_begin = 0; chunk_begin < number_of_pairs; chunk_begin += chunk_size)
+    {
+        const int32_t chunk_end = std::min(chunk_begin + chunk_size, number_of_pairs);
+        tasks.run([&pairs, &results, &scores, chunk_begin, chunk_end]() {
+            for (int32_t i = chunk_begin; i < chunk_end; ++i)
+            {
+                results[i] = smith_waterman_compute_score_cpu(pairs[i].first.data(), get_size<int32_t>(pairs[i].first),
+                                                              pairs[i].second.data(), get_size<int32_t>(pairs[i].second),
+                                                              scores);
+            }
+        });
+    }
+    tasks.wait();
+
+    return results;
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
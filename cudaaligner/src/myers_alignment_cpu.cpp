@@ -0,0 +1,569 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "myers_alignment_cpu.hpp"
+#include "edit_distance_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/mathutils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <climits>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+using WordType = uint64_t;
+
+constexpr int32_t word_size = sizeof(WordType) * CHAR_BIT;
+
+inline int32_t popcount(const WordType x)
+{
+    return __builtin_popcountll(x);
+}
+
+/// \brief advances one block of the Myers bit-vectors by one target character, returns the horizontal delta at the block's last row
+inline int32_t myers_advance_block(const WordType hmask, const int32_t carry_in, WordType eq, WordType& pv, WordType& mv)
+{
+    assert((pv & mv) == WordType(0));
+
+    const WordType xv = eq | mv;
+    if (carry_in < 0)
+        eq |= WordType(1);
+    const WordType xh = (((eq & pv) + pv) ^ pv) | eq;
+    WordType ph       = mv | (~(xh | pv));
+    WordType mh       = pv & xh;
+
+    const int32_t carry_out = ((ph & hmask) == WordType(0) ? 0 : 1) - ((mh & hmask) == WordType(0) ? 0 : 1);
+
+    ph <<= 1;
+    mh <<= 1;
+
+    if (carry_in < 0)
+        mh |= WordType(1);
+
+    if (carry_in > 0)
+        ph |= WordType(1);
+
+    pv = mh | (~(xv | ph));
+    mv = ph & xv;
+
+    return carry_out;
+}
+
+/// MyersMatrices - vertical difference bit-vectors and block scores of all columns, column j is stored contiguously
+///
+/// With free_target_gaps the first row of the NW matrix is 0 (semi-global alignment), otherwise it is 0, 1, 2, ... (global alignment)
+class MyersMatrices
+{
+public:
+    MyersMatrices(const int32_t query_length, const int32_t target_length, const bool free_target_gaps)
+        : free_target_gaps_(free_target_gaps)
+        , query_length_(query_length)
+        , n_words_(ceiling_divide(query_length, word_size))
+        , last_entry_mask_(query_length % word_size != 0 ? (WordType(1) << (query_length % word_size)) - 1 : ~WordType(0))
+        , pv_(static_cast<size_t>(n_words_) * (target_length + 1))
+        , mv_(static_cast<size_t>(n_words_) * (target_length + 1))
+        , score_(static_cast<size_t>(n_words_) * (target_length + 1))
+    {
+    }
+
+    int32_t n_words() const { return n_words_; }
+
+    WordType& pv(const int32_t word, const int32_t j) { return pv_[static_cast<size_t>(j) * n_words_ + word]; }
+    WordType& mv(const int32_t word, const int32_t j) { return mv_[static_cast<size_t>(j) * n_words_ + word]; }
+    int32_t& score(const int32_t word, const int32_t j) { return score_[static_cast<size_t>(j) * n_words_ + word]; }
+
+    /// \brief returns the Needleman-Wunsch score in row i (0 = empty query prefix) and column j
+    int32_t get_score(const int32_t i, const int32_t j)
+    {
+        if (i == 0)
+            return free_target_gaps_ ? 0 : j;
+        // the score is stored for the last row of each block, subtract the vertical differences below row i
+        const int32_t word_idx = (i - 1) / word_size;
+        const int32_t bit_idx  = (i - 1) % word_size;
+        WordType mask          = (~WordType(1)) << bit_idx;
+        if (word_idx == n_words_ - 1)
+            mask &= last_entry_mask_;
+        return score(word_idx, j) - popcount(mask & pv(word_idx, j)) + popcount(mask & mv(word_idx, j));
+    }
+
+    int32_t query_length() const { return query_length_; }
+
+    bool free_target_gaps() const { return free_target_gaps_; }
+
+    WordType last_entry_mask() const { return last_entry_mask_; }
+
+private:
+    bool free_target_gaps_;
+    int32_t query_length_;
+    int32_t n_words_;
+    WordType last_entry_mask_;
+    std::vector<WordType> pv_;
+    std::vector<WordType> mv_;
+    std::vector<int32_t> score_;
+};
+
+void myers_compute_matrices(MyersMatrices& matrices, const char* query, const char* target, const int32_t target_length)
+{
+    const int32_t query_length = matrices.query_length();
+    const int32_t n_words      = matrices.n_words();
+
+    // precompute the match patterns of all characters for the whole query
+    std::vector<WordType> peq(static_cast<size_t>(number_of_myers_patterns) * n_words, 0);
+    for (int32_t i = 0; i < query_length; ++i)
+    {
+        peq[get_myers_pattern_index(query[i]) * n_words + i / word_size] |= WordType(1) << (i % word_size);
+    }
+
+    for (int32_t w = 0; w < n_words; ++w)
+    {
+        matrices.pv(w, 0)    = ~WordType(0);
+        matrices.mv(w, 0)    = 0;
+        matrices.score(w, 0) = std::min((w + 1) * word_size, query_length);
+    }
+
+    const WordType last_hmask = (matrices.last_entry_mask() >> 1) + 1; // highest valid bit of the last block
+    for (int32_t j = 1; j <= target_length; ++j)
+    {
+        const WordType* const eq = peq.data() + get_myers_pattern_index(target[j - 1]) * n_words;
+        int32_t carry            = matrices.free_target_gaps() ? 0 : 1; // difference between consecutive columns in the first row of the NW matrix
+        for (int32_t w = 0; w < n_words; ++w)
+        {
+            const WordType hmask = w < n_words - 1 ? WordType(1) << (word_size - 1) : last_hmask;
+            WordType pv          = matrices.pv(w, j - 1);
+            WordType mv          = matrices.mv(w, j - 1);
+            carry                = myers_advance_block(hmask, carry, eq[w], pv, mv);
+            matrices.pv(w, j)    = pv;
+            matrices.mv(w, j)    = mv;
+            matrices.score(w, j) = matrices.score(w, j - 1) + carry;
+        }
+    }
+}
+
+/// \brief traces back from the last row in column target_end, returns the alignment in forward order and sets target_start
+std::vector<AlignmentState> myers_backtrace(MyersMatrices& matrices, const int32_t target_end, int32_t& target_start)
+{
+    int32_t i = matrices.query_length();
+    int32_t j = target_end;
+
+    std::vector<AlignmentState> path;
+    path.reserve(i + j);
+
+    int32_t myscore = matrices.get_score(i, j);
+    while (i > 0 && j > 0)
+    {
+        const int32_t left = matrices.get_score(i, j - 1);
+        if (left + 1 == myscore)
+        {
+            path.push_back(AlignmentState::insertion);
+            myscore = left;
+            --j;
+            continue;
+        }
+        const int32_t above = matrices.get_score(i - 1, j);
+        if (above + 1 == myscore)
+        {
+            path.push_back(AlignmentState::deletion);
+            myscore = above;
+            --i;
+            continue;
+        }
+        const int32_t diag = matrices.get_score(i - 1, j - 1);
+        path.push_back(diag == myscore ? AlignmentState::match : AlignmentState::mismatch);
+        myscore = diag;
+        --i;
+        --j;
+    }
+    path.insert(path.end(), i, AlignmentState::deletion);
+    if (!matrices.free_target_gaps())
+    {
+        path.insert(path.end(), j, AlignmentState::insertion);
+        j = 0;
+    }
+    target_start = j;
+
+    std::reverse(begin(path), end(path));
+    return path;
+}
+
+/// MyersLastRow - computes the last row of the global NW matrix of a pattern against all prefixes of a text
+///
+/// The matrix is cut into row_blocks x column_blocks tiles which are computed as a wavefront of tasks:
+/// tile (r, c) needs the bit-vectors of its words after tile (r, c - 1) and the horizontal deltas
+/// leaving the last word of tile (r - 1, c). Every finished tile starts the successors whose inputs are complete,
+/// so no task waits for another one. The memory is O(row_blocks * text_length) bytes for the deltas.
+class MyersLastRow
+{
+public:
+    MyersLastRow(const char* pattern, const int32_t pattern_length, const char* text, const int32_t text_length,
+                 const int32_t number_of_threads, std::vector<int32_t>& row, std::function<void()> on_finished)
+        : text_(text)
+        , text_length_(text_length)
+        , pattern_length_(pattern_length)
+        , n_words_(ceiling_divide(pattern_length, word_size))
+        , peq_(static_cast<size_t>(number_of_myers_patterns) * n_words_, 0)
+        , pv_(n_words_, ~WordType(0))
+        , mv_(n_words_, 0)
+        , row_(row)
+        , on_finished_(std::move(on_finished))
+    {
+        assert(pattern_length > 0);
+        for (int32_t i = 0; i < pattern_length; ++i)
+        {
+            peq_[get_myers_pattern_index(pattern[i]) * n_words_ + i / word_size] |= WordType(1) << (i % word_size);
+        }
+
+        // small matrices are computed by a single task, large ones by a wavefront with one row block per thread
+        // and enough column blocks to keep all of them busy most of the time
+        const int64_t work = static_cast<int64_t>(n_words_) * text_length;
+        row_blocks_        = work < min_parallel_work ? 1 : std::max(1, std::min(n_words_ / min_words_per_block, number_of_threads));
+        words_per_block_   = ceiling_divide(n_words_, row_blocks_);
+        row_blocks_        = ceiling_divide(n_words_, words_per_block_);
+        columns_per_block_ = std::max(min_columns_per_block, ceiling_divide(text_length, 8 * row_blocks_));
+        column_blocks_     = row_blocks_ == 1 ? 1 : std::max(1, ceiling_divide(text_length, columns_per_block_));
+        if (column_blocks_ == 1)
+        {
+            columns_per_block_ = std::max(1, text_length);
+        }
+
+        carries_.resize(static_cast<size_t>(row_blocks_) * text_length);
+        unfinished_dependencies_ = std::vector<std::atomic<int32_t>>(static_cast<size_t>(row_blocks_) * column_blocks_);
+        for (int32_t r = 0; r < row_blocks_; ++r)
+        {
+            for (int32_t c = 0; c < column_blocks_; ++c)
+            {
+                unfinished_dependencies_[r * column_blocks_ + c] = (r > 0 ? 1 : 0) + (c > 0 ? 1 : 0);
+            }
+        }
+    }
+
+    /// \brief starts the computation with tasks of the group, on_finished is called from the task computing the last tile
+    static void start(const std::shared_ptr<MyersLastRow>& last_row, TaskGroup& tasks)
+    {
+        tasks.run([last_row, &tasks]() { compute_tile(last_row, tasks, 0, 0); });
+    }
+
+private:
+    static constexpr int64_t min_parallel_work     = 1 << 20;
+    static constexpr int32_t min_words_per_block   = 4;
+    static constexpr int32_t min_columns_per_block = 1024;
+
+    static void compute_tile(const std::shared_ptr<MyersLastRow>& last_row, TaskGroup& tasks, const int32_t r, const int32_t c)
+    {
+        MyersLastRow& self = *last_row;
+        self.advance_tile(r, c);
+        if (r == self.row_blocks_ - 1 && c == self.column_blocks_ - 1)
+        {
+            self.finish();
+            return;
+        }
+        if (r + 1 < self.row_blocks_ && self.finish_dependency(r + 1, c))
+        {
+            tasks.run([last_row, &tasks, r, c]() { compute_tile(last_row, tasks, r + 1, c); });
+        }
+        if (c + 1 < self.column_blocks_ && self.finish_dependency(r, c + 1))
+        {
+            tasks.run([last_row, &tasks, r, c]() { compute_tile(last_row, tasks, r, c + 1); });
+        }
+    }
+
+    /// \brief returns true if the last input of tile (r, c) has been computed
+    bool finish_dependency(const int32_t r, const int32_t c)
+    {
+        return unfinished_dependencies_[r * column_blocks_ + c].fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    void advance_tile(const int32_t r, const int32_t c)
+    {
+        const int32_t word_begin     = r * words_per_block_;
+        const int32_t word_end       = std::min(word_begin + words_per_block_, n_words_);
+        const int32_t column_begin   = c * columns_per_block_;
+        const int32_t column_end     = std::min(column_begin + columns_per_block_, text_length_);
+        const int8_t* const carry_in = r > 0 ? carries_.data() + static_cast<size_t>(r - 1) * text_length_ : nullptr;
+        int8_t* const carry_out      = carries_.data() + static_cast<size_t>(r) * text_length_;
+        const WordType last_hmask    = WordType(1) << ((pattern_length_ - 1) % word_size); // highest valid bit of the last block
+
+        for (int32_t j = column_begin; j < column_end; ++j)
+        {
+            const WordType* const eq = peq_.data() + get_myers_pattern_index(text_[j]) * n_words_;
+            int32_t carry            = carry_in != nullptr ? carry_in[j] : 1; // the first row of the NW matrix is 0, 1, 2, ...
+            for (int32_t w = word_begin; w < word_end; ++w)
+            {
+                const WordType hmask = w < n_words_ - 1 ? WordType(1) << (word_size - 1) : last_hmask;
+                carry                = myers_advance_block(hmask, carry, eq[w], pv_[w], mv_[w]);
+            }
+            carry_out[j] = static_cast<int8_t>(carry);
+        }
+    }
+
+    void finish()
+    {
+        const int8_t* const deltas = carries_.data() + static_cast<size_t>(row_blocks_ - 1) * text_length_;
+        row_.resize(text_length_ + 1);
+        row_[0] = pattern_length_;
+        for (int32_t j = 0; j < text_length_; ++j)
+        {
+            row_[j + 1] = row_[j] + deltas[j];
+        }
+        carries_ = std::vector<int8_t>();
+        on_finished_();
+    }
+
+    const char* text_;
+    int32_t text_length_;
+    int32_t pattern_length_;
+    int32_t n_words_;
+    int32_t row_blocks_;
+    int32_t words_per_block_;
+    int32_t column_blocks_;
+    int32_t columns_per_block_;
+    std::vector<WordType> peq_;
+    std::vector<WordType> pv_;
+    std::vector<WordType> mv_;
+    std::vector<int8_t> carries_;
+    std::vector<std::atomic<int32_t>> unfinished_dependencies_;
+    std::vector<int32_t>& row_;
+    std::function<void()> on_finished_;
+};
+
+/// HirschbergMyersSplit - last rows of the two halves of one split of the recursion
+struct HirschbergMyersSplit
+{
+    int32_t query_begin;
+    int32_t query_split;
+    int32_t query_end;
+    int32_t target_begin;
+    int32_t target_end;
+    // forward_row[j]: cost of aligning the upper half of the query with the first j bases of the target,
+    // backward_row[k]: cost of aligning the lower half of the query with the last k bases of the target
+    std::vector<int32_t> forward_row;
+    std::vector<int32_t> backward_row;
+    std::atomic<int32_t> unfinished_rows;
+};
+
+/// HirschbergMyers - state of one alignment shared by all tasks of its recursion
+///
+/// Every split computes the last rows of both halves as tasks and, once both are available, spawns the two subproblems
+/// as tasks. Subproblems of at most max_tile_cells cells are aligned with full Myers matrices, their alignments are
+/// collected as tiles which are concatenated in the order of their positions after all tasks have finished.
+class HirschbergMyers
+{
+public:
+    HirschbergMyers(const char* query, const int32_t query_length, const char* target, const int32_t target_length,
+                    TaskGroup& tasks, const int32_t number_of_threads, const int64_t max_tile_cells)
+        : query_(query)
+        , reversed_query_(query, query + query_length)
+        , target_(target)
+        , reversed_target_(target, target + target_length)
+        , tasks_(tasks)
+        , number_of_threads_(number_of_threads)
+        , max_tile_cells_(max_tile_cells)
+    {
+        std::reverse(begin(reversed_query_), end(reversed_query_));
+        std::reverse(begin(reversed_target_), end(reversed_target_));
+    }
+
+    /// \brief aligns query[query_begin, query_end) and target[target_begin, target_end), called from tasks of the group
+    void align(const int32_t query_begin, const int32_t query_end, const int32_t target_begin, const int32_t target_end)
+    {
+        const int32_t m = query_end - query_begin;
+        const int32_t n = target_end - target_begin;
+        if (m <= 1 || n == 0 || static_cast<int64_t>(m + 1) * (n + 1) <= max_tile_cells_)
+        {
+            if (m + n > 0)
+            {
+                std::vector<AlignmentState> path = myers_compute_alignment_cpu(query_ + query_begin, m, target_ + target_begin, n);
+                std::lock_guard<std::mutex> lock(tiles_mutex_);
+                tiles_.push_back({query_begin, target_begin, std::move(path)});
+            }
+            return;
+        }
+
+        auto split             = std::make_shared<HirschbergMyersSplit>();
+        split->query_begin     = query_begin;
+        split->query_split     = query_begin + m / 2;
+        split->query_end       = query_end;
+        split->target_begin    = target_begin;
+        split->target_end      = target_end;
+        split->unfinished_rows = 2;
+
+        const int32_t query_length  = get_size<int32_t>(reversed_query_);
+        const int32_t target_length = get_size<int32_t>(reversed_target_);
+        const auto on_row_finished  = [this, split]() {
+            if (split->unfinished_rows.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                spawn_subproblems(*split);
+            }
+        };
+        MyersLastRow::start(std::make_shared<MyersLastRow>(query_ + query_begin, split->query_split - query_begin, target_ + target_begin, n,
+                                                           number_of_threads_, split->forward_row, on_row_finished),
+                            tasks_);
+        MyersLastRow::start(std::make_shared<MyersLastRow>(reversed_query_.data() + query_length - query_end, query_end - split->query_split,
+                                                           reversed_target_.data() + target_length - target_end, n,
+                                                           number_of_threads_, split->backward_row, on_row_finished),
+                            tasks_);
+    }
+
+    /// \brief returns the alignment, all tasks of the group have to be finished
+    std::vector<AlignmentState> get_alignment()
+    {
+        std::sort(begin(tiles_), end(tiles_), [](const Tile& a, const Tile& b) {
+            return a.query_begin != b.query_begin ? a.query_begin < b.query_begin : a.target_begin < b.target_begin;
+        });
+        size_t length = 0;
+        for (const Tile& tile : tiles_)
+        {
+            length += tile.path.size();
+        }
+        std::vector<AlignmentState> alignment;
+        alignment.reserve(length);
+        for (Tile& tile : tiles_)
+        {
+            alignment.insert(end(alignment), begin(tile.path), end(tile.path));
+            tile.path = std::vector<AlignmentState>();
+        }
+        return alignment;
+    }
+
+private:
+    struct Tile
+    {
+        int32_t query_begin;
+        int32_t target_begin;
+        std::vector<AlignmentState> path;
+    };
+
+    void spawn_subproblems(HirschbergMyersSplit& split)
+    {
+        const int32_t n      = split.target_end - split.target_begin;
+        int32_t target_split = 0;
+        int32_t best_cost    = std::numeric_limits<int32_t>::max();
+        for (int32_t j = 0; j <= n; ++j)
+        {
+            const int32_t cost = split.forward_row[j] + split.backward_row[n - j];
+            if (cost < best_cost)
+            {
+                best_cost    = cost;
+                target_split = split.target_begin + j;
+            }
+        }
+
+        const int32_t query_begin  = split.query_begin;
+        const int32_t query_split  = split.query_split;
+        const int32_t query_end    = split.query_end;
+        const int32_t target_begin = split.target_begin;
+        const int32_t target_end   = split.target_end;
+        split.forward_row          = std::vector<int32_t>();
+        split.backward_row         = std::vector<int32_t>();
+        tasks_.run([this, query_begin, query_split, target_begin, target_split]() { align(query_begin, query_split, target_begin, target_split); });
+        tasks_.run([this, query_split, query_end, target_split, target_end]() { align(query_split, query_end, target_split, target_end); });
+    }
+
+    const char* query_;
+    std::vector<char> reversed_query_;
+    const char* target_;
+    std::vector<char> reversed_target_;
+    TaskGroup& tasks_;
+    int32_t number_of_threads_;
+    int64_t max_tile_cells_;
+    std::mutex tiles_mutex_;
+    std::vector<Tile> tiles_;
+};
+
+} // namespace
+
+std::vector<AlignmentState> myers_compute_alignment_cpu(const char* query, const int32_t query_length, const char* target, const int32_t target_length)
+{
+    assert(query_length >= 0);
+    assert(target_length >= 0);
+    if (query_length == 0)
+    {
+        return std::vector<AlignmentState>(target_length, AlignmentState::insertion);
+    }
+
+    MyersMatrices matrices(query_length, target_length, false);
+    myers_compute_matrices(matrices, query, target, target_length);
+    int32_t target_start = 0;
+    return myers_backtrace(matrices, target_length, target_start);
+}
+
+std::vector<AlignmentState> myers_compute_semi_global_alignment_cpu(const char* query, const int32_t query_length, const char* target, const int32_t target_length, AlignedInterval& aligned_interval)
+{
+    assert(query_length >= 0);
+    assert(target_length >= 0);
+    if (query_length == 0)
+    {
+        aligned_interval = {0, 0, 0, 0};
+        return {};
+    }
+
+    MyersMatrices matrices(query_length, target_length, true);
+    myers_compute_matrices(matrices, query, target, target_length);
+
+    // the alignment ends in the leftmost column with the smallest score in the last row
+    int32_t target_end = 0;
+    int32_t best_score = matrices.get_score(query_length, 0);
+    for (int32_t j = 1; j <= target_length; ++j)
+    {
+        const int32_t score = matrices.get_score(query_length, j);
+        if (score < best_score)
+        {
+            best_score = score;
+            target_end = j;
+        }
+    }
+
+    int32_t target_start                  = 0;
+    std::vector<AlignmentState> alignment = myers_backtrace(matrices, target_end, target_start);
+    aligned_interval                      = {0, query_length, target_start, target_end};
+    return alignment;
+}
+
+std::vector<AlignmentState> hirschberg_myers_compute_alignment_cpu(const char* query, const int32_t query_length, const char* target, const int32_t target_length,
+                                                                   ThreadPool& thread_pool, const int64_t max_tile_cells)
+{
+    assert(query_length >= 0);
+    assert(target_length >= 0);
+    assert(max_tile_cells > 0);
+
+    TaskGroup tasks(thread_pool);
+    HirschbergMyers hirschberg(query, query_length, target, target_length, tasks, thread_pool.number_of_threads(), max_tile_cells);
+    tasks.run([&hirschberg, query_length, target_length]() { hirschberg.align(0, query_length, 0, target_length); });
+    tasks.wait();
+    return hirschberg.get_alignment();
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,84 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// \brief Computes an optimal global alignment on the CPU using Myers' bit-parallel algorithm followed by a traceback
+///
+/// The vertical difference bit-vectors of all columns are kept for the traceback,
+/// i.e. memory usage is O(query_length * target_length / 64).
+/// Only characters from the alphabet [ACGT] are guaranteed to provide correct results, all other characters are treated as mismatches.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \return sequence of AlignmentStates from the beginning to the end of both sequences
+std::vector<AlignmentState> myers_compute_alignment_cpu(const char* query, int32_t query_length, const char* target, int32_t target_length);
+
+/// \brief Computes an optimal semi-global alignment on the CPU using Myers' bit-parallel algorithm followed by a traceback
+///
+/// The query is aligned end-to-end to the substring of the target with the smallest edit distance,
+/// i.e. gaps before and after the aligned part of the target are free.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param aligned_interval output, aligned intervals of query (always the full query) and target
+/// \return sequence of AlignmentStates of the aligned intervals
+std::vector<AlignmentState> myers_compute_semi_global_alignment_cpu(const char* query, int32_t query_length, const char* target, int32_t target_length, AlignedInterval& aligned_interval);
+
+/// \brief Computes an optimal global alignment with unit costs on the CPU using Hirschberg's divide and conquer with Myers' bit-parallel algorithm
+///
+/// Each split computes the last rows of the upper half of the query and of the reversed lower half with Myers' algorithm,
+/// the two subproblems on both sides of the minimum are then spawned as tasks of thread_pool. The last rows of large
+/// subproblems are computed by a wavefront of tiles in parallel as well, so that a single long alignment keeps all threads busy
+/// from the first split on. Subproblems of at most max_tile_cells cells are aligned by myers_compute_alignment_cpu.
+/// Memory usage is O(max_tile_cells / 64) words per running tile plus, for a fixed number of threads, O(query_length + target_length).
+/// The calling thread takes part in executing the tasks, so it may be a task of thread_pool itself.
+/// Only characters from the alphabet [ACGT] are guaranteed to provide correct results, all other characters are treated as mismatches.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param thread_pool Pool to run the tasks on
+/// \param max_tile_cells Maximum number of cells of the subproblems aligned with a full Myers matrix, has to be positive
+/// \return sequence of AlignmentStates from the beginning to the end of both sequences
+std::vector<AlignmentState> hirschberg_myers_compute_alignment_cpu(const char* query, int32_t query_length, const char* target, int32_t target_length,
+                                                                   ThreadPool& thread_pool, int64_t max_tile_cells = 1 << 22);
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
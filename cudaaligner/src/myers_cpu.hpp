@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <claraparabricks/genomeworks/utils/mathutils.hpp>
 #include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
 
 #include <cassert>
@@ -765,6 +765,7 @@ __global__ void myers_banded_kernel(
     batched_device_matrices<int32_t>::device_interface* scorei,
     batched_device_matrices<WordType>::device_interface* query_patternsi,
     char const* sequences_d, int64_t const* sequence_starts_d,
+    int32_t const* sequence_ids,
     const int32_t max_bandwidth,
     const int32_t n_alignments)
 {
@@ -776,17 +777,19 @@ __global__ void myers_banded_kernel(
     const int32_t alignment_idx = blockIdx.y * blockDim.y + threadIdx.y;
     if (alignment_idx >= n_alignments)
         return;
-    const char* const query   = sequences_d + sequence_starts_d[2 * alignment_idx];
-    const char* const target  = sequences_d + sequence_starts_d[2 * alignment_idx + 1];
-    const int32_t query_size  = target - query;
-    const int32_t target_size = sequences_d + sequence_starts_d[2 * alignment_idx + 2] - target;
-    const int32_t n_words     = ceiling_divide(query_size, word_size);
-    int8_t* path              = paths_base + path_starts[alignment_idx];
+    // the matrices are indexed by alignment_idx, sequences and paths by sequence_idx
+    const int32_t sequence_idx = sequence_ids == nullptr ? alignment_idx : sequence_ids[alignment_idx];
+    const char* const query    = sequences_d + sequence_starts_d[2 * sequence_idx];
+    const char* const target   = sequences_d + sequence_starts_d[2 * sequence_idx + 1];
+    const int32_t query_size   = target - query;
+    const int32_t target_size  = sequences_d + sequence_starts_d[2 * sequence_idx + 2] - target;
+    const int32_t n_words      = ceiling_divide(query_size, word_size);
+    int8_t* path               = paths_base + path_starts[sequence_idx];
     if (max_bandwidth - 1 < abs(target_size - query_size))
     {
         if (threadIdx.x == 0)
         {
-            path_lengths[alignment_idx] = 0;
+            path_lengths[sequence_idx] = 0;
         }
         return;
     }
@@ -865,7 +868,7 @@ __global__ void myers_banded_kernel(
             band_width  = abs(band_width);
             path_length *= myers_backtrace_banded(path, pv, mv, score, diagonal_begin, diagonal_end, band_width, target_size, query_size);
         }
-        path_lengths[alignment_idx] = path_length;
+        path_lengths[sequence_idx] = path_length;
     }
 }
 
@@ -995,6 +998,7 @@ void myers_banded_gpu(int8_t* paths_d, int32_t* path_lengths_d, int64_t const* p
                       char const* sequences_d,
                       int64_t const* sequence_starts_d,
                       int32_t n_alignments,
+                      int32_t const* sequence_ids_d,
                       int32_t max_bandwidth,
                       batched_device_matrices<myers::WordType>& pv,
                       batched_device_matrices<myers::WordType>& mv,
@@ -1006,7 +1010,7 @@ void myers_banded_gpu(int8_t* paths_d, int32_t* path_lengths_d, int64_t const* p
     const dim3 blocks(1, ceiling_divide<int32_t>(n_alignments, threads.y), 1);
     myers::myers_banded_kernel<<<blocks, threads, 0, stream>>>(paths_d, path_lengths_d, path_starts_d,
                                                                pv.get_device_interface(), mv.get_device_interface(), score.get_device_interface(), query_patterns.get_device_interface(),
-                                                               sequences_d, sequence_starts_d, max_bandwidth, n_alignments);
+                                                               sequences_d, sequence_starts_d, sequence_ids_d, max_bandwidth, n_alignments);
 }
 
 } // namespace cudaaligner
@@ -50,10 +50,16 @@ void myers_gpu(int8_t* paths_d, int32_t* path_lengths_d, int32_t max_path_length
                batched_device_matrices<myers::WordType>& query_patterns,
                cudaStream_t stream);
 
+/// \brief Computes banded global alignments with Myers' algorithm on the GPU
+///
+/// Alignment k uses the k-th matrices of pv, mv, score and query_patterns. Its sequences, path and path length
+/// are the ones of alignment sequence_ids_d[k], or of alignment k if sequence_ids_d is nullptr.
+/// This allows to realign a subset of the alignments without moving their sequences and paths.
 void myers_banded_gpu(int8_t* paths_d, int32_t* path_lengths_d, int64_t const* path_starts_d,
                       char const* sequences_d,
                       int64_t const* sequence_starts_d,
                       int32_t n_alignments,
+                      int32_t const* sequence_ids_d,
                       int32_t max_bandwidth,
                       batched_device_matrices<myers::WordType>& pv,
                       batched_device_matrices<myers::WordType>& mv,
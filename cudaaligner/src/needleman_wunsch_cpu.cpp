@@ -15,13 +15,18 @@
 */
 
 #include "needleman_wunsch_cpu.hpp"
+#include "simd_cpu.hpp"
 
 #include <claraparabricks/genomeworks/cudaaligner/cudaaligner.hpp>
 #include <claraparabricks/genomeworks/utils/mathutils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
 
 #include <tuple>
 #include <cassert>
+#include <cstring>
 #include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 namespace claraparabricks
 {
@@ -32,6 +37,299 @@ namespace genomeworks
 namespace cudaaligner
 {
 
+namespace
+{
+
+// padding of the sequence copies for full-width vector loads, at least the largest number of lanes
+constexpr int32_t sequence_padding = 32;
+
+// parts of the alignment with at most this many cells are aligned with a full score matrix
+constexpr int64_t max_full_matrix_cells = 1 << 16;
+
+/// LastRowProblem - pair of sequences whose last row of the score matrix should be computed, the sequences are not owned
+struct LastRowProblem
+{
+    const char* reversed_query; // reversed_query[k] is the (query_length - 1 - k)-th base of the query
+    const char* target;
+    int32_t query_length;
+    int32_t target_length;
+};
+
+GW_CUDAALIGNER_BEGIN_SIMD_KERNELS
+
+/// ScoreVectorTypes - GCC vector types of NumberOfLanes scores and of NumberOfLanes bytes
+template <typename Score, int32_t NumberOfLanes>
+struct ScoreVectorTypes
+{
+    typedef Score vector_t __attribute__((vector_size(sizeof(Score) * NumberOfLanes)));
+    typedef int8_t byte_vector_t __attribute__((vector_size(NumberOfLanes)));
+};
+
+/// \brief computes H(query_length, j) for all columns j processing NumberOfLanes cells of an anti-diagonal at once
+///
+/// Query bases are rows i, target bases columns j. H(i,j) of anti-diagonal r = i + j depends on H(i-1,j) and H(i,j-1)
+/// of anti-diagonal r-1 and on H(i-1,j-1) of anti-diagonal r-2, the arrays are indexed by column.
+/// Scores have to fit into Score, i.e. query_length + target_length must not exceed its maximum.
+template <typename Score, int32_t NumberOfLanes>
+__attribute__((always_inline)) inline void needleman_wunsch_compute_last_row_lanes(const LastRowProblem& problem, std::vector<int32_t>& last_row)
+{
+    using vector_t      = typename ScoreVectorTypes<Score, NumberOfLanes>::vector_t;
+    using byte_vector_t = typename ScoreVectorTypes<Score, NumberOfLanes>::byte_vector_t;
+
+    const int32_t m    = problem.query_length;
+    const int32_t n    = problem.target_length;
+    const vector_t one = vector_t{} + 1;
+
+    last_row.resize(n + 1);
+    if (m == 0)
+    {
+        for (int32_t j = 0; j <= n; ++j)
+        {
+            last_row[j] = j;
+        }
+        return;
+    }
+
+    const int32_t array_size        = n + 1 + NumberOfLanes;
+    std::vector<Score> diagonals[3] = {std::vector<Score>(array_size, 0), std::vector<Score>(array_size, 0), std::vector<Score>(array_size, 0)};
+    for (int32_t r = 1; r <= m + n; ++r)
+    {
+        Score* const current         = diagonals[r % 3].data();
+        const Score* const previous  = diagonals[(r + 2) % 3].data();
+        const Score* const previous2 = diagonals[(r + 1) % 3].data();
+        const int32_t first_column   = std::max(1, r - m);
+        const int32_t last_column    = std::min(n, r - 1);
+        for (int32_t j = first_column; j <= last_column; j += NumberOfLanes)
+        {
+            vector_t above, left, diagonal;
+            byte_vector_t query_bases, target_bases;
+            std::memcpy(&above, previous + j, sizeof(vector_t));
+            std::memcpy(&left, previous + j - 1, sizeof(vector_t));
+            std::memcpy(&diagonal, previous2 + j - 1, sizeof(vector_t));
+            std::memcpy(&query_bases, problem.reversed_query + m - r + j, sizeof(byte_vector_t));
+            std::memcpy(&target_bases, problem.target + j - 1, sizeof(byte_vector_t));
+
+            // lanes of equal bases are -1
+            const byte_vector_t equal_bases = query_bases == target_bases;
+            const vector_t is_match         = __builtin_convertvector(equal_bases, vector_t);
+            const vector_t substitution     = diagonal + one + is_match;
+            const vector_t gap              = (above < left ? above : left) + one;
+            const vector_t h                = gap < substitution ? gap : substitution;
+            std::memcpy(current + j, &h, sizeof(vector_t));
+        }
+        // the border cells are written last, the vector stores above may have overwritten them
+        if (r <= n)
+        {
+            current[r] = r;
+        }
+        if (r <= m)
+        {
+            current[0] = r;
+        }
+        if (r >= m)
+        {
+            last_row[r - m] = current[r - m];
+        }
+    }
+}
+
+GW_CUDAALIGNER_END_SIMD_KERNELS
+
+bool fits_int16_scores(const LastRowProblem& problem)
+{
+    return static_cast<int64_t>(problem.query_length) + problem.target_length < std::numeric_limits<int16_t>::max();
+}
+
+void needleman_wunsch_compute_last_row_baseline(const LastRowProblem& problem, std::vector<int32_t>& last_row)
+{
+    if (fits_int16_scores(problem))
+    {
+        needleman_wunsch_compute_last_row_lanes<int16_t, 8>(problem, last_row);
+    }
+    else
+    {
+        needleman_wunsch_compute_last_row_lanes<int32_t, 4>(problem, last_row);
+    }
+}
+
+#ifdef GW_CUDAALIGNER_X86_SIMD
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+void needleman_wunsch_compute_last_row_avx2(const LastRowProblem& problem, std::vector<int32_t>& last_row)
+{
+    if (fits_int16_scores(problem))
+    {
+        needleman_wunsch_compute_last_row_lanes<int16_t, 16>(problem, last_row);
+    }
+    else
+    {
+        needleman_wunsch_compute_last_row_lanes<int32_t, 8>(problem, last_row);
+    }
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512bw")
+
+void needleman_wunsch_compute_last_row_avx512(const LastRowProblem& problem, std::vector<int32_t>& last_row)
+{
+    if (fits_int16_scores(problem))
+    {
+        needleman_wunsch_compute_last_row_lanes<int16_t, 32>(problem, last_row);
+    }
+    else
+    {
+        needleman_wunsch_compute_last_row_lanes<int32_t, 16>(problem, last_row);
+    }
+}
+
+#pragma GCC pop_options
+#endif
+
+using LastRowFunction = void (*)(const LastRowProblem&, std::vector<int32_t>&);
+
+LastRowFunction get_last_row_function(const InstructionSet instruction_set)
+{
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        throw std::invalid_argument("Requested instruction set is not supported on this machine.");
+    }
+    switch (instruction_set)
+    {
+#ifdef GW_CUDAALIGNER_X86_SIMD
+    case InstructionSet::avx512:
+        return __builtin_cpu_supports("avx512bw") ? needleman_wunsch_compute_last_row_avx512 : needleman_wunsch_compute_last_row_avx2;
+    case InstructionSet::avx2: return needleman_wunsch_compute_last_row_avx2;
+#endif
+    default: return needleman_wunsch_compute_last_row_baseline;
+    }
+}
+
+/// NeedlemanWunschSequences - forward and reversed copies of query and target, padded for full-width vector loads
+struct NeedlemanWunschSequences
+{
+    NeedlemanWunschSequences(const char* query, const int32_t query_length, const char* target, const int32_t target_length)
+        : query(query, query + query_length)
+        , reversed_query(query_length + sequence_padding, '\0')
+        , target(target, target + target_length)
+        , reversed_target(target_length + sequence_padding, '\0')
+    {
+        this->query.resize(query_length + sequence_padding, '\0');
+        this->target.resize(target_length + sequence_padding, '\0');
+        std::reverse_copy(query, query + query_length, begin(reversed_query));
+        std::reverse_copy(target, target + target_length, begin(reversed_target));
+    }
+
+    std::vector<char> query;
+    std::vector<char> reversed_query;
+    std::vector<char> target;
+    std::vector<char> reversed_target;
+};
+
+/// \brief appends an optimal alignment of query and target to path using a full score matrix
+void needleman_wunsch_align_full_matrix(const char* query, const int32_t query_length, const char* target, const int32_t target_length,
+                                        std::vector<int32_t>& scores, std::vector<AlignmentState>& path)
+{
+    const int32_t columns = target_length + 1;
+    scores.resize(static_cast<int64_t>(query_length + 1) * columns);
+    for (int32_t j = 0; j <= target_length; ++j)
+    {
+        scores[j] = j;
+    }
+    for (int32_t i = 1; i <= query_length; ++i)
+    {
+        int32_t* const row                = scores.data() + static_cast<int64_t>(i) * columns;
+        const int32_t* const previous_row = row - columns;
+        row[0]                            = i;
+        for (int32_t j = 1; j <= target_length; ++j)
+        {
+            row[j] = std::min({previous_row[j] + 1, row[j - 1] + 1, previous_row[j - 1] + (query[i - 1] == target[j - 1] ? 0 : 1)});
+        }
+    }
+
+    const int64_t path_begin = get_size<int64_t>(path);
+    int32_t i                = query_length;
+    int32_t j                = target_length;
+    while (i > 0 && j > 0)
+    {
+        const int32_t score         = scores[static_cast<int64_t>(i) * columns + j];
+        const bool is_match         = query[i - 1] == target[j - 1];
+        const int32_t diagonal_cost = scores[static_cast<int64_t>(i - 1) * columns + j - 1] + (is_match ? 0 : 1);
+        if (score == diagonal_cost)
+        {
+            path.push_back(is_match ? AlignmentState::match : AlignmentState::mismatch);
+            --i;
+            --j;
+        }
+        else if (score == scores[static_cast<int64_t>(i - 1) * columns + j] + 1)
+        {
+            path.push_back(AlignmentState::deletion);
+            --i;
+        }
+        else
+        {
+            path.push_back(AlignmentState::insertion);
+            --j;
+        }
+    }
+    path.insert(end(path), i, AlignmentState::deletion);
+    path.insert(end(path), j, AlignmentState::insertion);
+    std::reverse(begin(path) + path_begin, end(path));
+}
+
+/// NeedlemanWunschHirschberg - buffers of the recursion, reused by all parts of one alignment
+struct NeedlemanWunschHirschberg
+{
+    const NeedlemanWunschSequences& sequences;
+    LastRowFunction compute_last_row;
+    std::vector<int32_t> forward_row;
+    std::vector<int32_t> backward_row;
+    std::vector<int32_t> full_matrix;
+};
+
+/// \brief appends an optimal alignment of query[query_begin, query_end) and target[target_begin, target_end) to path
+void needleman_wunsch_align_hirschberg(NeedlemanWunschHirschberg& hirschberg,
+                                       const int32_t query_begin, const int32_t query_end,
+                                       const int32_t target_begin, const int32_t target_end,
+                                       std::vector<AlignmentState>& path)
+{
+    const NeedlemanWunschSequences& sequences = hirschberg.sequences;
+    const int32_t query_length                = get_size<int32_t>(sequences.query) - sequence_padding;
+    const int32_t target_length               = get_size<int32_t>(sequences.target) - sequence_padding;
+    const int32_t m                           = query_end - query_begin;
+    const int32_t n                           = target_end - target_begin;
+    if (m <= 1 || n == 0 || static_cast<int64_t>(m + 1) * (n + 1) <= max_full_matrix_cells)
+    {
+        needleman_wunsch_align_full_matrix(sequences.query.data() + query_begin, m, sequences.target.data() + target_begin, n, hirschberg.full_matrix, path);
+        return;
+    }
+
+    // forward_row[j]: cost of aligning the upper half of the query with the first j bases of the target,
+    // backward_row[k]: cost of aligning the lower half of the query with the last k bases of the target
+    const int32_t query_split = query_begin + m / 2;
+    hirschberg.compute_last_row({sequences.reversed_query.data() + query_length - query_split, sequences.target.data() + target_begin, query_split - query_begin, n}, hirschberg.forward_row);
+    hirschberg.compute_last_row({sequences.query.data() + query_split, sequences.reversed_target.data() + target_length - target_end, query_end - query_split, n}, hirschberg.backward_row);
+
+    int32_t target_split = 0;
+    int32_t best_cost    = std::numeric_limits<int32_t>::max();
+    for (int32_t j = 0; j <= n; ++j)
+    {
+        const int32_t cost = hirschberg.forward_row[j] + hirschberg.backward_row[n - j];
+        if (cost < best_cost)
+        {
+            best_cost    = cost;
+            target_split = j;
+        }
+    }
+
+    needleman_wunsch_align_hirschberg(hirschberg, query_begin, query_split, target_begin, target_begin + target_split, path);
+    needleman_wunsch_align_hirschberg(hirschberg, query_split, query_end, target_begin + target_split, target_end, path);
+}
+
+} // namespace
+
 int find_alignment_position(matrix<int> const& scores)
 {
     int const last_i = scores.num_rows() - 1;
@@ -136,51 +434,40 @@ matrix<int> needleman_wunsch_build_score_matrix_naive(std::string const& text, s
     return scores;
 }
 
-matrix<int> needleman_wunsch_build_score_matrix_diagonal(std::string const& text, std::string const& query)
+std::vector<int8_t> needleman_wunsch_cpu(std::string const& text, std::string const& query)
 {
-    int const query_size = query.size() + 1;
-    int const text_size  = text.size() + 1;
-    assert(query_size <= text_size);
-    matrix<int> scores(query_size, text_size);
-
-    for (int i = 0; i < query_size; ++i)
-        scores(i, 0) = i;
-    for (int j = 0; j < text_size; ++j)
-        scores(0, j) = j;
+    matrix<int> scores = needleman_wunsch_build_score_matrix_naive(text, query);
+    return std::get<1>(needleman_wunsch_backtrace_old(scores));
+}
 
-    for (int k = 1; k < query_size; ++k)
-    {
-        int const jmax = std::min(k, text_size);
-        for (int j = 1; j < jmax; ++j)
-        {
-            int const i  = k - j;
-            scores(i, j) = min3(
-                scores(i - 1, j) + 1,
-                scores(i, j - 1) + 1,
-                scores(i - 1, j - 1) + (query[i - 1] == text[j - 1] ? 0 : 1));
-        }
-    }
+int32_t needleman_wunsch_compute_edit_distance_cpu(const char* query, const int32_t query_length,
+                                                   const char* target, const int32_t target_length,
+                                                   const InstructionSet instruction_set)
+{
+    throw_on_negative(query_length, "query_length must be non-negative.");
+    throw_on_negative(target_length, "target_length must be non-negative.");
+    const LastRowFunction compute_last_row = get_last_row_function(instruction_set);
 
-    for (int l = 1; l < text_size; ++l)
-    {
-        int const imax = std::min(text_size - l, query_size - 1);
-        for (int k = 0; k < imax; ++k)
-        {
-            int const i  = query_size - k - 1;
-            int const j  = l + k;
-            scores(i, j) = min3(
-                scores(i - 1, j) + 1,
-                scores(i, j - 1) + 1,
-                scores(i - 1, j - 1) + (query[i - 1] == text[j - 1] ? 0 : 1));
-        }
-    }
-    return scores;
+    const NeedlemanWunschSequences sequences(query, query_length, target, target_length);
+    std::vector<int32_t> last_row;
+    compute_last_row({sequences.reversed_query.data(), sequences.target.data(), query_length, target_length}, last_row);
+    return last_row[target_length];
 }
 
-std::vector<int8_t> needleman_wunsch_cpu(std::string const& text, std::string const& query)
+std::vector<AlignmentState> needleman_wunsch_compute_alignment_cpu(const char* query, const int32_t query_length,
+                                                                   const char* target, const int32_t target_length,
+                                                                   const InstructionSet instruction_set)
 {
-    matrix<int> scores = needleman_wunsch_build_score_matrix_naive(text, query);
-    return std::get<1>(needleman_wunsch_backtrace_old(scores));
+    throw_on_negative(query_length, "query_length must be non-negative.");
+    throw_on_negative(target_length, "target_length must be non-negative.");
+    const LastRowFunction compute_last_row = get_last_row_function(instruction_set);
+
+    const NeedlemanWunschSequences sequences(query, query_length, target, target_length);
+    NeedlemanWunschHirschberg hirschberg{sequences, compute_last_row, {}, {}, {}};
+    std::vector<AlignmentState> path;
+    path.reserve(query_length + target_length);
+    needleman_wunsch_align_hirschberg(hirschberg, 0, query_length, 0, target_length, path);
+    return path;
 }
 
 } // namespace cudaaligner
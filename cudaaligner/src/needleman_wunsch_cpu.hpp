@@ -17,6 +17,9 @@
 #pragma once
 
 #include "matrix_cpu.hpp"
+#include "edit_distance_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/cudaaligner.hpp>
 
 #include <vector>
 #include <string>
@@ -34,6 +37,41 @@ matrix<int> needleman_wunsch_build_score_matrix_naive(std::string const& text, s
 
 std::vector<int8_t> needleman_wunsch_cpu(std::string const& text, std::string const& query);
 
+/// \brief Computes the global edit distance of two sequences on the CPU with an anti-diagonal Needleman-Wunsch kernel
+///
+/// The cells of one anti-diagonal do not depend on each other and are processed in SIMD lanes, using 16-bit scores
+/// if the sum of the sequence lengths fits and 32-bit scores otherwise. Only the last three anti-diagonals are kept.
+/// Identical characters match, all others are mismatches.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param instruction_set instruction set to use, throws if it is not supported on this machine
+/// \return edit distance
+/// \throw std::invalid_argument if instruction_set is not supported
+int32_t needleman_wunsch_compute_edit_distance_cpu(const char* query, int32_t query_length,
+                                                   const char* target, int32_t target_length,
+                                                   InstructionSet instruction_set = get_best_supported_instruction_set());
+
+/// \brief Computes an optimal global alignment with unit costs on the CPU in memory linear in the sequence lengths
+///
+/// Uses Hirschberg's divide and conquer: the last rows of the score matrices of the upper half of the query and of the
+/// reversed lower half are computed with the anti-diagonal kernel of needleman_wunsch_compute_edit_distance_cpu,
+/// the alignment is split where their sum is minimal and both parts are aligned recursively. Parts with up to
+/// 64k cells are aligned with a full score matrix and a traceback.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param instruction_set instruction set to use, throws if it is not supported on this machine
+/// \return sequence of AlignmentStates
+/// \throw std::invalid_argument if instruction_set is not supported
+std::vector<AlignmentState> needleman_wunsch_compute_alignment_cpu(const char* query, int32_t query_length,
+                                                                   const char* target, int32_t target_length,
+                                                                   InstructionSet instruction_set = get_best_supported_instruction_set());
+
 } // namespace cudaaligner
 
 } // namespace genomeworks
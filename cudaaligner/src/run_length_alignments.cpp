@@ -0,0 +1,125 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <claraparabricks/genomeworks/cudaaligner/run_length_alignments.hpp>
+
+#include <algorithm>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+char alignment_state_to_extended_cigar_state(const AlignmentState s)
+{
+    switch (s)
+    {
+    case AlignmentState::match: return '=';
+    case AlignmentState::mismatch: return 'X';
+    case AlignmentState::insertion: return 'I';
+    default: return 'D';
+    }
+}
+
+char alignment_state_to_cigar_state(const AlignmentState s)
+{
+    return s == AlignmentState::match || s == AlignmentState::mismatch ? 'M' : alignment_state_to_extended_cigar_state(s);
+}
+
+/// \brief emits the runs of [first, last) in CIGAR format, merging consecutive runs with the same CIGAR state
+template <typename ToCigarState>
+std::string runs_to_cigar(const uint32_t* first, const uint32_t* const last, ToCigarState to_cigar_state)
+{
+    std::string cigar;
+    while (first != last)
+    {
+        const char cigar_state = to_cigar_state(RunLengthAlignments::get_run_state(*first));
+        int64_t length         = 0;
+        for (; first != last && to_cigar_state(RunLengthAlignments::get_run_state(*first)) == cigar_state; ++first)
+        {
+            length += RunLengthAlignments::get_run_length(*first);
+        }
+        cigar += std::to_string(length);
+        cigar += cigar_state;
+    }
+    return cigar;
+}
+
+} // namespace
+
+std::vector<AlignmentState> RunLengthAlignments::get_alignment(const int32_t i) const
+{
+    std::vector<AlignmentState> alignment;
+    for (const uint32_t* run = runs_begin(i); run != runs_end(i); ++run)
+    {
+        alignment.insert(alignment.end(), get_run_length(*run), get_run_state(*run));
+    }
+    return alignment;
+}
+
+int32_t RunLengthAlignments::get_edit_distance(const int32_t i) const
+{
+    int32_t edit_distance = 0;
+    for (const uint32_t* run = runs_begin(i); run != runs_end(i); ++run)
+    {
+        if (get_run_state(*run) != AlignmentState::match)
+        {
+            edit_distance += get_run_length(*run);
+        }
+    }
+    return edit_distance;
+}
+
+std::string RunLengthAlignments::convert_to_cigar(const int32_t i) const
+{
+    return runs_to_cigar(runs_begin(i), runs_end(i), alignment_state_to_cigar_state);
+}
+
+std::string RunLengthAlignments::convert_to_extended_cigar(const int32_t i) const
+{
+    return runs_to_cigar(runs_begin(i), runs_end(i), alignment_state_to_extended_cigar_state);
+}
+
+void RunLengthAlignments::add_empty_alignment(const StatusType status)
+{
+    run_offsets_.push_back(static_cast<int64_t>(runs_.size()));
+    statuses_.push_back(status);
+    optimal_.push_back(0);
+    intervals_.push_back(AlignedInterval{0, 0, 0, 0});
+}
+
+void RunLengthAlignments::clear()
+{
+    runs_.clear();
+    run_offsets_.resize(1);
+    statuses_.clear();
+    optimal_.clear();
+    intervals_.clear();
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,33 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+// SIMD kernels are compiled for their instruction sets using target pragmas and selected at runtime,
+// so the library does not require the CPU it is built on to support them
+#if defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__)
+#define GW_CUDAALIGNER_X86_SIMD
+#endif
+
+#ifdef GW_CUDAALIGNER_X86_SIMD
+// the generic kernels are always inlined into functions compiled for the lanes' instruction set,
+// so no call with a vector ABI that differs between instruction sets is ever generated
+#define GW_CUDAALIGNER_BEGIN_SIMD_KERNELS _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wpsabi\"")
+#define GW_CUDAALIGNER_END_SIMD_KERNELS _Pragma("GCC diagnostic pop")
+#else
+#define GW_CUDAALIGNER_BEGIN_SIMD_KERNELS
+#define GW_CUDAALIGNER_END_SIMD_KERNELS
+#endif
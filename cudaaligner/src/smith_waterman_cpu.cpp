@@ -0,0 +1,362 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "smith_waterman_cpu.hpp"
+#include "simd_cpu.hpp"
+#include "affine_gap_alignment_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/mathutils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+/// SmithWatermanProblem - pair of sequences to score locally, the sequences are not owned
+struct SmithWatermanProblem
+{
+    const char* query;
+    const char* target;
+    int32_t query_length;
+    int32_t target_length;
+    int32_t match;
+    int32_t mismatch;
+    int32_t gap_first;  // penalty of the first base of a gap, positive or zero
+    int32_t gap_extend; // penalty of every further base of a gap, positive or zero
+};
+
+GW_CUDAALIGNER_BEGIN_SIMD_KERNELS
+
+/// StripedVectorType - GCC vector type of NumberOfLanes scores
+template <typename Score, int32_t NumberOfLanes>
+struct StripedVectorType
+{
+    typedef Score type __attribute__((vector_size(sizeof(Score) * NumberOfLanes)));
+};
+
+/// \brief moves every score one lane up, lane 0 becomes lane 0 of fill
+template <typename Vector, int32_t... Lanes>
+__attribute__((always_inline)) inline void shift_lanes_up(Vector& v, const Vector& fill, std::integer_sequence<int32_t, Lanes...>)
+{
+    // indices from sizeof...(Lanes) on select lanes of fill
+    v = __builtin_shuffle(v, fill, Vector{(Lanes == 0 ? static_cast<int32_t>(sizeof...(Lanes)) : Lanes - 1)...});
+}
+
+template <typename Vector>
+__attribute__((always_inline)) inline bool any_lane_greater(const Vector& a, const Vector& b)
+{
+    const Vector greater = a > b;
+    uint64_t words[sizeof(Vector) / sizeof(uint64_t)];
+    std::memcpy(words, &greater, sizeof(Vector));
+    uint64_t any = 0;
+    for (const uint64_t word : words)
+    {
+        any |= word;
+    }
+    return any != 0;
+}
+
+/// \brief computes the best local alignment score processing the query in NumberOfLanes stripes
+///
+/// Scores have to fit into Score, i.e. the largest possible score must stay well below its maximum.
+/// h_*, e and the query profiles hold segment_length vectors, vector s of h_* the scores of the column in the striped order.
+template <typename Score, int32_t NumberOfLanes>
+__attribute__((always_inline)) inline LocalAlignmentScore smith_waterman_striped_lanes(const SmithWatermanProblem& problem)
+{
+    using vector_t = typename StripedVectorType<Score, NumberOfLanes>::type;
+
+    const int32_t m          = problem.query_length;
+    const int32_t n          = problem.target_length;
+    LocalAlignmentScore best = {0, 0, 0};
+    if (m == 0 || n == 0)
+    {
+        return best;
+    }
+
+    const int32_t segment_length         = ceiling_divide(m, NumberOfLanes);
+    const int64_t column_size            = static_cast<int64_t>(segment_length) * NumberOfLanes;
+    const Score minus_infinity           = std::numeric_limits<Score>::min() / 2;
+    const vector_t zero                  = vector_t{};
+    const vector_t minus_infinity_vector = zero + minus_infinity;
+    const vector_t gap_first             = zero + static_cast<Score>(problem.gap_first);
+    const vector_t gap_extend            = zero + static_cast<Score>(problem.gap_extend);
+    const auto lanes                     = std::make_integer_sequence<int32_t, NumberOfLanes>();
+    vector_t best_score                  = zero;
+
+    // query profiles are built on first use of a target character, query positions past the end never score
+    std::array<int32_t, 256> profile_index;
+    profile_index.fill(-1);
+    std::vector<Score> profiles;
+    std::vector<Score> h_previous(column_size, 0);
+    std::vector<Score> h_current(column_size, 0);
+    std::vector<Score> e(column_size, 0);
+
+    for (int32_t j = 0; j < n; ++j)
+    {
+        const unsigned char target_base = static_cast<unsigned char>(problem.target[j]);
+        if (profile_index[target_base] < 0)
+        {
+            profile_index[target_base] = static_cast<int32_t>(get_size<int64_t>(profiles) / column_size);
+            profiles.resize(profiles.size() + column_size);
+            Score* const profile = profiles.data() + profile_index[target_base] * column_size;
+            for (int32_t s = 0; s < segment_length; ++s)
+            {
+                for (int32_t k = 0; k < NumberOfLanes; ++k)
+                {
+                    const int32_t i                = k * segment_length + s;
+                    const bool is_match            = i < m && static_cast<unsigned char>(problem.query[i]) == target_base;
+                    profile[s * NumberOfLanes + k] = i < m ? static_cast<Score>(is_match ? problem.match : problem.mismatch) : minus_infinity;
+                }
+            }
+        }
+        const Score* const profile = profiles.data() + profile_index[target_base] * column_size;
+
+        std::swap(h_previous, h_current);
+        Score* const h_column       = h_current.data();
+        const Score* const h_before = h_previous.data();
+        vector_t column_max         = zero;
+        vector_t f                  = minus_infinity_vector;
+        // diagonal predecessor of vector s is vector s - 1 of the previous column, the last vector shifted for s = 0
+        vector_t h;
+        std::memcpy(&h, h_before + column_size - NumberOfLanes, sizeof(vector_t));
+        shift_lanes_up(h, zero, lanes);
+        for (int32_t s = 0; s < segment_length; ++s)
+        {
+            vector_t e_s, score;
+            std::memcpy(&e_s, e.data() + s * NumberOfLanes, sizeof(vector_t));
+            std::memcpy(&score, profile + s * NumberOfLanes, sizeof(vector_t));
+            h          = h + score;
+            h          = h > e_s ? h : e_s;
+            h          = h > f ? h : f;
+            h          = h > zero ? h : zero;
+            column_max = column_max > h ? column_max : h;
+            std::memcpy(h_column + s * NumberOfLanes, &h, sizeof(vector_t));
+
+            const vector_t h_gap = h - gap_first;
+            e_s                  = e_s - gap_extend;
+            e_s                  = e_s > h_gap ? e_s : h_gap;
+            f                    = f - gap_extend;
+            f                    = f > h_gap ? f : h_gap;
+            std::memcpy(e.data() + s * NumberOfLanes, &e_s, sizeof(vector_t));
+            std::memcpy(&h, h_before + s * NumberOfLanes, sizeof(vector_t));
+        }
+
+        // Vertical gaps crossing from the last query base of a lane into the next lane. Within a lane the gap
+        // continuing from above only extends, reopening it is never better, so the gap entering lane k + 1 is the
+        // better one of the gap ending lane k and the gap entering lane k extended over the whole lane. Farrar's
+        // correction loop, which shifts the gaps by one lane per pass, can take as many passes as there are lanes
+        // for high-scoring alignments, with exact entering gaps a single pass suffices.
+        vector_t f_entering = minus_infinity_vector;
+        int64_t entering    = minus_infinity;
+        for (int32_t k = 1; k < NumberOfLanes; ++k)
+        {
+            entering      = std::max<int64_t>({f[k - 1], entering - static_cast<int64_t>(segment_length) * problem.gap_extend, minus_infinity});
+            f_entering[k] = static_cast<Score>(entering);
+        }
+        for (int32_t s = 0; s < segment_length; ++s)
+        {
+            vector_t h_s, e_s;
+            std::memcpy(&h_s, h_column + s * NumberOfLanes, sizeof(vector_t));
+            const vector_t h_gap = h_s - gap_first;
+            if (!any_lane_greater(f_entering, h_gap))
+            {
+                break;
+            }
+            h_s        = h_s > f_entering ? h_s : f_entering;
+            column_max = column_max > h_s ? column_max : h_s;
+            std::memcpy(h_column + s * NumberOfLanes, &h_s, sizeof(vector_t));
+            std::memcpy(&e_s, e.data() + s * NumberOfLanes, sizeof(vector_t));
+            const vector_t e_gap = h_s - gap_first;
+            e_s                  = e_s > e_gap ? e_s : e_gap;
+            std::memcpy(e.data() + s * NumberOfLanes, &e_s, sizeof(vector_t));
+            // lanes without a gap stay at minus_infinity instead of overflowing
+            f_entering = f_entering - gap_extend;
+            f_entering = f_entering > minus_infinity_vector ? f_entering : minus_infinity_vector;
+        }
+
+        if (any_lane_greater(column_max, best_score))
+        {
+            Score column_best = 0;
+            for (int32_t k = 0; k < NumberOfLanes; ++k)
+            {
+                column_best = std::max(column_best, column_max[k]);
+            }
+            // the first query base of the column reaching the score, lanes hold consecutive parts of the query
+            int32_t k = 0;
+            while (column_max[k] != column_best)
+            {
+                ++k;
+            }
+            int32_t s = 0;
+            while (h_column[s * NumberOfLanes + k] != column_best)
+            {
+                ++s;
+            }
+            best       = {column_best, k * segment_length + s + 1, j + 1};
+            best_score = zero + column_best;
+        }
+    }
+    return best;
+}
+
+GW_CUDAALIGNER_END_SIMD_KERNELS
+
+bool fits_int16_scores(const SmithWatermanProblem& problem)
+{
+    // no cell exceeds the score of matching the shorter sequence entirely, the rest is headroom for the gap penalties
+    return static_cast<int64_t>(std::max(problem.match, 0)) * std::min(problem.query_length, problem.target_length) < std::numeric_limits<int16_t>::max() / 2;
+}
+
+LocalAlignmentScore smith_waterman_compute_score_baseline(const SmithWatermanProblem& problem)
+{
+    if (fits_int16_scores(problem))
+    {
+        return smith_waterman_striped_lanes<int16_t, 8>(problem);
+    }
+    return smith_waterman_striped_lanes<int32_t, 4>(problem);
+}
+
+#ifdef GW_CUDAALIGNER_X86_SIMD
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+LocalAlignmentScore smith_waterman_compute_score_avx2(const SmithWatermanProblem& problem)
+{
+    if (fits_int16_scores(problem))
+    {
+        return smith_waterman_striped_lanes<int16_t, 16>(problem);
+    }
+    return smith_waterman_striped_lanes<int32_t, 8>(problem);
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512bw")
+
+LocalAlignmentScore smith_waterman_compute_score_avx512(const SmithWatermanProblem& problem)
+{
+    if (fits_int16_scores(problem))
+    {
+        return smith_waterman_striped_lanes<int16_t, 32>(problem);
+    }
+    return smith_waterman_striped_lanes<int32_t, 16>(problem);
+}
+
+#pragma GCC pop_options
+#endif
+
+using ScoreFunction = LocalAlignmentScore (*)(const SmithWatermanProblem&);
+
+ScoreFunction get_score_function(const InstructionSet instruction_set)
+{
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        throw std::invalid_argument("Requested instruction set is not supported on this machine.");
+    }
+    switch (instruction_set)
+    {
+#ifdef GW_CUDAALIGNER_X86_SIMD
+    case InstructionSet::avx512:
+        return __builtin_cpu_supports("avx512bw") ? smith_waterman_compute_score_avx512 : smith_waterman_compute_score_avx2;
+    case InstructionSet::avx2: return smith_waterman_compute_score_avx2;
+#endif
+    default: return smith_waterman_compute_score_baseline;
+    }
+}
+
+SmithWatermanProblem make_problem(const char* query, const int32_t query_length, const char* target, const int32_t target_length, const AffineGapScores& scores)
+{
+    throw_on_negative(query_length, "query_length must be non-negative.");
+    throw_on_negative(target_length, "target_length must be non-negative.");
+    validate_affine_gap_scores(scores);
+    return {query, target, query_length, target_length, scores.match, scores.mismatch, -scores.gap_open - scores.gap_extend, -scores.gap_extend};
+}
+
+} // namespace
+
+LocalAlignmentScore smith_waterman_compute_score_cpu(const char* query, const int32_t query_length,
+                                                     const char* target, const int32_t target_length,
+                                                     const AffineGapScores& scores,
+                                                     const InstructionSet instruction_set)
+{
+    const SmithWatermanProblem problem = make_problem(query, query_length, target, target_length, scores);
+    return get_score_function(instruction_set)(problem);
+}
+
+std::vector<AlignmentState> smith_waterman_compute_alignment_cpu(const char* query, const int32_t query_length,
+                                                                 const char* target, const int32_t target_length,
+                                                                 const AffineGapScores& scores,
+                                                                 AlignedInterval& aligned_interval,
+                                                                 const InstructionSet instruction_set)
+{
+    const SmithWatermanProblem problem = make_problem(query, query_length, target, target_length, scores);
+    const ScoreFunction compute_score  = get_score_function(instruction_set);
+
+    const LocalAlignmentScore end = compute_score(problem);
+    if (end.score == 0)
+    {
+        aligned_interval = {0, 0, 0, 0};
+        return {};
+    }
+
+    // The end is the first cell reaching the best score, so every alignment with this score within the prefixes
+    // ending there ends in this cell. The best local alignment of the reversed prefixes therefore starts in their
+    // first cell, and its end is the start of an optimal alignment.
+    const std::string reversed_query(std::make_reverse_iterator(query + end.query_end), std::make_reverse_iterator(query));
+    const std::string reversed_target(std::make_reverse_iterator(target + end.target_end), std::make_reverse_iterator(target));
+    SmithWatermanProblem reversed_problem = problem;
+    reversed_problem.query                = reversed_query.data();
+    reversed_problem.target               = reversed_target.data();
+    reversed_problem.query_length         = end.query_end;
+    reversed_problem.target_length        = end.target_end;
+    const LocalAlignmentScore start       = compute_score(reversed_problem);
+    assert(start.score == end.score);
+
+    const int32_t query_start  = end.query_end - start.query_end;
+    const int32_t target_start = end.target_end - start.target_end;
+    AlignedInterval global_interval;
+    std::vector<AlignmentState> alignment = affine_gap_compute_alignment_cpu(query + query_start, end.query_end - query_start,
+                                                                             target + target_start, end.target_end - target_start,
+                                                                             scores, false, -1, global_interval, instruction_set);
+    assert(compute_affine_gap_score(alignment, scores) == end.score);
+    aligned_interval = {query_start, end.query_end, target_start, end.target_end};
+    return alignment;
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
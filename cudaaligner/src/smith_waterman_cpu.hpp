@@ -0,0 +1,84 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include "edit_distance_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+#include <claraparabricks/genomeworks/cudaaligner/local_alignment.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// \brief Computes the score of the best local alignment on the CPU
+///
+/// Uses Farrar's striped Smith-Waterman: the query is split into as many segments as there are SIMD lanes,
+/// lane k of vector s holds query base k * segment_length + s, so the cells of a column depend on the previous
+/// vector only through the vertical gaps. These are computed within the lanes first, the gaps entering each lane
+/// from the previous one afterwards, and a correction pass applies them until they cannot improve a score. Scores are 16-bit if the largest possible score fits and
+/// 32-bit otherwise (8/4 lanes for InstructionSet::scalar using the baseline 128-bit vectors, 16/8 lanes for AVX2,
+/// 32/16 lanes for AVX-512 if AVX-512BW is available). Identical characters match, all others are mismatches.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param scores Scoring scheme, see validate_affine_gap_scores
+/// \param instruction_set instruction set to use, throws if it is not supported on this machine
+/// \return score and end of the best local alignment
+/// \throw std::invalid_argument if instruction_set is not supported or scores are invalid
+LocalAlignmentScore smith_waterman_compute_score_cpu(const char* query, int32_t query_length,
+                                                     const char* target, int32_t target_length,
+                                                     const AffineGapScores& scores,
+                                                     InstructionSet instruction_set = get_best_supported_instruction_set());
+
+/// \brief Computes an optimal local alignment on the CPU
+///
+/// The end of the alignment is found by smith_waterman_compute_score_cpu, its start by the same kernel on the
+/// reversed prefixes ending there. The aligned substrings are then aligned globally with affine_gap_compute_alignment_cpu,
+/// which needs memory proportional to the product of their lengths.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param scores Scoring scheme, see validate_affine_gap_scores
+/// \param aligned_interval output, aligned intervals of query and target, empty if no pair of substrings has a positive score
+/// \param instruction_set instruction set to use, throws if it is not supported on this machine
+/// \return sequence of AlignmentStates of the aligned intervals
+/// \throw std::invalid_argument if instruction_set is not supported or scores are invalid
+std::vector<AlignmentState> smith_waterman_compute_alignment_cpu(const char* query, int32_t query_length,
+                                                                 const char* target, int32_t target_length,
+                                                                 const AffineGapScores& scores,
+                                                                 AlignedInterval& aligned_interval,
+                                                                 InstructionSet instruction_set = get_best_supported_instruction_set());
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,506 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "wavefront_alignment_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+constexpr int32_t invalid_offset = std::numeric_limits<int32_t>::min() / 2;
+
+// subproblems of the bidirectional mode with at most this many bases are aligned keeping all wavefronts
+constexpr int32_t bidirectional_base_case_length = 256;
+
+/// WavefrontComponent - the three matrices of gap-affine alignments: alignments ending with a match or mismatch (or any of the two others), with an insertion and with a deletion
+enum class WavefrontComponent
+{
+    m,
+    i,
+    d
+};
+
+/// Wavefront - furthest reaching offsets (target positions) on the diagonals k = target position - query position in [lo, hi] for one penalty
+struct Wavefront
+{
+    int32_t lo = 0;
+    int32_t hi = -1;
+    std::vector<int32_t> m;
+    std::vector<int32_t> i;
+    std::vector<int32_t> d;
+
+    bool empty() const { return lo > hi; }
+
+    const std::vector<int32_t>& offsets(const WavefrontComponent component) const
+    {
+        switch (component)
+        {
+        case WavefrontComponent::i: return i;
+        case WavefrontComponent::d: return d;
+        default: return m;
+        }
+    }
+
+    int32_t get(const WavefrontComponent component, const int32_t k) const
+    {
+        return k < lo || k > hi ? invalid_offset : offsets(component)[k - lo];
+    }
+};
+
+/// SequencePair - query and target of a (sub)problem, the sequences are not owned
+struct SequencePair
+{
+    const char* query;
+    int32_t query_length;
+    const char* target;
+    int32_t target_length;
+};
+
+/// WavefrontSearch - computes the wavefronts of increasing penalty of a global alignment
+///
+/// The search can begin inside an insertion or deletion gap, whose opening penalty was already paid.
+/// Either all wavefronts are kept (for a traceback) or only the most recent ones in a ring buffer.
+class WavefrontSearch
+{
+public:
+    /// \brief Constructor, computes the wavefront of penalty 0
+    /// \param sequences
+    /// \param penalties
+    /// \param begin component the alignment begins in
+    /// \param kept_wavefronts number of most recent wavefronts to keep, 0 keeps all. Has to exceed the largest penalty of a single operation.
+    WavefrontSearch(const SequencePair& sequences, const WavefrontPenalties& penalties, const WavefrontComponent begin, const int32_t kept_wavefronts)
+        : sequences_(sequences)
+        , penalties_(penalties)
+        , kept_wavefronts_(kept_wavefronts)
+        , penalty_(0)
+    {
+        assert(kept_wavefronts == 0 || kept_wavefronts > std::max(penalties.mismatch, penalties.gap_open + penalties.gap_extend));
+        wavefronts_.resize(std::max(kept_wavefronts, 1));
+        Wavefront& w = wavefronts_[0];
+        w.lo         = 0;
+        w.hi         = 0;
+        w.m.assign(1, 0);
+        w.i.assign(1, begin == WavefrontComponent::i ? 0 : invalid_offset);
+        w.d.assign(1, begin == WavefrontComponent::d ? 0 : invalid_offset);
+        extend(w);
+    }
+
+    int32_t penalty() const { return penalty_; }
+
+    const SequencePair& sequences() const { return sequences_; }
+
+    const WavefrontPenalties& penalties() const { return penalties_; }
+
+    /// \brief returns the wavefront of penalty s, or an empty wavefront if it is out of range or was dropped
+    const Wavefront& get(const int32_t s) const
+    {
+        if (s < 0 || s > penalty_ || (kept_wavefronts_ > 0 && s <= penalty_ - kept_wavefronts_))
+            return empty_;
+        return kept_wavefronts_ > 0 ? wavefronts_[s % kept_wavefronts_] : wavefronts_[s];
+    }
+
+    const Wavefront& current() const { return get(penalty_); }
+
+    /// \brief offset on diagonal k reached with penalty s by a mismatch, before the extension of the following matches
+    int32_t mismatch_offset(const int32_t s, const int32_t k) const
+    {
+        return bound(get(s - penalties_.mismatch).get(WavefrontComponent::m, k) + 1, k);
+    }
+
+    /// \brief offset of the insertion wavefront on diagonal k with penalty s
+    int32_t insertion_offset(const int32_t s, const int32_t k) const
+    {
+        return bound(std::max(get(s - penalties_.gap_open - penalties_.gap_extend).get(WavefrontComponent::m, k - 1),
+                              get(s - penalties_.gap_extend).get(WavefrontComponent::i, k - 1)) +
+                         1,
+                     k);
+    }
+
+    /// \brief offset of the deletion wavefront on diagonal k with penalty s
+    int32_t deletion_offset(const int32_t s, const int32_t k) const
+    {
+        return bound(std::max(get(s - penalties_.gap_open - penalties_.gap_extend).get(WavefrontComponent::m, k + 1),
+                              get(s - penalties_.gap_extend).get(WavefrontComponent::d, k + 1)),
+                     k);
+    }
+
+    /// \brief computes the wavefront of the next penalty
+    void next()
+    {
+        const int32_t s = penalty_ + 1;
+        if (kept_wavefronts_ == 0)
+        {
+            wavefronts_.emplace_back();
+        }
+        Wavefront& w = kept_wavefronts_ > 0 ? wavefronts_[s % kept_wavefronts_] : wavefronts_.back();
+
+        int32_t lo = std::numeric_limits<int32_t>::max();
+        int32_t hi = std::numeric_limits<int32_t>::min();
+        for (const int32_t source : {s - penalties_.mismatch, s - penalties_.gap_open - penalties_.gap_extend, s - penalties_.gap_extend})
+        {
+            const Wavefront& source_wavefront = get(source);
+            if (!source_wavefront.empty())
+            {
+                lo = std::min(lo, source_wavefront.lo - 1);
+                hi = std::max(hi, source_wavefront.hi + 1);
+            }
+        }
+        penalty_ = s;
+        w.lo     = std::max(lo, -sequences_.query_length);
+        w.hi     = std::min(hi, sequences_.target_length);
+        if (w.empty())
+        {
+            return;
+        }
+
+        const int32_t size = w.hi - w.lo + 1;
+        w.m.resize(size);
+        w.i.resize(size);
+        w.d.resize(size);
+        for (int32_t k = w.lo; k <= w.hi; ++k)
+        {
+            // the wavefront of penalty s does not depend on itself, so it can be read while being written
+            const int32_t insertion = insertion_offset(s, k);
+            const int32_t deletion  = deletion_offset(s, k);
+            w.i[k - w.lo]           = insertion;
+            w.d[k - w.lo]           = deletion;
+            w.m[k - w.lo]           = std::max({mismatch_offset(s, k), insertion, deletion});
+        }
+        extend(w);
+    }
+
+    /// \brief returns whether the current wavefront reaches the end of both sequences in the given component
+    bool reached_end(const WavefrontComponent end) const
+    {
+        return current().get(end, sequences_.target_length - sequences_.query_length) == sequences_.target_length;
+    }
+
+private:
+    int32_t bound(const int32_t offset, const int32_t k) const
+    {
+        return (offset < 0 || offset > sequences_.target_length || offset - k > sequences_.query_length) ? invalid_offset : offset;
+    }
+
+    void extend(Wavefront& w) const
+    {
+        const char* const query  = sequences_.query;
+        const char* const target = sequences_.target;
+        for (int32_t k = w.lo; k <= w.hi; ++k)
+        {
+            int32_t h = w.m[k - w.lo];
+            if (h < 0)
+                continue;
+            int32_t v = h - k;
+            while (v < sequences_.query_length && h < sequences_.target_length && query[v] == target[h])
+            {
+                ++v;
+                ++h;
+            }
+            w.m[k - w.lo] = h;
+        }
+    }
+
+    SequencePair sequences_;
+    WavefrontPenalties penalties_;
+    int32_t kept_wavefronts_;
+    int32_t penalty_;
+    std::vector<Wavefront> wavefronts_;
+    Wavefront empty_;
+};
+
+/// \brief traces back from the end of both sequences in component end, all wavefronts have to be kept. Appends the alignment to path.
+void wavefront_backtrace(const WavefrontSearch& search, const WavefrontComponent end, std::vector<AlignmentState>& path)
+{
+    const SequencePair& sequences       = search.sequences();
+    const WavefrontPenalties& penalties = search.penalties();
+    const int32_t gap_open_extend       = penalties.gap_open + penalties.gap_extend;
+    int32_t s                           = search.penalty();
+    int32_t k                           = sequences.target_length - sequences.query_length;
+    int32_t h                           = sequences.target_length;
+    WavefrontComponent component        = end;
+    const std::size_t first             = path.size();
+    while (true)
+    {
+        if (component == WavefrontComponent::m)
+        {
+            const int32_t mismatch = s == 0 ? 0 : search.mismatch_offset(s, k);
+            const int32_t before   = s == 0 ? 0 : std::max({mismatch, search.get(s).get(WavefrontComponent::i, k), search.get(s).get(WavefrontComponent::d, k)});
+            assert(before >= 0 && before <= h);
+            path.insert(path.end(), h - before, AlignmentState::match);
+            h = before;
+            if (s == 0)
+            {
+                assert(k == 0 && h == 0);
+                break;
+            }
+            if (mismatch == before)
+            {
+                --h;
+                path.push_back(sequences.query[h - k] == sequences.target[h] ? AlignmentState::match : AlignmentState::mismatch);
+                s -= penalties.mismatch;
+                continue;
+            }
+            component = search.get(s).get(WavefrontComponent::i, k) == before ? WavefrontComponent::i : WavefrontComponent::d;
+        }
+        if (s == 0)
+        {
+            // the alignment begins inside a gap
+            assert(k == 0 && h == 0);
+            break;
+        }
+        if (component == WavefrontComponent::i)
+        {
+            path.push_back(AlignmentState::insertion);
+            --h;
+            --k;
+            if (search.get(s - penalties.gap_extend).get(WavefrontComponent::i, k) == h)
+            {
+                s -= penalties.gap_extend;
+            }
+            else
+            {
+                s -= gap_open_extend;
+                component = WavefrontComponent::m;
+            }
+        }
+        else
+        {
+            path.push_back(AlignmentState::deletion);
+            ++k;
+            if (search.get(s - penalties.gap_extend).get(WavefrontComponent::d, k) == h)
+            {
+                s -= penalties.gap_extend;
+            }
+            else
+            {
+                s -= gap_open_extend;
+                component = WavefrontComponent::m;
+            }
+        }
+    }
+    std::reverse(path.begin() + first, path.end());
+}
+
+void wavefront_align_full(const SequencePair& sequences, const WavefrontPenalties& penalties, const WavefrontComponent begin, const WavefrontComponent end, std::vector<AlignmentState>& path)
+{
+    WavefrontSearch search(sequences, penalties, begin, 0);
+    while (!search.reached_end(end))
+    {
+        search.next();
+    }
+    wavefront_backtrace(search, end, path);
+}
+
+/// Breakpoint - point where an optimal alignment can be split, found where forward and reverse wavefronts overlap
+struct Breakpoint
+{
+    int32_t penalty              = std::numeric_limits<int32_t>::max();
+    int32_t k                    = 0;
+    int32_t offset               = 0;
+    WavefrontComponent component = WavefrontComponent::m;
+};
+
+/// \brief checks a forward wavefront of penalty forward_penalty and a reverse wavefront of penalty reverse_penalty for overlaps, updates breakpoint if one is better
+void find_breakpoint(const Wavefront& forward, const int32_t forward_penalty, const Wavefront& reverse, const int32_t reverse_penalty,
+                     const SequencePair& sequences, const int32_t gap_open, Breakpoint& breakpoint)
+{
+    if (forward.empty() || reverse.empty())
+        return;
+    // diagonal k of the forward search is diagonal k_end - k of the reverse search
+    const int32_t k_end = sequences.target_length - sequences.query_length;
+    const int32_t lo    = std::max(forward.lo, k_end - reverse.hi);
+    const int32_t hi    = std::min(forward.hi, k_end - reverse.lo);
+    if (lo > hi)
+        return;
+    for (const WavefrontComponent component : {WavefrontComponent::m, WavefrontComponent::i, WavefrontComponent::d})
+    {
+        // a gap crossing the breakpoint was opened by both searches
+        const int32_t penalty = forward_penalty + reverse_penalty - (component == WavefrontComponent::m ? 0 : gap_open);
+        if (penalty >= breakpoint.penalty)
+            continue;
+        // forward_offsets[j] and reverse_offsets[-j] are on diagonal lo + j,
+        // invalid offsets are negative enough to never reach the target length, even if both are invalid
+        const int32_t* const forward_offsets = forward.offsets(component).data() + (lo - forward.lo);
+        const int32_t* const reverse_offsets = reverse.offsets(component).data() + (k_end - lo - reverse.lo);
+        bool overlap                         = false;
+        for (int32_t j = 0; j <= hi - lo; ++j)
+        {
+            overlap |= forward_offsets[j] + reverse_offsets[-j] >= sequences.target_length;
+        }
+        if (!overlap)
+            continue;
+        for (int32_t j = 0; j <= hi - lo; ++j)
+        {
+            if (forward_offsets[j] + reverse_offsets[-j] >= sequences.target_length)
+            {
+                breakpoint = {penalty, lo + j, forward_offsets[j], component};
+                break;
+            }
+        }
+    }
+}
+
+/// FullSequences - the complete query and target and their reverses, subproblems refer to intervals of them
+struct FullSequences
+{
+    const char* query;
+    int32_t query_length;
+    const char* target;
+    int32_t target_length;
+    std::string reversed_query;
+    std::string reversed_target;
+};
+
+/// \brief aligns query[query_begin, query_end) to target[target_begin, target_end) with BiWFA, appends the alignment to path
+void wavefront_align_bidirectional(const FullSequences& full, const int32_t query_begin, const int32_t query_end, const int32_t target_begin, const int32_t target_end,
+                                   const WavefrontPenalties& penalties, const WavefrontComponent begin, const WavefrontComponent end, std::vector<AlignmentState>& path)
+{
+    const int32_t query_length  = query_end - query_begin;
+    const int32_t target_length = target_end - target_begin;
+    if (query_length == 0 || target_length == 0)
+    {
+        path.insert(path.end(), query_length, AlignmentState::deletion);
+        path.insert(path.end(), target_length, AlignmentState::insertion);
+        return;
+    }
+
+    const SequencePair forward_sequences = {full.query + query_begin, query_length, full.target + target_begin, target_length};
+    if (query_length + target_length <= bidirectional_base_case_length)
+    {
+        wavefront_align_full(forward_sequences, penalties, begin, end, path);
+        return;
+    }
+    const SequencePair reverse_sequences = {full.reversed_query.data() + (full.query_length - query_end), query_length,
+                                            full.reversed_target.data() + (full.target_length - target_end), target_length};
+
+    // Any optimal alignment has a point whose forward and reverse penalties differ by at most twice the largest penalty
+    // of a single operation plus the gap opening penalty. Keeping that many wavefronts of both searches guarantees
+    // that the overlap of such a pair is checked once both are computed.
+    const int32_t max_step = std::max(penalties.mismatch, penalties.gap_open + penalties.gap_extend);
+    const int32_t kept     = 2 * max_step + penalties.gap_open + 3;
+    WavefrontSearch forward(forward_sequences, penalties, begin, kept);
+    WavefrontSearch reverse(reverse_sequences, penalties, end, kept);
+
+    Breakpoint breakpoint;
+    find_breakpoint(forward.current(), 0, reverse.current(), 0, forward_sequences, penalties.gap_open, breakpoint);
+    // stop once the middle points of all alignments with lower penalties would have been found
+    while (breakpoint.penalty == std::numeric_limits<int32_t>::max() ||
+           2 * std::min(forward.penalty(), reverse.penalty()) < breakpoint.penalty + 2 * (max_step + penalties.gap_open))
+    {
+        forward.next();
+        for (int32_t s = std::max(0, reverse.penalty() - kept + 1); s <= reverse.penalty(); ++s)
+        {
+            find_breakpoint(forward.current(), forward.penalty(), reverse.get(s), s, forward_sequences, penalties.gap_open, breakpoint);
+        }
+        reverse.next();
+        for (int32_t s = std::max(0, forward.penalty() - kept + 1); s <= forward.penalty(); ++s)
+        {
+            find_breakpoint(forward.get(s), s, reverse.current(), reverse.penalty(), forward_sequences, penalties.gap_open, breakpoint);
+        }
+    }
+
+    const int32_t target_split = breakpoint.offset;
+    const int32_t query_split  = breakpoint.offset - breakpoint.k;
+    if ((query_split == 0 && target_split == 0) || (query_split == query_length && target_split == target_length))
+    {
+        // the whole alignment is on one side of the breakpoint, which only happens for alignments with very low penalties
+        wavefront_align_full(forward_sequences, penalties, begin, end, path);
+        return;
+    }
+    wavefront_align_bidirectional(full, query_begin, query_begin + query_split, target_begin, target_begin + target_split, penalties, begin, breakpoint.component, path);
+    wavefront_align_bidirectional(full, query_begin + query_split, query_end, target_begin + target_split, target_end, penalties, breakpoint.component, end, path);
+}
+
+} // namespace
+
+void validate_wavefront_penalties(const WavefrontPenalties& penalties)
+{
+    if (penalties.mismatch <= 0 || penalties.gap_extend <= 0)
+    {
+        throw std::invalid_argument("Wavefront mismatch and gap extension penalties must be positive.");
+    }
+    if (penalties.gap_open < 0)
+    {
+        throw std::invalid_argument("Wavefront gap opening penalty must be non-negative.");
+    }
+}
+
+std::vector<AlignmentState> wavefront_compute_alignment_cpu(const char* query, const int32_t query_length,
+                                                            const char* target, const int32_t target_length,
+                                                            const WavefrontPenalties& penalties,
+                                                            const WavefrontMemoryMode memory_mode)
+{
+    throw_on_negative(query_length, "query_length must be non-negative.");
+    throw_on_negative(target_length, "target_length must be non-negative.");
+    validate_wavefront_penalties(penalties);
+
+    std::vector<AlignmentState> path;
+    path.reserve(query_length + target_length);
+    if (memory_mode == WavefrontMemoryMode::bidirectional)
+    {
+        FullSequences full{query, query_length, target, target_length, std::string(query, query_length), std::string(target, target_length)};
+        std::reverse(begin(full.reversed_query), end(full.reversed_query));
+        std::reverse(begin(full.reversed_target), end(full.reversed_target));
+        wavefront_align_bidirectional(full, 0, query_length, 0, target_length, penalties, WavefrontComponent::m, WavefrontComponent::m, path);
+    }
+    else
+    {
+        wavefront_align_full({query, query_length, target, target_length}, penalties, WavefrontComponent::m, WavefrontComponent::m, path);
+    }
+    return path;
+}
+
+int32_t compute_wavefront_penalty(const std::vector<AlignmentState>& alignment, const WavefrontPenalties& penalties)
+{
+    int32_t penalty               = 0;
+    AlignmentState previous_state = AlignmentState::match;
+    for (const AlignmentState s : alignment)
+    {
+        switch (s)
+        {
+        case AlignmentState::match: break;
+        case AlignmentState::mismatch: penalty += penalties.mismatch; break;
+        default:
+            penalty += (s == previous_state ? 0 : penalties.gap_open) + penalties.gap_extend;
+            break;
+        }
+        previous_state = s;
+    }
+    return penalty;
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,68 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// \brief Checks that penalties can be used by wavefront_compute_alignment_cpu
+/// \param penalties
+/// \throw std::invalid_argument if mismatch or gap_extend are not positive or gap_open is negative
+void validate_wavefront_penalties(const WavefrontPenalties& penalties);
+
+/// \brief Computes an optimal global alignment on the CPU using the wavefront algorithm (WFA)
+///
+/// For an alignment with penalty s, only the furthest reaching points of the diagonals with penalty up to s
+/// are computed, i.e. the run time is O((query_length + target_length) * s) and very low for similar sequences.
+/// With WavefrontMemoryMode::full all wavefronts are kept for the traceback, with WavefrontMemoryMode::bidirectional
+/// forward and reverse wavefronts are computed until they meet, and both halves are aligned recursively (BiWFA).
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param penalties Penalties, see validate_wavefront_penalties
+/// \param memory_mode Whether to keep all wavefronts or to split the alignment recursively
+/// \return sequence of AlignmentStates
+std::vector<AlignmentState> wavefront_compute_alignment_cpu(const char* query, int32_t query_length,
+                                                            const char* target, int32_t target_length,
+                                                            const WavefrontPenalties& penalties,
+                                                            WavefrontMemoryMode memory_mode);
+
+/// \brief Computes the penalty of an alignment
+/// \param alignment sequence of AlignmentStates
+/// \param penalties
+/// \return penalty
+int32_t compute_wavefront_penalty(const std::vector<AlignmentState>& alignment, const WavefrontPenalties& penalties);
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
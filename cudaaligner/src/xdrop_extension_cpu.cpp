@@ -0,0 +1,180 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "xdrop_extension_cpu.hpp"
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+constexpr int32_t match_score    = 1;
+constexpr int32_t mismatch_score = -1;
+constexpr int32_t gap_score      = -1;
+constexpr int32_t minus_infinity = std::numeric_limits<int32_t>::min() / 2;
+constexpr int8_t from_diagonal   = 0;
+constexpr int8_t from_above      = 1;
+constexpr int8_t from_left       = 2;
+
+/// XDropRow - traceback directions of the computed cells [begin, begin + directions.size()) of one row of the DP matrix
+struct XDropRow
+{
+    int32_t begin;
+    std::vector<int8_t> directions;
+};
+
+std::vector<AlignmentState> xdrop_backtrace(const std::vector<XDropRow>& rows, const char* query, const char* target, int32_t i, int32_t j)
+{
+    std::vector<AlignmentState> path;
+    path.reserve(i + j);
+    while (i > 0 || j > 0)
+    {
+        const XDropRow& row = rows[i];
+        assert(j >= row.begin && j - row.begin < get_size<int32_t>(row.directions));
+        switch (row.directions[j - row.begin])
+        {
+        case from_diagonal:
+            path.push_back(query[i - 1] == target[j - 1] ? AlignmentState::match : AlignmentState::mismatch);
+            --i;
+            --j;
+            break;
+        case from_above:
+            path.push_back(AlignmentState::deletion);
+            --i;
+            break;
+        default:
+            path.push_back(AlignmentState::insertion);
+            --j;
+            break;
+        }
+    }
+    std::reverse(begin(path), end(path));
+    return path;
+}
+
+} // namespace
+
+std::vector<AlignmentState> xdrop_extend_cpu(const char* query, const int32_t query_length, const char* target, const int32_t target_length, const int32_t x_drop, AlignedInterval& aligned_interval)
+{
+    assert(query_length >= 0);
+    assert(target_length >= 0);
+    assert(x_drop >= 0);
+
+    int32_t best_score = 0;
+    int32_t best_i     = 0;
+    int32_t best_j     = 0;
+
+    std::vector<XDropRow> rows;
+    rows.reserve(query_length + 1);
+
+    // first row: gaps in the query only, scores of live cells are never below -x_drop
+    int32_t live_begin = 0;
+    int32_t live_end   = std::min(target_length, x_drop / -gap_score) + 1;
+    std::vector<int32_t> previous_scores(live_end);
+    rows.push_back({0, std::vector<int8_t>(live_end, from_left)});
+    for (int32_t j = 0; j < live_end; ++j)
+    {
+        previous_scores[j] = j * gap_score;
+    }
+
+    std::vector<int32_t> scores;
+    for (int32_t i = 1; i <= query_length; ++i)
+    {
+        // previous_scores holds the live cells [live_begin, live_end) of row i-1
+        const int32_t threshold = best_score - x_drop;
+        const auto previous     = [&](const int32_t j) {
+            return (j >= live_begin && j < live_end) ? previous_scores[j - live_begin] : minus_infinity;
+        };
+
+        XDropRow row{live_begin, {}};
+        scores.clear();
+        int32_t new_begin = -1;
+        int32_t new_end   = -1;
+        for (int32_t j = live_begin; j <= target_length; ++j)
+        {
+            int32_t score    = previous(j) + gap_score;
+            int8_t direction = from_above;
+            if (j > 0)
+            {
+                const int32_t diagonal = previous(j - 1) + (query[i - 1] == target[j - 1] ? match_score : mismatch_score);
+                if (diagonal >= score)
+                {
+                    score     = diagonal;
+                    direction = from_diagonal;
+                }
+            }
+            if (j > live_begin && scores.back() + gap_score > score)
+            {
+                score     = scores.back() + gap_score;
+                direction = from_left;
+            }
+            if (score < threshold)
+            {
+                score = minus_infinity;
+                if (j >= live_end)
+                {
+                    // nothing to the right of this cell can be reached from row i-1 or from a live cell in row i
+                    break;
+                }
+            }
+            else
+            {
+                new_begin = new_begin < 0 ? j : new_begin;
+                new_end   = j + 1;
+                if (score > best_score)
+                {
+                    best_score = score;
+                    best_i     = i;
+                    best_j     = j;
+                }
+            }
+            scores.push_back(score);
+            row.directions.push_back(direction);
+        }
+
+        if (new_begin < 0)
+        {
+            break;
+        }
+        rows.push_back(std::move(row));
+        previous_scores.assign(begin(scores) + (new_begin - live_begin), begin(scores) + (new_end - live_begin));
+        live_begin = new_begin;
+        live_end   = new_end;
+    }
+
+    aligned_interval = {0, best_i, 0, best_j};
+    return xdrop_backtrace(rows, query, target, best_i, best_j);
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,53 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+/// \brief Extends an alignment from the first bases of query and target on the CPU using an X-drop criterion
+///
+/// Matches score +1, mismatches and gaps -1. Cells of the DP matrix whose score drops more than x_drop below
+/// the best score seen so far are pruned, the extension stops when a row has no cells left.
+/// The returned alignment ends at the cell with the best score.
+///
+/// \param query Query string
+/// \param query_length Query string length
+/// \param target Target string
+/// \param target_length Target string length
+/// \param x_drop Maximal drop of the score below the best score before a cell is pruned, has to be non-negative
+/// \param aligned_interval output, aligned prefixes of query and target
+/// \return sequence of AlignmentStates of the aligned prefixes
+std::vector<AlignmentState> xdrop_extend_cpu(const char* query, int32_t query_length, const char* target, int32_t target_length, int32_t x_drop, AlignedInterval& aligned_interval);
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,219 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "../src/affine_gap_alignment_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+// Gotoh's algorithm on the full matrices, returns the optimal score
+int32_t affine_gap_score_naive(const std::string& query, const std::string& target, const AffineGapScores& scores, const bool semi_global)
+{
+    const int32_t minus_infinity = std::numeric_limits<int32_t>::min() / 2;
+    const int32_t m              = get_size<int32_t>(query);
+    const int32_t n              = get_size<int32_t>(target);
+    std::vector<int32_t> h(n + 1);
+    std::vector<int32_t> e(n + 1, minus_infinity);
+    for (int32_t j = 1; j <= n; ++j)
+    {
+        h[j] = semi_global ? 0 : scores.gap_open + j * scores.gap_extend;
+    }
+    for (int32_t i = 1; i <= m; ++i)
+    {
+        int32_t diagonal = h[0];
+        int32_t f        = minus_infinity;
+        h[0]             = scores.gap_open + i * scores.gap_extend;
+        for (int32_t j = 1; j <= n; ++j)
+        {
+            e[j]                = std::max(e[j], h[j] + scores.gap_open) + scores.gap_extend;
+            f                   = std::max(f, h[j - 1] + scores.gap_open) + scores.gap_extend;
+            const int32_t above = h[j];
+            h[j]                = std::max({diagonal + (query[i - 1] == target[j - 1] ? scores.match : scores.mismatch), e[j], f});
+            diagonal            = above;
+        }
+    }
+    return semi_global ? *std::max_element(begin(h), end(h)) : h[n];
+}
+
+void check_alignment_is_consistent(const std::string& query, const std::string& target, const std::vector<AlignmentState>& alignment)
+{
+    int32_t i = 0;
+    int32_t j = 0;
+    for (const AlignmentState s : alignment)
+    {
+        switch (s)
+        {
+        case AlignmentState::match:
+            ASSERT_EQ(query[i], target[j]) << "match at mismatching position " << i << ", " << j;
+            ++i;
+            ++j;
+            break;
+        case AlignmentState::mismatch:
+            ASSERT_NE(query[i], target[j]) << "mismatch at matching position " << i << ", " << j;
+            ++i;
+            ++j;
+            break;
+        case AlignmentState::insertion: ++j; break;
+        case AlignmentState::deletion: ++i; break;
+        }
+    }
+    EXPECT_EQ(get_size(query), i);
+    EXPECT_EQ(get_size(target), j);
+}
+
+} // namespace
+
+class TestAffineGapAlignmentCPU : public ::testing::TestWithParam<InstructionSet>
+{
+};
+
+TEST_P(TestAffineGapAlignmentCPU, TestAgainstGotoh)
+{
+    const InstructionSet instruction_set = GetParam();
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        GTEST_SKIP() << "instruction set not supported on this machine";
+    }
+
+    std::minstd_rand rng(5);
+    const std::vector<AffineGapScores> scoring_schemes = {AffineGapScores(), {1, -1, 0, -1}, {5, -3, -12, -1}};
+    const std::vector<int32_t> lengths                 = {1, 2, 15, 16, 33, 100, 257, 600};
+    for (const AffineGapScores& scores : scoring_schemes)
+    {
+        for (const int32_t length : lengths)
+        {
+            const std::string target = genomeutils::generate_random_genome(length + 7, rng);
+            const std::string query  = genomeutils::generate_random_sequence(target.substr(3, length), rng, length / 8 + 1, length / 8 + 1, length / 8 + 1);
+            for (const bool semi_global : {false, true})
+            {
+                AlignedInterval interval                    = {-1, -1, -1, -1};
+                const std::vector<AlignmentState> alignment = affine_gap_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                               scores, semi_global, -1, interval, instruction_set);
+                EXPECT_EQ(0, interval.query_start);
+                EXPECT_EQ(get_size<int32_t>(query), interval.query_end);
+                if (!semi_global)
+                {
+                    EXPECT_EQ(0, interval.target_start);
+                    EXPECT_EQ(get_size<int32_t>(target), interval.target_end);
+                }
+                check_alignment_is_consistent(query, target.substr(interval.target_start, interval.target_end - interval.target_start), alignment);
+                EXPECT_EQ(affine_gap_score_naive(query, target, scores, semi_global), compute_affine_gap_score(alignment, scores))
+                    << "length " << length << ", semi-global " << semi_global;
+            }
+        }
+    }
+}
+
+TEST_P(TestAffineGapAlignmentCPU, TestBanded)
+{
+    const InstructionSet instruction_set = GetParam();
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        GTEST_SKIP() << "instruction set not supported on this machine";
+    }
+
+    std::minstd_rand rng(9);
+    const AffineGapScores scores;
+    for (const int32_t length : {10, 64, 500, 2000})
+    {
+        const std::string target = genomeutils::generate_random_genome(length, rng);
+        const std::string query  = genomeutils::generate_random_sequence(target, rng, length / 50 + 1, length / 50 + 1, length / 50 + 1);
+        const int32_t optimum    = affine_gap_score_naive(query, target, scores, false);
+        for (const int32_t bandwidth : {0, 4, 32, length})
+        {
+            AlignedInterval interval;
+            const std::vector<AlignmentState> alignment = affine_gap_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                           scores, false, bandwidth, interval, instruction_set);
+            check_alignment_is_consistent(query, target, alignment);
+            const int32_t score = compute_affine_gap_score(alignment, scores);
+            EXPECT_LE(score, optimum);
+            if (bandwidth >= 32)
+            {
+                // the indels of these sequences stay close to the main diagonal
+                EXPECT_EQ(optimum, score) << "length " << length << ", bandwidth " << bandwidth;
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TestAffineGapAlignmentCPU, TestAffineGapAlignmentCPU, ::testing::Values(InstructionSet::scalar, InstructionSet::avx2, InstructionSet::avx512));
+
+TEST(TestAffineGapAlignmentCPU, TestGapsAreMerged)
+{
+    // with unit costs both alignments have the same number of edits, affine gaps prefer one long gap over two short ones
+    const std::string query  = "ACGTACGTTTTTGGCCAACG";
+    const std::string target = "ACGTACGTGGCCAACG";
+    AlignedInterval interval;
+    const std::vector<AlignmentState> alignment = affine_gap_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                   AffineGapScores(), false, -1, interval);
+    EXPECT_EQ(2 * 16 - 4 - 4 * 2, compute_affine_gap_score(alignment, AffineGapScores()));
+}
+
+TEST(TestAffineGapAlignmentCPU, TestEmptySequencesAndInvalidScores)
+{
+    AlignedInterval interval;
+    EXPECT_EQ(std::vector<AlignmentState>(3, AlignmentState::insertion), affine_gap_compute_alignment_cpu("", 0, "ACG", 3, AffineGapScores(), false, -1, interval));
+    EXPECT_TRUE(affine_gap_compute_alignment_cpu("", 0, "ACG", 3, AffineGapScores(), true, -1, interval).empty());
+    EXPECT_EQ(std::vector<AlignmentState>(2, AlignmentState::deletion), affine_gap_compute_alignment_cpu("AC", 2, "", 0, AffineGapScores(), false, -1, interval));
+
+    EXPECT_THROW(validate_affine_gap_scores({1, -1, 1, -1}), std::invalid_argument);
+    EXPECT_THROW(validate_affine_gap_scores({1, 2, -1, -1}), std::invalid_argument);
+    EXPECT_THROW(validate_affine_gap_scores({2000, -1, -1, -1}), std::invalid_argument);
+}
+
+TEST(TestAffineGapAlignmentCPU, TestAlignerBatch)
+{
+    ThreadPool thread_pool(2);
+    std::unique_ptr<Aligner> aligner = create_cpu_aligner(32, 32, 2, AlignmentType::semi_global_affine_alignment, AffineGapScores(), -1, thread_pool);
+    ASSERT_EQ(StatusType::success, aligner->add_alignment("ACGTTGCA", 8, "TTTTACGTTGCATTTT", 16));
+    ASSERT_EQ(StatusType::success, aligner->add_alignment("ACGTGCA", 7, "TTTTACGTTGCATTTT", 16));
+    aligner->align_all();
+    aligner->sync_alignments();
+
+    const std::vector<std::shared_ptr<Alignment>>& alignments = aligner->get_alignments();
+    EXPECT_EQ(AlignmentType::semi_global_affine_alignment, alignments[0]->get_alignment_type());
+    EXPECT_EQ("8M", alignments[0]->convert_to_cigar());
+    EXPECT_EQ(4, alignments[0]->get_aligned_interval().target_start);
+    EXPECT_EQ(12, alignments[0]->get_aligned_interval().target_end);
+    EXPECT_EQ(1, alignments[1]->get_edit_distance());
+    EXPECT_EQ(4, alignments[1]->get_aligned_interval().target_start);
+    EXPECT_EQ(12, alignments[1]->get_aligned_interval().target_end);
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,446 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "../src/aligner_cpu.hpp"
+#include "../src/myers_alignment_cpu.hpp"
+#include "../src/needleman_wunsch_cpu.hpp"
+#include "../src/xdrop_extension_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <random>
+#include <stdexcept>
+#include "gtest/gtest.h"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+int32_t count_edits(const std::vector<AlignmentState>& alignment)
+{
+    return static_cast<int32_t>(std::count_if(begin(alignment), end(alignment), [](AlignmentState s) { return s != AlignmentState::match; }));
+}
+
+void check_alignment_is_consistent(const std::string& query, const std::string& target, const std::vector<AlignmentState>& alignment)
+{
+    int32_t i = 0;
+    int32_t j = 0;
+    for (const AlignmentState s : alignment)
+    {
+        switch (s)
+        {
+        case AlignmentState::match:
+            ASSERT_EQ(query[i], target[j]) << "match at mismatching position " << i << ", " << j;
+            ++i;
+            ++j;
+            break;
+        case AlignmentState::mismatch:
+            ASSERT_NE(query[i], target[j]) << "mismatch at matching position " << i << ", " << j;
+            ++i;
+            ++j;
+            break;
+        case AlignmentState::insertion: ++j; break;
+        case AlignmentState::deletion: ++i; break;
+        }
+    }
+    EXPECT_EQ(get_size(query), i);
+    EXPECT_EQ(get_size(target), j);
+}
+
+int32_t semi_global_edit_distance_naive(const std::string& query, const std::string& target)
+{
+    // first row is 0, i.e. the alignment may start anywhere in the target
+    std::vector<int32_t> row(target.size() + 1, 0);
+    for (int32_t i = 1; i <= get_size<int32_t>(query); ++i)
+    {
+        int32_t diagonal = row[0];
+        row[0]           = i;
+        for (int32_t j = 1; j <= get_size<int32_t>(target); ++j)
+        {
+            const int32_t above = row[j];
+            row[j]              = std::min({diagonal + (query[i - 1] == target[j - 1] ? 0 : 1), above + 1, row[j - 1] + 1});
+            diagonal            = above;
+        }
+    }
+    return *std::min_element(begin(row), end(row));
+}
+
+/// ThrowingAlignerCPU - AlignerCPU whose alignment tasks throw
+class ThrowingAlignerCPU : public AlignerCPU
+{
+public:
+    explicit ThrowingAlignerCPU(ThreadPool& thread_pool)
+        : AlignerCPU(10, 10, 2, AlignmentType::global_alignment, thread_pool, 0)
+    {
+    }
+
+protected:
+    void compute_alignment(AlignmentImpl*) const override
+    {
+        throw std::runtime_error("compute_alignment failed");
+    }
+};
+
+} // namespace
+
+TEST(TestAlignerCPU, TestMyersAlignmentAgainstNeedlemanWunsch)
+{
+    std::minstd_rand rng(7);
+    // cover lengths below, at and above word boundaries
+    const std::vector<int32_t> lengths = {1, 5, 63, 64, 65, 128, 200, 1000};
+    for (const int32_t length : lengths)
+    {
+        const std::string target = genomeutils::generate_random_genome(length, rng);
+        const std::string query  = genomeutils::generate_random_sequence(target, rng, length / 10 + 1, length / 10 + 1, length / 10 + 1);
+
+        const std::vector<AlignmentState> alignment = myers_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target));
+        const matrix<int> scores                    = needleman_wunsch_build_score_matrix_naive(target, query);
+
+        check_alignment_is_consistent(query, target, alignment);
+        EXPECT_EQ(scores(scores.num_rows() - 1, scores.num_cols() - 1), count_edits(alignment)) << "length " << length;
+    }
+}
+
+TEST(TestAlignerCPU, TestMyersAlignmentEmptySequences)
+{
+    EXPECT_TRUE(myers_compute_alignment_cpu("", 0, "", 0).empty());
+    EXPECT_EQ(std::vector<AlignmentState>(3, AlignmentState::insertion), myers_compute_alignment_cpu("", 0, "ACG", 3));
+    EXPECT_EQ(std::vector<AlignmentState>(2, AlignmentState::deletion), myers_compute_alignment_cpu("AC", 2, "", 0));
+}
+
+TEST(TestAlignerCPU, TestNeedlemanWunschAgainstNaive)
+{
+    std::minstd_rand rng(5);
+    // short lengths use a full score matrix, long ones Hirschberg's recursion
+    const std::vector<std::pair<int32_t, int32_t>> lengths = {{1, 1}, {1, 40}, {40, 1}, {17, 33}, {300, 280}, {1000, 1000}, {2000, 150}};
+    for (const InstructionSet instruction_set : {InstructionSet::scalar, InstructionSet::avx2, InstructionSet::avx512})
+    {
+        if (!is_instruction_set_supported(instruction_set))
+        {
+            continue;
+        }
+        for (const auto& length : lengths)
+        {
+            const std::string target = genomeutils::generate_random_genome(length.second, rng);
+            const std::string query  = genomeutils::generate_random_sequence(genomeutils::generate_random_genome(length.first, rng), rng, length.first / 10, length.first / 10, length.first / 10);
+
+            const std::vector<AlignmentState> alignment = needleman_wunsch_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target), instruction_set);
+            const matrix<int> scores                    = needleman_wunsch_build_score_matrix_naive(target, query);
+            const int32_t edit_distance                 = scores(scores.num_rows() - 1, scores.num_cols() - 1);
+
+            check_alignment_is_consistent(query, target, alignment);
+            EXPECT_EQ(edit_distance, count_edits(alignment)) << "lengths " << length.first << ", " << length.second;
+            EXPECT_EQ(edit_distance, needleman_wunsch_compute_edit_distance_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target), instruction_set));
+        }
+    }
+}
+
+TEST(TestAlignerCPU, TestNeedlemanWunschLongAlignment)
+{
+    // scores exceed the 16-bit range in the first levels of the recursion
+    std::minstd_rand rng(3);
+    const std::string target = genomeutils::generate_random_genome(20000, rng);
+    const std::string query  = genomeutils::generate_random_sequence(target, rng, 500, 500, 500);
+
+    const std::vector<AlignmentState> alignment = needleman_wunsch_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target));
+    check_alignment_is_consistent(query, target, alignment);
+    EXPECT_EQ(myers_compute_edit_distance_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target)), count_edits(alignment));
+}
+
+TEST(TestAlignerCPU, TestNeedlemanWunschEmptySequences)
+{
+    EXPECT_TRUE(needleman_wunsch_compute_alignment_cpu("", 0, "", 0).empty());
+    EXPECT_EQ(std::vector<AlignmentState>(3, AlignmentState::insertion), needleman_wunsch_compute_alignment_cpu("", 0, "ACG", 3));
+    EXPECT_EQ(std::vector<AlignmentState>(2, AlignmentState::deletion), needleman_wunsch_compute_alignment_cpu("AC", 2, "", 0));
+    EXPECT_EQ(3, needleman_wunsch_compute_edit_distance_cpu("", 0, "ACG", 3));
+}
+
+TEST(TestAlignerCPU, TestNeedlemanWunschAligner)
+{
+    ThreadPool thread_pool(2);
+    const std::vector<std::pair<std::string, std::string>> inputs = {{"AAAA", "TTAT"}, {"ATAAAAAAAA", "AAAAAAAAA"}, {"ACTG", "ACTG"}, {"", "AC"}};
+    const std::vector<int32_t> edit_distances                     = {3, 1, 0, 2};
+
+    std::unique_ptr<Aligner> aligner = create_cpu_aligner(10, 10, get_size<int32_t>(inputs), AlignmentType::global_alignment, CpuAlignmentMemoryMode::linear, thread_pool);
+    for (const auto& input : inputs)
+    {
+        ASSERT_EQ(StatusType::success, aligner->add_alignment(input.first.c_str(), get_size<int32_t>(input.first), input.second.c_str(), get_size<int32_t>(input.second)));
+    }
+    aligner->align_all();
+    aligner->sync_alignments();
+
+    const std::vector<std::shared_ptr<Alignment>>& alignments = aligner->get_alignments();
+    ASSERT_EQ(get_size(inputs), get_size(alignments));
+    for (int32_t a = 0; a < get_size<int32_t>(alignments); ++a)
+    {
+        EXPECT_EQ(StatusType::success, alignments[a]->get_status());
+        EXPECT_EQ(AlignmentType::global_alignment, alignments[a]->get_alignment_type());
+        EXPECT_EQ(edit_distances[a], alignments[a]->get_edit_distance()) << "index: " << a;
+    }
+}
+
+TEST(TestAlignerCPU, TestUnsupportedTypesThrow)
+{
+    ThreadPool thread_pool(1);
+    // affine gap and local aligners need AffineGapScores
+    for (const AlignmentType type : {AlignmentType::global_affine_alignment, AlignmentType::semi_global_affine_alignment, AlignmentType::local_alignment, AlignmentType::unset})
+    {
+        EXPECT_THROW(create_cpu_aligner(10, 10, 1, type, thread_pool), std::runtime_error) << type;
+        EXPECT_THROW(create_cpu_aligner(10, 10, 1, type, CpuAlignmentMemoryMode::full, thread_pool), std::runtime_error) << type;
+    }
+    EXPECT_THROW(create_cpu_aligner(10, 10, 1, AlignmentType::semi_global_alignment, CpuAlignmentMemoryMode::linear, thread_pool), std::runtime_error);
+    EXPECT_THROW(create_cpu_aligner(10, 10, 1, AlignmentType::extension_alignment, CpuAlignmentMemoryMode::linear, thread_pool), std::runtime_error);
+    EXPECT_NE(nullptr, create_cpu_aligner(10, 10, 1, AlignmentType::semi_global_alignment, CpuAlignmentMemoryMode::full, thread_pool));
+}
+
+TEST(TestAlignerCPU, TestHirschbergMyersAgainstMyers)
+{
+    ThreadPool thread_pool(4);
+    std::minstd_rand rng(11);
+    // small tiles force deep recursions with splits next to empty and single-base subproblems
+    const std::vector<std::pair<int32_t, int32_t>> lengths = {{1, 1}, {1, 40}, {40, 1}, {17, 33}, {300, 280}, {1000, 1000}, {2000, 150}, {150, 2000}};
+    for (const int64_t max_tile_cells : {int64_t(1), int64_t(64), int64_t(5000)})
+    {
+        for (const auto& length : lengths)
+        {
+            const std::string target = genomeutils::generate_random_genome(length.second, rng);
+            const std::string query  = genomeutils::generate_random_sequence(genomeutils::generate_random_genome(length.first, rng), rng, length.first / 10, length.first / 10, length.first / 10);
+
+            const std::vector<AlignmentState> alignment = hirschberg_myers_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target), thread_pool, max_tile_cells);
+            check_alignment_is_consistent(query, target, alignment);
+            EXPECT_EQ(myers_compute_edit_distance_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target)), count_edits(alignment))
+                << "lengths " << length.first << ", " << length.second << ", max_tile_cells " << max_tile_cells;
+        }
+    }
+}
+
+TEST(TestAlignerCPU, TestHirschbergMyersLongAlignment)
+{
+    // the last rows of the first splits are large enough to be computed by a wavefront of tiles
+    ThreadPool thread_pool(4);
+    std::minstd_rand rng(13);
+    const std::string target = genomeutils::generate_random_genome(40000, rng);
+    const std::string query  = genomeutils::generate_random_sequence(target, rng, 1000, 1000, 1000);
+
+    const std::vector<AlignmentState> alignment = hirschberg_myers_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target), thread_pool);
+    check_alignment_is_consistent(query, target, alignment);
+    EXPECT_EQ(myers_compute_edit_distance_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target)), count_edits(alignment));
+}
+
+TEST(TestAlignerCPU, TestHirschbergMyersEmptySequences)
+{
+    ThreadPool thread_pool(2);
+    EXPECT_TRUE(hirschberg_myers_compute_alignment_cpu("", 0, "", 0, thread_pool).empty());
+    EXPECT_EQ(std::vector<AlignmentState>(3, AlignmentState::insertion), hirschberg_myers_compute_alignment_cpu("", 0, "ACG", 3, thread_pool, 1));
+    EXPECT_EQ(std::vector<AlignmentState>(2, AlignmentState::deletion), hirschberg_myers_compute_alignment_cpu("AC", 2, "", 0, thread_pool, 1));
+}
+
+TEST(TestAlignerCPU, TestHirschbergMyersAligner)
+{
+    ThreadPool thread_pool(2);
+    const std::vector<std::pair<std::string, std::string>> inputs = {{"AAAA", "TTAT"}, {"ATAAAAAAAA", "AAAAAAAAA"}, {"ACTG", "ACTG"}, {"", "AC"}};
+    const std::vector<int32_t> edit_distances                     = {3, 1, 0, 2};
+
+    std::unique_ptr<Aligner> aligner = create_hirschberg_myers_cpu_aligner(10, 10, get_size<int32_t>(inputs), thread_pool, 4);
+    for (const auto& input : inputs)
+    {
+        ASSERT_EQ(StatusType::success, aligner->add_alignment(input.first.c_str(), get_size<int32_t>(input.first), input.second.c_str(), get_size<int32_t>(input.second)));
+    }
+    aligner->align_all();
+    aligner->sync_alignments();
+
+    const std::vector<std::shared_ptr<Alignment>>& alignments = aligner->get_alignments();
+    ASSERT_EQ(get_size(inputs), get_size(alignments));
+    for (int32_t a = 0; a < get_size<int32_t>(alignments); ++a)
+    {
+        EXPECT_EQ(StatusType::success, alignments[a]->get_status());
+        EXPECT_EQ(AlignmentType::global_alignment, alignments[a]->get_alignment_type());
+        EXPECT_EQ(edit_distances[a], alignments[a]->get_edit_distance()) << "index: " << a;
+    }
+    EXPECT_THROW(create_hirschberg_myers_cpu_aligner(10, 10, 1, thread_pool, 0), std::invalid_argument);
+}
+
+TEST(TestAlignerCPU, TestAlignmentAddition)
+{
+    ThreadPool thread_pool(2);
+    AlignerCPU aligner(10, 10, 3, AlignmentType::global_alignment, thread_pool, 0);
+    ASSERT_EQ(StatusType::success, aligner.add_alignment("ATCG", 4, "TACG", 4, false, false));
+    ASSERT_EQ(StatusType::exceeded_max_length, aligner.add_alignment("ATCGATTACGC", 11, "TACG", 4, false, false));
+    ASSERT_EQ(StatusType::exceeded_max_length, aligner.add_alignment("ATCG", 4, "ATACGTAGCGA", 11, false, false));
+    ASSERT_EQ(StatusType::success, aligner.add_alignment("ATCG", 4, "TACG", 4, false, false));
+    ASSERT_EQ(StatusType::success, aligner.add_alignment("ATCG", 4, "TACG", 4, false, false));
+    ASSERT_EQ(StatusType::exceeded_max_alignments, aligner.add_alignment("ATCG", 4, "TACG", 4, false, false));
+    ASSERT_EQ(3, aligner.num_alignments());
+
+    aligner.reset();
+    ASSERT_EQ(0, aligner.num_alignments());
+}
+
+TEST(TestAlignerCPU, TestAlignBatch)
+{
+    ThreadPool thread_pool(4);
+    const std::vector<std::pair<std::string, std::string>> inputs = {{"AAAA", "TTAT"}, {"ATAAAAAAAA", "AAAAAAAAA"}, {"AAAAAAAAA", "ATAAAAAAAA"}, {"ACTGA", "GCTAG"}, {"ACTG", "ACTG"}, {"A", "T"}};
+    const std::vector<std::string> cigars                         = {"4M", "1M1D8M", "1M1I8M", "3M1D1M1I", "4M", "1M"};
+    const std::vector<int32_t> edit_distances                     = {3, 1, 1, 3, 0, 1};
+
+    std::unique_ptr<Aligner> aligner = create_cpu_aligner(10, 10, get_size<int32_t>(inputs), AlignmentType::global_alignment, thread_pool);
+    for (const auto& input : inputs)
+    {
+        ASSERT_EQ(StatusType::success, aligner->add_alignment(input.first.c_str(), get_size<int32_t>(input.first), input.second.c_str(), get_size<int32_t>(input.second)));
+    }
+    aligner->align_all();
+    aligner->sync_alignments();
+
+    const std::vector<std::shared_ptr<Alignment>>& alignments = aligner->get_alignments();
+    ASSERT_EQ(get_size(inputs), get_size(alignments));
+    for (int32_t a = 0; a < get_size<int32_t>(alignments); ++a)
+    {
+        EXPECT_EQ(StatusType::success, alignments[a]->get_status());
+        EXPECT_EQ(AlignmentType::global_alignment, alignments[a]->get_alignment_type());
+        EXPECT_TRUE(alignments[a]->is_optimal());
+        EXPECT_EQ(cigars[a], alignments[a]->convert_to_cigar()) << "index: " << a;
+        EXPECT_EQ(edit_distances[a], alignments[a]->get_edit_distance()) << "index: " << a;
+    }
+}
+
+TEST(TestAlignerCPU, TestRunLengthResultsModeIsNotSupported)
+{
+    ThreadPool thread_pool(1);
+    std::unique_ptr<Aligner> aligner = create_cpu_aligner(10, 10, 1, AlignmentType::global_alignment, thread_pool);
+    EXPECT_EQ(StatusType::generic_error, aligner->set_results_mode(AlignmentResultsMode::run_length));
+    EXPECT_EQ(StatusType::success, aligner->set_results_mode(AlignmentResultsMode::alignment_objects));
+
+    ASSERT_EQ(StatusType::success, aligner->add_alignment("ACTGA", 5, "GCTAG", 5));
+    aligner->align_all();
+    aligner->sync_alignments();
+    ASSERT_EQ(1u, aligner->get_alignments().size());
+    EXPECT_EQ("3M1D1M1I", aligner->get_alignments()[0]->convert_to_cigar());
+    EXPECT_EQ(0, aligner->get_run_length_alignments().size());
+}
+
+TEST(TestAlignerCPU, TestTaskExceptionsAreReturnedAsStatus)
+{
+    ThreadPool thread_pool(2);
+    ThrowingAlignerCPU aligner(thread_pool);
+    ASSERT_EQ(StatusType::success, aligner.add_alignment("ACTGA", 5, "GCTAG", 5, false, false));
+    ASSERT_EQ(StatusType::success, aligner.add_alignment("AAAA", 4, "TTAT", 4, false, false));
+    EXPECT_EQ(StatusType::success, aligner.align_all());
+    EXPECT_EQ(StatusType::generic_error, aligner.sync_alignments());
+
+    // the aligner can be reused after the error
+    aligner.reset();
+    EXPECT_EQ(StatusType::success, aligner.sync_alignments());
+}
+
+TEST(TestAlignerCPU, TestReverseComplement)
+{
+    ThreadPool thread_pool(1);
+    AlignerCPU aligner(10, 10, 1, AlignmentType::global_alignment, thread_pool, 0);
+    ASSERT_EQ(StatusType::success, aligner.add_alignment("AACG", 4, "AACG", 4, true, false));
+    aligner.align_all();
+    aligner.sync_alignments();
+    EXPECT_EQ("CGTT", aligner.get_alignments()[0]->get_query_sequence());
+    EXPECT_EQ(4, aligner.get_alignments()[0]->get_edit_distance());
+}
+
+TEST(TestAlignerCPU, TestSemiGlobalAlignmentAgainstNaive)
+{
+    std::minstd_rand rng(11);
+    const std::vector<int32_t> lengths = {1, 20, 63, 64, 65, 150, 300};
+    for (const int32_t length : lengths)
+    {
+        const std::string flank_left  = genomeutils::generate_random_genome(length / 2 + 1, rng);
+        const std::string flank_right = genomeutils::generate_random_genome(length + 3, rng);
+        const std::string query       = genomeutils::generate_random_genome(length, rng);
+        const std::string target      = flank_left + genomeutils::generate_random_sequence(query, rng, length / 10 + 1, length / 10 + 1, length / 10 + 1) + flank_right;
+
+        AlignedInterval interval                    = {-1, -1, -1, -1};
+        const std::vector<AlignmentState> alignment = myers_compute_semi_global_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target), interval);
+
+        EXPECT_EQ(0, interval.query_start);
+        EXPECT_EQ(get_size<int32_t>(query), interval.query_end);
+        check_alignment_is_consistent(query, target.substr(interval.target_start, interval.target_end - interval.target_start), alignment);
+        EXPECT_EQ(semi_global_edit_distance_naive(query, target), count_edits(alignment)) << "length " << length;
+    }
+}
+
+TEST(TestAlignerCPU, TestXDropExtension)
+{
+    const std::string shared = "ACGTTGCAAGCTAGCATTAC";
+    const std::string query  = shared + "AAAAAAAAAAAAAAAAAAAA";
+    const std::string target = shared + "CCCCCCCCCCCCCCCCCCCC";
+
+    AlignedInterval interval                    = {-1, -1, -1, -1};
+    const std::vector<AlignmentState> alignment = xdrop_extend_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target), 5, interval);
+    EXPECT_EQ(0, interval.query_start);
+    EXPECT_EQ(get_size<int32_t>(shared), interval.query_end);
+    EXPECT_EQ(0, interval.target_start);
+    EXPECT_EQ(get_size<int32_t>(shared), interval.target_end);
+    EXPECT_EQ(std::vector<AlignmentState>(shared.size(), AlignmentState::match), alignment);
+
+    // an insertion in the target costs less than the drop and is bridged
+    const std::string target_with_insertion  = shared.substr(0, 10) + "G" + shared.substr(10);
+    const std::vector<AlignmentState> gapped = xdrop_extend_cpu(shared.data(), get_size<int32_t>(shared), target_with_insertion.data(), get_size<int32_t>(target_with_insertion), 5, interval);
+    EXPECT_EQ(get_size<int32_t>(shared), interval.query_end);
+    EXPECT_EQ(get_size<int32_t>(target_with_insertion), interval.target_end);
+    check_alignment_is_consistent(shared, target_with_insertion, gapped);
+    EXPECT_EQ(1, count_edits(gapped));
+
+    EXPECT_TRUE(xdrop_extend_cpu("A", 1, "C", 1, 0, interval).empty());
+    EXPECT_EQ(0, interval.query_end);
+    EXPECT_EQ(0, interval.target_end);
+}
+
+TEST(TestAlignerCPU, TestSemiGlobalAndExtensionBatch)
+{
+    ThreadPool thread_pool(2);
+    std::unique_ptr<Aligner> semi_global = create_cpu_aligner(20, 20, 1, AlignmentType::semi_global_alignment, thread_pool);
+    ASSERT_EQ(StatusType::success, semi_global->add_alignment("ACGT", 4, "TTTACGTTT", 9));
+    semi_global->align_all();
+    semi_global->sync_alignments();
+    const std::shared_ptr<Alignment>& semi_global_alignment = semi_global->get_alignments()[0];
+    EXPECT_EQ(AlignmentType::semi_global_alignment, semi_global_alignment->get_alignment_type());
+    EXPECT_EQ("4M", semi_global_alignment->convert_to_cigar());
+    EXPECT_EQ(3, semi_global_alignment->get_aligned_interval().target_start);
+    EXPECT_EQ(7, semi_global_alignment->get_aligned_interval().target_end);
+
+    std::unique_ptr<Aligner> extension = create_cpu_aligner(20, 20, 1, AlignmentType::extension_alignment, thread_pool, 2);
+    ASSERT_EQ(StatusType::success, extension->add_alignment("ACGTAAAAAA", 10, "ACGTCCCCCC", 10));
+    extension->align_all();
+    extension->sync_alignments();
+    const std::shared_ptr<Alignment>& extension_alignment = extension->get_alignments()[0];
+    EXPECT_EQ(AlignmentType::extension_alignment, extension_alignment->get_alignment_type());
+    EXPECT_EQ("4M", extension_alignment->convert_to_cigar());
+    EXPECT_EQ(4, extension_alignment->get_aligned_interval().query_end);
+    EXPECT_EQ(4, extension_alignment->get_aligned_interval().target_end);
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
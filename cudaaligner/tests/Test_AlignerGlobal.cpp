@@ -316,6 +316,51 @@ TEST_P(TestAlignerGlobal, TestAlignmentKernel)
 
 INSTANTIATE_TEST_SUITE_P(TestCudaAligner, TestAlignerGlobal, ::testing::ValuesIn(create_aligner_test_cases()));
 
+// Test that the adaptive band aligner finds the same alignments as an aligner using the full band
+TEST(TestCudaAligner, TestAdaptiveBandAligner)
+{
+    DefaultDeviceAllocator allocator = create_default_device_allocator();
+    std::minstd_rand rng(7);
+    std::vector<std::pair<std::string, std::string>> inputs;
+    for (int32_t i = 0; i < 64; ++i)
+    {
+        // every other pair has a length difference which does not fit into the initial band
+        const int32_t length     = 200 + 13 * i;
+        const std::string target = genomeutils::generate_random_genome(length, rng);
+        const std::string query  = genomeutils::generate_random_sequence(i % 2 == 0 ? target : target.substr(0, length - 40 - i), rng, 5, 5, 5);
+        inputs.emplace_back(query, target);
+    }
+
+    std::unique_ptr<AdaptiveBandAligner> adaptive_aligner = create_adaptive_band_aligner(AlignmentType::global_alignment, 16, 1024, nullptr, 0, allocator, -1);
+    std::unique_ptr<Aligner> reference_aligner            = std::make_unique<AlignerGlobalMyersBanded>(-1, 1024, allocator, nullptr, 0);
+    for (auto& pair : inputs)
+    {
+        ASSERT_EQ(StatusType::success, adaptive_aligner->add_alignment(pair.first.c_str(), get_size<int32_t>(pair.first), pair.second.c_str(), get_size<int32_t>(pair.second)));
+        ASSERT_EQ(StatusType::success, reference_aligner->add_alignment(pair.first.c_str(), get_size<int32_t>(pair.first), pair.second.c_str(), get_size<int32_t>(pair.second)));
+    }
+    adaptive_aligner->align_all();
+    adaptive_aligner->sync_alignments();
+    reference_aligner->align_all();
+    reference_aligner->sync_alignments();
+
+    const BandRetryStatistics statistics = adaptive_aligner->get_band_retry_statistics();
+    EXPECT_EQ(get_size<int32_t>(inputs), statistics.number_of_alignments);
+    EXPECT_GE(statistics.number_of_retried_alignments, get_size<int32_t>(inputs) / 2);
+    EXPECT_GE(statistics.number_of_retries, statistics.number_of_retried_alignments);
+    EXPECT_GT(statistics.number_of_rounds, 0);
+    EXPECT_EQ(0, statistics.number_of_failed_alignments);
+
+    const std::vector<std::shared_ptr<Alignment>>& alignments           = adaptive_aligner->get_alignments();
+    const std::vector<std::shared_ptr<Alignment>>& reference_alignments = reference_aligner->get_alignments();
+    ASSERT_EQ(get_size(reference_alignments), get_size(alignments));
+    for (int32_t a = 0; a < get_size(alignments); ++a)
+    {
+        EXPECT_EQ(StatusType::success, alignments[a]->get_status()) << "index: " << a;
+        EXPECT_TRUE(alignments[a]->is_optimal()) << "index: " << a;
+        EXPECT_EQ(reference_alignments[a]->get_edit_distance(), alignments[a]->get_edit_distance()) << "index: " << a;
+    }
+}
+
 TEST_P(TestAlignerGlobalImplPerf, TestAlignmentKernelPerf)
 {
     AlignerTestData param                                          = GetParam();
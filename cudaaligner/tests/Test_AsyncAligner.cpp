@@ -0,0 +1,218 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "../src/myers_alignment_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/async_aligner.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <stdexcept>
+#include "gtest/gtest.h"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+int32_t count_edits(const std::vector<AlignmentState>& alignment)
+{
+    return static_cast<int32_t>(std::count_if(begin(alignment), end(alignment), [](AlignmentState s) { return s != AlignmentState::match; }));
+}
+
+/// Aligner which forwards to a CPU aligner and throws from add_alignment() for the given call or from reset() for the first call
+class ThrowingAligner : public Aligner
+{
+public:
+    ThrowingAligner(ThreadPool& thread_pool, const int32_t throwing_add_alignment_call, const bool throw_on_first_reset)
+        : aligner_(create_cpu_aligner(16, 16, 4, AlignmentType::global_alignment, thread_pool))
+        , remaining_add_alignment_calls_(throwing_add_alignment_call)
+        , throw_on_reset_(throw_on_first_reset)
+    {
+    }
+
+    StatusType align_all() override { return aligner_->align_all(); }
+
+    StatusType sync_alignments() override { return aligner_->sync_alignments(); }
+
+    StatusType add_alignment(const char* query, int32_t query_length, const char* target, int32_t target_length,
+                             bool reverse_complement_query, bool reverse_complement_target) override
+    {
+        if (remaining_add_alignment_calls_-- == 0)
+        {
+            throw std::runtime_error("add_alignment failed");
+        }
+        return aligner_->add_alignment(query, query_length, target, target_length, reverse_complement_query, reverse_complement_target);
+    }
+
+    const std::vector<std::shared_ptr<Alignment>>& get_alignments() const override { return aligner_->get_alignments(); }
+
+    StatusType set_results_mode(AlignmentResultsMode mode) override { return aligner_->set_results_mode(mode); }
+
+    const RunLengthAlignments& get_run_length_alignments() const override { return aligner_->get_run_length_alignments(); }
+
+    void reset() override
+    {
+        aligner_->reset();
+        if (throw_on_reset_)
+        {
+            throw_on_reset_ = false;
+            throw 42; // not derived from std::exception
+        }
+    }
+
+private:
+    std::unique_ptr<Aligner> aligner_;
+    int32_t remaining_add_alignment_calls_;
+    bool throw_on_reset_;
+};
+
+} // namespace
+
+TEST(TestAsyncAligner, TestFuturesMatchSynchronousResults)
+{
+    ThreadPool thread_pool(2);
+    std::minstd_rand rng(7);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        const std::string target = genomeutils::generate_random_genome(100 + i, rng);
+        pairs.emplace_back(genomeutils::generate_random_sequence(target, rng, 3, 3, 3), target);
+    }
+
+    std::vector<std::future<std::shared_ptr<Alignment>>> futures;
+    {
+        AsyncAligner aligner([&thread_pool]() { return create_cpu_aligner(200, 200, 8, AlignmentType::global_alignment, thread_pool); }, 8);
+        for (const auto& pair : pairs)
+        {
+            futures.push_back(aligner.submit(pair.first.data(), get_size<int32_t>(pair.first), pair.second.data(), get_size<int32_t>(pair.second)));
+        }
+        aligner.wait();
+        for (int32_t i = 0; i < get_size<int32_t>(pairs); ++i)
+        {
+            ASSERT_EQ(std::future_status::ready, futures[i].wait_for(std::chrono::seconds(0)));
+            const std::shared_ptr<Alignment> alignment = futures[i].get();
+            EXPECT_EQ(pairs[i].first, alignment->get_query_sequence());
+            EXPECT_EQ(pairs[i].second, alignment->get_target_sequence());
+            EXPECT_EQ(count_edits(myers_compute_alignment_cpu(pairs[i].first.data(), get_size<int32_t>(pairs[i].first), pairs[i].second.data(), get_size<int32_t>(pairs[i].second))),
+                      alignment->get_edit_distance());
+        }
+    }
+}
+
+TEST(TestAsyncAligner, TestCallbacksAndBackpressure)
+{
+    ThreadPool thread_pool(2);
+    std::atomic<int32_t> completed(0);
+    std::atomic<int32_t> failed(0);
+    {
+        // the queue holds fewer alignments than a batch, full queues are aligned in partial batches
+        AsyncAligner aligner([&thread_pool]() { return create_cpu_aligner(16, 16, 4, AlignmentType::global_alignment, thread_pool); }, 4, 3, 2, thread_pool);
+        for (int32_t i = 0; i < 100; ++i)
+        {
+            aligner.submit("ACGTACGT", 8, "ACGAACGT", 8, false, false, [&completed](StatusType status, std::shared_ptr<Alignment> alignment) {
+                EXPECT_EQ(StatusType::success, status);
+                EXPECT_EQ(1, alignment->get_edit_distance());
+                ++completed;
+            });
+        }
+        // the sequences exceed the maximal length of the aligners
+        aligner.submit("ACGTACGTACGTACGTACGT", 20, "ACGT", 4, false, false, [&failed](StatusType status, std::shared_ptr<Alignment> alignment) {
+            EXPECT_EQ(StatusType::exceeded_max_length, status);
+            EXPECT_EQ(nullptr, alignment);
+            ++failed;
+        });
+        // the destructor waits for all alignments
+    }
+    EXPECT_EQ(100, completed);
+    EXPECT_EQ(1, failed);
+}
+
+TEST(TestAsyncAligner, TestFailedFutureAndInvalidArguments)
+{
+    ThreadPool thread_pool(1);
+    const AsyncAligner::AlignerFactory create_aligner = [&thread_pool]() { return create_cpu_aligner(4, 4, 2, AlignmentType::global_alignment, thread_pool); };
+    // the engine and the alignments of its aligner share the only thread of the pool
+    AsyncAligner aligner(create_aligner, 2, 1, -1, thread_pool);
+    std::future<std::shared_ptr<Alignment>> too_long = aligner.submit("ACGTACGT", 8, "ACGT", 4);
+    std::future<std::shared_ptr<Alignment>> fits     = aligner.submit("ACGT", 4, "ACGT", 4);
+    EXPECT_THROW(too_long.get(), std::runtime_error);
+    EXPECT_EQ("4M", fits.get()->convert_to_cigar());
+
+    EXPECT_THROW(AsyncAligner(create_aligner, 0), std::invalid_argument);
+    EXPECT_THROW(AsyncAligner(create_aligner, 2, 0), std::invalid_argument);
+    EXPECT_THROW(AsyncAligner(create_aligner, 2, 2, 0), std::invalid_argument);
+}
+
+TEST(TestAsyncAligner, TestEveryRequestIsReportedOnceIfTheAlignerThrows)
+{
+    ThreadPool thread_pool(1);
+    {
+        // reset() throws after the results of the first batch have been handed out, they must not be reported again
+        AsyncAligner aligner([&thread_pool]() { return std::make_unique<ThrowingAligner>(thread_pool, -1, true); }, 4, 1, -1, thread_pool);
+        std::vector<std::future<std::shared_ptr<Alignment>>> futures;
+        for (int32_t i = 0; i < 8; ++i)
+        {
+            futures.push_back(aligner.submit("ACGT", 4, "ACGT", 4));
+        }
+        aligner.wait();
+        for (std::future<std::shared_ptr<Alignment>>& future : futures)
+        {
+            EXPECT_EQ("4M", future.get()->convert_to_cigar());
+        }
+    }
+    {
+        // add_alignment() throws for the second request, the others of the batch fail once and the next batch succeeds
+        std::vector<std::atomic<int32_t>> reported(8);
+        std::vector<StatusType> statuses(8, StatusType::success);
+        for (std::atomic<int32_t>& r : reported)
+        {
+            r = 0;
+        }
+        AsyncAligner aligner([&thread_pool]() { return std::make_unique<ThrowingAligner>(thread_pool, 1, false); }, 4, 1, -1, thread_pool);
+        for (int32_t i = 0; i < 8; ++i)
+        {
+            aligner.submit("ACGT", 4, "ACGT", 4, false, false, [&reported, &statuses, i](StatusType status, std::shared_ptr<Alignment>) {
+                statuses[i] = status;
+                ++reported[i];
+            });
+        }
+        aligner.wait();
+        for (int32_t i = 0; i < 8; ++i)
+        {
+            EXPECT_EQ(1, reported[i]) << i;
+            EXPECT_EQ(i < 4 ? StatusType::generic_error : StatusType::success, statuses[i]) << i;
+        }
+    }
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,152 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "../src/edit_distance_cpu.hpp"
+#include "../src/needleman_wunsch_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/edit_distance.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+
+#include <random>
+#include "gtest/gtest.h"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+class TestEditDistanceCPU : public ::testing::TestWithParam<InstructionSet>
+{
+};
+
+TEST_P(TestEditDistanceCPU, TestAgainstNeedlemanWunsch)
+{
+    const InstructionSet instruction_set = GetParam();
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        GTEST_SKIP() << "instruction set not supported on this machine";
+    }
+
+    // lengths below, at and above word boundaries, mixed so that lanes of one group differ in length
+    std::minstd_rand rng(3);
+    const std::vector<int32_t> lengths = {1, 7, 63, 64, 65, 100, 127, 128, 129, 300, 1000, 2, 64, 500, 33, 0};
+    std::vector<std::string> queries;
+    std::vector<std::string> targets;
+    for (const int32_t length : lengths)
+    {
+        targets.push_back(genomeutils::generate_random_genome(length, rng));
+        queries.push_back(length == 0 ? std::string() : genomeutils::generate_random_sequence(targets.back(), rng, length / 10 + 1, length / 10 + 1, length / 10 + 1));
+    }
+    // unrelated sequences of different lengths
+    targets.push_back(genomeutils::generate_random_genome(200, rng));
+    queries.push_back(genomeutils::generate_random_genome(70, rng));
+    targets.push_back("");
+    queries.push_back("ACGT");
+
+    std::vector<EditDistanceInput> inputs;
+    for (std::size_t i = 0; i < queries.size(); ++i)
+    {
+        inputs.push_back({queries[i].data(), get_size<int32_t>(queries[i]), targets[i].data(), get_size<int32_t>(targets[i])});
+    }
+
+    const std::vector<int32_t> distances = myers_compute_edit_distances_cpu(inputs, instruction_set);
+    ASSERT_EQ(inputs.size(), distances.size());
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        const matrix<int> scores = needleman_wunsch_build_score_matrix_naive(targets[i], queries[i]);
+        EXPECT_EQ(scores(scores.num_rows() - 1, scores.num_cols() - 1), distances[i]) << "index " << i;
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TestEditDistanceCPU, TestEditDistanceCPU, ::testing::Values(InstructionSet::scalar, InstructionSet::avx2, InstructionSet::avx512));
+
+TEST(TestEditDistanceCPU, TestSinglePair)
+{
+    EXPECT_EQ(3, myers_compute_edit_distance_cpu("AAAA", 4, "TTAT", 4));
+    EXPECT_EQ(1, myers_compute_edit_distance_cpu("ATAAAAAAAA", 10, "AAAAAAAAA", 9));
+    EXPECT_EQ(0, myers_compute_edit_distance_cpu("ACTG", 4, "ACTG", 4));
+    EXPECT_EQ(3, myers_compute_edit_distance_cpu("", 0, "ACT", 3));
+}
+
+TEST(TestEditDistanceCPU, TestBoundedEditDistanceAgainstNeedlemanWunsch)
+{
+    std::minstd_rand rng(5);
+    for (int32_t length : {1, 10, 63, 64, 65, 130, 400, 1000})
+    {
+        for (int32_t mutations : {0, 1, length / 20 + 1, length / 5 + 1})
+        {
+            const std::string target = genomeutils::generate_random_genome(length, rng);
+            const std::string query  = genomeutils::generate_random_sequence(target, rng, mutations, mutations, mutations);
+            const matrix<int> scores = needleman_wunsch_build_score_matrix_naive(target, query);
+            const int32_t distance   = scores(scores.num_rows() - 1, scores.num_cols() - 1);
+            for (int32_t max_distance : {0, distance / 2, distance - 1, distance, distance + 1, 2 * distance + 10})
+            {
+                if (max_distance < 0)
+                    continue;
+                EXPECT_EQ(distance <= max_distance ? distance : edit_distance_exceeds_max,
+                          myers_compute_bounded_edit_distance_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target), max_distance))
+                    << "length " << length << ", distance " << distance << ", max_distance " << max_distance;
+            }
+        }
+    }
+}
+
+TEST(TestEditDistanceCPU, TestBoundedEditDistanceEdgeCases)
+{
+    EXPECT_EQ(0, myers_compute_bounded_edit_distance_cpu("", 0, "", 0, 0));
+    EXPECT_EQ(2, myers_compute_bounded_edit_distance_cpu("", 0, "AC", 2, 2));
+    EXPECT_EQ(edit_distance_exceeds_max, myers_compute_bounded_edit_distance_cpu("", 0, "AC", 2, 1));
+    EXPECT_EQ(edit_distance_exceeds_max, myers_compute_bounded_edit_distance_cpu("ACGTACGT", 8, "A", 1, 6));
+    EXPECT_EQ(7, myers_compute_bounded_edit_distance_cpu("ACGTACGT", 8, "A", 1, 7));
+}
+
+TEST(TestEditDistanceCPU, TestComputeEditDistances)
+{
+    ThreadPool thread_pool(3);
+    std::minstd_rand rng(11);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        std::string target = genomeutils::generate_random_genome(50 + 7 * i, rng);
+        std::string query  = genomeutils::generate_random_sequence(target, rng, i % 7, i % 5, i % 3);
+        pairs.emplace_back(std::move(query), std::move(target));
+    }
+
+    const std::vector<int32_t> exact   = compute_edit_distances(pairs, -1, thread_pool);
+    const std::vector<int32_t> bounded = compute_edit_distances(pairs, 5, thread_pool);
+    ASSERT_EQ(pairs.size(), exact.size());
+    ASSERT_EQ(pairs.size(), bounded.size());
+    for (std::size_t i = 0; i < pairs.size(); ++i)
+    {
+        const matrix<int> scores = needleman_wunsch_build_score_matrix_naive(pairs[i].second, pairs[i].first);
+        const int32_t distance   = scores(scores.num_rows() - 1, scores.num_cols() - 1);
+        EXPECT_EQ(distance, exact[i]) << "index " << i;
+        EXPECT_EQ(distance <= 5 ? distance : edit_distance_exceeds_max, bounded[i]) << "index " << i;
+    }
+
+    EXPECT_TRUE(compute_edit_distances({}, 3, thread_pool).empty());
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,98 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include <claraparabricks/genomeworks/cudaaligner/run_length_alignments.hpp>
+
+#include "../src/alignment_impl.hpp"
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include "gtest/gtest.h"
+#include <iterator>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+TEST(TestRunLengthAlignments, EncodeRun)
+{
+    const uint32_t run = RunLengthAlignments::encode_run(AlignmentState::deletion, 12345);
+    EXPECT_EQ(AlignmentState::deletion, RunLengthAlignments::get_run_state(run));
+    EXPECT_EQ(12345, RunLengthAlignments::get_run_length(run));
+
+    const uint32_t longest = RunLengthAlignments::encode_run(AlignmentState::mismatch, RunLengthAlignments::max_run_length);
+    EXPECT_EQ(AlignmentState::mismatch, RunLengthAlignments::get_run_state(longest));
+    EXPECT_EQ(RunLengthAlignments::max_run_length, RunLengthAlignments::get_run_length(longest));
+}
+
+TEST(TestRunLengthAlignments, MatchesAlignmentImpl)
+{
+    const std::vector<AlignmentState> states = {AlignmentState::match, AlignmentState::match, AlignmentState::mismatch, AlignmentState::match,
+                                                AlignmentState::insertion, AlignmentState::insertion, AlignmentState::match, AlignmentState::deletion};
+    AlignmentImpl alignment("AAAAAA", 6, "AACATTA", 7);
+    alignment.set_alignment(states, true);
+
+    RunLengthAlignments alignments;
+    alignments.add_alignment(begin(states), end(states), true, AlignedInterval{0, 6, 0, 7});
+    ASSERT_EQ(1, alignments.size());
+    EXPECT_EQ(StatusType::success, alignments.get_status(0));
+    EXPECT_TRUE(alignments.is_optimal(0));
+    EXPECT_EQ(6, alignments.get_number_of_runs(0));
+    EXPECT_EQ(states, alignments.get_alignment(0));
+    EXPECT_EQ(alignment.convert_to_cigar(), alignments.convert_to_cigar(0));
+    EXPECT_EQ("4M2I1M1D", alignments.convert_to_cigar(0));
+    EXPECT_EQ("2=1X1=2I1=1D", alignments.convert_to_extended_cigar(0));
+    EXPECT_EQ(alignment.get_edit_distance(), alignments.get_edit_distance(0));
+    EXPECT_EQ(7, alignments.get_aligned_interval(0).target_end);
+}
+
+TEST(TestRunLengthAlignments, MultipleAlignments)
+{
+    // results of the GPU aligners are stored in reverse order as int8_t
+    const std::vector<int8_t> reversed = {AlignmentState::deletion, AlignmentState::match, AlignmentState::match};
+    const std::vector<AlignmentState> empty;
+
+    RunLengthAlignments alignments;
+    alignments.add_alignment(reversed.rbegin(), reversed.rend(), false, AlignedInterval{0, 3, 0, 2});
+    alignments.add_empty_alignment(StatusType::uninitialized);
+    alignments.add_alignment(begin(empty), end(empty), true, AlignedInterval{0, 0, 0, 0});
+
+    ASSERT_EQ(3, alignments.size());
+    EXPECT_FALSE(alignments.is_optimal(0));
+    EXPECT_EQ("2M1D", alignments.convert_to_cigar(0));
+    EXPECT_EQ(StatusType::uninitialized, alignments.get_status(1));
+    EXPECT_EQ(0, alignments.get_number_of_runs(1));
+    EXPECT_EQ(StatusType::success, alignments.get_status(2));
+    EXPECT_EQ("", alignments.convert_to_cigar(2));
+    EXPECT_EQ(0, alignments.get_edit_distance(2));
+
+    alignments.clear();
+    EXPECT_EQ(0, alignments.size());
+    alignments.add_alignment(reversed.begin(), reversed.end(), true, AlignedInterval{0, 3, 0, 2});
+    EXPECT_EQ("1D2M", alignments.convert_to_cigar(0));
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
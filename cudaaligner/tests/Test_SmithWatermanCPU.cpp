@@ -0,0 +1,215 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "../src/smith_waterman_cpu.hpp"
+#include "../src/affine_gap_alignment_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
+#include <claraparabricks/genomeworks/cudaaligner/local_alignment.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+
+#include <algorithm>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+// Gotoh's local algorithm on the full matrices, column by column like the striped kernel
+LocalAlignmentScore smith_waterman_score_naive(const std::string& query, const std::string& target, const AffineGapScores& scores)
+{
+    const int32_t m = get_size<int32_t>(query);
+    const int32_t n = get_size<int32_t>(target);
+    std::vector<int32_t> h(m + 1, 0);
+    std::vector<int32_t> f(m + 1, 0);
+    LocalAlignmentScore best = {0, 0, 0};
+    for (int32_t j = 1; j <= n; ++j)
+    {
+        int32_t diagonal = 0;
+        int32_t e        = 0;
+        for (int32_t i = 1; i <= m; ++i)
+        {
+            e                  = std::max(e + scores.gap_extend, h[i - 1] + scores.gap_open + scores.gap_extend);
+            f[i]               = std::max(f[i] + scores.gap_extend, h[i] + scores.gap_open + scores.gap_extend);
+            const int32_t left = h[i];
+            h[i]               = std::max({0, diagonal + (query[i - 1] == target[j - 1] ? scores.match : scores.mismatch), e, f[i]});
+            diagonal           = left;
+            if (h[i] > best.score)
+            {
+                best = {h[i], i, j};
+            }
+        }
+    }
+    return best;
+}
+
+// plants a mutated copy of the query's middle into random flanks of the target
+std::pair<std::string, std::string> generate_local_pair(const int32_t length, std::minstd_rand& rng)
+{
+    const std::string query  = genomeutils::generate_random_genome(length, rng);
+    const std::string core   = genomeutils::generate_random_sequence(query.substr(length / 4, length / 2), rng, length / 20 + 1, length / 40 + 1, length / 40 + 1);
+    const std::string target = genomeutils::generate_random_genome(length / 3, rng) + core + genomeutils::generate_random_genome(length / 5, rng);
+    return {query, target};
+}
+
+} // namespace
+
+class TestSmithWatermanCPU : public ::testing::TestWithParam<InstructionSet>
+{
+};
+
+TEST_P(TestSmithWatermanCPU, TestAgainstGotoh)
+{
+    const InstructionSet instruction_set = GetParam();
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        GTEST_SKIP() << "instruction set not supported on this machine";
+    }
+
+    std::minstd_rand rng(3);
+    const std::vector<AffineGapScores> scoring_schemes = {AffineGapScores(), {1, -1, 0, -1}, {5, -3, -12, -1}, {1000, -1000, -1000, -1000}};
+    const std::vector<int32_t> lengths                 = {1, 2, 7, 15, 16, 33, 100, 257, 600};
+    for (const AffineGapScores& scores : scoring_schemes)
+    {
+        for (const int32_t length : lengths)
+        {
+            const std::pair<std::string, std::string> sequences = generate_local_pair(length, rng);
+            const std::string& query                            = sequences.first;
+            const std::string& target                           = sequences.second;
+            const LocalAlignmentScore expected                  = smith_waterman_score_naive(query, target, scores);
+            const LocalAlignmentScore result                    = smith_waterman_compute_score_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                scores, instruction_set);
+            EXPECT_EQ(expected.score, result.score) << "length " << length;
+            EXPECT_EQ(expected.query_end, result.query_end) << "length " << length;
+            EXPECT_EQ(expected.target_end, result.target_end) << "length " << length;
+
+            AlignedInterval interval                    = {-1, -1, -1, -1};
+            const std::vector<AlignmentState> alignment = smith_waterman_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                               scores, interval, instruction_set);
+            EXPECT_EQ(expected.query_end, interval.query_end);
+            EXPECT_EQ(expected.target_end, interval.target_end);
+            EXPECT_EQ(expected.score, compute_affine_gap_score(alignment, scores)) << "length " << length;
+            int32_t query_bases  = 0;
+            int32_t target_bases = 0;
+            for (const AlignmentState s : alignment)
+            {
+                query_bases += (s == AlignmentState::insertion ? 0 : 1);
+                target_bases += (s == AlignmentState::deletion ? 0 : 1);
+                if (s == AlignmentState::match)
+                {
+                    EXPECT_EQ(query[interval.query_start + query_bases - 1], target[interval.target_start + target_bases - 1]);
+                }
+            }
+            EXPECT_EQ(interval.query_end - interval.query_start, query_bases);
+            EXPECT_EQ(interval.target_end - interval.target_start, target_bases);
+        }
+    }
+}
+
+TEST_P(TestSmithWatermanCPU, TestLargeScores)
+{
+    const InstructionSet instruction_set = GetParam();
+    if (!is_instruction_set_supported(instruction_set))
+    {
+        GTEST_SKIP() << "instruction set not supported on this machine";
+    }
+
+    // scores beyond the range of 16-bit integers
+    std::minstd_rand rng(11);
+    const AffineGapScores scores                        = {100, -150, -200, -100};
+    const std::pair<std::string, std::string> sequences = generate_local_pair(1500, rng);
+    const LocalAlignmentScore expected                  = smith_waterman_score_naive(sequences.first, sequences.second, scores);
+    const LocalAlignmentScore result                    = smith_waterman_compute_score_cpu(sequences.first.data(), get_size<int32_t>(sequences.first),
+                                                                        sequences.second.data(), get_size<int32_t>(sequences.second), scores, instruction_set);
+    ASSERT_GT(expected.score, std::numeric_limits<int16_t>::max());
+    EXPECT_EQ(expected.score, result.score);
+    EXPECT_EQ(expected.query_end, result.query_end);
+    EXPECT_EQ(expected.target_end, result.target_end);
+}
+
+INSTANTIATE_TEST_SUITE_P(TestSmithWatermanCPU, TestSmithWatermanCPU, ::testing::Values(InstructionSet::scalar, InstructionSet::avx2, InstructionSet::avx512));
+
+TEST(TestSmithWatermanCPU, TestNoPositiveScore)
+{
+    AlignedInterval interval = {-1, -1, -1, -1};
+    EXPECT_TRUE(smith_waterman_compute_alignment_cpu("AAAA", 4, "CCCCCC", 6, AffineGapScores(), interval).empty());
+    EXPECT_EQ(0, interval.query_start);
+    EXPECT_EQ(0, interval.query_end);
+    EXPECT_EQ(0, smith_waterman_compute_score_cpu("", 0, "ACGT", 4, AffineGapScores()).score);
+    EXPECT_EQ(0, smith_waterman_compute_score_cpu("ACGT", 4, "", 0, AffineGapScores()).score);
+    EXPECT_THROW(smith_waterman_compute_score_cpu("A", 1, "A", 1, {1, -1, 1, -1}), std::invalid_argument);
+}
+
+TEST(TestSmithWatermanCPU, TestAlignerBatch)
+{
+    ThreadPool thread_pool(2);
+    std::unique_ptr<Aligner> aligner = create_cpu_aligner(64, 64, 2, AlignmentType::local_alignment, AffineGapScores(), -1, thread_pool);
+    // an adapter at the end of a read
+    ASSERT_EQ(StatusType::success, aligner->add_alignment("AGATCGGAAGAGC", 13, "TTGCAGCTTACCGTAGATCGGAAGAGCACA", 30));
+    ASSERT_EQ(StatusType::success, aligner->add_alignment("AAAA", 4, "CCCC", 4));
+    aligner->align_all();
+    aligner->sync_alignments();
+
+    const std::vector<std::shared_ptr<Alignment>>& alignments = aligner->get_alignments();
+    ASSERT_EQ(2, get_size(alignments));
+    EXPECT_EQ(AlignmentType::local_alignment, alignments[0]->get_alignment_type());
+    EXPECT_EQ("13M", alignments[0]->convert_to_cigar());
+    const AlignedInterval interval = alignments[0]->get_aligned_interval();
+    EXPECT_EQ(0, interval.query_start);
+    EXPECT_EQ(13, interval.query_end);
+    EXPECT_EQ(14, interval.target_start);
+    EXPECT_EQ(27, interval.target_end);
+    EXPECT_TRUE(alignments[1]->get_alignment().empty());
+}
+
+TEST(TestSmithWatermanCPU, TestScoreScreening)
+{
+    ThreadPool thread_pool(3);
+    std::minstd_rand rng(17);
+    std::vector<std::pair<std::string, std::string>> pairs;
+    for (int32_t i = 0; i < 50; ++i)
+    {
+        pairs.push_back(generate_local_pair(20 + 7 * i, rng));
+    }
+    const AffineGapScores scores                   = {1, -1, 0, -1};
+    const std::vector<LocalAlignmentScore> results = compute_local_alignment_scores(pairs, scores, thread_pool);
+    ASSERT_EQ(get_size(pairs), get_size(results));
+    for (int32_t i = 0; i < get_size(pairs); ++i)
+    {
+        const LocalAlignmentScore expected = smith_waterman_score_naive(pairs[i].first, pairs[i].second, scores);
+        EXPECT_EQ(expected.score, results[i].score) << "pair " << i;
+        EXPECT_EQ(expected.query_end, results[i].query_end) << "pair " << i;
+        EXPECT_EQ(expected.target_end, results[i].target_end) << "pair " << i;
+    }
+    EXPECT_THROW(compute_local_alignment_scores(pairs, {1, 2, -1, -1}, thread_pool), std::invalid_argument);
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,198 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+
+#include "../src/wavefront_alignment_cpu.hpp"
+
+#include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include "gtest/gtest.h"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudaaligner
+{
+
+namespace
+{
+
+// Gotoh's algorithm on the full matrices minimizing the penalty, returns the optimal penalty
+int32_t wavefront_penalty_naive(const std::string& query, const std::string& target, const WavefrontPenalties& penalties)
+{
+    const int32_t infinity = std::numeric_limits<int32_t>::max() / 2;
+    const int32_t m        = get_size<int32_t>(query);
+    const int32_t n        = get_size<int32_t>(target);
+    std::vector<int32_t> h(n + 1, 0);
+    std::vector<int32_t> e(n + 1, infinity);
+    for (int32_t j = 1; j <= n; ++j)
+    {
+        h[j] = penalties.gap_open + j * penalties.gap_extend;
+    }
+    for (int32_t i = 1; i <= m; ++i)
+    {
+        int32_t diagonal = h[0];
+        int32_t f        = infinity;
+        h[0]             = penalties.gap_open + i * penalties.gap_extend;
+        for (int32_t j = 1; j <= n; ++j)
+        {
+            e[j]                = std::min(e[j], h[j] + penalties.gap_open) + penalties.gap_extend;
+            f                   = std::min(f, h[j - 1] + penalties.gap_open) + penalties.gap_extend;
+            const int32_t above = h[j];
+            h[j]                = std::min({diagonal + (query[i - 1] == target[j - 1] ? 0 : penalties.mismatch), e[j], f});
+            diagonal            = above;
+        }
+    }
+    return h[n];
+}
+
+void check_alignment_is_consistent(const std::string& query, const std::string& target, const std::vector<AlignmentState>& alignment)
+{
+    int32_t i = 0;
+    int32_t j = 0;
+    for (const AlignmentState s : alignment)
+    {
+        switch (s)
+        {
+        case AlignmentState::match:
+            ASSERT_EQ(query[i], target[j]) << "match at mismatching position " << i << ", " << j;
+            ++i;
+            ++j;
+            break;
+        case AlignmentState::mismatch:
+            ASSERT_NE(query[i], target[j]) << "mismatch at matching position " << i << ", " << j;
+            ++i;
+            ++j;
+            break;
+        case AlignmentState::insertion: ++j; break;
+        case AlignmentState::deletion: ++i; break;
+        }
+    }
+    EXPECT_EQ(get_size(query), i);
+    EXPECT_EQ(get_size(target), j);
+}
+
+} // namespace
+
+class TestWavefrontAlignmentCPU : public ::testing::TestWithParam<WavefrontMemoryMode>
+{
+};
+
+TEST_P(TestWavefrontAlignmentCPU, TestAgainstGotoh)
+{
+    const WavefrontMemoryMode memory_mode = GetParam();
+    std::minstd_rand rng(17);
+    const std::vector<WavefrontPenalties> penalty_schemes = {WavefrontPenalties(), {1, 0, 1}, {3, 10, 1}, {5, 0, 2}};
+    const std::vector<int32_t> lengths                    = {1, 2, 15, 100, 257, 600, 1500};
+    for (const WavefrontPenalties& penalties : penalty_schemes)
+    {
+        for (const int32_t length : lengths)
+        {
+            for (const int32_t errors : {0, length / 50 + 1, length / 8 + 1})
+            {
+                const std::string target = genomeutils::generate_random_genome(length, rng);
+                const std::string query  = genomeutils::generate_random_sequence(target, rng, errors, errors, errors);
+
+                const std::vector<AlignmentState> alignment = wavefront_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                              penalties, memory_mode);
+                check_alignment_is_consistent(query, target, alignment);
+                EXPECT_EQ(wavefront_penalty_naive(query, target, penalties), compute_wavefront_penalty(alignment, penalties))
+                    << "length " << length << ", errors " << errors << ", penalties " << penalties.mismatch << " " << penalties.gap_open << " " << penalties.gap_extend;
+            }
+        }
+    }
+}
+
+TEST_P(TestWavefrontAlignmentCPU, TestLongGapsAndDissimilarSequences)
+{
+    const WavefrontMemoryMode memory_mode = GetParam();
+    std::minstd_rand rng(3);
+    const WavefrontPenalties penalties;
+    const std::string prefix = genomeutils::generate_random_genome(400, rng);
+    const std::string suffix = genomeutils::generate_random_genome(400, rng);
+    const std::string gap    = genomeutils::generate_random_genome(300, rng);
+    const std::vector<std::pair<std::string, std::string>> pairs = {
+        {prefix + suffix, prefix + gap + suffix},
+        {prefix + gap + suffix, prefix + suffix},
+        {prefix, suffix},
+        {prefix + gap, gap.substr(0, 30)},
+    };
+    for (const auto& pair : pairs)
+    {
+        const std::string& query  = pair.first;
+        const std::string& target = pair.second;
+        const std::vector<AlignmentState> alignment = wavefront_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                      penalties, memory_mode);
+        check_alignment_is_consistent(query, target, alignment);
+        EXPECT_EQ(wavefront_penalty_naive(query, target, penalties), compute_wavefront_penalty(alignment, penalties));
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(TestWavefrontAlignmentCPU, TestWavefrontAlignmentCPU, ::testing::Values(WavefrontMemoryMode::full, WavefrontMemoryMode::bidirectional));
+
+TEST(TestWavefrontAlignmentCPU, TestEditDistancePenalties)
+{
+    const std::string query  = "ACGTACGTTTTTGGCCAACG";
+    const std::string target = "ACGTACGTGGCCAACG";
+    const std::vector<AlignmentState> alignment = wavefront_compute_alignment_cpu(query.data(), get_size<int32_t>(query), target.data(), get_size<int32_t>(target),
+                                                                                  {1, 0, 1}, WavefrontMemoryMode::full);
+    EXPECT_EQ(4, compute_wavefront_penalty(alignment, {1, 0, 1}));
+}
+
+TEST(TestWavefrontAlignmentCPU, TestEmptySequencesAndInvalidPenalties)
+{
+    for (const WavefrontMemoryMode memory_mode : {WavefrontMemoryMode::full, WavefrontMemoryMode::bidirectional})
+    {
+        EXPECT_TRUE(wavefront_compute_alignment_cpu("", 0, "", 0, WavefrontPenalties(), memory_mode).empty());
+        EXPECT_EQ(std::vector<AlignmentState>(3, AlignmentState::insertion), wavefront_compute_alignment_cpu("", 0, "ACG", 3, WavefrontPenalties(), memory_mode));
+        EXPECT_EQ(std::vector<AlignmentState>(2, AlignmentState::deletion), wavefront_compute_alignment_cpu("AC", 2, "", 0, WavefrontPenalties(), memory_mode));
+    }
+
+    EXPECT_THROW(validate_wavefront_penalties({0, 6, 2}), std::invalid_argument);
+    EXPECT_THROW(validate_wavefront_penalties({4, -1, 2}), std::invalid_argument);
+    EXPECT_THROW(validate_wavefront_penalties({4, 6, 0}), std::invalid_argument);
+}
+
+TEST(TestWavefrontAlignmentCPU, TestAlignerBatch)
+{
+    ThreadPool thread_pool(2);
+    std::unique_ptr<Aligner> aligner = create_wavefront_aligner(32, 32, 2, WavefrontPenalties(), WavefrontMemoryMode::bidirectional, thread_pool);
+    ASSERT_EQ(StatusType::success, aligner->add_alignment("ACGTTGCA", 8, "ACGTTGCA", 8));
+    ASSERT_EQ(StatusType::success, aligner->add_alignment("ACGTGCA", 7, "ACGTTGCA", 8));
+    aligner->align_all();
+    aligner->sync_alignments();
+
+    const std::vector<std::shared_ptr<Alignment>>& alignments = aligner->get_alignments();
+    EXPECT_EQ(AlignmentType::global_alignment, alignments[0]->get_alignment_type());
+    EXPECT_EQ("8M", alignments[0]->convert_to_cigar());
+    EXPECT_EQ(1, alignments[1]->get_edit_distance());
+    EXPECT_TRUE(alignments[1]->is_optimal());
+}
+
+} // namespace cudaaligner
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <iosfwd>
 #include <memory>
 #include <string>
 #include <vector>
@@ -99,6 +100,7 @@ public:
     /// \param hash_representations if true, hash kmer representations
     /// \param filtering_parameter filter out all representations for which number_of_sketch_elements_with_that_representation/total_skech_elements >= filtering_parameter, filtering_parameter == 1.0 disables filtering
     /// \param cuda_stream CUDA stream on which the work is to be done. Device arrays are also associated with this stream and will not be freed at least until all work issued on this stream before calling their destructor is done
+    /// \param dust_score_threshold leave out sketch elements overlapping low-complexity intervals with SDUST score above this value, 0 disables masking
     /// \return instance of Index
     static std::unique_ptr<Index>
     create_index(DefaultDeviceAllocator allocator,
@@ -107,9 +109,10 @@ public:
                  const read_id_t past_the_last_read_id,
                  const std::uint64_t kmer_size,
                  const std::uint64_t window_size,
-                 const bool hash_representations  = true,
-                 const double filtering_parameter = 1.0,
-                 const cudaStream_t cuda_stream   = 0);
+                 const bool hash_representations         = true,
+                 const double filtering_parameter        = 1.0,
+                 const cudaStream_t cuda_stream          = 0,
+                 const std::int32_t dust_score_threshold = 0);
 };
 
 /// IndexHostCopyBase - Creates and maintains a copy of computed IndexGPU elements on the host, then allows to retrieve target
@@ -172,6 +175,11 @@ public:
     /// \return window_size_
     virtual std::uint64_t window_size() const = 0;
 
+    /// \brief writes the index to a binary stream so it can later be loaded using load_cache()
+    /// \param output_stream stream to write to, should be opened in binary mode
+    /// \throw std::runtime_error if writing fails
+    virtual void save(std::ostream& output_stream) const = 0;
+
     /// \brief Constructor
     /// \brief creates a copy of input processed index on the host
     /// \param index - pointer to computed index parameters (vectors of sketch elements) on GPU
@@ -185,6 +193,13 @@ public:
                                                            const std::uint64_t kmer_size,
                                                            const std::uint64_t window_size,
                                                            const cudaStream_t cuda_stream = 0);
+
+    /// \brief Constructor
+    /// \brief loads a host copy of an index previously written by save()
+    /// \param input_stream stream to read from, should be opened in binary mode
+    /// \throw std::runtime_error if the stream does not contain a valid index
+    /// \return - an instance of IndexHostCopyBase
+    static std::unique_ptr<IndexHostCopyBase> load_cache(std::istream& input_stream);
 };
 
 } // namespace cudamapper
@@ -36,6 +36,19 @@ class FastaParser;
 namespace cudamapper
 {
 
+/// \brief formats overlaps in <a href="https://github.com/lh3/miniasm/blob/master/PAF.md">PAF format</a>
+/// \param overlaps vector of overlap objects
+/// \param cigars CIGAR strings. Empty vector if none exist
+/// \param query_parser needed for read names and lengths
+/// \param target_parser needed for read names and lengths
+/// \param kmer_size minimizer kmer size
+/// \return one line per overlap, each line ends with a new line
+std::string format_paf(const std::vector<Overlap>& overlaps,
+                       const std::vector<std::string>& cigars,
+                       const io::FastaParser& query_parser,
+                       const io::FastaParser& target_parser,
+                       int32_t kmer_size);
+
 /// \brief prints overlaps to stdout in <a href="https://github.com/lh3/miniasm/blob/master/PAF.md">PAF format</a>
 /// \param overlaps vector of overlap objects
 /// \param cigars CIGAR strings. Empty vector if none exist
@@ -0,0 +1,109 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "alignment_binning.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+std::int32_t get_query_length(const Overlap& overlap)
+{
+    return overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_;
+}
+
+std::int32_t get_target_length(const Overlap& overlap)
+{
+    return overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_;
+}
+
+std::int32_t get_overlap_length(const Overlap& overlap)
+{
+    return std::max(get_query_length(overlap), get_target_length(overlap));
+}
+
+} // namespace
+
+std::vector<AlignmentBin> bin_overlaps_by_length(const std::vector<Overlap>& overlaps,
+                                                 const float max_length_ratio,
+                                                 std::vector<std::int32_t>& overlap_order)
+{
+    if (max_length_ratio < 1.0f)
+    {
+        throw std::invalid_argument("max_length_ratio must be at least 1.");
+    }
+
+    overlap_order.resize(overlaps.size());
+    std::iota(std::begin(overlap_order), std::end(overlap_order), 0);
+    std::stable_sort(std::begin(overlap_order),
+                     std::end(overlap_order),
+                     [&overlaps](const std::int32_t a, const std::int32_t b) {
+                         return get_overlap_length(overlaps[a]) < get_overlap_length(overlaps[b]);
+                     });
+
+    std::vector<AlignmentBin> bins;
+    for (std::int32_t i = 0; i < get_size<std::int32_t>(overlap_order); ++i)
+    {
+        const Overlap& overlap = overlaps[overlap_order[i]];
+        // overlaps of length 0 are binned with those of length 1
+        if (bins.empty() || get_overlap_length(overlap) > max_length_ratio * std::max(get_overlap_length(overlaps[overlap_order[bins.back().begin]]), 1))
+        {
+            bins.push_back({i, i, 0, 0});
+        }
+        AlignmentBin& bin     = bins.back();
+        bin.end               = i + 1;
+        bin.max_query_length  = std::max(bin.max_query_length, get_query_length(overlap));
+        bin.max_target_length = std::max(bin.max_target_length, get_target_length(overlap));
+    }
+    return bins;
+}
+
+std::int32_t calc_alignment_batch_size(const std::int64_t available_memory,
+                                       const std::int64_t memory_per_alignment,
+                                       const std::int32_t num_alignment_engines,
+                                       const std::int32_t number_of_alignments)
+{
+    if (memory_per_alignment <= 0 || num_alignment_engines <= 0)
+    {
+        throw std::invalid_argument("memory_per_alignment and num_alignment_engines must be positive.");
+    }
+    const std::int64_t alignments_per_engine = available_memory / memory_per_alignment / num_alignment_engines;
+    // larger batches than the share of one engine would leave the other engines idle
+    const std::int64_t alignments_per_batch = std::min<std::int64_t>(alignments_per_engine,
+                                                                     (number_of_alignments + num_alignment_engines - 1) / num_alignment_engines);
+    return static_cast<std::int32_t>(std::max<std::int64_t>(alignments_per_batch, 1));
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
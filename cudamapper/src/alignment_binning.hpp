@@ -0,0 +1,76 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <claraparabricks/genomeworks/cudamapper/types.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// AlignmentBin - overlaps of similar lengths which are aligned by aligners of the same size
+struct AlignmentBin
+{
+    /// first position of the bin in the order of overlaps
+    std::int32_t begin;
+    /// past the last position of the bin in the order of overlaps
+    std::int32_t end;
+    /// longest query part of an overlap in the bin
+    std::int32_t max_query_length;
+    /// longest target part of an overlap in the bin
+    std::int32_t max_target_length;
+};
+
+/// \brief sorts overlaps by length and splits them into bins of similar lengths
+///
+/// Aligners are sized for their longest alignment, so aligning short overlaps together with long ones wastes memory.
+/// The length of an overlap is the longer of its query and target parts. Within a bin the longest overlap is at most
+/// max_length_ratio times as long as the shortest one.
+///
+/// \param overlaps overlaps to align
+/// \param max_length_ratio maximal ratio of the lengths of the longest and the shortest overlap of a bin, at least 1
+/// \param overlap_order output, indices of overlaps sorted by length
+/// \return bins as consecutive ranges of overlap_order, shortest overlaps first
+std::vector<AlignmentBin> bin_overlaps_by_length(const std::vector<Overlap>& overlaps,
+                                                 float max_length_ratio,
+                                                 std::vector<std::int32_t>& overlap_order);
+
+/// \brief computes the number of alignments per batch so that the batches of all alignment engines fit into the available memory
+/// \param available_memory memory available for all alignment engines in bytes
+/// \param memory_per_alignment memory needed per alignment of a batch in bytes
+/// \param num_alignment_engines number of alignment engines running concurrently
+/// \param number_of_alignments number of alignments to be performed, batches are never larger
+/// \return number of alignments per batch, at least 1
+std::int32_t calc_alignment_batch_size(std::int64_t available_memory,
+                                       std::int64_t memory_per_alignment,
+                                       std::int32_t num_alignment_engines,
+                                       std::int32_t number_of_alignments);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
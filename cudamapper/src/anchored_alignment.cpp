@@ -0,0 +1,249 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "anchored_alignment.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// query and target distances between consecutive checkpoints have to differ by less than this, same limit as for fusing chains
+constexpr std::int32_t max_diagonal_difference = 300;
+
+/// Checkpoint - position where two consecutive segments of an overlap meet,
+/// relative to the beginning of the overlap's query part and of its target part in the orientation of the query
+struct Checkpoint
+{
+    std::int32_t query_position;
+    std::int32_t target_position;
+};
+
+/// \brief returns true if next can be the checkpoint following previous
+bool can_follow(const Checkpoint& previous,
+                const Checkpoint& next)
+{
+    const std::int32_t query_distance  = next.query_position - previous.query_position;
+    const std::int32_t target_distance = next.target_position - previous.target_position;
+    return query_distance > 0 &&
+           target_distance > 0 &&
+           std::abs(query_distance - target_distance) < max_diagonal_difference;
+}
+
+/// \brief creates the segment of overlap between two checkpoints, the segment's target part is in read coordinates like the overlap's
+Overlap create_segment(const Overlap& overlap,
+                       const Checkpoint& begin,
+                       const Checkpoint& end)
+{
+    Overlap segment                       = overlap;
+    segment.query_start_position_in_read_ = overlap.query_start_position_in_read_ + begin.query_position;
+    segment.query_end_position_in_read_   = overlap.query_start_position_in_read_ + end.query_position;
+    if (overlap.relative_strand == RelativeStrand::Reverse)
+    {
+        // the target part gets reverse complemented before aligning, so its beginning is at the end of the read interval
+        segment.target_start_position_in_read_ = overlap.target_end_position_in_read_ - end.target_position;
+        segment.target_end_position_in_read_   = overlap.target_end_position_in_read_ - begin.target_position;
+    }
+    else
+    {
+        segment.target_start_position_in_read_ = overlap.target_start_position_in_read_ + begin.target_position;
+        segment.target_end_position_in_read_   = overlap.target_start_position_in_read_ + end.target_position;
+    }
+    return segment;
+}
+
+/// \brief appends the segments of one overlap to segments
+/// \param overlap
+/// \param anchor first anchor of the overlap's pair of reads which starts after the beginning of the query part
+/// \param anchors_end end of the anchors
+/// \param segment_length
+/// \param kmer_size
+/// \param segments
+void split_overlap(const Overlap& overlap,
+                   std::vector<Anchor>::const_iterator anchor,
+                   const std::vector<Anchor>::const_iterator anchors_end,
+                   const std::int32_t segment_length,
+                   const std::int32_t kmer_size,
+                   std::vector<Overlap>& segments)
+{
+    const std::int32_t query_length  = overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_;
+    const std::int32_t target_length = overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_;
+    const bool reverse               = overlap.relative_strand == RelativeStrand::Reverse;
+
+    Checkpoint previous  = {0, 0};
+    Checkpoint candidate = {0, 0};
+    bool has_candidate   = false;
+    for (; anchor != anchors_end; ++anchor)
+    {
+        if (anchor->query_read_id_ != overlap.query_read_id_ ||
+            anchor->target_read_id_ != overlap.target_read_id_ ||
+            anchor->query_position_in_read_ >= overlap.query_end_position_in_read_)
+        {
+            break;
+        }
+
+        // the anchor's target k-mer gets reverse complemented with the target part, so in reverse overlaps it starts kmer_size bases before its mirrored position
+        const std::int32_t target_offset = static_cast<std::int32_t>(anchor->target_position_in_read_) - static_cast<std::int32_t>(overlap.target_start_position_in_read_);
+        const Checkpoint checkpoint      = {static_cast<std::int32_t>(anchor->query_position_in_read_ - overlap.query_start_position_in_read_),
+                                            reverse ? std::min(std::max(target_length - target_offset - kmer_size, 0), target_length) : target_offset};
+        if (checkpoint.target_position <= 0 || checkpoint.target_position >= target_length)
+        {
+            continue;
+        }
+
+        // the candidate is the furthest checkpoint within segment_length, it is taken once an anchor is further away
+        if (has_candidate && checkpoint.query_position - previous.query_position > segment_length)
+        {
+            segments.push_back(create_segment(overlap, previous, candidate));
+            previous      = candidate;
+            has_candidate = false;
+        }
+        if (can_follow(previous, checkpoint) && (!has_candidate || checkpoint.query_position - previous.query_position <= segment_length))
+        {
+            candidate     = checkpoint;
+            has_candidate = true;
+        }
+    }
+    // the end of the overlap is the last checkpoint
+    if (has_candidate && query_length - previous.query_position > segment_length)
+    {
+        segments.push_back(create_segment(overlap, previous, candidate));
+        previous = candidate;
+    }
+    segments.push_back(create_segment(overlap, previous, {query_length, target_length}));
+}
+
+/// \brief appends the operations of a CIGAR string to a CIGAR string being built, the last operation of which is still open
+/// \param cigar CIGAR string without the open operation
+/// \param open_operation last operation of cigar, '\0' if there is none
+/// \param open_operation_length
+/// \param segment_cigar CIGAR string to append
+void append_cigar(std::string& cigar,
+                  char& open_operation,
+                  std::int64_t& open_operation_length,
+                  const std::string& segment_cigar)
+{
+    std::int64_t length = 0;
+    for (const char c : segment_cigar)
+    {
+        if (c >= '0' && c <= '9')
+        {
+            length = 10 * length + (c - '0');
+            continue;
+        }
+        if (c == open_operation)
+        {
+            open_operation_length += length;
+        }
+        else
+        {
+            if (open_operation != '\0')
+            {
+                cigar += std::to_string(open_operation_length) + open_operation;
+            }
+            open_operation        = c;
+            open_operation_length = length;
+        }
+        length = 0;
+    }
+}
+
+} // namespace
+
+OverlapSegments split_overlaps_at_anchors(const std::vector<Overlap>& overlaps,
+                                          const std::vector<Anchor>& anchors,
+                                          const std::int32_t segment_length,
+                                          const std::int32_t kmer_size)
+{
+    if (segment_length <= 0)
+    {
+        throw std::invalid_argument("segment_length has to be positive");
+    }
+    if (kmer_size <= 0)
+    {
+        throw std::invalid_argument("kmer_size has to be positive");
+    }
+
+    OverlapSegments overlap_segments;
+    overlap_segments.first_segment.reserve(overlaps.size() + 1);
+    for (const Overlap& overlap : overlaps)
+    {
+        overlap_segments.first_segment.push_back(get_size<std::int64_t>(overlap_segments.segments));
+
+        // anchors are sorted by read ids and query position, those strictly inside the query part follow the lower bound
+        const auto anchor_before_overlap = [&overlap](const Anchor& anchor) {
+            if (anchor.query_read_id_ != overlap.query_read_id_)
+                return anchor.query_read_id_ < overlap.query_read_id_;
+            if (anchor.target_read_id_ != overlap.target_read_id_)
+                return anchor.target_read_id_ < overlap.target_read_id_;
+            return anchor.query_position_in_read_ <= overlap.query_start_position_in_read_;
+        };
+        const auto first_anchor = std::partition_point(std::begin(anchors), std::end(anchors), anchor_before_overlap);
+        split_overlap(overlap, first_anchor, std::end(anchors), segment_length, kmer_size, overlap_segments.segments);
+    }
+    overlap_segments.first_segment.push_back(get_size<std::int64_t>(overlap_segments.segments));
+    return overlap_segments;
+}
+
+std::vector<std::string> stitch_segment_cigars(const OverlapSegments& overlap_segments,
+                                               const std::vector<std::string>& segment_cigars)
+{
+    const std::int64_t number_of_overlaps = get_size<std::int64_t>(overlap_segments.first_segment) - 1;
+    std::vector<std::string> cigars(std::max<std::int64_t>(number_of_overlaps, 0));
+    for (std::int64_t i = 0; i < number_of_overlaps; ++i)
+    {
+        std::string cigar;
+        char open_operation                = '\0';
+        std::int64_t open_operation_length = 0;
+        bool complete                      = true;
+        for (std::int64_t segment = overlap_segments.first_segment[i]; segment < overlap_segments.first_segment[i + 1]; ++segment)
+        {
+            const Overlap& overlap_segment = overlap_segments.segments[segment];
+            const bool empty_segment       = overlap_segment.query_end_position_in_read_ == overlap_segment.query_start_position_in_read_ &&
+                                       overlap_segment.target_end_position_in_read_ == overlap_segment.target_start_position_in_read_;
+            if (segment_cigars[segment].empty() && !empty_segment)
+            {
+                complete = false;
+                break;
+            }
+            append_cigar(cigar, open_operation, open_operation_length, segment_cigars[segment]);
+        }
+        if (complete && open_operation != '\0')
+        {
+            cigars[i] = cigar + std::to_string(open_operation_length) + open_operation;
+        }
+    }
+    return cigars;
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,77 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/cudamapper/types.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// OverlapSegments - overlaps cut into segments which are aligned independently
+///
+/// The segments of overlap i are segments[first_segment[i]], ..., segments[first_segment[i + 1] - 1], in the order
+/// in which their alignments are concatenated. Segments have the read ids and the relative strand of their overlap.
+struct OverlapSegments
+{
+    /// segments of all overlaps
+    std::vector<Overlap> segments;
+    /// index of the first segment of each overlap, one more element than there are overlaps
+    std::vector<std::int64_t> first_segment;
+};
+
+/// \brief cuts overlaps into segments at checkpoints taken from the anchors the overlaps were built from
+///
+/// The anchors of an overlap's pair of reads which lie inside the overlap are walked in query order and
+/// a sparse subset of them is picked as checkpoints: each checkpoint is the furthest anchor at most segment_length
+/// query bases after the previous one, or the next anchor if there is none, and the end of the overlap counts as an anchor. Checkpoints are strictly increasing
+/// in both sequences (decreasing in the target for reverse overlaps) and their query and target distances from the previous
+/// checkpoint differ by less than 300 bases, which skips anchors of repeats off the overlap's diagonal.
+/// Overlaps without suitable anchors consist of a single segment.
+///
+/// \param overlaps overlaps to split
+/// \param anchors anchors sorted by query_read_id -> target_read_id -> query_position_in_read -> target_position_in_read
+/// \param segment_length targeted query length of the segments, has to be positive
+/// \param kmer_size length of the k-mers the anchors were found with, needed to mirror anchor positions in reverse overlaps
+/// \return segments of all overlaps
+/// \throw std::invalid_argument if segment_length or kmer_size is not positive
+OverlapSegments split_overlaps_at_anchors(const std::vector<Overlap>& overlaps,
+                                          const std::vector<Anchor>& anchors,
+                                          std::int32_t segment_length,
+                                          std::int32_t kmer_size);
+
+/// \brief concatenates the CIGAR strings of the segments of each overlap, joining equal operations at segment boundaries
+/// \param overlap_segments segments created by split_overlaps_at_anchors()
+/// \param segment_cigars CIGAR strings of the alignments of overlap_segments.segments
+/// \return CIGAR strings of the overlaps, empty if the alignment of any of the overlap's segments is missing
+std::vector<std::string> stitch_segment_cigars(const OverlapSegments& overlap_segments,
+                                               const std::vector<std::string>& segment_cigars);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -16,15 +16,21 @@
 
 #include "application_parameters.hpp"
 
+#include <algorithm>
 #include <getopt.h>
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
 
 #include <claraparabricks/genomeworks/cudamapper/index.hpp>
 #include <claraparabricks/genomeworks/io/fasta_parser.hpp>
 #include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
 #include <claraparabricks/genomeworks/version.hpp>
 
+#include "read_list.hpp"
+
 namespace claraparabricks
 {
 
@@ -34,6 +40,36 @@ namespace genomeworks
 namespace cudamapper
 {
 
+namespace
+{
+
+/// \brief parses list of CPUs like "0-3,8,10-11"
+/// \param cpu_list
+/// \return ids of CPUs in the order they appear in the list
+std::vector<int32_t> parse_cpu_list(const std::string& cpu_list)
+{
+    std::vector<int32_t> cpu_ids;
+    std::stringstream cpu_list_stream(cpu_list);
+    std::string range;
+    while (std::getline(cpu_list_stream, range, ','))
+    {
+        const std::size_t dash_position = range.find('-');
+        const int32_t first_cpu         = std::stoi(range.substr(0, dash_position));
+        const int32_t last_cpu          = dash_position == std::string::npos ? first_cpu : std::stoi(range.substr(dash_position + 1));
+        if (first_cpu < 0 || last_cpu < first_cpu)
+        {
+            throw std::invalid_argument("Invalid CPU range: " + range);
+        }
+        for (int32_t cpu_id = first_cpu; cpu_id <= last_cpu; ++cpu_id)
+        {
+            cpu_ids.push_back(cpu_id);
+        }
+    }
+    return cpu_ids;
+}
+
+} // namespace
+
 ApplicationParameters::ApplicationParameters(int argc, char* argv[])
 {
     struct option options[] = {
@@ -45,6 +81,7 @@ ApplicationParameters::ApplicationParameters(int argc, char* argv[])
         {"target-index-size", required_argument, 0, 't'},
         {"filtering-parameter", required_argument, 0, 'F'},
         {"alignment-engines", required_argument, 0, 'a'},
+        {"alignment-segment-length", required_argument, 0, 'g'},
         {"min-residues", required_argument, 0, 'r'},
         {"min-overlap-length", required_argument, 0, 'l'},
         {"min-bases-per-residue", required_argument, 0, 'b'},
@@ -55,11 +92,28 @@ ApplicationParameters::ApplicationParameters(int argc, char* argv[])
         {"query-indices-in-device-memory", required_argument, 0, 'q'},
         {"target-indices-in-host-memory", required_argument, 0, 'C'},
         {"target-indices-in-device-memory", required_argument, 0, 'q'},
+        {"backend", required_argument, 0, 'B'},
+        {"threads", required_argument, 0, 'T'},
+        {"output-queue-length", required_argument, 0, 'O'},
+        {"output-queue-memory", required_argument, 0, 'M'},
+        {"cpu-affinity", required_argument, 0, 'A'},
+        {"serve", required_argument, 0, 'S'},
+        {"stream", no_argument, 0, 's'},
+        {"stream-latency", required_argument, 0, 'L'},
+        {"stream-idle-timeout", required_argument, 0, 'I'},
+        {"incremental", required_argument, 0, 'X'},
+        {"dust-threshold", required_argument, 0, 'u'},
+        {"dust-bed", required_argument, 0, 'U'},
+        {"query-read-list", required_argument, 0, 'n'},
+        {"target-read-list", required_argument, 0, 'N'},
+        {"prescreen-min-shared-seeds", required_argument, 0, 'P'},
+        {"prescreen-sketch-size", required_argument, 0, 'p'},
+        {"sketch-similarity", required_argument, 0, 'j'},
         {"version", no_argument, 0, 'v'},
         {"help", no_argument, 0, 'h'},
     };
 
-    std::string optstring = "k:w:d:m:i:t:F:a:r:l:b:z:RDQ:q:C:c:vh";
+    std::string optstring = "k:w:d:m:i:t:F:a:g:r:l:b:z:RDQ:q:C:c:B:T:O:M:A:S:sL:I:X:u:U:n:N:P:p:j:vh";
 
     bool target_indices_in_host_memory_set   = false;
     bool target_indices_in_device_memory_set = false;
@@ -99,6 +153,10 @@ ApplicationParameters::ApplicationParameters(int argc, char* argv[])
             alignment_engines = std::stoi(optarg);
             throw_on_negative(alignment_engines, "Number of alignment engines should be non-negative");
             break;
+        case 'g':
+            alignment_segment_length = std::stoi(optarg);
+            throw_on_negative(alignment_segment_length, "Alignment segment length should be non-negative");
+            break;
         case 'r':
             min_residues = std::stoi(optarg);
             break;
@@ -131,6 +189,77 @@ ApplicationParameters::ApplicationParameters(int argc, char* argv[])
             target_indices_in_device_memory     = std::stoi(optarg);
             target_indices_in_device_memory_set = true;
             break;
+        case 'B':
+            if (std::string(optarg) == "gpu")
+            {
+                backend = ComputeBackend::gpu;
+            }
+            else if (std::string(optarg) == "cpu")
+            {
+                backend = ComputeBackend::cpu;
+            }
+            else
+            {
+                std::cerr << "-B / --backend must be either gpu or cpu" << std::endl;
+                exit(1);
+            }
+            break;
+        case 'T':
+            num_threads = std::stoi(optarg);
+            throw_on_negative(num_threads, "Number of threads should be non-negative");
+            break;
+        case 'O':
+            output_queue_length = std::stoi(optarg);
+            throw_on_negative(output_queue_length, "Output queue length should be non-negative");
+            break;
+        case 'M':
+            output_queue_memory = std::stoi(optarg);
+            throw_on_negative(output_queue_memory, "Output queue memory should be non-negative");
+            break;
+        case 'A':
+            cpu_affinity = parse_cpu_list(optarg);
+            break;
+        case 'S':
+            serve_socket_path = std::string(optarg);
+            break;
+        case 's':
+            stream_queries = true;
+            break;
+        case 'L':
+            stream_latency = std::stoi(optarg);
+            throw_on_negative(stream_latency, "Stream latency should be non-negative");
+            break;
+        case 'I':
+            stream_idle_timeout = std::stoi(optarg);
+            throw_on_negative(stream_idle_timeout, "Stream idle timeout should be non-negative");
+            break;
+        case 'X':
+            incremental_directory = std::string(optarg);
+            break;
+        case 'u':
+            dust_score_threshold = std::stoi(optarg);
+            throw_on_negative(dust_score_threshold, "DUST score threshold should be non-negative");
+            break;
+        case 'U':
+            dust_bed_filepath = std::string(optarg);
+            break;
+        case 'n':
+            query_read_list_filepath = std::string(optarg);
+            break;
+        case 'N':
+            target_read_list_filepath = std::string(optarg);
+            break;
+        case 'P':
+            prescreen_min_shared_seeds = std::stoi(optarg);
+            throw_on_negative(prescreen_min_shared_seeds, "Minimum number of shared seeds should be non-negative");
+            break;
+        case 'p':
+            prescreen_sketch_size = std::stoi(optarg);
+            throw_on_negative(prescreen_sketch_size, "Sketch size should be non-negative");
+            break;
+        case 'j':
+            sketch_similarity_threshold = std::stod(optarg);
+            break;
         case 'v':
             print_version();
         case 'h':
@@ -158,8 +287,79 @@ ApplicationParameters::ApplicationParameters(int argc, char* argv[])
         exit(1);
     }
 
-    // Check remaining argument count.
-    if ((argc - optind) < 2)
+    if (!serve_socket_path.empty() && stream_queries)
+    {
+        std::cerr << "-S / --serve and -s / --stream cannot be used together" << std::endl;
+        exit(1);
+    }
+
+    if (!queries_known_upfront() && backend == ComputeBackend::cpu)
+    {
+        std::cerr << "-S / --serve and -s / --stream are not supported with cpu backend" << std::endl;
+        exit(1);
+    }
+
+    if (!queries_known_upfront() && alignment_engines > 0)
+    {
+        std::cerr << "-a / --alignment-engines is not supported with -S / --serve and -s / --stream" << std::endl;
+        exit(1);
+    }
+
+    if (!incremental_directory.empty() && !queries_known_upfront())
+    {
+        std::cerr << "-X / --incremental cannot be used together with -S / --serve or -s / --stream" << std::endl;
+        exit(1);
+    }
+
+    if (!incremental_directory.empty() && backend == ComputeBackend::cpu)
+    {
+        std::cerr << "-X / --incremental is not supported with cpu backend" << std::endl;
+        exit(1);
+    }
+
+    if (!query_read_list_filepath.empty() && !queries_known_upfront())
+    {
+        std::cerr << "-n / --query-read-list cannot be used together with -S / --serve or -s / --stream" << std::endl;
+        exit(1);
+    }
+
+    if (!incremental_directory.empty() && (!query_read_list_filepath.empty() || !target_read_list_filepath.empty()))
+    {
+        std::cerr << "-X / --incremental cannot be used together with -n / --query-read-list or -N / --target-read-list" << std::endl;
+        exit(1);
+    }
+
+    if (prescreen_min_shared_seeds > 0 && !queries_known_upfront())
+    {
+        std::cerr << "-P / --prescreen-min-shared-seeds cannot be used together with -S / --serve or -s / --stream" << std::endl;
+        exit(1);
+    }
+
+    if (prescreen_min_shared_seeds > 0 && prescreen_sketch_size == 0)
+    {
+        std::cerr << "-p / --prescreen-sketch-size must be positive when -P / --prescreen-min-shared-seeds is used" << std::endl;
+        exit(1);
+    }
+
+    if (sketch_similarity_threshold > 1.0)
+    {
+        std::cerr << "-j / --sketch-similarity must be in range [0.0, 1.0]" << std::endl;
+        exit(1);
+    }
+
+    if (sketch_similarity_threshold >= 0.0 && (!queries_known_upfront() || !incremental_directory.empty() || alignment_engines > 0))
+    {
+        std::cerr << "-j / --sketch-similarity cannot be used together with -S / --serve, -s / --stream, -X / --incremental or -a / --alignment-engines" << std::endl;
+        exit(1);
+    }
+
+    if (num_threads == 0)
+    {
+        num_threads = std::max(static_cast<int32_t>(std::thread::hardware_concurrency()), 1);
+    }
+
+    // Check remaining argument count. When serving only target file is given, queries are received over the socket
+    if ((argc - optind) < (serve_socket_path.empty() ? 2 : 1))
     {
         std::cerr << "Invalid inputs. Please refer to the help function." << std::endl;
         help(1);
@@ -189,10 +389,19 @@ ApplicationParameters::ApplicationParameters(int argc, char* argv[])
         exit(1);
     }
 
-    query_filepath  = std::string(argv[optind++]);
-    target_filepath = std::string(argv[optind++]);
+    if (!serve_socket_path.empty())
+    {
+        target_filepath = std::string(argv[optind++]);
+    }
+    else
+    {
+        query_filepath  = std::string(argv[optind++]);
+        target_filepath = std::string(argv[optind++]);
+    }
 
-    if (query_filepath == target_filepath)
+    // a stream of queries is mapped chunk by chunk, it is never processed all-to-all
+    // with different read lists query and target are different subsets of the same file
+    if (query_filepath == target_filepath && query_read_list_filepath == target_read_list_filepath && !stream_queries)
     {
         all_to_all        = true;
         target_index_size = index_size;
@@ -203,7 +412,8 @@ ApplicationParameters::ApplicationParameters(int argc, char* argv[])
 
     set_filtering_parameter(query_parser, target_parser, custom_filtering_parameter);
 
-    max_cached_memory_bytes = get_max_cached_memory_bytes();
+    // cpu backend and sketch similarity mode do not allocate any device memory
+    max_cached_memory_bytes = backend == ComputeBackend::gpu && sketch_similarity_threshold < 0.0 ? get_max_cached_memory_bytes() : 0;
 }
 
 void ApplicationParameters::set_filtering_parameter(std::shared_ptr<io::FastaParser>& query_parser,
@@ -215,7 +425,7 @@ void ApplicationParameters::set_filtering_parameter(std::shared_ptr<io::FastaPar
     const number_of_basepairs_t minimum_for_automatic_filtering = 500000; // Require at least 0.5Mbp of sequence for filtering by default
     number_of_reads_t query_index                               = 0;
     number_of_reads_t target_index                              = 0;
-    while (total_sequence_length < minimum_for_automatic_filtering && query_index < query_parser->get_num_seqences())
+    while (query_parser && total_sequence_length < minimum_for_automatic_filtering && query_index < query_parser->get_num_seqences())
     {
         total_sequence_length += get_size<number_of_basepairs_t>(query_parser->get_sequence_by_id(query_index).seq);
         ++query_index;
@@ -239,7 +449,17 @@ void ApplicationParameters::create_input_parsers(std::shared_ptr<io::FastaParser
     assert(query_parser == nullptr);
     assert(target_parser == nullptr);
 
-    query_parser = io::create_kseq_fasta_parser(query_filepath, kmer_size + windows_size - 1);
+    if (!queries_known_upfront())
+    {
+        target_parser = create_parser(target_filepath, target_read_list_filepath, true);
+        std::cerr << "Target file: " << target_filepath << ", number of reads: " << target_parser->get_num_seqences() << std::endl;
+        return;
+    }
+
+    // reads keep their ids between incremental runs only if they are not shuffled
+    const bool shuffle_reads = incremental_directory.empty();
+
+    query_parser = create_parser(query_filepath, query_read_list_filepath, shuffle_reads);
 
     if (all_to_all)
     {
@@ -247,13 +467,53 @@ void ApplicationParameters::create_input_parsers(std::shared_ptr<io::FastaParser
     }
     else
     {
-        target_parser = io::create_kseq_fasta_parser(target_filepath, kmer_size + windows_size - 1);
+        target_parser = create_parser(target_filepath, target_read_list_filepath, shuffle_reads);
     }
 
     std::cerr << "Query file: " << query_filepath << ", number of reads: " << query_parser->get_num_seqences() << std::endl;
     std::cerr << "Target file: " << target_filepath << ", number of reads: " << target_parser->get_num_seqences() << std::endl;
 }
 
+std::shared_ptr<io::FastaParser> ApplicationParameters::create_parser(const std::string& filepath,
+                                                                     const std::string& read_list_filepath,
+                                                                     const bool shuffle_reads) const
+{
+    std::unique_ptr<io::FastaParser> parser = io::create_kseq_fasta_parser(filepath, kmer_size + windows_size - 1, shuffle_reads);
+
+    if (read_list_filepath.empty())
+    {
+        return parser;
+    }
+
+    std::vector<std::string> read_names;
+    try
+    {
+        read_names = load_read_list(read_list_filepath);
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cerr << e.what() << std::endl;
+        exit(1);
+    }
+
+    // listed reads get new read_ids, reads which are not listed are dropped here and never sketched, matched or loaded to the device
+    parser = create_read_list_parser(*parser, read_names);
+    std::cerr << "Read list: " << read_list_filepath << ", " << parser->get_num_seqences() << " of " << read_names.size() << " listed reads found in " << filepath << std::endl;
+
+    if (parser->get_num_seqences() == 0)
+    {
+        std::cerr << "None of the reads listed in " << read_list_filepath << " were found in " << filepath << std::endl;
+        exit(1);
+    }
+
+    return parser;
+}
+
+bool ApplicationParameters::queries_known_upfront() const
+{
+    return serve_socket_path.empty() && !stream_queries;
+}
+
 int64_t ApplicationParameters::get_max_cached_memory_bytes()
 {
 #ifdef GW_ENABLE_CACHING_ALLOCATOR
@@ -296,6 +556,9 @@ void ApplicationParameters::help(int32_t exit_code)
 {
     std::cerr <<
         R"(Usage: cudamapper [options ...] <query_sequences> <target_sequences>
+       cudamapper [options ...] --serve <socket_path> <target_sequences>
+       cudamapper [options ...] --stream <query_sequences> <target_sequences>
+       cudamapper [options ...] --incremental <state_directory> <query_sequences> <target_sequences>
      <sequences>
         Input file in FASTA/FASTQ format (can be compressed with gzip)
         containing sequences used for all-to-all overlapping
@@ -323,7 +586,12 @@ void ApplicationParameters::help(int32_t exit_code)
             Remove representations with frequency (sketch_elements_with_that_representation/total_sketch_elements) >= filtering_parameter. Filtering is disabled if filtering_parameter == 1.0 (Min = 0.0, Max = 1.0) [1e-5])"
               << R"(
         -a, --alignment-engines
-            Number of alignment engines to use (per device) for generating CIGAR strings for overlap alignments. Default value 0 = no alignment to be performed. Typically 2-4 engines per device gives best perf.)"
+            Number of alignment engines to use (per device) for generating CIGAR strings for overlap alignments. Default value 0 = no alignment to be performed. Typically 2-4 engines per device gives best perf. With cpu backend any value > 0 enables alignment, alignments are computed on the shared thread pool.)"
+              << R"(
+        -g, --alignment-segment-length
+            with -a, split each overlap at a sparse subset of the anchors it was found from into segments of about this many query bases,
+            align the segments independently and join their CIGAR strings. Long overlaps are then aligned as many short problems instead of
+            one large one, so the length of overlaps is not limited by the memory of the aligners. 0 = align overlaps as a whole [0])"
               << R"(
         -r, --min-residues
             Minimum number of matching residues in an overlap (recommended: 1 - 10) [3])"
@@ -355,6 +623,70 @@ void ApplicationParameters::help(int32_t exit_code)
         -c, --target-indices-in-device-memory
             number of target indices to keep in device memory [5])"
               << R"(
+        -B, --backend
+            hardware used to compute indices, anchors and overlaps, gpu or cpu. With cpu no device is used and -d, -m, -q and -c are ignored [gpu])"
+              << R"(
+        -T, --threads
+            number of threads in the thread pool used for post-processing, alignment and cpu backend, 0 = number of hardware threads [0])"
+              << R"(
+        -O, --output-queue-length
+            maximum number of processed pairs of indices (per device) whose overlaps wait to be written, if the queue is full the computing thread writes its overlaps itself, 0 = no limit [0])"
+              << R"(
+        -M, --output-queue-memory
+            maximum amount of host memory (per device) in MiB taken by overlaps and cigars waiting to be written, if the queue is full the computing thread writes its overlaps itself, 0 = no limit [4096])"
+              << R"(
+        -A, --cpu-affinity
+            comma-separated list of CPUs (or ranges of CPUs, e.g. 0-3,8) to pin thread pool threads to, empty = threads are not pinned [])"
+              << R"(
+        -S, --serve
+            generate target indices once and keep mapping queries received over Unix domain socket <socket_path> until terminated,
+            use cudamapper-client to send queries. Only the first device is used, -a is not supported [])"
+              << R"(
+        -s, --stream
+            map query reads as they arrive instead of reading the whole query file first. <query_sequences> is uncompressed FASTA/FASTQ,
+            - means stdin. Reads are grouped into chunks of -i MB and overlaps of each chunk are written as soon as it is mapped.
+            Only the first device is used, -a is not supported)"
+              << R"(
+        -L, --stream-latency
+            with -s, maximum time in milliseconds a query read waits for its chunk to fill up before the chunk is mapped anyway [1000])"
+              << R"(
+        -I, --stream-idle-timeout
+            with -s and a query file (not stdin), the file is expected to grow and mapping only ends after no reads have been appended
+            for this many seconds [60])"
+              << R"(
+        -X, --incremental
+            keep indices and overlaps in <state_directory> and on later runs only process reads appended to the input files since the
+            previous run. All overlaps (previous and new) are written to the output. Reads are not shuffled, cpu backend is not supported [])"
+              << R"(
+        -u, --dust-threshold
+            mask low-complexity regions (tandem repeats, homopolymers) with SDUST before sketching, sketch elements overlapping masked
+            regions are not added to indices. Higher values mask less, 20 is a typical value, 0 = no masking [0])"
+              << R"(
+        -U, --dust-bed
+            write low-complexity regions found with -u threshold (20 if -u is not set) of all query and target reads to <file> in BED format [])"
+              << R"(
+        -n, --query-read-list
+            only map query reads whose names are listed in <file>, one name per line. Other query reads are never sketched or matched.
+            Not supported with -S, -s and -X [])"
+              << R"(
+        -N, --target-read-list
+            only map against target reads whose names are listed in <file>, one name per line. Other target reads are never sketched,
+            matched or loaded to the device. Not supported with -X [])"
+              << R"(
+        -P, --prescreen-min-shared-seeds
+            skip pairs of query and target indices whose estimated number of shared seeds (unique k-mer representations) is lower than
+            this value, without matching them. The estimate is based on MinHash sketches of the indices. Skipped pairs are reported
+            on stderr, 0 = no pre-screening. Not supported with -S and -s [0])"
+              << R"(
+        -p, --prescreen-sketch-size
+            number of representations in MinHash sketch of each index used by -P, larger sketches give more accurate estimates [1000])"
+              << R"(
+        -j, --sketch-similarity
+            instead of overlaps only compute similarities of pairs of reads from their minimizers (Mash-style). Pairs whose containment
+            (shared minimizers / minimizers of the read with fewer minimizers) is at least this value are written as tab-separated lines:
+            query name, target name, Mash distance, Jaccard index, containment, shared, query and target minimizers. Negative value = find
+            overlaps. Not supported with -S, -s, -X and -a [-1.0])"
+              << R"(
         -v, --version
             Version information)"
               << std::endl;
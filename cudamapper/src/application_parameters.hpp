@@ -15,6 +15,8 @@
 */
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include <claraparabricks/genomeworks/utils/allocator.hpp>
 
@@ -32,6 +34,13 @@ class FastaParser;
 namespace cudamapper
 {
 
+/// @brief hardware on which indices, anchors and overlaps are computed
+enum class ComputeBackend
+{
+    gpu,
+    cpu
+};
+
 /// @brief application parameteres, default or passed through command line
 class ApplicationParameters
 {
@@ -41,31 +50,53 @@ public:
     /// @param argv
     ApplicationParameters(int argc, char* argv[]);
 
-    uint32_t kmer_size                      = 15;    // k
-    uint32_t windows_size                   = 10;    // w
-    int32_t num_devices                     = 1;     // d
-    int32_t max_cached_memory               = 0;     // m
-    int32_t index_size                      = 30;    // i
-    int32_t target_index_size               = 30;    // t
-    double filtering_parameter              = 1e-5;  // F
-    int32_t alignment_engines               = 0;     // a
-    int32_t min_residues                    = 3;     // r, recommended range: 1 - 10. Higher: more accurate. Lower: more sensitive
-    int32_t min_overlap_len                 = 250;   // l, recommended range: 100 - 1000
-    int32_t min_bases_per_residue           = 1000;  // b
-    float min_overlap_fraction              = 0.8;   // z
-    bool perform_overlap_end_rescue         = false; // R
-    bool drop_fused_overlaps                = false; // D
-    int32_t query_indices_in_host_memory    = 10;    // Q
-    int32_t query_indices_in_device_memory  = 5;     // q
-    int32_t target_indices_in_host_memory   = 10;    // C
-    int32_t target_indices_in_device_memory = 5;     // c
+    uint32_t kmer_size                      = 15;                  // k
+    uint32_t windows_size                   = 10;                  // w
+    int32_t num_devices                     = 1;                   // d
+    int32_t max_cached_memory               = 0;                   // m
+    int32_t index_size                      = 30;                  // i
+    int32_t target_index_size               = 30;                  // t
+    double filtering_parameter              = 1e-5;                // F
+    int32_t alignment_engines               = 0;                   // a
+    int32_t alignment_segment_length        = 0;                   // g, 0 = overlaps are aligned as a whole
+    int32_t min_residues                    = 3;                   // r, recommended range: 1 - 10. Higher: more accurate. Lower: more sensitive
+    int32_t min_overlap_len                 = 250;                 // l, recommended range: 100 - 1000
+    int32_t min_bases_per_residue           = 1000;                // b
+    float min_overlap_fraction              = 0.8;                 // z
+    bool perform_overlap_end_rescue         = false;               // R
+    bool drop_fused_overlaps                = false;               // D
+    int32_t query_indices_in_host_memory    = 10;                  // Q
+    int32_t query_indices_in_device_memory  = 5;                   // q
+    int32_t target_indices_in_host_memory   = 10;                  // C
+    int32_t target_indices_in_device_memory = 5;                   // c
+    ComputeBackend backend                  = ComputeBackend::gpu; // B
+    int32_t num_threads                     = 0;                   // T, 0 = number of hardware threads
+    int32_t output_queue_length             = 0;                   // O, 0 = no limit
+    int32_t output_queue_memory             = 4096;                // M, in MiB, 0 = no limit
+    std::vector<int32_t> cpu_affinity;                             // A, empty = threads are not pinned
+    std::string serve_socket_path;                                 // S, empty = map query file and exit
+    bool stream_queries                     = false;               // s
+    int32_t stream_latency                  = 1000;                // L, in ms
+    int32_t stream_idle_timeout             = 60;                  // I, in s
+    std::string incremental_directory;                             // X, empty = process all reads
+    int32_t dust_score_threshold            = 0;                   // u, 0 = no masking
+    std::string dust_bed_filepath;                                 // U, empty = masked intervals are not written
+    std::string query_read_list_filepath;                          // n, empty = all query reads are mapped
+    std::string target_read_list_filepath;                         // N, empty = all target reads are mapped
+    int32_t prescreen_min_shared_seeds      = 0;                   // P, 0 = no pre-screening
+    int32_t prescreen_sketch_size           = 1000;                // p
+    double sketch_similarity_threshold      = -1.0;                // j, negative = find overlaps
     bool all_to_all                         = false;
     std::string query_filepath;
     std::string target_filepath;
-    std::shared_ptr<io::FastaParser> query_parser;
+    std::shared_ptr<io::FastaParser> query_parser; // nullptr if queries_known_upfront() is false
     std::shared_ptr<io::FastaParser> target_parser;
     int64_t max_cached_memory_bytes;
 
+    /// \brief returns whether all queries are in query file when the program starts, false for -S and -s
+    /// \return whether query_parser has been created
+    bool queries_known_upfront() const;
+
 private:
     /// \brief creates query and target parsers
     /// \param query_parser nullptr on input, query parser on output
@@ -73,6 +104,15 @@ private:
     void create_input_parsers(std::shared_ptr<io::FastaParser>& query_parser,
                               std::shared_ptr<io::FastaParser>& target_parser);
 
+    /// \brief creates parser for a query or target file, only with reads listed in read list file if it is given
+    /// \param filepath FASTA/FASTQ file
+    /// \param read_list_filepath read list, empty = all reads
+    /// \param shuffle_reads
+    /// \return the parser
+    std::shared_ptr<io::FastaParser> create_parser(const std::string& filepath,
+                                                   const std::string& read_list_filepath,
+                                                   bool shuffle_reads) const;
+
     /// \brief Determines if filtering should be run and sets the filtering level parameter accordingly.
     /// \param query_parser A FAST(x) file parser for query sequences
     /// \param target_parser A FAST(x) file parser for target sequences
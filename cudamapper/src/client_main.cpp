@@ -0,0 +1,116 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include "mapping_server.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// \brief reads the whole file, "-" means stdin
+/// \param filepath
+/// \return content of the file
+std::string read_file(const std::string& filepath)
+{
+    std::string content;
+    if (filepath == "-")
+    {
+        content.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+    }
+    else
+    {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file)
+        {
+            throw std::invalid_argument("Could not open " + filepath);
+        }
+        content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    // server expects plain FASTA/FASTQ
+    if (content.size() >= 2 && static_cast<unsigned char>(content[0]) == 0x1f && static_cast<unsigned char>(content[1]) == 0x8b)
+    {
+        throw std::invalid_argument(filepath + " is compressed, only uncompressed FASTA/FASTQ can be sent to the server");
+    }
+
+    return content;
+}
+
+void help(const int32_t exit_code)
+{
+    std::cerr <<
+        R"(Usage: cudamapper-client <socket_path> <query_sequences>
+     <socket_path>
+        Unix domain socket of a running cudamapper --serve
+     <query_sequences>
+        Uncompressed FASTA/FASTQ file with queries to map against the targets of the server, - for stdin
+
+Overlaps are written to stdout in PAF format.
+)";
+    exit(exit_code);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        help(1);
+    }
+
+    try
+    {
+        const std::string response = request_mapping(argv[1], read_file(argv[2]));
+        std::cout << response << std::flush;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
+
+/// \brief main function
+/// main function cannot be in a namespace so using this function to call actual main function
+int main(int argc, char* argv[])
+{
+    return claraparabricks::genomeworks::cudamapper::main(argc, argv);
+}
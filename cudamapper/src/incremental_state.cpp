@@ -0,0 +1,329 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "incremental_state.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include "application_parameters.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// First line of state file, increase the version when the format changes
+const std::string state_file_header = "cudamapper incremental state 1";
+
+/// \brief creates directory if it does not exist
+/// \throw std::runtime_error if the directory can not be created
+void create_directory_if_missing(const std::string& directory)
+{
+    if (0 != mkdir(directory.c_str(), 0755) && EEXIST != errno)
+    {
+        throw std::runtime_error("Could not create directory " + directory);
+    }
+}
+
+std::string get_state_file_path(const std::string& state_directory)
+{
+    return state_directory + "/state.txt";
+}
+
+void write_index_descriptors(std::ostream& output_stream,
+                             const std::vector<IndexDescriptor>& index_descriptors)
+{
+    output_stream << index_descriptors.size();
+    for (const IndexDescriptor& index_descriptor : index_descriptors)
+    {
+        output_stream << ' ' << index_descriptor.first_read() << ' ' << index_descriptor.number_of_reads();
+    }
+}
+
+std::vector<IndexDescriptor> read_index_descriptors(std::istream& input_stream)
+{
+    std::size_t number_of_index_descriptors = 0;
+    input_stream >> number_of_index_descriptors;
+    std::vector<IndexDescriptor> index_descriptors;
+    for (std::size_t i = 0; i < number_of_index_descriptors && input_stream; ++i)
+    {
+        read_id_t first_read              = 0;
+        number_of_reads_t number_of_reads = 0;
+        input_stream >> first_read >> number_of_reads;
+        index_descriptors.emplace_back(first_read, number_of_reads);
+    }
+    return index_descriptors;
+}
+
+/// \brief checks that reads of previous runs are still at the beginning of the file, groups appended reads into new indices
+/// \throw std::runtime_error if previous reads have changed
+void extend_reads(const io::FastaParser& parser,
+                  const std::string& file_description,
+                  const number_of_reads_t previous_number_of_reads,
+                  const std::uint64_t previous_reads_hash,
+                  const std::vector<IndexDescriptor>& previous_index_descriptors,
+                  const number_of_basepairs_t basepairs_per_index,
+                  number_of_reads_t& number_of_reads,
+                  std::uint64_t& reads_hash,
+                  std::vector<IndexDescriptor>& index_descriptors)
+{
+    number_of_reads = parser.get_num_seqences();
+    if (number_of_reads < previous_number_of_reads)
+    {
+        throw std::runtime_error(file_description + " has fewer reads than in previous run, reads can only be appended");
+    }
+    if (hash_reads(parser, previous_number_of_reads) != previous_reads_hash)
+    {
+        throw std::runtime_error("Reads processed in previous runs have changed in " + file_description + ", reads can only be appended");
+    }
+    reads_hash = hash_reads(parser, number_of_reads);
+
+    index_descriptors = previous_index_descriptors;
+    const std::vector<IndexDescriptor> new_index_descriptors = group_reads_into_indices(parser,
+                                                                                        previous_number_of_reads,
+                                                                                        number_of_reads,
+                                                                                        basepairs_per_index);
+    index_descriptors.insert(end(index_descriptors),
+                             begin(new_index_descriptors),
+                             end(new_index_descriptors));
+}
+
+} // namespace
+
+std::string describe_overlap_parameters(const ApplicationParameters& parameters)
+{
+    std::ostringstream description;
+    description << "k=" << parameters.kmer_size
+                << " w=" << parameters.windows_size
+                << " F=" << parameters.filtering_parameter
+                << " a=" << (parameters.alignment_engines > 0 ? 1 : 0)
+                << " r=" << parameters.min_residues
+                << " l=" << parameters.min_overlap_len
+                << " b=" << parameters.min_bases_per_residue
+                << " z=" << parameters.min_overlap_fraction
+                << " R=" << parameters.perform_overlap_end_rescue
+                << " D=" << parameters.drop_fused_overlaps
+                << " u=" << parameters.dust_score_threshold;
+    return description.str();
+}
+
+std::uint64_t hash_reads(const io::FastaParser& parser,
+                         const number_of_reads_t number_of_reads)
+{
+    // FNV-1a, unlike std::hash its value is the same in every build
+    std::uint64_t hash     = 14695981039346656037ull;
+    const auto add_to_hash = [&hash](const std::string& data) {
+        for (const char c : data)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ull;
+        }
+        hash ^= '\n';
+        hash *= 1099511628211ull;
+    };
+
+    for (read_id_t read_id = 0; read_id < number_of_reads; ++read_id)
+    {
+        const io::FastaSequence& read = parser.get_sequence_by_id(read_id);
+        add_to_hash(read.name);
+        add_to_hash(read.seq);
+    }
+
+    return hash;
+}
+
+IncrementalState load_incremental_state(const std::string& state_directory)
+{
+    create_directory_if_missing(state_directory);
+    create_directory_if_missing(get_incremental_index_directory(state_directory));
+
+    IncrementalState state;
+
+    std::ifstream state_file(get_state_file_path(state_directory));
+    if (!state_file)
+    {
+        // no run has finished yet
+        return state;
+    }
+
+    std::string line;
+    std::getline(state_file, line);
+    if (line != state_file_header)
+    {
+        throw std::runtime_error(get_state_file_path(state_directory) + " is not a valid state file or was created by an incompatible version");
+    }
+
+    while (std::getline(state_file, line))
+    {
+        const std::size_t separator = line.find(' ');
+        const std::string key       = line.substr(0, separator);
+        const std::string value     = separator == std::string::npos ? "" : line.substr(separator + 1);
+        std::istringstream value_stream(value);
+
+        if (key == "parameters")
+        {
+            state.parameters = value;
+        }
+        else if (key == "query_file")
+        {
+            state.query_filepath = value;
+        }
+        else if (key == "target_file")
+        {
+            state.target_filepath = value;
+        }
+        else if (key == "query_reads")
+        {
+            value_stream >> state.number_of_query_reads >> state.query_reads_hash;
+        }
+        else if (key == "target_reads")
+        {
+            value_stream >> state.number_of_target_reads >> state.target_reads_hash;
+        }
+        else if (key == "overlaps_file_size")
+        {
+            value_stream >> state.overlaps_file_size;
+        }
+        else if (key == "query_indices")
+        {
+            state.query_index_descriptors = read_index_descriptors(value_stream);
+        }
+        else if (key == "target_indices")
+        {
+            state.target_index_descriptors = read_index_descriptors(value_stream);
+        }
+        else
+        {
+            throw std::runtime_error("Unknown entry " + key + " in " + get_state_file_path(state_directory));
+        }
+
+        if (value_stream.fail())
+        {
+            throw std::runtime_error("Invalid value of " + key + " in " + get_state_file_path(state_directory));
+        }
+    }
+
+    return state;
+}
+
+void save_incremental_state(const std::string& state_directory,
+                            const IncrementalState& state)
+{
+    const std::string state_file_path     = get_state_file_path(state_directory);
+    const std::string temporary_file_path = state_file_path + ".tmp";
+
+    {
+        std::ofstream state_file(temporary_file_path, std::ios::trunc);
+        state_file << state_file_header << '\n';
+        state_file << "parameters " << state.parameters << '\n';
+        state_file << "query_file " << state.query_filepath << '\n';
+        state_file << "target_file " << state.target_filepath << '\n';
+        state_file << "query_reads " << state.number_of_query_reads << ' ' << state.query_reads_hash << '\n';
+        state_file << "target_reads " << state.number_of_target_reads << ' ' << state.target_reads_hash << '\n';
+        state_file << "overlaps_file_size " << state.overlaps_file_size << '\n';
+        state_file << "query_indices ";
+        write_index_descriptors(state_file, state.query_index_descriptors);
+        state_file << '\n';
+        state_file << "target_indices ";
+        write_index_descriptors(state_file, state.target_index_descriptors);
+        state_file << '\n';
+
+        if (!state_file.flush())
+        {
+            throw std::runtime_error("Could not write " + temporary_file_path);
+        }
+    }
+
+    if (0 != std::rename(temporary_file_path.c_str(), state_file_path.c_str()))
+    {
+        throw std::runtime_error("Could not rename " + temporary_file_path + " to " + state_file_path);
+    }
+}
+
+IncrementalState extend_incremental_state(const IncrementalState& previous_state,
+                                          const ApplicationParameters& parameters,
+                                          const number_of_basepairs_t query_basepairs_per_index,
+                                          const number_of_basepairs_t target_basepairs_per_index)
+{
+    IncrementalState state;
+    state.parameters      = describe_overlap_parameters(parameters);
+    state.query_filepath  = parameters.query_filepath;
+    state.target_filepath = parameters.target_filepath;
+
+    // state of a directory in which no run has finished yet can be extended with any parameters and files
+    const bool first_run = previous_state.parameters.empty();
+
+    if (!first_run && state.parameters != previous_state.parameters)
+    {
+        throw std::runtime_error("Parameters (" + state.parameters + ") are not the same as in previous runs (" + previous_state.parameters + "). Note that -F is adjusted automatically for small inputs unless set explicitly");
+    }
+
+    if (!first_run && (state.query_filepath != previous_state.query_filepath || state.target_filepath != previous_state.target_filepath))
+    {
+        throw std::runtime_error("Input files are not the same as in previous runs (" + previous_state.query_filepath + ", " + previous_state.target_filepath + ")");
+    }
+
+    extend_reads(*parameters.query_parser,
+                 "Query file",
+                 previous_state.number_of_query_reads,
+                 previous_state.query_reads_hash,
+                 previous_state.query_index_descriptors,
+                 query_basepairs_per_index,
+                 state.number_of_query_reads,
+                 state.query_reads_hash,
+                 state.query_index_descriptors);
+
+    extend_reads(*parameters.target_parser,
+                 "Target file",
+                 previous_state.number_of_target_reads,
+                 previous_state.target_reads_hash,
+                 previous_state.target_index_descriptors,
+                 target_basepairs_per_index,
+                 state.number_of_target_reads,
+                 state.target_reads_hash,
+                 state.target_index_descriptors);
+
+    return state;
+}
+
+std::string get_incremental_index_directory(const std::string& state_directory)
+{
+    return state_directory + "/indices";
+}
+
+std::string get_incremental_overlaps_path(const std::string& state_directory)
+{
+    return state_directory + "/overlaps.paf";
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,120 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/types.hpp>
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "index_descriptor.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+class ApplicationParameters;
+
+/// IncrementalState - describes reads which have already been processed in previous incremental runs (see -X / --incremental)
+///
+/// State is saved in the state directory after every successful run. In the next run only reads appended to the input files after
+/// the previous run need new indices and only pairs of indices that contain at least one of those indices need to be overlapped.
+struct IncrementalState
+{
+    /// all parameters which influence the overlaps, see describe_overlap_parameters()
+    std::string parameters;
+    std::string query_filepath;
+    std::string target_filepath;
+    /// reads [0, number_of_query_reads) have been processed
+    number_of_reads_t number_of_query_reads = 0;
+    /// reads [0, number_of_target_reads) have been processed
+    number_of_reads_t number_of_target_reads = 0;
+    /// hash of processed query reads, used to detect input files which were modified instead of appended to
+    std::uint64_t query_reads_hash = 0;
+    /// hash of processed target reads
+    std::uint64_t target_reads_hash = 0;
+    /// size of valid part of overlaps file, anything after it was written by a run that has not finished
+    std::int64_t overlaps_file_size = 0;
+    /// indices of processed query reads, reads appended later are always put in new indices so these never change
+    std::vector<IndexDescriptor> query_index_descriptors;
+    /// indices of processed target reads
+    std::vector<IndexDescriptor> target_index_descriptors;
+};
+
+/// \brief returns a description of all parameters which influence the generated overlaps
+/// \param parameters
+/// \return description of parameters
+std::string describe_overlap_parameters(const ApplicationParameters& parameters);
+
+/// \brief returns the hash of names and sequences of reads [0, number_of_reads)
+/// \param parser
+/// \param number_of_reads
+/// \return the hash
+std::uint64_t hash_reads(const io::FastaParser& parser,
+                         number_of_reads_t number_of_reads);
+
+/// \brief loads the state of previous runs from state directory, creates the directory if it does not exist
+/// \param state_directory
+/// \return loaded state, empty state if no run has finished yet
+/// \throw std::runtime_error if the state can not be read
+IncrementalState load_incremental_state(const std::string& state_directory);
+
+/// \brief saves the state to state directory
+/// State is first written to a temporary file which is then renamed, so an interrupted run leaves the previous state intact
+/// \param state_directory
+/// \param state
+/// \throw std::runtime_error if the state can not be written
+void save_incremental_state(const std::string& state_directory,
+                            const IncrementalState& state);
+
+/// \brief returns the state after all reads currently in the input files have been processed
+///
+/// Reads appended since the previous run are grouped into new IndexDescriptors, IndexDescriptors of previous runs are kept.
+///
+/// \param previous_state state after the previous run
+/// \param parameters
+/// \param query_basepairs_per_index
+/// \param target_basepairs_per_index
+/// \return the new state, overlaps_file_size is not set
+/// \throw std::runtime_error if parameters or input files are not the same as in previous runs, or if reads have not only been appended to the input files
+IncrementalState extend_incremental_state(const IncrementalState& previous_state,
+                                          const ApplicationParameters& parameters,
+                                          number_of_basepairs_t query_basepairs_per_index,
+                                          number_of_basepairs_t target_basepairs_per_index);
+
+/// \brief returns the directory in which indices are persisted
+/// \param state_directory
+/// \return the directory
+std::string get_incremental_index_directory(const std::string& state_directory);
+
+/// \brief returns the path of the file with overlaps of all previous runs
+/// \param state_directory
+/// \return the path
+std::string get_incremental_overlaps_path(const std::string& state_directory);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -36,7 +36,8 @@ std::unique_ptr<Index> Index::create_index(DefaultDeviceAllocator allocator,
                                            const std::uint64_t window_size,
                                            const bool hash_representations,
                                            const double filtering_parameter,
-                                           const cudaStream_t cuda_stream)
+                                           const cudaStream_t cuda_stream,
+                                           const std::int32_t dust_score_threshold)
 {
     GW_NVTX_RANGE(profiler, "create_index");
     return std::make_unique<IndexGPU<Minimizer>>(allocator,
@@ -47,7 +48,8 @@ std::unique_ptr<Index> Index::create_index(DefaultDeviceAllocator allocator,
                                                  window_size,
                                                  hash_representations,
                                                  filtering_parameter,
-                                                 cuda_stream);
+                                                 cuda_stream,
+                                                 dust_score_threshold);
 }
 
 std::unique_ptr<IndexHostCopyBase> IndexHostCopyBase::create_cache(const Index& index,
@@ -64,6 +66,12 @@ std::unique_ptr<IndexHostCopyBase> IndexHostCopyBase::create_cache(const Index&
                                            cuda_stream);
 }
 
+std::unique_ptr<IndexHostCopyBase> IndexHostCopyBase::load_cache(std::istream& input_stream)
+{
+    GW_NVTX_RANGE(profiler, "cache_load");
+    return IndexHostCopy::load(input_stream);
+}
+
 } // namespace cudamapper
 
 } // namespace genomeworks
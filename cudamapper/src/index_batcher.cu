@@ -58,10 +58,43 @@ std::vector<BatchOfIndices> generate_batches_of_indices(const number_of_indices_
     }
 
     // split indices into IndexDescriptors
-    std::vector<IndexDescriptor> query_index_descriptors  = group_reads_into_indices(*query_parser,
-                                                                                    query_basepairs_per_index);
-    std::vector<IndexDescriptor> target_index_descriptors = group_reads_into_indices(*target_parser,
-                                                                                     target_basepairs_per_index);
+    const std::vector<IndexDescriptor> query_index_descriptors  = group_reads_into_indices(*query_parser,
+                                                                                          query_basepairs_per_index);
+    const std::vector<IndexDescriptor> target_index_descriptors = group_reads_into_indices(*target_parser,
+                                                                                           target_basepairs_per_index);
+
+    return generate_batches_of_indices(query_indices_per_host_batch,
+                                       query_indices_per_device_batch,
+                                       target_indices_per_host_batch,
+                                       target_indices_per_device_batch,
+                                       query_index_descriptors,
+                                       target_index_descriptors,
+                                       same_query_and_target);
+}
+
+std::vector<BatchOfIndices> generate_batches_of_indices(const number_of_indices_t query_indices_per_host_batch,
+                                                        const number_of_indices_t query_indices_per_device_batch,
+                                                        const number_of_indices_t target_indices_per_host_batch,
+                                                        const number_of_indices_t target_indices_per_device_batch,
+                                                        const std::vector<IndexDescriptor>& query_index_descriptors,
+                                                        const std::vector<IndexDescriptor>& target_index_descriptors,
+                                                        const bool same_query_and_target)
+{
+    if (same_query_and_target)
+    {
+        if (query_indices_per_host_batch != target_indices_per_host_batch)
+        {
+            throw std::invalid_argument("generate_batches_of_indices: indices_per_host_batch not the same");
+        }
+        if (query_indices_per_device_batch != target_indices_per_device_batch)
+        {
+            throw std::invalid_argument("generate_batches_of_indices: indices_per_device_batch not the same");
+        }
+        if (query_index_descriptors != target_index_descriptors)
+        {
+            throw std::invalid_argument("generate_batches_of_indices: index descriptors not the same");
+        }
+    }
 
     // find host batches
     std::vector<IndexBatch> host_batches = details::index_batcher::group_into_batches(query_index_descriptors,
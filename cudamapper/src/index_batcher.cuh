@@ -115,6 +115,29 @@ std::vector<BatchOfIndices> generate_batches_of_indices(number_of_indices_t quer
                                                         number_of_basepairs_t target_basepairs_per_index,
                                                         bool same_query_and_target);
 
+/// \brief Groups already generated IndexDescriptors into batches
+///
+/// Same as generate_batches_of_indices() above, but query and target IndexDescriptors are provided by the caller.
+/// This makes it possible to generate batches for a subset of all pairs of indices, for example only for pairs
+/// which contain at least one index with reads that were not processed in a previous run.
+///
+/// \param query_indices_per_host_batch
+/// \param query_indices_per_device_batch
+/// \param target_indices_per_host_batch
+/// \param target_indices_per_device_batch
+/// \param query_index_descriptors
+/// \param target_index_descriptors
+/// \param same_query_and_target
+/// \throw std::invalid_argument if same_query_and_target is true and corresponding parameters for query and target are not the same
+/// \return generated batches
+std::vector<BatchOfIndices> generate_batches_of_indices(number_of_indices_t query_indices_per_host_batch,
+                                                        number_of_indices_t query_indices_per_device_batch,
+                                                        number_of_indices_t target_indices_per_host_batch,
+                                                        number_of_indices_t target_indices_per_device_batch,
+                                                        const std::vector<IndexDescriptor>& query_index_descriptors,
+                                                        const std::vector<IndexDescriptor>& target_index_descriptors,
+                                                        bool same_query_and_target);
+
 namespace details
 {
 
@@ -18,6 +18,11 @@
 
 #include "index_host_copy.cuh"
 
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <stdexcept>
+#include <thread>
 #include <unordered_set>
 
 #include <claraparabricks/genomeworks/cudamapper/index.hpp>
@@ -32,6 +37,53 @@ namespace genomeworks
 namespace cudamapper
 {
 
+namespace
+{
+
+/// \brief loads host copy of index from file, returns nullptr if the file does not exist
+/// \throw std::runtime_error if the file exists, but its index was generated with different parameters or is corrupted
+std::shared_ptr<const IndexHostCopyBase> load_persisted_index(const std::string& path,
+                                                              const std::uint64_t kmer_size,
+                                                              const std::uint64_t window_size)
+{
+    std::ifstream input_stream(path, std::ios::binary);
+    if (!input_stream)
+    {
+        return nullptr;
+    }
+
+    std::shared_ptr<const IndexHostCopyBase> index = IndexHostCopyBase::load_cache(input_stream);
+    if (index->kmer_size() != kmer_size || index->window_size() != window_size)
+    {
+        throw std::runtime_error("Persisted index " + path + " was generated with different k-mer or window size");
+    }
+    return index;
+}
+
+/// \brief saves host copy of index to file
+/// Index is first written to a temporary file which is then renamed, so an interrupted run never leaves a partially written index behind
+/// \throw std::runtime_error if saving fails
+void save_persisted_index(const IndexHostCopyBase& index,
+                          const std::string& path)
+{
+    // several devices might be generating the same index at the same time, each of them needs its own temporary file
+    const std::string temporary_path = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream output_stream(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!output_stream)
+        {
+            throw std::runtime_error("Could not open " + temporary_path + " for writing");
+        }
+        index.save(output_stream);
+    }
+    if (0 != std::rename(temporary_path.c_str(), path.c_str()))
+    {
+        throw std::runtime_error("Could not rename " + temporary_path + " to " + path);
+    }
+}
+
+} // namespace
+
 IndexCacheHost::IndexCacheHost(const bool same_query_and_target,
                                genomeworks::DefaultDeviceAllocator allocator,
                                std::shared_ptr<genomeworks::io::FastaParser> query_parser,
@@ -40,7 +92,9 @@ IndexCacheHost::IndexCacheHost(const bool same_query_and_target,
                                const std::uint64_t window_size,
                                const bool hash_representations,
                                const double filtering_parameter,
-                               const cudaStream_t cuda_stream)
+                               const cudaStream_t cuda_stream,
+                               const std::int32_t dust_score_threshold,
+                               const std::string& persisted_cache_directory)
     : same_query_and_target_(same_query_and_target)
     , allocator_(allocator)
     , query_parser_(query_parser)
@@ -49,7 +103,9 @@ IndexCacheHost::IndexCacheHost(const bool same_query_and_target,
     , window_size_(window_size)
     , hash_representations_(hash_representations)
     , filtering_parameter_(filtering_parameter)
+    , dust_score_threshold_(dust_score_threshold)
     , cuda_stream_(cuda_stream)
+    , persisted_cache_directory_(persisted_cache_directory)
 {
 }
 
@@ -150,6 +206,16 @@ void IndexCacheHost::generate_cache_content(const std::vector<IndexDescriptor>&
                     index_on_device = index_on_host->copy_index_to_device(allocator_, cuda_stream_);
                 }
             }
+            else if (!persisted_cache_directory_.empty() && nullptr != (index_on_host = load_persisted_index(get_persisted_index_path(descriptor_of_index_to_cache, which_cache),
+                                                                                                                kmer_size_,
+                                                                                                                window_size_)))
+            {
+                // index generated in one of the previous runs
+                if (keep_on_device || skip_copy_to_host)
+                {
+                    index_on_device = index_on_host->copy_index_to_device(allocator_, cuda_stream_);
+                }
+            }
             else
             {
                 // create index
@@ -161,9 +227,10 @@ void IndexCacheHost::generate_cache_content(const std::vector<IndexDescriptor>&
                                                       window_size_,
                                                       hash_representations_,
                                                       filtering_parameter_,
-                                                      cuda_stream_);
+                                                      cuda_stream_,
+                                                      dust_score_threshold_);
                 // copy it to host memory
-                if (!skip_copy_to_host)
+                if (!skip_copy_to_host || !persisted_cache_directory_.empty())
                 {
                     index_on_host = IndexHostCopy::create_cache(*index_on_device,
                                                                 descriptor_of_index_to_cache.first_read(),
@@ -171,6 +238,12 @@ void IndexCacheHost::generate_cache_content(const std::vector<IndexDescriptor>&
                                                                 window_size_,
                                                                 cuda_stream_);
                 }
+                // and save it so it does not have to be generated in the next run
+                if (!persisted_cache_directory_.empty())
+                {
+                    save_persisted_index(*index_on_host,
+                                         get_persisted_index_path(descriptor_of_index_to_cache, which_cache));
+                }
             }
         }
 
@@ -190,6 +263,14 @@ void IndexCacheHost::generate_cache_content(const std::vector<IndexDescriptor>&
     std::swap(new_cache, cache_to_edit);
 }
 
+std::string IndexCacheHost::get_persisted_index_path(const IndexDescriptor& index_descriptor,
+                                                     const CacheSelector which_cache) const
+{
+    // if query and target are the same indices are shared, so they should also share the file
+    const std::string prefix = (same_query_and_target_ || CacheSelector::target_cache == which_cache) ? "target" : "query";
+    return persisted_cache_directory_ + "/" + prefix + "_" + std::to_string(index_descriptor.first_read()) + "_" + std::to_string(index_descriptor.number_of_reads()) + ".gwidx";
+}
+
 std::shared_ptr<Index> IndexCacheHost::get_index_from_cache(const IndexDescriptor& descriptor_of_index_to_cache,
                                                             const CacheSelector which_cache)
 {
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <unordered_map>
 
 #include <claraparabricks/genomeworks/cudamapper/types.hpp>
@@ -59,15 +60,19 @@ public:
     /// \param hash_representations // see Index
     /// \param filtering_parameter // see Index
     /// \param cuda_stream // device memory used for Index copy will only we freed up once all previously scheduled work on this stream has finished
+    /// \param dust_score_threshold // see Index
+    /// \param persisted_cache_directory if not empty host copies of indices are also saved to this directory and loaded from it instead of being generated if already there
     IndexCacheHost(bool same_query_and_target,
                    genomeworks::DefaultDeviceAllocator allocator,
                    std::shared_ptr<genomeworks::io::FastaParser> query_parser,
                    std::shared_ptr<genomeworks::io::FastaParser> target_parser,
                    std::uint64_t kmer_size,
                    std::uint64_t window_size,
-                   bool hash_representations  = true,
-                   double filtering_parameter = 1.0,
-                   cudaStream_t cuda_stream   = 0);
+                   bool hash_representations                    = true,
+                   double filtering_parameter                   = 1.0,
+                   cudaStream_t cuda_stream                     = 0,
+                   std::int32_t dust_score_threshold            = 0,
+                   const std::string& persisted_cache_directory = "");
 
     IndexCacheHost(const IndexCacheHost&) = delete;
     IndexCacheHost& operator=(const IndexCacheHost&) = delete;
@@ -133,6 +138,10 @@ private:
                                 bool skip_copy_to_host,
                                 CacheSelector which_cache);
 
+    /// \brief Returns the path of the file in persisted_cache_directory_ in which the given index is stored
+    std::string get_persisted_index_path(const IndexDescriptor& index_descriptor,
+                                         CacheSelector which_cache) const;
+
     /// \brief Fetches requested index
     /// Copies index from host to device memory, unless index is saved in temp device cache
     /// If that is the case it returs that device copy are removes it from temp device cache
@@ -154,7 +163,9 @@ private:
     const std::uint64_t window_size_;
     const bool hash_representations_;
     const double filtering_parameter_;
+    const std::int32_t dust_score_threshold_;
     const cudaStream_t cuda_stream_;
+    const std::string persisted_cache_directory_;
 };
 
 /// IndexCacheDevice - Keeps copies of Indices in device memory
@@ -0,0 +1,389 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "index_cpu.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <numeric>
+
+#include <claraparabricks/genomeworks/logging/logging.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include "low_complexity_masker.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace details
+{
+namespace index_cpu
+{
+
+representation_t wang_hash64(representation_t key)
+{
+    uint64_t mask = (uint64_t(1) << 32) - 1;
+    key           = (~key + (key << 21)) & mask;
+    key           = key ^ key >> 24;
+    key           = ((key + (key << 3)) + (key << 8)) & mask;
+    key           = key ^ key >> 14;
+    key           = ((key + (key << 2)) + (key << 4)) & mask;
+    key           = key ^ key >> 28;
+    key           = (key + (key << 31)) & mask;
+    return key;
+}
+
+namespace
+{
+
+/// \brief returns 2-bit lexical ordering hash of a basepair, same encoding as in minimizer.cu (A -> 0, C -> 1, G -> 2, T -> 3)
+char forward_basepair_hash(const char bp)
+{
+    return 0b11 & (bp >> 2 ^ bp >> 1);
+}
+
+/// \brief returns 2-bit lexical ordering hash of the complement of a basepair, same encoding as in minimizer.cu
+char reverse_basepair_hash(const char bp)
+{
+    // A -> T, C -> G, T -> A, G -> C, anything else -> 0
+    constexpr char forward_to_reverse_complement[8] = {0b0000, 0b0100, 0b0000, 0b0111, 0b0001, 0b0000, 0b0000, 0b0011};
+    const char complement                           = forward_to_reverse_complement[0b111 & bp];
+    return 0b11 & (complement >> 2 ^ complement >> 1);
+}
+
+} // namespace
+
+void find_minimizers(const char* const basepairs,
+                     const position_in_read_t number_of_basepairs,
+                     const read_id_t read_id,
+                     const std::uint64_t kmer_size,
+                     const std::uint64_t window_size,
+                     const bool hash_representations,
+                     std::vector<representation_t>& representations,
+                     std::vector<read_id_t>& read_ids,
+                     std::vector<position_in_read_t>& positions_in_reads,
+                     std::vector<SketchElement::DirectionOfRepresentation>& directions_of_reads)
+{
+    assert(kmer_size > 0 && window_size > 0);
+    assert(number_of_basepairs >= kmer_size + window_size - 1);
+
+    const std::int64_t number_of_kmers = number_of_basepairs - kmer_size + 1;
+
+    // *** find representations of all kmers ***
+    // forward representation has the first basepair in the most significant bits, reverse representation has it in the least significant bits
+    std::vector<representation_t> kmer_representations(number_of_kmers);
+    std::vector<SketchElement::DirectionOfRepresentation> kmer_directions(number_of_kmers);
+
+    const representation_t kmer_mask        = 2 * kmer_size >= sizeof(representation_t) * CHAR_BIT ? ~representation_t(0) : (representation_t(1) << 2 * kmer_size) - 1;
+    representation_t forward_representation = 0;
+    representation_t reverse_representation = 0;
+    for (std::int64_t i = 0; i < number_of_basepairs; ++i)
+    {
+        forward_representation = ((forward_representation << 2) | forward_basepair_hash(basepairs[i])) & kmer_mask;
+        reverse_representation = (reverse_representation >> 2) | (static_cast<representation_t>(reverse_basepair_hash(basepairs[i])) << 2 * (kmer_size - 1));
+
+        const std::int64_t kmer_index = i - kmer_size + 1;
+        if (kmer_index >= 0)
+        {
+            representation_t forward = forward_representation;
+            representation_t reverse = reverse_representation;
+            if (hash_representations)
+            {
+                forward = wang_hash64(forward);
+                reverse = wang_hash64(reverse);
+            }
+            if (forward <= reverse)
+            {
+                kmer_representations[kmer_index] = forward;
+                kmer_directions[kmer_index]      = SketchElement::DirectionOfRepresentation::FORWARD;
+            }
+            else
+            {
+                kmer_representations[kmer_index] = reverse;
+                kmer_directions[kmer_index]      = SketchElement::DirectionOfRepresentation::REVERSE;
+            }
+        }
+    }
+
+    // *** find window minimizers ***
+    // If there are several kmers with the same representation take the last one (thus <=)
+    auto find_window_minimizer = [&kmer_representations](const std::int64_t first_kmer, const std::int64_t last_kmer) {
+        std::int64_t minimizer_index = first_kmer;
+        for (std::int64_t i = first_kmer + 1; i <= last_kmer; ++i)
+        {
+            if (kmer_representations[i] <= kmer_representations[minimizer_index])
+            {
+                minimizer_index = i;
+            }
+        }
+        return minimizer_index;
+    };
+
+    // Consecutive windows often share the same minimizer, only write it once
+    std::int64_t last_written_kmer = -1;
+    auto write_window_minimizer    = [&](const std::int64_t first_kmer, const std::int64_t last_kmer) {
+        const std::int64_t minimizer_index = find_window_minimizer(first_kmer, last_kmer);
+        if (minimizer_index != last_written_kmer)
+        {
+            representations.push_back(kmer_representations[minimizer_index]);
+            read_ids.push_back(read_id);
+            positions_in_reads.push_back(static_cast<position_in_read_t>(minimizer_index));
+            directions_of_reads.push_back(kmer_directions[minimizer_index]);
+            last_written_kmer = minimizer_index;
+        }
+    };
+
+    const std::int64_t w = static_cast<std::int64_t>(window_size);
+
+    // front end windows
+    for (std::int64_t last_kmer = 0; last_kmer < w - 1; ++last_kmer)
+    {
+        write_window_minimizer(0, last_kmer);
+    }
+    // central windows
+    for (std::int64_t first_kmer = 0; first_kmer + w <= number_of_kmers; ++first_kmer)
+    {
+        write_window_minimizer(first_kmer, first_kmer + w - 1);
+    }
+    // back end windows
+    for (std::int64_t first_kmer = number_of_kmers - w + 1; first_kmer < number_of_kmers; ++first_kmer)
+    {
+        write_window_minimizer(first_kmer, number_of_kmers - 1);
+    }
+}
+
+} // namespace index_cpu
+} // namespace details
+
+IndexCPU::IndexCPU(const io::FastaParser& parser,
+                   const read_id_t first_read_id,
+                   const read_id_t past_the_last_read_id,
+                   const std::uint64_t kmer_size,
+                   const std::uint64_t window_size,
+                   const bool hash_representations,
+                   const double filtering_parameter,
+                   const std::int32_t dust_score_threshold)
+    : first_read_id_(first_read_id)
+    , kmer_size_(kmer_size)
+    , window_size_(window_size)
+    , number_of_reads_(0)
+    , number_of_basepairs_in_longest_read_(0)
+{
+    generate_index(parser,
+                   past_the_last_read_id,
+                   hash_representations,
+                   filtering_parameter,
+                   dust_score_threshold);
+}
+
+const std::vector<representation_t>& IndexCPU::representations() const
+{
+    return representations_;
+}
+
+const std::vector<read_id_t>& IndexCPU::read_ids() const
+{
+    return read_ids_;
+}
+
+const std::vector<position_in_read_t>& IndexCPU::positions_in_reads() const
+{
+    return positions_in_reads_;
+}
+
+const std::vector<SketchElement::DirectionOfRepresentation>& IndexCPU::directions_of_reads() const
+{
+    return directions_of_reads_;
+}
+
+const std::vector<representation_t>& IndexCPU::unique_representations() const
+{
+    return unique_representations_;
+}
+
+const std::vector<std::uint32_t>& IndexCPU::first_occurrence_of_representations() const
+{
+    return first_occurrence_of_representations_;
+}
+
+read_id_t IndexCPU::number_of_reads() const
+{
+    return number_of_reads_;
+}
+
+read_id_t IndexCPU::smallest_read_id() const
+{
+    return number_of_reads_ > 0 ? first_read_id_ : 0;
+}
+
+read_id_t IndexCPU::largest_read_id() const
+{
+    return number_of_reads_ > 0 ? first_read_id_ + number_of_reads_ - 1 : 0;
+}
+
+position_in_read_t IndexCPU::number_of_basepairs_in_longest_read() const
+{
+    return number_of_basepairs_in_longest_read_;
+}
+
+void IndexCPU::generate_index(const io::FastaParser& parser,
+                              const read_id_t past_the_last_read_id,
+                              const bool hash_representations,
+                              const double filtering_parameter,
+                              const std::int32_t dust_score_threshold)
+{
+    // check if there are any reads to process
+    if (first_read_id_ >= past_the_last_read_id)
+    {
+        GW_LOG_INFO("No Sketch Elements to be added to index");
+        number_of_reads_ = 0;
+        return;
+    }
+
+    number_of_reads_ = past_the_last_read_id - first_read_id_;
+
+    // *** generate sketch elements, grouped by read_id ***
+    std::vector<representation_t> generated_representations;
+    std::vector<read_id_t> generated_read_ids;
+    std::vector<position_in_read_t> generated_positions_in_reads;
+    std::vector<SketchElement::DirectionOfRepresentation> generated_directions_of_reads;
+
+    for (read_id_t read_id = first_read_id_; read_id < past_the_last_read_id; ++read_id)
+    {
+        const io::FastaSequence& read     = parser.get_sequence_by_id(read_id);
+        const std::string& read_basepairs = read.seq;
+        if (read_basepairs.length() >= window_size_ + kmer_size_ - 1)
+        {
+            number_of_basepairs_in_longest_read_ = std::max(number_of_basepairs_in_longest_read_, static_cast<position_in_read_t>(read_basepairs.length()));
+            const std::size_t first_sketch_element_of_read = generated_representations.size();
+            details::index_cpu::find_minimizers(read_basepairs.data(),
+                                                static_cast<position_in_read_t>(read_basepairs.length()),
+                                                read_id,
+                                                kmer_size_,
+                                                window_size_,
+                                                hash_representations,
+                                                generated_representations,
+                                                generated_read_ids,
+                                                generated_positions_in_reads,
+                                                generated_directions_of_reads);
+            if (dust_score_threshold > 0)
+            {
+                // remove sketch elements of this read which overlap low-complexity intervals
+                const std::vector<MaskedInterval> masked_intervals = find_low_complexity_intervals(read_basepairs, dust_score_threshold);
+                std::size_t kept_sketch_elements                   = first_sketch_element_of_read;
+                for (std::size_t i = first_sketch_element_of_read; i < generated_representations.size(); ++i)
+                {
+                    if (!is_kmer_masked(masked_intervals, generated_positions_in_reads[i], kmer_size_))
+                    {
+                        generated_representations[kept_sketch_elements]     = generated_representations[i];
+                        generated_read_ids[kept_sketch_elements]            = generated_read_ids[i];
+                        generated_positions_in_reads[kept_sketch_elements]  = generated_positions_in_reads[i];
+                        generated_directions_of_reads[kept_sketch_elements] = generated_directions_of_reads[i];
+                        ++kept_sketch_elements;
+                    }
+                }
+                generated_representations.resize(kept_sketch_elements);
+                generated_read_ids.resize(kept_sketch_elements);
+                generated_positions_in_reads.resize(kept_sketch_elements);
+                generated_directions_of_reads.resize(kept_sketch_elements);
+            }
+        }
+        else
+        {
+            GW_LOG_INFO("Skipping read {}. It has {} basepairs, one window covers {} basepairs",
+                        read.name,
+                        read_basepairs.length(),
+                        window_size_ + kmer_size_ - 1);
+        }
+    }
+
+    if (generated_representations.empty())
+    {
+        GW_LOG_INFO("Index for reads {} to past {} is empty",
+                    first_read_id_,
+                    past_the_last_read_id);
+        number_of_reads_                     = 0;
+        number_of_basepairs_in_longest_read_ = 0;
+        return;
+    }
+
+    // *** sort sketch elements by representation ***
+    // As this is a stable sort and the data was initially grouped by read_id this means that the sketch elements within each representation are sorted by read_id
+    std::vector<std::uint32_t> sorted_indices(generated_representations.size());
+    std::iota(std::begin(sorted_indices), std::end(sorted_indices), 0);
+    std::stable_sort(std::begin(sorted_indices),
+                     std::end(sorted_indices),
+                     [&generated_representations](const std::uint32_t i, const std::uint32_t j) {
+                         return generated_representations[i] < generated_representations[j];
+                     });
+
+    // *** find unique representations, their first occurrences and filtering threshold ***
+    std::vector<representation_t> unique_representations_before_filtering;
+    std::vector<std::uint32_t> first_occurrence_before_filtering;
+    for (std::uint32_t i = 0; i < get_size<std::uint32_t>(sorted_indices); ++i)
+    {
+        const representation_t representation = generated_representations[sorted_indices[i]];
+        if (unique_representations_before_filtering.empty() || unique_representations_before_filtering.back() != representation)
+        {
+            unique_representations_before_filtering.push_back(representation);
+            first_occurrence_before_filtering.push_back(i);
+        }
+    }
+    first_occurrence_before_filtering.push_back(get_size<std::uint32_t>(sorted_indices));
+
+    // filtering_parameter == 1.0 disables filtering, see IndexGPU for details of the threshold calculation
+    const bool filtering_enabled            = filtering_parameter < 1.0;
+    const std::uint64_t filtering_threshold = static_cast<std::uint64_t>(sorted_indices.size() * filtering_parameter + 0.001);
+
+    // *** copy sketch elements of kept representations to data arrays ***
+    representations_.reserve(sorted_indices.size());
+    read_ids_.reserve(sorted_indices.size());
+    positions_in_reads_.reserve(sorted_indices.size());
+    directions_of_reads_.reserve(sorted_indices.size());
+    for (std::size_t unique_index = 0; unique_index < unique_representations_before_filtering.size(); ++unique_index)
+    {
+        const std::uint32_t first_occurrence         = first_occurrence_before_filtering[unique_index];
+        const std::uint32_t past_the_last_occurrence = first_occurrence_before_filtering[unique_index + 1];
+        if (filtering_enabled && past_the_last_occurrence - first_occurrence >= filtering_threshold)
+        {
+            continue;
+        }
+        unique_representations_.push_back(unique_representations_before_filtering[unique_index]);
+        first_occurrence_of_representations_.push_back(get_size<std::uint32_t>(representations_));
+        for (std::uint32_t i = first_occurrence; i < past_the_last_occurrence; ++i)
+        {
+            const std::uint32_t generated_index = sorted_indices[i];
+            representations_.push_back(generated_representations[generated_index]);
+            read_ids_.push_back(generated_read_ids[generated_index]);
+            positions_in_reads_.push_back(generated_positions_in_reads[generated_index]);
+            directions_of_reads_.push_back(generated_directions_of_reads[generated_index]);
+        }
+    }
+    first_occurrence_of_representations_.push_back(get_size<std::uint32_t>(representations_));
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
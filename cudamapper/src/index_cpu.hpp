@@ -0,0 +1,169 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <claraparabricks/genomeworks/cudamapper/sketch_element.hpp>
+#include <claraparabricks/genomeworks/cudamapper/types.hpp>
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// IndexCPU - host implementation of the mapping of (k,w)-kmer-representation to all its occurrences
+///
+/// Used by the CPU backend. Produces the same sketch elements as IndexGPU<Minimizer> (same 2-bit basepair encoding,
+/// same hash function and same front end, central and back end windows), but keeps all arrays in host memory.
+///
+/// Data arrays are sorted by representation, elements with the same representation are sorted by read_id and then by position_in_read
+class IndexCPU
+{
+public:
+    /// \brief Constructor
+    /// \param parser parser for the whole input file (part that goes into this index is determined by first_read_id and past_the_last_read_id)
+    /// \param first_read_id read_id of the first read to the included in this index
+    /// \param past_the_last_read_id read_id+1 of the last read to be included in this index
+    /// \param kmer_size k - the kmer length
+    /// \param window_size w - the length of the sliding window used to find sketch elements (i.e. the number of adjacent kmers in a window, adjacent = shifted by one basepair)
+    /// \param hash_representations if true, hash kmer representations
+    /// \param filtering_parameter filter out all representations for which number_of_sketch_elements_with_that_representation/total_skech_elements >= filtering_parameter, filtering_parameter == 1.0 disables filtering
+    /// \param dust_score_threshold leave out sketch elements overlapping low-complexity intervals with SDUST score above this value, 0 disables masking
+    IndexCPU(const io::FastaParser& parser,
+             const read_id_t first_read_id,
+             const read_id_t past_the_last_read_id,
+             const std::uint64_t kmer_size,
+             const std::uint64_t window_size,
+             const bool hash_representations         = true,
+             const double filtering_parameter        = 1.0,
+             const std::int32_t dust_score_threshold = 0);
+
+    /// \brief returns an array of representations of sketch elements
+    /// \return an array of representations of sketch elements
+    const std::vector<representation_t>& representations() const;
+
+    /// \brief returns an array of reads ids for sketch elements
+    /// \return an array of reads ids for sketch elements
+    const std::vector<read_id_t>& read_ids() const;
+
+    /// \brief returns an array of starting positions of sketch elements in their reads
+    /// \return an array of starting positions of sketch elements in their reads
+    const std::vector<position_in_read_t>& positions_in_reads() const;
+
+    /// \brief returns an array of directions in which sketch elements were read
+    /// \return an array of directions in which sketch elements were read
+    const std::vector<SketchElement::DirectionOfRepresentation>& directions_of_reads() const;
+
+    /// \brief returns an array where each representation is recorded only once, sorted by representation
+    /// \return an array where each representation is recorded only once, sorted by representation
+    const std::vector<representation_t>& unique_representations() const;
+
+    /// \brief returns first occurrence of corresponding representation from unique_representations(), plus one more element with the total number of sketch elements
+    /// \return first occurrence of corresponding representation from unique_representations(), plus one more element with the total number of sketch elements
+    const std::vector<std::uint32_t>& first_occurrence_of_representations() const;
+
+    /// \brief returns number of reads in input data
+    /// \return number of reads in input data
+    read_id_t number_of_reads() const;
+
+    /// \brief returns smallest read_id in index
+    /// \return smallest read_id in index (0 if empty index)
+    read_id_t smallest_read_id() const;
+
+    /// \brief returns largest read_id in index
+    /// \return largest read_id in index (0 if empty index)
+    read_id_t largest_read_id() const;
+
+    /// \brief returns length of the longest read in this index
+    /// \return length of the longest read in this index
+    position_in_read_t number_of_basepairs_in_longest_read() const;
+
+private:
+    /// \brief generates the index
+    void generate_index(const io::FastaParser& parser,
+                        const read_id_t past_the_last_read_id,
+                        const bool hash_representations,
+                        const double filtering_parameter,
+                        const std::int32_t dust_score_threshold);
+
+    std::vector<representation_t> representations_;
+    std::vector<read_id_t> read_ids_;
+    std::vector<position_in_read_t> positions_in_reads_;
+    std::vector<SketchElement::DirectionOfRepresentation> directions_of_reads_;
+
+    std::vector<representation_t> unique_representations_;
+    std::vector<std::uint32_t> first_occurrence_of_representations_;
+
+    const read_id_t first_read_id_;
+    const std::uint64_t kmer_size_;
+    const std::uint64_t window_size_;
+    read_id_t number_of_reads_;
+    position_in_read_t number_of_basepairs_in_longest_read_;
+};
+
+namespace details
+{
+namespace index_cpu
+{
+
+/// \brief host version of the hash function used by IndexGPU, see wang_hash64() in minimizer.cu
+/// \param key the input representation
+/// \return hashed representation, masked to 32 bits
+representation_t wang_hash64(representation_t key);
+
+/// \brief finds all minimizers of one read and appends them to output arrays
+///
+/// Minimizers of front end windows (window size 1 to window_size-1 starting at the first kmer), central windows (window size window_size)
+/// and back end windows (window size window_size-1 to 1 ending at the last kmer) are found. If several kmers in a window have
+/// the same representation the last one is taken. Consecutive windows with the same minimizer produce only one output element.
+///
+/// \param basepairs basepairs of the read
+/// \param number_of_basepairs number of basepairs in the read, has to be at least kmer_size + window_size - 1
+/// \param read_id read_id to assign to found minimizers
+/// \param kmer_size k - the kmer length
+/// \param window_size w - number of kmers in a central window
+/// \param hash_representations if true, hash kmer representations
+/// \param representations output array, representations of minimizers are appended to it
+/// \param read_ids output array, read_ids of minimizers are appended to it
+/// \param positions_in_reads output array, positions of minimizers are appended to it
+/// \param directions_of_reads output array, directions of minimizers are appended to it
+void find_minimizers(const char* const basepairs,
+                     const position_in_read_t number_of_basepairs,
+                     const read_id_t read_id,
+                     const std::uint64_t kmer_size,
+                     const std::uint64_t window_size,
+                     const bool hash_representations,
+                     std::vector<representation_t>& representations,
+                     std::vector<read_id_t>& read_ids,
+                     std::vector<position_in_read_t>& positions_in_reads,
+                     std::vector<SketchElement::DirectionOfRepresentation>& directions_of_reads);
+
+} // namespace index_cpu
+} // namespace details
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -81,17 +81,32 @@ std::size_t IndexDescriptorHash::operator()(const IndexDescriptor& index_descrip
 
 std::vector<IndexDescriptor> group_reads_into_indices(const io::FastaParser& parser,
                                                       const number_of_basepairs_t max_basepairs_per_index)
+{
+    return group_reads_into_indices(parser,
+                                    0,
+                                    parser.get_num_seqences(),
+                                    max_basepairs_per_index);
+}
+
+std::vector<IndexDescriptor> group_reads_into_indices(const io::FastaParser& parser,
+                                                      const read_id_t first_read,
+                                                      const read_id_t past_the_last_read,
+                                                      const number_of_basepairs_t max_basepairs_per_index)
 {
     std::vector<IndexDescriptor> index_descriptors;
 
-    const number_of_reads_t total_number_of_reads              = parser.get_num_seqences();
-    read_id_t first_read_in_current_index                      = 0;
+    if (first_read >= past_the_last_read)
+    {
+        return index_descriptors;
+    }
+
+    read_id_t first_read_in_current_index                      = first_read;
     number_of_reads_t number_of_reads_in_current_index         = 0;
     number_of_basepairs_t number_of_basepairs_in_current_index = 0;
-    for (read_id_t read_id = 0; read_id < total_number_of_reads; read_id++)
+    for (read_id_t read_id = first_read; read_id < past_the_last_read; read_id++)
     {
         number_of_basepairs_t basepairs_in_this_read = get_size<number_of_basepairs_t>(parser.get_sequence_by_id(read_id).seq);
-        if (basepairs_in_this_read + number_of_basepairs_in_current_index > max_basepairs_per_index)
+        if (number_of_reads_in_current_index > 0 && basepairs_in_this_read + number_of_basepairs_in_current_index > max_basepairs_per_index)
         {
             // adding this sequence would lead to index_descriptor being larger than max_basepairs_per_index
             // save current index_descriptor and start a new one
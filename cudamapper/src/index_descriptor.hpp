@@ -92,6 +92,21 @@ struct IndexDescriptorHash
 std::vector<IndexDescriptor> group_reads_into_indices(const io::FastaParser& parser,
                                                       number_of_basepairs_t max_basepairs_per_index = 1000000);
 
+/// \brief returns a list of IndexDescriptors covering reads [first_read, past_the_last_read) in which the sum of basepairs of all reads in one IndexDescriptor is at most max_basepairs_per_index
+///
+/// Grouping only depends on the reads in the range, so reads appended to the input later never change the IndexDescriptors of an earlier range.
+/// If a single read exceeds max_chunk_size it will be placed in its own IndexDescriptor.
+///
+/// \param parser parser to get the reads from
+/// \param first_read first read to group
+/// \param past_the_last_read one past the last read to group
+/// \param max_basepairs_per_index the maximum number of basepairs in an IndexDescriptor
+/// \return list of IndexDescriptors, empty if the range is empty
+std::vector<IndexDescriptor> group_reads_into_indices(const io::FastaParser& parser,
+                                                      read_id_t first_read,
+                                                      read_id_t past_the_last_read,
+                                                      number_of_basepairs_t max_basepairs_per_index);
+
 } // namespace cudamapper
 
 } // namespace genomeworks
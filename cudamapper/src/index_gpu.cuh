@@ -21,7 +21,9 @@
 
 #include <thrust/adjacent_difference.h>
 #include <thrust/copy.h>
+#include <thrust/count.h>
 #include <thrust/host_vector.h>
+#include <thrust/iterator/zip_iterator.h>
 #include <thrust/replace.h>
 #include <thrust/transform.h>
 #include <thrust/transform_scan.h>
@@ -35,6 +37,7 @@
 #include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
 
 #include "index_host_copy.cuh"
+#include "low_complexity_masker.hpp"
 
 namespace claraparabricks
 {
@@ -72,15 +75,17 @@ public:
     /// \param hash_representations - if true, hash kmer representations
     /// \param filtering_parameter - filter out all representations for which number_of_sketch_elements_with_that_representation/total_skech_elements >= filtering_parameter, filtering_parameter == 1.0 disables filtering
     /// \param cuda_stream CUDA stream on which the work is to be done. Device arrays are also associated with this stream and will not be freed at least until all work issued on this stream before calling their destructor is done
+    /// \param dust_score_threshold - remove sketch elements overlapping low-complexity intervals with SDUST score above this value, 0 disables masking
     IndexGPU(DefaultDeviceAllocator allocator,
              const io::FastaParser& parser,
              const read_id_t first_read_id,
              const read_id_t past_the_last_read_id,
              const std::uint64_t kmer_size,
              const std::uint64_t window_size,
-             const bool hash_representations  = true,
-             const double filtering_parameter = 1.0,
-             const cudaStream_t cuda_stream   = 0);
+             const bool hash_representations         = true,
+             const double filtering_parameter        = 1.0,
+             const cudaStream_t cuda_stream          = 0,
+             const std::int32_t dust_score_threshold = 0);
 
     /// \brief Constructor which copies the index from host copy
     ///
@@ -137,7 +142,8 @@ private:
                         const read_id_t first_read_id,
                         const read_id_t past_the_last_read_id,
                         const bool hash_representations,
-                        const double filtering_parameter);
+                        const double filtering_parameter,
+                        const std::int32_t dust_score_threshold);
 
     device_buffer<representation_t> representations_d_;
     device_buffer<read_id_t> read_ids_d_;
@@ -546,6 +552,73 @@ void filter_out_most_common_representations(DefaultDeviceAllocator allocator,
     swap(directions_of_representations_d, directions_of_representations_after_compression_d);
 }
 
+/// \brief removes sketch elements whose k-mers overlap masked basepairs
+///
+/// Sketch elements are expected to be grouped by read, as they are when they are generated, and their relative order is preserved
+///
+/// \param allocator pointer to asynchronous device allocator
+/// \param first_read_id read_id of the first read in the index
+/// \param kmer_size k - the kmer length
+/// \param masked_basepairs_d one element per basepair in merged basepairs array, 1 if the basepair is masked
+/// \param read_id_to_basepairs_section_d section of merged basepairs array for each read
+/// \param representations_d original values on input, filtered on output
+/// \param rest_d original values on input, filtered on output
+/// \param cuda_stream CUDA stream on which the work is to be done
+/// \tparam ReadidPositionDirection any implementation of SketchElementImpl::ReadidPositionDirection
+template <typename ReadidPositionDirection>
+void remove_masked_sketch_elements(DefaultDeviceAllocator allocator,
+                                   const read_id_t first_read_id,
+                                   const std::uint64_t kmer_size,
+                                   const device_buffer<char>& masked_basepairs_d,
+                                   const device_buffer<ArrayBlock>& read_id_to_basepairs_section_d,
+                                   device_buffer<representation_t>& representations_d,
+                                   device_buffer<ReadidPositionDirection>& rest_d,
+                                   const cudaStream_t cuda_stream = 0)
+{
+    // *** mark sketch elements to keep ***
+    device_buffer<char> keep_sketch_element_d(rest_d.size(), allocator, cuda_stream);
+    {
+        // direct pointers needed as device_buffer does not have device accessors
+        const char* const masked_basepairs_d_ptr                   = masked_basepairs_d.data();
+        const ArrayBlock* const read_id_to_basepairs_section_d_ptr = read_id_to_basepairs_section_d.data();
+        thrust::transform(thrust::cuda::par(allocator).on(cuda_stream),
+                          std::begin(rest_d),
+                          std::end(rest_d),
+                          std::begin(keep_sketch_element_d),
+                          [masked_basepairs_d_ptr, read_id_to_basepairs_section_d_ptr, first_read_id, kmer_size] __device__(const ReadidPositionDirection& sketch_element) -> char {
+                              const std::uint64_t first_basepair = read_id_to_basepairs_section_d_ptr[sketch_element.read_id_ - first_read_id].first_element_ + sketch_element.position_in_read_;
+                              for (std::uint64_t i = 0; i < kmer_size; ++i)
+                              {
+                                  if (masked_basepairs_d_ptr[first_basepair + i])
+                                      return 0;
+                              }
+                              return 1;
+                          });
+    }
+
+    const std::int64_t number_of_kept_sketch_elements = thrust::count(thrust::cuda::par(allocator).on(cuda_stream),
+                                                                      std::begin(keep_sketch_element_d),
+                                                                      std::end(keep_sketch_element_d),
+                                                                      1);
+
+    GW_LOG_INFO("Removing {} of {} sketch elements overlapping low-complexity regions",
+                get_size(rest_d) - number_of_kept_sketch_elements,
+                get_size(rest_d));
+
+    // *** compress arrays ***
+    device_buffer<representation_t> kept_representations_d(number_of_kept_sketch_elements, allocator, cuda_stream);
+    device_buffer<ReadidPositionDirection> kept_rest_d(number_of_kept_sketch_elements, allocator, cuda_stream);
+    thrust::copy_if(thrust::cuda::par(allocator).on(cuda_stream),
+                    thrust::make_zip_iterator(thrust::make_tuple(std::begin(representations_d), std::begin(rest_d))),
+                    thrust::make_zip_iterator(thrust::make_tuple(std::end(representations_d), std::end(rest_d))),
+                    std::begin(keep_sketch_element_d),
+                    thrust::make_zip_iterator(thrust::make_tuple(std::begin(kept_representations_d), std::begin(kept_rest_d))),
+                    [] __device__(const char keep) { return keep != 0; });
+
+    swap(representations_d, kept_representations_d);
+    swap(rest_d, kept_rest_d);
+}
+
 } // namespace index_gpu
 
 } // namespace details
@@ -559,7 +632,8 @@ IndexGPU<SketchElementImpl>::IndexGPU(DefaultDeviceAllocator allocator,
                                       const std::uint64_t window_size,
                                       const bool hash_representations,
                                       const double filtering_parameter,
-                                      const cudaStream_t cuda_stream)
+                                      const cudaStream_t cuda_stream,
+                                      const std::int32_t dust_score_threshold)
     : first_read_id_(first_read_id)
     , kmer_size_(kmer_size)
     , window_size_(window_size)
@@ -578,7 +652,8 @@ IndexGPU<SketchElementImpl>::IndexGPU(DefaultDeviceAllocator allocator,
                    first_read_id_,
                    past_the_last_read_id,
                    hash_representations,
-                   filtering_parameter);
+                   filtering_parameter,
+                   dust_score_threshold);
 
     // This is not completely necessary, but if removed one has to make sure that the next step
     // uses the same stream or that sync is done in caller
@@ -698,7 +773,8 @@ void IndexGPU<SketchElementImpl>::generate_index(const io::FastaParser& parser,
                                                  const read_id_t first_read_id,
                                                  const read_id_t past_the_last_read_id,
                                                  const bool hash_representations,
-                                                 const double filtering_parameter)
+                                                 const double filtering_parameter,
+                                                 const std::int32_t dust_score_threshold)
 {
 
     // check if there are any reads to process
@@ -761,6 +837,27 @@ void IndexGPU<SketchElementImpl>::generate_index(const io::FastaParser& parser,
                   std::end(read_basepairs),
                   std::next(std::begin(merged_basepairs_h), read_id_to_basepairs_section_h[local_read_id].first_element_));
     }
+
+    // mark basepairs in low-complexity intervals, sketch elements overlapping them get removed after they are generated
+    std::vector<char> masked_basepairs_h;
+    if (dust_score_threshold > 0)
+    {
+        masked_basepairs_h.resize(total_basepairs, 0);
+        const std::vector<std::vector<MaskedInterval>> masked_intervals = find_low_complexity_intervals(parser,
+                                                                                                        first_read_id,
+                                                                                                        past_the_last_read_id,
+                                                                                                        dust_score_threshold);
+        for (read_id_t local_read_id = 0; local_read_id < number_of_reads_; ++local_read_id)
+        {
+            const std::uint64_t first_basepair = read_id_to_basepairs_section_h[local_read_id].first_element_;
+            for (const MaskedInterval& interval : masked_intervals[local_read_id])
+            {
+                std::fill(std::next(std::begin(masked_basepairs_h), first_basepair + interval.begin),
+                          std::next(std::begin(masked_basepairs_h), first_basepair + interval.end),
+                          1);
+            }
+        }
+    }
     fasta_reads.clear();
     fasta_reads.shrink_to_fit();
 
@@ -800,6 +897,27 @@ void IndexGPU<SketchElementImpl>::generate_index(const io::FastaParser& parser,
     //       Consider implementing a move-to-index function for that sort. That way this interface would be more verbose and there
     //       would be no need for copy_rest_to_separate_arrays()
 
+    if (!masked_basepairs_h.empty())
+    {
+        GW_LOG_INFO("Allocating {} bytes for masked_basepairs_d", masked_basepairs_h.size() * sizeof(decltype(masked_basepairs_h)::value_type));
+        device_buffer<decltype(masked_basepairs_h)::value_type> masked_basepairs_d(masked_basepairs_h.size(), allocator_, cuda_stream_);
+        cudautils::device_copy_n(masked_basepairs_h.data(),
+                                 masked_basepairs_h.size(),
+                                 masked_basepairs_d.data(),
+                                 cuda_stream_); // H2D
+
+        details::index_gpu::remove_masked_sketch_elements(allocator_,
+                                                          first_read_id,
+                                                          kmer_size_,
+                                                          masked_basepairs_d,
+                                                          read_id_to_basepairs_section_d,
+                                                          generated_representations_d,
+                                                          generated_rest_d,
+                                                          cuda_stream_);
+        // masked_basepairs_h has to stay alive until the asynchronous copy is done
+        GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream_));
+    }
+
     GW_LOG_INFO("Deallocating {} bytes from read_id_to_basepairs_section_d", read_id_to_basepairs_section_d.size() * sizeof(decltype(read_id_to_basepairs_section_d)::value_type));
     read_id_to_basepairs_section_d.free();
     GW_LOG_INFO("Deallocating {} bytes from merged_basepairs_d", merged_basepairs_d.size() * sizeof(decltype(merged_basepairs_d)::value_type));
@@ -14,6 +14,11 @@
 * limitations under the License.
 */
 
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <type_traits>
+
 #include <thrust/copy.h>
 #include "index_host_copy.cuh"
 #include "index_gpu.cuh"
@@ -28,6 +33,55 @@ namespace genomeworks
 namespace cudamapper
 {
 
+namespace
+{
+
+/// Identifies GenomeWorks index files, increase the last byte when the layout changes
+constexpr std::uint64_t index_file_magic = 0x4757494E44455801; // "GWINDEX" + version 1
+
+template <typename T>
+void write_value(std::ostream& output_stream,
+                 const T& value)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be written directly");
+    output_stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+T read_value(std::istream& input_stream)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be read directly");
+    T value;
+    if (!input_stream.read(reinterpret_cast<char*>(&value), sizeof(T)))
+    {
+        throw std::runtime_error("Unexpected end of index file");
+    }
+    return value;
+}
+
+template <typename T>
+void write_vector(std::ostream& output_stream,
+                  const std::vector<T>& data)
+{
+    write_value(output_stream, static_cast<std::uint64_t>(data.size()));
+    output_stream.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(T));
+}
+
+template <typename T>
+std::vector<T> read_vector(std::istream& input_stream)
+{
+    static_assert(std::is_trivially_copyable<T>::value, "only trivially copyable values can be read directly");
+    const std::uint64_t number_of_elements = read_value<std::uint64_t>(input_stream);
+    std::vector<T> data(number_of_elements);
+    if (!input_stream.read(reinterpret_cast<char*>(data.data()), number_of_elements * sizeof(T)))
+    {
+        throw std::runtime_error("Unexpected end of index file");
+    }
+    return data;
+}
+
+} // namespace
+
 IndexHostCopy::IndexHostCopy(const Index& index,
                              const read_id_t first_read_id,
                              const std::uint64_t kmer_size,
@@ -83,6 +137,100 @@ IndexHostCopy::IndexHostCopy(const Index& index,
     GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream));
 }
 
+IndexHostCopy::IndexHostCopy(std::vector<representation_t> representations,
+                             std::vector<read_id_t> read_ids,
+                             std::vector<position_in_read_t> positions_in_reads,
+                             std::vector<SketchElement::DirectionOfRepresentation> directions_of_reads,
+                             std::vector<representation_t> unique_representations,
+                             std::vector<std::uint32_t> first_occurrence_of_representations,
+                             const read_id_t number_of_reads,
+                             const position_in_read_t number_of_basepairs_in_longest_read,
+                             const read_id_t first_read_id,
+                             const std::uint64_t kmer_size,
+                             const std::uint64_t window_size)
+    : representations_(std::move(representations))
+    , read_ids_(std::move(read_ids))
+    , positions_in_reads_(std::move(positions_in_reads))
+    , directions_of_reads_(std::move(directions_of_reads))
+    , unique_representations_(std::move(unique_representations))
+    , first_occurrence_of_representations_(std::move(first_occurrence_of_representations))
+    , number_of_reads_(number_of_reads)
+    , number_of_basepairs_in_longest_read_(number_of_basepairs_in_longest_read)
+    , first_read_id_(first_read_id)
+    , kmer_size_(kmer_size)
+    , window_size_(window_size)
+{
+}
+
+std::unique_ptr<IndexHostCopy> IndexHostCopy::load(std::istream& input_stream)
+{
+    GW_NVTX_RANGE(profiler, "load_index");
+
+    if (read_value<std::uint64_t>(input_stream) != index_file_magic)
+    {
+        throw std::runtime_error("Not an index file or index file created by an incompatible version");
+    }
+
+    const read_id_t first_read_id                           = read_value<read_id_t>(input_stream);
+    const std::uint64_t kmer_size                           = read_value<std::uint64_t>(input_stream);
+    const std::uint64_t window_size                         = read_value<std::uint64_t>(input_stream);
+    const read_id_t number_of_reads                         = read_value<read_id_t>(input_stream);
+    const position_in_read_t number_of_basepairs_in_longest = read_value<position_in_read_t>(input_stream);
+
+    std::vector<representation_t> representations                    = read_vector<representation_t>(input_stream);
+    std::vector<read_id_t> read_ids                                  = read_vector<read_id_t>(input_stream);
+    std::vector<position_in_read_t> positions_in_reads               = read_vector<position_in_read_t>(input_stream);
+    std::vector<SketchElement::DirectionOfRepresentation> directions = read_vector<SketchElement::DirectionOfRepresentation>(input_stream);
+    std::vector<representation_t> unique_representations             = read_vector<representation_t>(input_stream);
+    std::vector<std::uint32_t> first_occurrence_of_representations   = read_vector<std::uint32_t>(input_stream);
+
+    if (read_ids.size() != representations.size() ||
+        positions_in_reads.size() != representations.size() ||
+        directions.size() != representations.size() ||
+        first_occurrence_of_representations.size() != unique_representations.size() + 1)
+    {
+        throw std::runtime_error("Index file is corrupted, array sizes do not match");
+    }
+
+    // constructor is private, so std::make_unique can't be used
+    return std::unique_ptr<IndexHostCopy>(new IndexHostCopy(std::move(representations),
+                                                            std::move(read_ids),
+                                                            std::move(positions_in_reads),
+                                                            std::move(directions),
+                                                            std::move(unique_representations),
+                                                            std::move(first_occurrence_of_representations),
+                                                            number_of_reads,
+                                                            number_of_basepairs_in_longest,
+                                                            first_read_id,
+                                                            kmer_size,
+                                                            window_size));
+}
+
+void IndexHostCopy::save(std::ostream& output_stream) const
+{
+    GW_NVTX_RANGE(profiler, "save_index");
+
+    write_value(output_stream, index_file_magic);
+
+    write_value(output_stream, first_read_id_);
+    write_value(output_stream, kmer_size_);
+    write_value(output_stream, window_size_);
+    write_value(output_stream, number_of_reads_);
+    write_value(output_stream, number_of_basepairs_in_longest_read_);
+
+    write_vector(output_stream, representations_);
+    write_vector(output_stream, read_ids_);
+    write_vector(output_stream, positions_in_reads_);
+    write_vector(output_stream, directions_of_reads_);
+    write_vector(output_stream, unique_representations_);
+    write_vector(output_stream, first_occurrence_of_representations_);
+
+    if (!output_stream)
+    {
+        throw std::runtime_error("Could not write index file");
+    }
+}
+
 std::unique_ptr<Index> IndexHostCopy::copy_index_to_device(DefaultDeviceAllocator allocator,
                                                            const cudaStream_t cuda_stream) const
 {
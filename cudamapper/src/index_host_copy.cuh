@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <iosfwd>
+
 #include <claraparabricks/genomeworks/cudamapper/index.hpp>
 
 namespace claraparabricks
@@ -46,6 +48,12 @@ public:
                   const std::uint64_t window_size,
                   const cudaStream_t cuda_stream);
 
+    /// \brief reads an index previously written by save()
+    /// \param input_stream stream to read from, should be opened in binary mode
+    /// \throw std::runtime_error if the stream does not contain a valid index
+    /// \return - pointer to genomeworks::cudamapper::IndexHostCopy
+    static std::unique_ptr<IndexHostCopy> load(std::istream& input_stream);
+
     /// \brief copy cached index vectors from the host and create an object of Index on GPU
     /// \param allocator pointer to asynchronous device allocator
     /// \param cuda_stream H2D copy is done on this stream. Device arrays are also associated with this stream and will not be freed at least until all work issued on this stream before calling their destructor is done
@@ -97,7 +105,25 @@ public:
     /// \return window_size_
     std::uint64_t window_size() const override;
 
+    /// \brief writes the index to a binary stream so it can later be loaded using load()
+    /// \param output_stream stream to write to, should be opened in binary mode
+    /// \throw std::runtime_error if writing fails
+    void save(std::ostream& output_stream) const override;
+
 private:
+    /// \brief Constructor used by load()
+    IndexHostCopy(std::vector<representation_t> representations,
+                  std::vector<read_id_t> read_ids,
+                  std::vector<position_in_read_t> positions_in_reads,
+                  std::vector<SketchElement::DirectionOfRepresentation> directions_of_reads,
+                  std::vector<representation_t> unique_representations,
+                  std::vector<std::uint32_t> first_occurrence_of_representations,
+                  read_id_t number_of_reads,
+                  position_in_read_t number_of_basepairs_in_longest_read,
+                  read_id_t first_read_id,
+                  std::uint64_t kmer_size,
+                  std::uint64_t window_size);
+
     std::vector<representation_t> representations_;
     std::vector<read_id_t> read_ids_;
     std::vector<position_in_read_t> positions_in_reads_;
@@ -0,0 +1,99 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "index_sketch.hpp"
+
+#include <algorithm>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+IndexSketch create_index_sketch(const representation_t* const sorted_unique_representations,
+                                const std::int64_t number_of_unique_representations,
+                                const std::int32_t sketch_size)
+{
+    const std::int64_t number_of_representations_in_sketch = std::min<std::int64_t>(sketch_size, number_of_unique_representations);
+
+    IndexSketch sketch;
+    sketch.smallest_representations.assign(sorted_unique_representations,
+                                           sorted_unique_representations + number_of_representations_in_sketch);
+    sketch.number_of_unique_representations = number_of_unique_representations;
+    return sketch;
+}
+
+double estimate_number_of_shared_representations(const IndexSketch& a,
+                                                  const IndexSketch& b)
+{
+    const std::int64_t a_size = get_size<std::int64_t>(a.smallest_representations);
+    const std::int64_t b_size = get_size<std::int64_t>(b.smallest_representations);
+
+    if (0 == a_size || 0 == b_size)
+    {
+        return 0.0;
+    }
+
+    const bool both_complete = a_size == a.number_of_unique_representations && b_size == b.number_of_unique_representations;
+
+    // walk through the union of both sketches in ascending order, for incomplete sketches only the smallest sketch_size elements
+    // of the union are a uniform sample in which each element is known to be in both sets or not
+    const std::int64_t union_sample_size = both_complete ? a_size + b_size : std::min(a_size, b_size);
+    std::int64_t a_index                 = 0;
+    std::int64_t b_index                 = 0;
+    std::int64_t sampled                 = 0;
+    std::int64_t shared                  = 0;
+    while (sampled < union_sample_size && a_index < a_size && b_index < b_size)
+    {
+        const representation_t a_representation = a.smallest_representations[a_index];
+        const representation_t b_representation = b.smallest_representations[b_index];
+        if (a_representation < b_representation)
+        {
+            ++a_index;
+        }
+        else if (b_representation < a_representation)
+        {
+            ++b_index;
+        }
+        else
+        {
+            ++shared;
+            ++a_index;
+            ++b_index;
+        }
+        ++sampled;
+    }
+
+    if (both_complete)
+    {
+        return static_cast<double>(shared);
+    }
+
+    const double jaccard_index = static_cast<double>(shared) / sampled;
+    return jaccard_index / (1.0 + jaccard_index) * (a.number_of_unique_representations + b.number_of_unique_representations);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,70 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <claraparabricks/genomeworks/cudamapper/types.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// IndexSketch - bottom-k MinHash sketch of the set of representations in one index
+///
+/// Representations are hashed k-mers and unique_representations of an index are sorted, so the first sketch_size unique representations
+/// are a uniform sample of all of them. Sketches of two indices are enough to estimate how many representations (seeds) they share without
+/// running the Matcher.
+struct IndexSketch
+{
+    /// sketch_size smallest unique representations in ascending order, all unique representations if the index has fewer
+    std::vector<representation_t> smallest_representations;
+    /// total number of unique representations in the index
+    std::int64_t number_of_unique_representations = 0;
+};
+
+/// \brief creates sketch of an index
+/// \param sorted_unique_representations unique representations of the index in ascending order, only the first min(sketch_size, number_of_unique_representations) are accessed
+/// \param number_of_unique_representations
+/// \param sketch_size maximal number of representations in the sketch
+/// \return the sketch
+IndexSketch create_index_sketch(const representation_t* sorted_unique_representations,
+                                std::int64_t number_of_unique_representations,
+                                std::int32_t sketch_size);
+
+/// \brief estimates the number of unique representations present in both indices
+///
+/// If both sketches contain all representations of their indices the exact number is returned. Otherwise Jaccard index J is estimated
+/// from the smallest representations of the union of both sketches and the number of shared representations is J / (1 + J) * (|A| + |B|).
+///
+/// \param a sketch of one index
+/// \param b sketch of the other index
+/// \return estimated number of shared unique representations
+double estimate_number_of_shared_representations(const IndexSketch& a,
+                                                  const IndexSketch& b);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
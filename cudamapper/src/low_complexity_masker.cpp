@@ -0,0 +1,325 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "low_complexity_masker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <deque>
+
+#include <claraparabricks/genomeworks/utils/cudautils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// length of the words whose repetitions are scored
+constexpr std::int32_t triplet_length = 3;
+/// number of different triplets
+constexpr std::int32_t number_of_triplets = 1 << (2 * triplet_length);
+
+/// PerfectInterval - interval whose score is larger than the score of any interval it contains
+struct PerfectInterval
+{
+    std::int32_t start;
+    std::int32_t finish;
+    std::int32_t score;
+    std::int32_t length;
+};
+
+/// SdustWindow - triplets of the current window and the running scores of the window and of its suffix
+///
+/// The suffix is the longest suffix of the window in which no triplet occurs so often that it alone exceeds the threshold.
+struct SdustWindow
+{
+    std::deque<std::int32_t> triplets;
+    std::int32_t suffix_length = 0;
+    std::int32_t window_score  = 0;
+    std::int32_t suffix_score  = 0;
+    std::array<std::int32_t, number_of_triplets> window_counts{};
+    std::array<std::int32_t, number_of_triplets> suffix_counts{};
+};
+
+/// \brief returns 2-bit encoding of a basepair or 4 if it is not A, C, G or T
+std::int32_t encode_basepair(const char basepair)
+{
+    switch (basepair)
+    {
+    case 'A':
+    case 'a':
+        return 0;
+    case 'C':
+    case 'c':
+        return 1;
+    case 'G':
+    case 'g':
+        return 2;
+    case 'T':
+    case 't':
+        return 3;
+    default:
+        return 4;
+    }
+}
+
+/// \brief adds triplet to the window, removes the oldest triplet if the window is full and shortens the suffix if needed
+void shift_window(const std::int32_t triplet,
+                  const std::int32_t score_threshold,
+                  const std::int32_t window_size,
+                  SdustWindow& window)
+{
+    if (get_size<std::int32_t>(window.triplets) >= window_size - triplet_length + 1)
+    {
+        const std::int32_t removed_triplet = window.triplets.front();
+        window.triplets.pop_front();
+        window.window_score -= --window.window_counts[removed_triplet];
+        if (window.suffix_length > get_size<std::int32_t>(window.triplets))
+        {
+            --window.suffix_length;
+            window.suffix_score -= --window.suffix_counts[removed_triplet];
+        }
+    }
+
+    window.triplets.push_back(triplet);
+    ++window.suffix_length;
+    window.window_score += window.window_counts[triplet]++;
+    window.suffix_score += window.suffix_counts[triplet]++;
+
+    if (window.suffix_counts[triplet] * 10 > score_threshold * 2)
+    {
+        // this triplet alone makes the suffix score too high, remove triplets from the front of the suffix up to its previous occurrence
+        std::int32_t removed_triplet = 0;
+        do
+        {
+            removed_triplet = window.triplets[window.triplets.size() - window.suffix_length];
+            window.suffix_score -= --window.suffix_counts[removed_triplet];
+            --window.suffix_length;
+        } while (removed_triplet != triplet);
+    }
+}
+
+/// \brief moves perfect intervals which start before start into masked intervals, merging overlapping intervals
+void save_masked_intervals(const std::int32_t start,
+                           std::vector<PerfectInterval>& perfect_intervals,
+                           std::vector<MaskedInterval>& masked_intervals)
+{
+    // perfect intervals are sorted by start in descending order
+    if (perfect_intervals.empty() || perfect_intervals.back().start >= start)
+    {
+        return;
+    }
+
+    const PerfectInterval& interval = perfect_intervals.back();
+    if (!masked_intervals.empty() && static_cast<position_in_read_t>(interval.start) <= masked_intervals.back().end)
+    {
+        masked_intervals.back().end = std::max(masked_intervals.back().end, static_cast<position_in_read_t>(interval.finish));
+    }
+    else
+    {
+        masked_intervals.push_back({static_cast<position_in_read_t>(interval.start),
+                                    static_cast<position_in_read_t>(interval.finish)});
+    }
+
+    // remove perfect intervals which have fallen out of the window
+    while (!perfect_intervals.empty() && perfect_intervals.back().start < start)
+    {
+        perfect_intervals.pop_back();
+    }
+}
+
+/// \brief finds perfect intervals which end at the end of the window and start before its suffix
+void find_perfect_intervals(const SdustWindow& window,
+                            const std::int32_t score_threshold,
+                            const std::int32_t start,
+                            std::vector<PerfectInterval>& perfect_intervals)
+{
+    std::array<std::int32_t, number_of_triplets> counts = window.suffix_counts;
+    std::int32_t score                                  = window.suffix_score;
+    std::int32_t max_score                              = 0;
+    std::int32_t max_length                             = 0;
+
+    for (std::int32_t i = get_size<std::int32_t>(window.triplets) - window.suffix_length - 1; i >= 0; --i)
+    {
+        const std::int32_t triplet = window.triplets[i];
+        score += counts[triplet]++;
+        const std::int32_t length = get_size<std::int32_t>(window.triplets) - i - 1;
+        if (score * 10 > score_threshold * length)
+        {
+            // find insertion position and the best perfect interval that contains this one
+            std::size_t insertion_position = 0;
+            for (; insertion_position < perfect_intervals.size() && perfect_intervals[insertion_position].start >= i + start; ++insertion_position)
+            {
+                const PerfectInterval& interval = perfect_intervals[insertion_position];
+                if (max_score == 0 || interval.score * max_length > max_score * interval.length)
+                {
+                    max_score  = interval.score;
+                    max_length = interval.length;
+                }
+            }
+            if (max_score == 0 || score * max_length >= max_score * length)
+            {
+                max_score  = score;
+                max_length = length;
+                perfect_intervals.insert(std::next(std::begin(perfect_intervals), insertion_position),
+                                         PerfectInterval{i + start,
+                                                         get_size<std::int32_t>(window.triplets) + (triplet_length - 1) + start,
+                                                         score,
+                                                         length});
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool operator==(const MaskedInterval& lhs,
+                const MaskedInterval& rhs)
+{
+    return lhs.begin == rhs.begin && lhs.end == rhs.end;
+}
+
+std::vector<MaskedInterval> find_low_complexity_intervals(const std::string& sequence,
+                                                          const std::int32_t score_threshold,
+                                                          const std::int32_t window_size)
+{
+    std::vector<MaskedInterval> masked_intervals;
+    std::vector<PerfectInterval> perfect_intervals;
+    SdustWindow window;
+
+    const std::int32_t sequence_length = get_size<std::int32_t>(sequence);
+    std::int32_t part_length           = 0; // number of basepairs since the last basepair which is not A, C, G or T
+    std::int32_t triplet               = 0;
+    for (std::int32_t i = 0; i <= sequence_length; ++i)
+    {
+        const std::int32_t basepair = i < sequence_length ? encode_basepair(sequence[i]) : 4;
+        if (basepair < 4)
+        {
+            ++part_length;
+            triplet = ((triplet << 2) | basepair) & (number_of_triplets - 1);
+            if (part_length >= triplet_length)
+            {
+                const std::int32_t start = std::max(part_length - window_size, 0) + (i + 1 - part_length); // start of the current window
+                save_masked_intervals(start, perfect_intervals, masked_intervals);
+                shift_window(triplet, score_threshold, window_size, window);
+                if (window.window_score * 10 > window.suffix_length * score_threshold)
+                {
+                    find_perfect_intervals(window, score_threshold, start, perfect_intervals);
+                }
+            }
+        }
+        else
+        {
+            // end of sequence or a basepair which breaks the sequence into independent parts, save all remaining perfect intervals
+            std::int32_t start = std::max(part_length - window_size + 1, 0) + (i + 1 - part_length);
+            while (!perfect_intervals.empty())
+            {
+                save_masked_intervals(start++, perfect_intervals, masked_intervals);
+            }
+            part_length = 0;
+            triplet     = 0;
+            window      = SdustWindow();
+        }
+    }
+
+    return masked_intervals;
+}
+
+std::vector<std::vector<MaskedInterval>> find_low_complexity_intervals(const io::FastaParser& parser,
+                                                                       const read_id_t first_read_id,
+                                                                       const read_id_t past_the_last_read_id,
+                                                                       const std::int32_t score_threshold,
+                                                                       const std::int32_t window_size)
+{
+    GW_NVTX_RANGE(profiler, "find_low_complexity_intervals");
+
+    std::vector<std::vector<MaskedInterval>> masked_intervals(past_the_last_read_id - first_read_id);
+
+    // reads are split into a few parts per thread to balance the load without creating a task per read
+    const read_id_t number_of_reads = past_the_last_read_id - first_read_id;
+    const read_id_t reads_per_task  = std::max<read_id_t>(1, number_of_reads / (4 * get_global_thread_pool().number_of_threads()));
+
+    TaskGroup tasks(get_global_thread_pool());
+    for (read_id_t first_read_in_task = 0; first_read_in_task < number_of_reads; first_read_in_task += reads_per_task)
+    {
+        const read_id_t past_the_last_read_in_task = std::min(first_read_in_task + reads_per_task, number_of_reads);
+        tasks.run([&, first_read_in_task, past_the_last_read_in_task]() {
+            for (read_id_t i = first_read_in_task; i < past_the_last_read_in_task; ++i)
+            {
+                masked_intervals[i] = find_low_complexity_intervals(parser.get_sequence_by_id(first_read_id + i).seq,
+                                                                    score_threshold,
+                                                                    window_size);
+            }
+        });
+    }
+    tasks.wait();
+
+    return masked_intervals;
+}
+
+bool is_kmer_masked(const std::vector<MaskedInterval>& intervals,
+                    const position_in_read_t kmer_position,
+                    const std::uint64_t kmer_size)
+{
+    // first interval which ends after the first basepair of the k-mer
+    const auto interval = std::upper_bound(std::begin(intervals),
+                                           std::end(intervals),
+                                           kmer_position,
+                                           [](const position_in_read_t position, const MaskedInterval& interval) {
+                                               return position < interval.end;
+                                           });
+    return interval != std::end(intervals) && interval->begin < kmer_position + kmer_size;
+}
+
+void write_low_complexity_intervals_bed(const io::FastaParser& parser,
+                                        const std::int32_t score_threshold,
+                                        std::ostream& output_stream)
+{
+    // process reads in parts to limit the memory taken by intervals which have not been written yet
+    const read_id_t reads_per_part  = 100000;
+    const read_id_t number_of_reads = parser.get_num_seqences();
+    for (read_id_t first_read_id = 0; first_read_id < number_of_reads; first_read_id += reads_per_part)
+    {
+        const read_id_t past_the_last_read_id                           = std::min(first_read_id + reads_per_part, number_of_reads);
+        const std::vector<std::vector<MaskedInterval>> masked_intervals = find_low_complexity_intervals(parser,
+                                                                                                        first_read_id,
+                                                                                                        past_the_last_read_id,
+                                                                                                        score_threshold);
+        for (read_id_t read_id = first_read_id; read_id < past_the_last_read_id; ++read_id)
+        {
+            const std::string& read_name = parser.get_sequence_by_id(read_id).name;
+            for (const MaskedInterval& interval : masked_intervals[read_id - first_read_id])
+            {
+                output_stream << read_name << '\t' << interval.begin << '\t' << interval.end << '\n';
+            }
+        }
+    }
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,95 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/types.hpp>
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// MaskedInterval - interval of basepairs [begin, end) of one read
+struct MaskedInterval
+{
+    position_in_read_t begin;
+    position_in_read_t end;
+};
+
+bool operator==(const MaskedInterval& lhs,
+                const MaskedInterval& rhs);
+
+/// \brief finds low-complexity intervals of a sequence using the symmetric DUST algorithm (SDUST)
+///
+/// Every window of window_size basepairs is scored by the number of repeated triplets in it. Low-complexity intervals are
+/// the maximal "perfect" intervals whose score is above score_threshold, see Morgulis et al., A fast and symmetric DUST
+/// implementation to mask low-complexity DNA sequences, J Comput Biol 2006. Basepairs other than A, C, G and T split the
+/// sequence into independent parts.
+///
+/// \param sequence basepairs of the sequence
+/// \param score_threshold intervals with score above this value are masked, higher values mask less
+/// \param window_size length of the scoring window in basepairs
+/// \return sorted and non-overlapping low-complexity intervals
+std::vector<MaskedInterval> find_low_complexity_intervals(const std::string& sequence,
+                                                          std::int32_t score_threshold = 20,
+                                                          std::int32_t window_size     = 64);
+
+/// \brief finds low-complexity intervals of reads [first_read_id, past_the_last_read_id), reads are processed in parallel on the global thread pool
+/// \param parser
+/// \param first_read_id
+/// \param past_the_last_read_id
+/// \param score_threshold see find_low_complexity_intervals()
+/// \param window_size see find_low_complexity_intervals()
+/// \return low-complexity intervals of each read, element i belongs to read first_read_id + i
+std::vector<std::vector<MaskedInterval>> find_low_complexity_intervals(const io::FastaParser& parser,
+                                                                       read_id_t first_read_id,
+                                                                       read_id_t past_the_last_read_id,
+                                                                       std::int32_t score_threshold = 20,
+                                                                       std::int32_t window_size     = 64);
+
+/// \brief checks if k-mer overlaps any of the intervals
+/// \param intervals sorted and non-overlapping intervals
+/// \param kmer_position position of the first basepair of the k-mer
+/// \param kmer_size
+/// \return true if at least one basepair of the k-mer is in one of the intervals
+bool is_kmer_masked(const std::vector<MaskedInterval>& intervals,
+                    position_in_read_t kmer_position,
+                    std::uint64_t kmer_size);
+
+/// \brief writes low-complexity intervals of all reads in BED format (read name, begin, end)
+/// \param parser
+/// \param score_threshold see find_low_complexity_intervals()
+/// \param output_stream
+void write_low_complexity_intervals_bed(const io::FastaParser& parser,
+                                        std::int32_t score_threshold,
+                                        std::ostream& output_stream);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
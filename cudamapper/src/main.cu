@@ -16,28 +16,54 @@
 
 #include <atomic>
 #include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
-#include <future>
+#include <iterator>
 #include <mutex>
+#include <numeric>
+#include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <claraparabricks/genomeworks/utils/cudautils.hpp>
 #include <claraparabricks/genomeworks/utils/mathutils.hpp>
 #include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
 #include <claraparabricks/genomeworks/utils/threadsafe_containers.hpp>
 
 #include <claraparabricks/genomeworks/cudaaligner/aligner.hpp>
 #include <claraparabricks/genomeworks/cudaaligner/alignment.hpp>
+#include <claraparabricks/genomeworks/cudaaligner/async_aligner.hpp>
 
 #include <claraparabricks/genomeworks/cudamapper/index.hpp>
 #include <claraparabricks/genomeworks/cudamapper/matcher.hpp>
 #include <claraparabricks/genomeworks/cudamapper/overlapper.hpp>
 #include <claraparabricks/genomeworks/cudamapper/utils.hpp>
 
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "alignment_binning.hpp"
+#include "anchored_alignment.hpp"
 #include "application_parameters.hpp"
 #include "cudamapper_utils.hpp"
 #include "index_batcher.cuh"
+#include "index_cpu.hpp"
+#include "index_sketch.hpp"
+#include "incremental_state.hpp"
+#include "low_complexity_masker.hpp"
+#include "mapping_server.hpp"
+#include "mapping_service.cuh"
+#include "sketch_similarity.hpp"
+#include "streaming_fasta_reader.hpp"
+#include "matcher_cpu.hpp"
+#include "overlapper_cpu.hpp"
 
 namespace claraparabricks
 {
@@ -51,85 +77,125 @@ namespace cudamapper
 namespace
 {
 
-void run_alignment_batch(DefaultDeviceAllocator allocator,
-                         std::mutex& overlap_idx_mtx,
-                         std::vector<Overlap>& overlaps,
-                         const io::FastaParser& query_parser,
-                         const io::FastaParser& target_parser,
-                         int32_t& overlap_idx,
-                         const int32_t max_query_size, const int32_t max_target_size,
-                         std::vector<std::string>& cigars, const int32_t batch_size)
+/// with -X overlaps are written to stdout and appended to this file, access is controlled by the same mutex as stdout
+std::FILE* incremental_overlaps_file = nullptr;
+
+/// with -P number of pairs of indices which were not matched because their sketches share too few representations
+std::atomic<int64_t> number_of_prescreened_pairs_of_indices(0);
+
+/// \brief copies the smallest unique representations of an index to host and creates its sketch
+/// \param index
+/// \param sketch_size
+/// \param cuda_stream
+/// \return sketch of the index
+IndexSketch create_index_sketch(const Index& index,
+                                const int32_t sketch_size,
+                                cudaStream_t cuda_stream)
 {
-    int32_t device_id;
-    GW_CU_CHECK_ERR(cudaGetDevice(&device_id));
-    cudaStream_t stream;
-    GW_CU_CHECK_ERR(cudaStreamCreate(&stream));
-    std::unique_ptr<cudaaligner::Aligner> batch =
-        cudaaligner::create_aligner(
-            max_query_size,
-            max_target_size,
-            batch_size,
-            cudaaligner::AlignmentType::global_alignment,
-            allocator,
-            stream,
-            device_id);
-    while (true)
-    {
-        int32_t idx_start = 0, idx_end = 0;
-        // Get the range of overlaps for this batch
-        {
-            std::lock_guard<std::mutex> lck(overlap_idx_mtx);
-            if (overlap_idx == get_size<int32_t>(overlaps))
-            {
-                break;
-            }
-            else
-            {
-                idx_start   = overlap_idx;
-                idx_end     = std::min(idx_start + batch_size, get_size<int32_t>(overlaps));
-                overlap_idx = idx_end;
-            }
-        }
-        for (int32_t idx = idx_start; idx < idx_end; idx++)
+    const int64_t number_of_unique_representations = get_size(index.unique_representations());
+    std::vector<representation_t> smallest_representations(std::min<int64_t>(sketch_size, number_of_unique_representations));
+    cudautils::device_copy_n(index.unique_representations().data(),
+                             smallest_representations.size(),
+                             smallest_representations.data(),
+                             cuda_stream); // D2H
+    GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream));
+    return create_index_sketch(smallest_representations.data(),
+                               number_of_unique_representations,
+                               sketch_size);
+}
+
+/// \brief checks if the sketches of a pair of indices share enough representations for the pair to be matched, reports skipped pairs
+/// \param query_index_descriptor
+/// \param target_index_descriptor
+/// \param query_sketch
+/// \param target_sketch
+/// \param application_parameters
+/// \return true if the pair should be matched
+bool has_enough_shared_seeds(const IndexDescriptor& query_index_descriptor,
+                             const IndexDescriptor& target_index_descriptor,
+                             const IndexSketch& query_sketch,
+                             const IndexSketch& target_sketch,
+                             const ApplicationParameters& application_parameters)
+{
+    const double estimated_shared_seeds = estimate_number_of_shared_representations(query_sketch, target_sketch);
+    if (estimated_shared_seeds >= application_parameters.prescreen_min_shared_seeds)
+    {
+        return true;
+    }
+
+    ++number_of_prescreened_pairs_of_indices;
+    // whole line is composed first so that lines from different threads do not get interleaved
+    std::ostringstream message;
+    message << "Prescreen: skipping query reads [" << query_index_descriptor.first_read() << ", "
+            << query_index_descriptor.first_read() + query_index_descriptor.number_of_reads() << ") and target reads ["
+            << target_index_descriptor.first_read() << ", " << target_index_descriptor.first_read() + target_index_descriptor.number_of_reads()
+            << "), estimated shared seeds " << static_cast<int64_t>(estimated_shared_seeds) << " < " << application_parameters.prescreen_min_shared_seeds << '\n';
+    std::cerr << message.str();
+    return false;
+}
+
+/// \brief prints the number of pairs of indices skipped by has_enough_shared_seeds()
+/// \param application_parameters
+void report_prescreened_pairs_of_indices(const ApplicationParameters& application_parameters)
+{
+    if (number_of_prescreened_pairs_of_indices != 0)
+    {
+        std::cerr << "NOTE: Skipped " << number_of_prescreened_pairs_of_indices << " pairs of indices with fewer than " << application_parameters.prescreen_min_shared_seeds << " estimated shared seeds" << std::endl;
+    }
+}
+
+/// CudaStreams - CUDA streams which are destroyed when the object goes out of scope, also if an exception is thrown
+class CudaStreams
+{
+public:
+    /// \brief creates the streams
+    /// \param number_of_streams
+    explicit CudaStreams(const int32_t number_of_streams)
+    {
+        streams_.reserve(number_of_streams);
+        for (int32_t i = 0; i < number_of_streams; ++i)
         {
-            const Overlap& overlap         = overlaps[idx];
-            const io::FastaSequence query  = query_parser.get_sequence_by_id(overlap.query_read_id_);
-            const io::FastaSequence target = target_parser.get_sequence_by_id(overlap.target_read_id_);
-            const char* query_start        = &query.seq[overlap.query_start_position_in_read_];
-            const int32_t query_length     = overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_;
-            const char* target_start       = &target.seq[overlap.target_start_position_in_read_];
-            const int32_t target_length    = overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_;
-            cudaaligner::StatusType status = batch->add_alignment(query_start, query_length, target_start, target_length,
-                                                                  false, overlap.relative_strand == RelativeStrand::Reverse);
-            if (status != cudaaligner::success)
-            {
-                throw std::runtime_error("Experienced error type " + std::to_string(status));
-            }
+            cudaStream_t stream;
+            GW_CU_CHECK_ERR(cudaStreamCreate(&stream));
+            streams_.push_back(stream);
         }
-        // Launch alignment on the GPU. align_all is an async call.
-        batch->align_all();
-        // Synchronize all alignments.
-        batch->sync_alignments();
-        const std::vector<std::shared_ptr<cudaaligner::Alignment>>& alignments = batch->get_alignments();
+    }
+
+    ~CudaStreams()
+    {
+        for (cudaStream_t stream : streams_)
         {
-            GW_NVTX_RANGE(profiler, "copy_alignments");
-            for (int32_t i = 0; i < get_size<int32_t>(alignments); i++)
-            {
-                cigars[idx_start + i] = alignments[i]->convert_to_cigar();
-            }
+            GW_CU_ABORT_ON_ERR(cudaStreamDestroy(stream));
         }
-        // Reset batch to reuse memory for new alignments.
-        batch->reset();
     }
-    GW_CU_CHECK_ERR(cudaStreamDestroy(stream));
-}
+
+    CudaStreams(const CudaStreams&) = delete;
+    CudaStreams& operator=(const CudaStreams&) = delete;
+
+    /// \brief returns the i-th stream
+    /// \param i
+    /// \return stream
+    cudaStream_t operator[](const int32_t i) const
+    {
+        return streams_[i];
+    }
+
+private:
+    std::vector<cudaStream_t> streams_;
+};
 
 /// \brief performs global alignment between overlapped regions of reads
+///
+/// Overlaps are binned by length and the aligners of each bin are sized for its longest overlap,
+/// so that a few long overlaps do not shrink the batches of the many short ones.
+/// The alignment engines of a bin run behind an AsyncAligner, which fills the batch of one engine
+/// while the others are aligning.
+///
 /// \param overlaps List of overlaps to align
 /// \param query_parser Parser for query reads
 /// \param target_parser Parser for target reads
 /// \param num_alignment_engines Number of parallel alignment engines to use for alignment
-/// \param cigars Output vector to store CIGAR strings for alignments
+/// \param cigars Output vector to store CIGAR strings for alignments, in the order of overlaps
 /// \param allocator The allocator to allocate memory on the device
 void align_overlaps(DefaultDeviceAllocator allocator,
                     std::vector<Overlap>& overlaps,
@@ -138,76 +204,304 @@ void align_overlaps(DefaultDeviceAllocator allocator,
                     int32_t num_alignment_engines,
                     std::vector<std::string>& cigars)
 {
-    // Calculate max target/query size in overlaps
+    // the longest overlap of a bin is at most twice as long as the shortest one
+    const float max_length_ratio = 2.0f;
+    std::vector<int32_t> overlap_order;
+    const std::vector<AlignmentBin> bins = bin_overlaps_by_length(overlaps, max_length_ratio, overlap_order);
+
+    int32_t device_id;
+    GW_CU_CHECK_ERR(cudaGetDevice(&device_id));
+
+    // every engine gets its own stream, so that the copies of one engine overlap with the compute of the others
+    const CudaStreams streams(num_alignment_engines);
+
+    for (const AlignmentBin& bin : bins)
+    {
+        // The aligners of the previous bin are destroyed, so the memory available to this bin can be queried.
+        // The batch size is chosen from the memory each aligner reports for its workspace.
+        const int64_t memory_per_alignment = cudaaligner::calc_aligner_device_memory(bin.max_query_length, bin.max_target_length, 1, cudaaligner::AlignmentType::global_alignment);
+        size_t free, total;
+        GW_CU_CHECK_ERR(cudaMemGetInfo(&free, &total));
+        const int64_t available_memory = static_cast<int64_t>(free) * 85 / 100; // Using 85% of available memory
+        const int32_t batch_size       = calc_alignment_batch_size(available_memory, memory_per_alignment, num_alignment_engines, bin.end - bin.begin);
+        std::cerr << "Aligning " << bin.end - bin.begin << " overlaps (" << bin.max_query_length << "x" << bin.max_target_length << ") with batch size " << batch_size << std::endl;
+
+        // callbacks must not throw, the first error is rethrown once all alignments of the bin are done
+        std::atomic<int32_t> error_status(cudaaligner::success);
+        int32_t next_stream = 0;
+        cudaaligner::AsyncAligner aligner(
+            [&]() {
+                return cudaaligner::create_aligner(bin.max_query_length,
+                                                   bin.max_target_length,
+                                                   batch_size,
+                                                   cudaaligner::AlignmentType::global_alignment,
+                                                   allocator,
+                                                   streams[next_stream++],
+                                                   device_id);
+            },
+            batch_size,
+            num_alignment_engines);
+        for (int32_t idx = bin.begin; idx < bin.end; idx++)
+        {
+            const int32_t overlap_id       = overlap_order[idx];
+            const Overlap& overlap         = overlaps[overlap_id];
+            const io::FastaSequence query  = query_parser.get_sequence_by_id(overlap.query_read_id_);
+            const io::FastaSequence target = target_parser.get_sequence_by_id(overlap.target_read_id_);
+            aligner.submit(&query.seq[overlap.query_start_position_in_read_],
+                           overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_,
+                           &target.seq[overlap.target_start_position_in_read_],
+                           overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_,
+                           false,
+                           overlap.relative_strand == RelativeStrand::Reverse,
+                           [&cigars, &error_status, overlap_id](cudaaligner::StatusType status, std::shared_ptr<cudaaligner::Alignment> alignment) {
+                               if (status != cudaaligner::success)
+                               {
+                                   int32_t no_error = cudaaligner::success;
+                                   error_status.compare_exchange_strong(no_error, status);
+                                   return;
+                               }
+                               GW_NVTX_RANGE(profiler, "copy_alignments");
+                               cigars[overlap_id] = alignment->convert_to_cigar();
+                           });
+        }
+        aligner.wait();
+        if (error_status != cudaaligner::success)
+        {
+            throw std::runtime_error("Experienced error type " + std::to_string(error_status));
+        }
+    }
+}
+
+/// \brief performs global alignment between overlapped regions of reads on the CPU
+///
+/// Each alignment is a separate task of the global thread pool, so alignments of multiple pairs of indices can be computed concurrently.
+///
+/// \param overlaps List of overlaps to align
+/// \param query_parser Parser for query reads
+/// \param target_parser Parser for target reads
+/// \param cigars Output vector to store CIGAR strings for alignments
+void align_overlaps_cpu(const std::vector<Overlap>& overlaps,
+                        const io::FastaParser& query_parser,
+                        const io::FastaParser& target_parser,
+                        std::vector<std::string>& cigars)
+{
+    if (overlaps.empty())
+    {
+        return;
+    }
+
     int32_t max_query_size  = 0;
     int32_t max_target_size = 0;
     for (const auto& overlap : overlaps)
     {
-        int32_t query_overlap_size  = overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_;
-        int32_t target_overlap_size = overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_;
-        if (query_overlap_size > max_query_size)
-            max_query_size = query_overlap_size;
-        if (target_overlap_size > max_target_size)
-            max_target_size = target_overlap_size;
-    }
-
-    // Heuristically calculate max alignments possible with available memory based on
-    // empirical measurements of memory needed for alignment per base.
-    const float memory_per_base = 0.03f; // Estimation of space per base in bytes for alignment
-    float memory_per_alignment  = memory_per_base * max_query_size * max_target_size;
-    size_t free, total;
-    GW_CU_CHECK_ERR(cudaMemGetInfo(&free, &total));
-    const size_t max_alignments = (static_cast<float>(free) * 85 / 100) / memory_per_alignment; // Using 85% of available memory
-    int32_t batch_size          = std::min(get_size<int32_t>(overlaps), static_cast<int32_t>(max_alignments)) / num_alignment_engines;
-    std::cerr << "Aligning " << overlaps.size() << " overlaps (" << max_query_size << "x" << max_target_size << ") with batch size " << batch_size << std::endl;
-
-    int32_t overlap_idx = 0;
-    std::mutex overlap_idx_mtx;
-
-    // Launch multiple alignment engines in separate threads to overlap D2H and H2D copies
-    // with compute from concurrent engines.
-    std::vector<std::future<void>> align_futures;
-    for (int32_t t = 0; t < num_alignment_engines; t++)
-    {
-        align_futures.push_back(std::async(std::launch::async,
-                                           &run_alignment_batch,
-                                           allocator,
-                                           std::ref(overlap_idx_mtx),
-                                           std::ref(overlaps),
-                                           std::ref(query_parser),
-                                           std::ref(target_parser),
-                                           std::ref(overlap_idx),
-                                           max_query_size,
-                                           max_target_size,
-                                           std::ref(cigars),
-                                           batch_size));
-    }
-
-    for (auto& f : align_futures)
-    {
-        f.get();
+        max_query_size  = std::max(max_query_size, static_cast<int32_t>(overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_));
+        max_target_size = std::max(max_target_size, static_cast<int32_t>(overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_));
+    }
+
+    std::unique_ptr<cudaaligner::Aligner> aligner = cudaaligner::create_cpu_aligner(max_query_size,
+                                                                                     max_target_size,
+                                                                                     get_size<int32_t>(overlaps),
+                                                                                     cudaaligner::AlignmentType::global_alignment,
+                                                                                     get_global_thread_pool());
+    for (const Overlap& overlap : overlaps)
+    {
+        const io::FastaSequence query  = query_parser.get_sequence_by_id(overlap.query_read_id_);
+        const io::FastaSequence target = target_parser.get_sequence_by_id(overlap.target_read_id_);
+        cudaaligner::StatusType status = aligner->add_alignment(&query.seq[overlap.query_start_position_in_read_],
+                                                                overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_,
+                                                                &target.seq[overlap.target_start_position_in_read_],
+                                                                overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_,
+                                                                false,
+                                                                overlap.relative_strand == RelativeStrand::Reverse);
+        if (status != cudaaligner::success)
+        {
+            throw std::runtime_error("Experienced error type " + std::to_string(status));
+        }
+    }
+    aligner->align_all();
+    aligner->sync_alignments();
+
+    const std::vector<std::shared_ptr<cudaaligner::Alignment>>& alignments = aligner->get_alignments();
+    cigars.resize(overlaps.size());
+    for (int32_t i = 0; i < get_size<int32_t>(alignments); i++)
+    {
+        cigars[i] = alignments[i]->convert_to_cigar();
     }
 }
 
-/// OverlapsAndCigars - packs overlaps and cigars together so they can be passed to writer thread more easily
+/// OverlapsAndCigars - packs overlaps and cigars together so they can be passed to post-processing and writing more easily
 struct OverlapsAndCigars
 {
     std::vector<Overlap> overlaps;
     std::vector<std::string> cigars;
 };
 
+/// \brief returns approximate amount of host memory taken by overlaps and cigars, used to limit the amount of data waiting to be written
+/// \param overlaps_and_cigars
+/// \return size in bytes
+int64_t get_size_in_bytes(const OverlapsAndCigars& overlaps_and_cigars)
+{
+    int64_t size_in_bytes = get_size<int64_t>(overlaps_and_cigars.overlaps) * sizeof(Overlap);
+    for (const std::string& cigar : overlaps_and_cigars.cigars)
+    {
+        size_in_bytes += sizeof(std::string) + get_size<int64_t>(cigar);
+    }
+    return size_in_bytes;
+}
+
+/// \brief prints statistics of the queue between a worker thread and its post-processing and writing tasks
+/// \param worker_name name of the worker thread used in the message
+/// \param statistics
+/// \param number_of_inline_writes number of elements the computation post-processed and wrote itself because the queue was full
+void print_output_queue_statistics(const std::string& worker_name,
+                                   const ThreadsafeProducerConsumerStatistics& statistics,
+                                   const int64_t number_of_inline_writes)
+{
+    const std::string message = worker_name + " output queue: " + std::to_string(statistics.number_of_added_elements) + " elements added" +
+                                ", max " + std::to_string(statistics.max_number_of_elements) + " elements" +
+                                " / " + std::to_string(statistics.max_number_of_bytes / (1024 * 1024)) + " MiB queued" +
+                                ", computation wrote " + std::to_string(number_of_inline_writes) + " elements itself because the queue was full" +
+                                ", writers waited " + std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(statistics.consumer_wait_time).count()) + " ms\n";
+    std::cerr << message;
+}
+
+/// \brief does post-processing and writes data to output
+/// \param data_to_write overlaps and cigars to post-process and write
+/// \param application_parameters
+/// \param output_mutex controls access to output to prevent race conditions
+void postprocess_and_write(OverlapsAndCigars& data_to_write,
+                           const ApplicationParameters& application_parameters,
+                           std::mutex& output_mutex)
+{
+    GW_NVTX_RANGE(profiler, "main::postprocess_and_write");
+    std::vector<Overlap>& overlaps         = data_to_write.overlaps;
+    const std::vector<std::string>& cigars = data_to_write.cigars;
+
+    {
+        GW_NVTX_RANGE(profiler, "main::postprocess_and_write::postprocessing");
+        // Overlap post processing - add overlaps which can be combined into longer ones.
+        Overlapper::post_process_overlaps(overlaps, application_parameters.drop_fused_overlaps);
+    }
+
+    if (application_parameters.perform_overlap_end_rescue)
+    {
+        GW_NVTX_RANGE(profiler, "main::postprocess_and_write::rescue_overlap_end");
+        // Perform overlap-end rescue
+        Overlapper::rescue_overlap_ends(overlaps,
+                                        *application_parameters.query_parser,
+                                        *application_parameters.target_parser,
+                                        50,
+                                        0.5);
+    }
+
+    // write to output
+    {
+        GW_NVTX_RANGE(profiler, "main::postprocess_and_write::print_paf");
+        if (nullptr == incremental_overlaps_file)
+        {
+            print_paf(overlaps,
+                      cigars,
+                      *application_parameters.query_parser,
+                      *application_parameters.target_parser,
+                      application_parameters.kmer_size,
+                      output_mutex);
+        }
+        else
+        {
+            const std::string formatted_overlaps = format_paf(overlaps,
+                                                              cigars,
+                                                              *application_parameters.query_parser,
+                                                              *application_parameters.target_parser,
+                                                              application_parameters.kmer_size);
+            std::lock_guard<std::mutex> lg(output_mutex);
+            std::fputs(formatted_overlaps.c_str(), stdout);
+            std::fputs(formatted_overlaps.c_str(), incremental_overlaps_file);
+        }
+    }
+}
+
+/// PostprocessAndWriteTasks - post-processes and writes overlaps and cigars using the global thread pool
+///
+/// Every added element is put into a bounded queue and gets one post-processing task. If the queue is full (see -O and -M)
+/// the thread adding the element post-processes and writes it itself, which keeps the memory bounded and slows down computation
+/// to the speed of writing. Elements can be added from multiple threads, including threads of the pool, without risking a deadlock.
+class PostprocessAndWriteTasks
+{
+public:
+    /// \brief Constructor
+    /// \param application_parameters
+    /// \param output_mutex controls access to output to prevent race conditions
+    PostprocessAndWriteTasks(const ApplicationParameters& application_parameters,
+                             std::mutex& output_mutex)
+        : application_parameters_(application_parameters)
+        , output_mutex_(output_mutex)
+        , queue_(application_parameters.output_queue_length,
+                 application_parameters.output_queue_memory * 1024ll * 1024ll, // value was in MiB
+                 get_size_in_bytes)
+        , number_of_inline_writes_(0)
+        , task_group_(get_global_thread_pool())
+    {
+    }
+
+    /// \brief adds overlaps and cigars to be post-processed and written
+    /// \param overlaps_and_cigars
+    void add_new_element(OverlapsAndCigars&& overlaps_and_cigars)
+    {
+        if (queue_.try_add_new_element(overlaps_and_cigars))
+        {
+            // every task takes one element, it does not have to be the one added here
+            task_group_.run([this]() {
+                gw_optional_t<OverlapsAndCigars> data_to_write = queue_.get_next_element();
+                postprocess_and_write(data_to_write.value(), application_parameters_, output_mutex_);
+            });
+        }
+        else
+        {
+            ++number_of_inline_writes_;
+            postprocess_and_write(overlaps_and_cigars, application_parameters_, output_mutex_);
+        }
+    }
+
+    /// \brief waits for all added elements to be written
+    void wait()
+    {
+        task_group_.wait();
+    }
+
+    /// \brief returns statistics of the queue
+    /// \return statistics of the queue
+    ThreadsafeProducerConsumerStatistics get_statistics() const
+    {
+        return queue_.get_statistics();
+    }
+
+    /// \brief returns the number of elements which were post-processed and written by the thread adding them because the queue was full
+    /// \return the number of elements written by the adding thread
+    int64_t get_number_of_inline_writes() const
+    {
+        return number_of_inline_writes_;
+    }
+
+private:
+    const ApplicationParameters& application_parameters_;
+    std::mutex& output_mutex_;
+    ThreadsafeProducerConsumer<OverlapsAndCigars> queue_;
+    std::atomic<int64_t> number_of_inline_writes_;
+    TaskGroup task_group_;
+};
+
 /// \brief does overlapping and matching for pairs of query and target indices from device_batch
 /// \param device_batch
 /// \param device_cache data will be loaded into cache within the function
 /// \param application_parameters
-/// \param overlaps_and_cigars_to_process overlaps and cigars are output here and the then consumed by another thread
+/// \param overlaps_and_cigars_to_process overlaps and cigars are output here and then post-processed and written on the global thread pool
 /// \param number_of_skipped_pairs_of_indices number of pairs of indices skipped due to OOM error, variable shared between all threads, each call increases the number by the number of skipped pairs
 /// \param cuda_stream
 void process_one_device_batch(const IndexBatch& device_batch,
                               IndexCacheDevice& device_cache,
                               const ApplicationParameters& application_parameters,
                               DefaultDeviceAllocator device_allocator,
-                              ThreadsafeProducerConsumer<OverlapsAndCigars>& overlaps_and_cigars_to_process,
+                              PostprocessAndWriteTasks& overlaps_and_cigars_to_process,
                               std::atomic<int32_t>& number_of_skipped_pairs_of_indices,
                               cudaStream_t cuda_stream)
 {
@@ -220,6 +514,21 @@ void process_one_device_batch(const IndexBatch& device_batch,
     device_cache.generate_query_cache_content(query_index_descriptors);
     device_cache.generate_target_cache_content(target_index_descriptors);
 
+    // with -P sketches are created once per index of this device batch, they are used to skip pairs of indices with too few shared seeds
+    using SketchMap = std::unordered_map<IndexDescriptor, IndexSketch, IndexDescriptorHash>;
+    SketchMap query_sketches;
+    SketchMap target_sketches;
+    auto get_sketch = [&application_parameters, cuda_stream](SketchMap& sketches,
+                                                             const IndexDescriptor& index_descriptor,
+                                                             const Index& index) -> const IndexSketch& {
+        auto sketch = sketches.find(index_descriptor);
+        if (sketch == std::end(sketches))
+        {
+            sketch = sketches.emplace(index_descriptor, create_index_sketch(index, application_parameters.prescreen_sketch_size, cuda_stream)).first;
+        }
+        return sketch->second;
+    };
+
     // process pairs of query and target indices
     for (const IndexDescriptor& query_index_descriptor : query_index_descriptors)
     {
@@ -231,6 +540,16 @@ void process_one_device_batch(const IndexBatch& device_batch,
                 std::shared_ptr<Index> query_index  = device_cache.get_index_from_query_cache(query_index_descriptor);
                 std::shared_ptr<Index> target_index = device_cache.get_index_from_target_cache(target_index_descriptor);
 
+                if (application_parameters.prescreen_min_shared_seeds > 0 &&
+                    !has_enough_shared_seeds(query_index_descriptor,
+                                             target_index_descriptor,
+                                             get_sketch(query_sketches, query_index_descriptor, *query_index),
+                                             get_sketch(target_sketches, target_index_descriptor, *target_index),
+                                             application_parameters))
+                {
+                    continue;
+                }
+
                 try
                 {
                     // find anchors and overlaps
@@ -250,12 +569,41 @@ void process_one_device_batch(const IndexBatch& device_batch,
                                              application_parameters.min_bases_per_residue,
                                              application_parameters.min_overlap_fraction);
 
+                    // with -g overlaps are aligned in segments between their anchors, which have to be copied before the matcher is freed
+                    const bool align_segments = application_parameters.alignment_engines > 0 && application_parameters.alignment_segment_length > 0;
+                    OverlapSegments overlap_segments;
+                    if (align_segments)
+                    {
+                        std::vector<Anchor> anchors(matcher->anchors().size());
+                        cudautils::device_copy_n(matcher->anchors().data(),
+                                                 anchors.size(),
+                                                 anchors.data(),
+                                                 cuda_stream); // D2H
+                        GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream));
+                        overlap_segments = split_overlaps_at_anchors(overlaps,
+                                                                     anchors,
+                                                                     application_parameters.alignment_segment_length,
+                                                                     static_cast<std::int32_t>(application_parameters.kmer_size));
+                    }
+
                     // free up memory taken by matcher
                     matcher.reset(nullptr);
 
                     // Align overlaps
                     std::vector<std::string> cigars;
-                    if (application_parameters.alignment_engines > 0)
+                    if (align_segments)
+                    {
+                        std::vector<std::string> segment_cigars(overlap_segments.segments.size());
+                        GW_NVTX_RANGE(profiler, "align_overlaps");
+                        align_overlaps(device_allocator,
+                                       overlap_segments.segments,
+                                       *application_parameters.query_parser,
+                                       *application_parameters.target_parser,
+                                       application_parameters.alignment_engines,
+                                       segment_cigars);
+                        cigars = stitch_segment_cigars(overlap_segments, segment_cigars);
+                    }
+                    else if (application_parameters.alignment_engines > 0)
                     {
                         cigars.resize(overlaps.size());
                         GW_NVTX_RANGE(profiler, "align_overlaps");
@@ -267,7 +615,7 @@ void process_one_device_batch(const IndexBatch& device_batch,
                                        cigars);
                     }
 
-                    // pass overlaps and cigars to writer thread
+                    // pass overlaps and cigars to post-processing and writing
                     overlaps_and_cigars_to_process.add_new_element({std::move(overlaps), std::move(cigars)});
                 }
                 catch (device_memory_allocation_exception& oom_exception)
@@ -285,7 +633,7 @@ void process_one_device_batch(const IndexBatch& device_batch,
 /// \param application_parameters
 /// \param host_cache data will be loaded into cache within the function
 /// \param device_cache data will be loaded into cache within the function
-/// \param overlaps_and_cigars_to_process overlaps and cigars are output to this structure and the then consumed by another thread
+/// \param overlaps_and_cigars_to_process overlaps and cigars are output to this structure and then post-processed and written on the global thread pool
 /// \param number_of_skipped_pairs_of_indices number of pairs of indices skipped due to OOM error, variable shared between all threads, each call increases the number by the number of skipped pairs
 /// \param cuda_stream
 void process_one_batch(const BatchOfIndices& batch,
@@ -293,7 +641,7 @@ void process_one_batch(const BatchOfIndices& batch,
                        DefaultDeviceAllocator device_allocator,
                        IndexCacheHost& host_cache,
                        IndexCacheDevice& device_cache,
-                       ThreadsafeProducerConsumer<OverlapsAndCigars>& overlaps_and_cigars_to_process,
+                       PostprocessAndWriteTasks& overlaps_and_cigars_to_process,
                        std::atomic<int32_t>& number_of_skipped_pairs_of_indices,
                        cudaStream_t cuda_stream)
 {
@@ -332,64 +680,10 @@ void process_one_batch(const BatchOfIndices& batch,
     }
 }
 
-/// \brief does post-processing and writes data to output
-/// \param device_id
-/// \param application_parameters
-/// \param overlaps_and_cigars_to_process new data is added to this structure as it gets available, also signals when there is not going to be any new data
-/// \param output_mutex controls access to output to prevent race conditions
-void postprocess_and_write_thread_function(const int32_t device_id,
-                                           const ApplicationParameters& application_parameters,
-                                           ThreadsafeProducerConsumer<OverlapsAndCigars>& overlaps_and_cigars_to_process,
-                                           std::mutex& output_mutex)
-{
-    GW_NVTX_RANGE(profiler, ("main::postprocess_and_write_thread_for_device_" + std::to_string(device_id)).c_str());
-    // This function is expected to run in a separate thread so set current device in order to avoid problems
-    GW_CU_CHECK_ERR(cudaSetDevice(device_id));
-
-    // keep processing data as it arrives
-    gw_optional_t<OverlapsAndCigars> data_to_write;
-    while (data_to_write = overlaps_and_cigars_to_process.get_next_element()) // if optional is empty that means that there will be no more overlaps to process and the thread can finish
-    {
-        {
-            GW_NVTX_RANGE(profiler, "main::postprocess_and_write_thread::one_set");
-            std::vector<Overlap>& overlaps         = data_to_write->overlaps;
-            const std::vector<std::string>& cigars = data_to_write->cigars;
-
-            {
-                GW_NVTX_RANGE(profiler, "main::postprocess_and_write_thread::postprocessing");
-                // Overlap post processing - add overlaps which can be combined into longer ones.
-                Overlapper::post_process_overlaps(data_to_write->overlaps, application_parameters.drop_fused_overlaps);
-            }
-
-            if (application_parameters.perform_overlap_end_rescue)
-            {
-                GW_NVTX_RANGE(profiler, "main::postprocess_and_write_thread::rescue_overlap_end");
-                // Perform overlap-end rescue
-                Overlapper::rescue_overlap_ends(data_to_write->overlaps,
-                                                *application_parameters.query_parser,
-                                                *application_parameters.target_parser,
-                                                50,
-                                                0.5);
-            }
-
-            // write to output
-            {
-                GW_NVTX_RANGE(profiler, "main::postprocess_and_write_thread::print_paf");
-                print_paf(overlaps,
-                          cigars,
-                          *application_parameters.query_parser,
-                          *application_parameters.target_parser,
-                          application_parameters.kmer_size,
-                          output_mutex);
-            }
-        }
-    }
-}
-
 /// \brief controls one GPU
 ///
-/// Each thread is resposible for one GPU. It takes one batch, processes it and passes it to postprocess_and_write_thread.
-/// It keeps doing this as long as there are available batches. It also controls the postprocess_and_write_thread.
+/// Each thread is resposible for one GPU. It takes one batch, processes it and passes it to post-processing and writing tasks.
+/// It keeps doing this as long as there are available batches.
 ///
 /// \param device_id
 /// \param batches_of_indices
@@ -424,32 +718,17 @@ void worker_thread_function(const int32_t device_id,
                                                        application_parameters.windows_size,
                                                        true, // hash_representations
                                                        application_parameters.filtering_parameter,
-                                                       cuda_stream);
+                                                       cuda_stream,
+                                                       application_parameters.dust_score_threshold,
+                                                       application_parameters.incremental_directory.empty() ? "" : get_incremental_index_directory(application_parameters.incremental_directory));
 
     // create host_cache, data is not loaded at this point but later as each batch gets processed
     IndexCacheDevice device_cache(application_parameters.all_to_all,
                                   host_cache);
 
-    // data structure used to exchange data with postprocess_and_write_thread
-    ThreadsafeProducerConsumer<OverlapsAndCigars> overlaps_and_cigars_to_process;
-
-    // There should be at least one postprocess_and_write_thread per worker_thread. If more threads are available one thread should be reserved for
-    // worker_thread and all other threads should be postprocess_and_write_threads
-    const int32_t threads_per_device = ceiling_divide(static_cast<int32_t>(std::thread::hardware_concurrency()),
-                                                      application_parameters.num_devices);
-
-    const int32_t postprocess_and_write_threads_per_device = std::max(threads_per_device - 1, 1);
-
-    // postprocess_and_write_threads run in the background and post-process and write overlaps and cigars to output as they become available in overlaps_and_cigars_to_process
-    std::vector<std::thread> postprocess_and_write_threads;
-    for (int32_t i = 0; i < postprocess_and_write_threads_per_device; ++i)
-    {
-        postprocess_and_write_threads.emplace_back(postprocess_and_write_thread_function,
-                                                   device_id,
-                                                   std::ref(application_parameters),
-                                                   std::ref(overlaps_and_cigars_to_process),
-                                                   std::ref(output_mutex));
-    }
+    // overlaps and cigars are post-processed and written on the global thread pool as they become available
+    PostprocessAndWriteTasks overlaps_and_cigars_to_process(application_parameters,
+                                                            output_mutex);
 
     // keep processing batches of indices until there are none left
     gw_optional_t<BatchOfIndices> batch_of_indices;
@@ -469,16 +748,567 @@ void worker_thread_function(const int32_t device_id,
                           cuda_stream);
     }
 
-    // tell writer thread that there will be no more overlaps and it can finish once it has written all overlaps
-    overlaps_and_cigars_to_process.signal_pushed_last_element();
+    // wait for all overlaps to be written
+    overlaps_and_cigars_to_process.wait();
+
+    print_output_queue_statistics("Device " + std::to_string(device_id),
+                                  overlaps_and_cigars_to_process.get_statistics(),
+                                  overlaps_and_cigars_to_process.get_number_of_inline_writes());
+
+    // by this point all GPU work should anyway be done as all overlaps have been written and all GPU work had to be done before last values could be written
+    GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream));
+}
 
-    for (std::thread& postprocess_and_write_thread : postprocess_and_write_threads)
+/// \brief runs function on every element of data using the global thread pool
+/// \param data elements to process
+/// \param function function to be called on each element
+template <typename T, typename Function>
+void for_each_in_parallel(std::vector<T>& data,
+                          Function function)
+{
+    TaskGroup task_group(get_global_thread_pool());
+    for (T& element : data)
     {
-        postprocess_and_write_thread.join();
+        task_group.run([&element, &function]() {
+            function(element);
+        });
     }
+    task_group.wait();
+}
 
-    // by this point all GPU work should anyway be done as postprocess_and_write_thread also finished and all GPU work had to be done before last values could be written
-    GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream));
+/// IndexMapCPU - indices of a host batch generated on the host
+using IndexMapCPU = std::unordered_map<IndexDescriptor, std::shared_ptr<const IndexCPU>, IndexDescriptorHash>;
+
+/// \brief generates query and target indices of a host batch on the host, in parallel on the global thread pool
+///
+/// In all-to-all mode query and target indices come from the same file so they are only generated once, into query_indices
+///
+/// \param host_batch
+/// \param application_parameters
+/// \param query_indices output, query indices of host_batch
+/// \param target_indices output, target indices of host_batch, stays empty in all-to-all mode
+void generate_indices_cpu(const IndexBatch& host_batch,
+                          const ApplicationParameters& application_parameters,
+                          IndexMapCPU& query_indices,
+                          IndexMapCPU& target_indices)
+{
+    IndexMapCPU& target_indices_to_use = application_parameters.all_to_all ? query_indices : target_indices;
+
+    // create all map entries upfront so that each thread only writes to its own entry
+    struct IndexToGenerate
+    {
+        IndexDescriptor descriptor;
+        const io::FastaParser* parser;
+        std::shared_ptr<const IndexCPU>* index;
+    };
+    std::vector<IndexToGenerate> indices_to_generate;
+    for (const IndexDescriptor& descriptor : host_batch.query_indices)
+    {
+        query_indices.emplace(descriptor, nullptr);
+    }
+    for (const IndexDescriptor& descriptor : host_batch.target_indices)
+    {
+        target_indices_to_use.emplace(descriptor, nullptr);
+    }
+    for (auto& descriptor_and_index : query_indices)
+    {
+        indices_to_generate.push_back({descriptor_and_index.first, application_parameters.query_parser.get(), &descriptor_and_index.second});
+    }
+    if (!application_parameters.all_to_all)
+    {
+        for (auto& descriptor_and_index : target_indices)
+        {
+            indices_to_generate.push_back({descriptor_and_index.first, application_parameters.target_parser.get(), &descriptor_and_index.second});
+        }
+    }
+
+    for_each_in_parallel(indices_to_generate,
+                         [&application_parameters](const IndexToGenerate& index_to_generate) {
+                             *index_to_generate.index = std::make_shared<const IndexCPU>(*index_to_generate.parser,
+                                                                                         index_to_generate.descriptor.first_read(),
+                                                                                         index_to_generate.descriptor.first_read() + index_to_generate.descriptor.number_of_reads(),
+                                                                                         application_parameters.kmer_size,
+                                                                                         application_parameters.windows_size,
+                                                                                         true, // hash_representations
+                                                                                         application_parameters.filtering_parameter,
+                                                                                         application_parameters.dust_score_threshold);
+                         });
+}
+
+/// \brief collects pairs of query and target indices of a batch in the same order as process_one_device_batch() would process them
+/// \param batch
+/// \param all_to_all if true pairs in which target index comes before query index are skipped as they are covered by symmetry
+/// \return pairs of query and target index descriptors
+std::vector<std::pair<IndexDescriptor, IndexDescriptor>> collect_pairs_of_indices(const BatchOfIndices& batch,
+                                                                                  const bool all_to_all)
+{
+    std::vector<std::pair<IndexDescriptor, IndexDescriptor>> pairs_of_indices;
+    for (const IndexBatch& device_batch : batch.device_batches)
+    {
+        for (const IndexDescriptor& query_index_descriptor : device_batch.query_indices)
+        {
+            for (const IndexDescriptor& target_index_descriptor : device_batch.target_indices)
+            {
+                // if doing all-to-all skip pairs in which target batch has smaller id than query batch as it will be covered by symmetry
+                if (!all_to_all || target_index_descriptor.first_read() >= query_index_descriptor.first_read())
+                {
+                    pairs_of_indices.emplace_back(query_index_descriptor, target_index_descriptor);
+                }
+            }
+        }
+    }
+    return pairs_of_indices;
+}
+
+/// \brief generates indices of one host batch on the host and finds overlaps for all pairs of query and target indices of its device batches
+///
+/// Equivalent of process_one_batch() for cpu backend. Indices are generated in parallel and then pairs of indices are processed in parallel,
+/// both using the global thread pool
+///
+/// \param batch
+/// \param application_parameters
+/// \param overlaps_and_cigars_to_process overlaps are output to this structure and then post-processed and written on the global thread pool
+void process_one_batch_cpu(const BatchOfIndices& batch,
+                           const ApplicationParameters& application_parameters,
+                           PostprocessAndWriteTasks& overlaps_and_cigars_to_process)
+{
+    GW_NVTX_RANGE(profiler, "main::process_one_batch_cpu");
+
+    const IndexBatch& host_batch = batch.host_batch;
+    assert(!host_batch.query_indices.empty() && !host_batch.target_indices.empty() && !batch.device_batches.empty());
+
+    // in all-to-all mode query and target indices come from the same file so they are only generated once
+    IndexMapCPU query_indices;
+    IndexMapCPU target_indices;
+    const IndexMapCPU& target_indices_to_use = application_parameters.all_to_all ? query_indices : target_indices;
+    {
+        GW_NVTX_RANGE(profiler, "main::process_one_batch_cpu::generate_indices");
+        generate_indices_cpu(host_batch, application_parameters, query_indices, target_indices);
+    }
+
+    std::vector<std::pair<IndexDescriptor, IndexDescriptor>> pairs_of_indices = collect_pairs_of_indices(batch, application_parameters.all_to_all);
+
+    // with -P skip pairs of indices whose sketches share too few representations
+    if (application_parameters.prescreen_min_shared_seeds > 0)
+    {
+        using SketchMap = std::unordered_map<IndexDescriptor, IndexSketch, IndexDescriptorHash>;
+        SketchMap query_sketches;
+        SketchMap target_sketches;
+        auto create_sketches = [&application_parameters](const IndexMapCPU& indices, SketchMap& sketches) {
+            for (const auto& descriptor_and_index : indices)
+            {
+                const std::vector<representation_t>& unique_representations = descriptor_and_index.second->unique_representations();
+                sketches.emplace(descriptor_and_index.first,
+                                 create_index_sketch(unique_representations.data(),
+                                                     get_size(unique_representations),
+                                                     application_parameters.prescreen_sketch_size));
+            }
+        };
+        create_sketches(query_indices, query_sketches);
+        create_sketches(target_indices_to_use, target_sketches);
+
+        pairs_of_indices.erase(std::remove_if(std::begin(pairs_of_indices),
+                                              std::end(pairs_of_indices),
+                                              [&](const std::pair<IndexDescriptor, IndexDescriptor>& pair_of_indices) {
+                                                  return !has_enough_shared_seeds(pair_of_indices.first,
+                                                                                  pair_of_indices.second,
+                                                                                  query_sketches.at(pair_of_indices.first),
+                                                                                  target_sketches.at(pair_of_indices.second),
+                                                                                  application_parameters);
+                                              }),
+                               std::end(pairs_of_indices));
+    }
+
+    {
+        GW_NVTX_RANGE(profiler, "main::process_one_batch_cpu::overlap");
+        for_each_in_parallel(pairs_of_indices,
+                             [&](const std::pair<IndexDescriptor, IndexDescriptor>& pair_of_indices) {
+                                 const IndexCPU& query_index  = *query_indices.at(pair_of_indices.first);
+                                 const IndexCPU& target_index = *target_indices_to_use.at(pair_of_indices.second);
+
+                                 // find anchors and overlaps
+                                 auto matcher = std::make_unique<MatcherCPU>(query_index,
+                                                                             target_index);
+
+                                 std::vector<Overlap> overlaps;
+                                 OverlapperCPU overlapper;
+                                 overlapper.get_overlaps(overlaps,
+                                                         matcher->anchors(),
+                                                         application_parameters.all_to_all,
+                                                         application_parameters.min_residues,
+                                                         application_parameters.min_overlap_len,
+                                                         application_parameters.min_bases_per_residue,
+                                                         application_parameters.min_overlap_fraction);
+
+                                 // with -g overlaps are aligned in segments between their anchors, which have to be taken before the matcher is freed
+                                 const bool align_segments = application_parameters.alignment_engines > 0 && application_parameters.alignment_segment_length > 0;
+                                 OverlapSegments overlap_segments;
+                                 if (align_segments)
+                                 {
+                                     overlap_segments = split_overlaps_at_anchors(overlaps,
+                                                                                  matcher->anchors(),
+                                                                                  application_parameters.alignment_segment_length,
+                                                                                  static_cast<std::int32_t>(application_parameters.kmer_size));
+                                 }
+
+                                 // free up memory taken by matcher
+                                 matcher.reset(nullptr);
+
+                                 // Align overlaps
+                                 std::vector<std::string> cigars;
+                                 if (align_segments)
+                                 {
+                                     std::vector<std::string> segment_cigars;
+                                     GW_NVTX_RANGE(profiler, "align_overlaps_cpu");
+                                     align_overlaps_cpu(overlap_segments.segments,
+                                                        *application_parameters.query_parser,
+                                                        *application_parameters.target_parser,
+                                                        segment_cigars);
+                                     cigars = stitch_segment_cigars(overlap_segments, segment_cigars);
+                                 }
+                                 else if (application_parameters.alignment_engines > 0)
+                                 {
+                                     GW_NVTX_RANGE(profiler, "align_overlaps_cpu");
+                                     align_overlaps_cpu(overlaps,
+                                                        *application_parameters.query_parser,
+                                                        *application_parameters.target_parser,
+                                                        cigars);
+                                 }
+
+                                 // pass overlaps and cigars to post-processing and writing
+                                 overlaps_and_cigars_to_process.add_new_element({std::move(overlaps), std::move(cigars)});
+                             });
+    }
+}
+
+/// \brief does all the work on the host
+///
+/// Equivalent of worker_thread_function() for cpu backend. Takes one batch, processes it using the global thread pool and passes
+/// it to post-processing and writing tasks. It keeps doing this as long as there are available batches.
+///
+/// \param batches_of_indices
+/// \param application_parameters
+/// \param output_mutex
+/// \param number_of_total_batches
+/// \param number_of_processed_batches
+void cpu_worker_thread_function(ThreadsafeDataProvider<BatchOfIndices>& batches_of_indices,
+                                const ApplicationParameters& application_parameters,
+                                std::mutex& output_mutex,
+                                const int64_t number_of_total_batches,
+                                std::atomic<int64_t>& number_of_processed_batches)
+{
+    GW_NVTX_RANGE(profiler, "main::cpu_worker_thread");
+
+    // overlaps are post-processed and written on the global thread pool as they become available
+    PostprocessAndWriteTasks overlaps_and_cigars_to_process(application_parameters,
+                                                            output_mutex);
+
+    // keep processing batches of indices until there are none left
+    gw_optional_t<BatchOfIndices> batch_of_indices;
+    while (batch_of_indices = batches_of_indices.get_next_element())
+    {
+        const int64_t batch_number         = number_of_processed_batches.fetch_add(1);
+        const std::string progress_message = "CPU took batch " + std::to_string(batch_number + 1) + " out of " + std::to_string(number_of_total_batches) + " batches in total\n";
+        std::cerr << progress_message;
+
+        process_one_batch_cpu(batch_of_indices.value(),
+                              application_parameters,
+                              overlaps_and_cigars_to_process);
+    }
+
+    // wait for all overlaps to be written
+    overlaps_and_cigars_to_process.wait();
+
+    print_output_queue_statistics("CPU",
+                                  overlaps_and_cigars_to_process.get_statistics(),
+                                  overlaps_and_cigars_to_process.get_number_of_inline_writes());
+}
+
+/// \brief prepares a run with -X, generates batches only for pairs of indices which contain reads appended since the previous run
+///
+/// Overlaps of previous runs are written to stdout and the file with overlaps is opened for appending new overlaps.
+///
+/// \param application_parameters
+/// \param batches_of_indices output, batches to process
+/// \return state to save once all batches have been processed, overlaps_file_size is not set
+/// \throw std::runtime_error if the state can not be loaded or the input can not be processed incrementally
+IncrementalState prepare_incremental_run(const ApplicationParameters& application_parameters,
+                                         std::vector<BatchOfIndices>& batches_of_indices)
+{
+    const std::string& state_directory    = application_parameters.incremental_directory;
+    const IncrementalState previous_state = load_incremental_state(state_directory);
+
+    IncrementalState state = extend_incremental_state(previous_state,
+                                                      application_parameters,
+                                                      application_parameters.index_size * 1'000'000,         // value was in MB
+                                                      application_parameters.target_index_size * 1'000'000); // value was in MB
+
+    const std::vector<IndexDescriptor> new_query_index_descriptors(begin(state.query_index_descriptors) + previous_state.query_index_descriptors.size(),
+                                                                   end(state.query_index_descriptors));
+    const std::vector<IndexDescriptor> new_target_index_descriptors(begin(state.target_index_descriptors) + previous_state.target_index_descriptors.size(),
+                                                                    end(state.target_index_descriptors));
+
+    std::cerr << "Incremental run: " << state.number_of_query_reads - previous_state.number_of_query_reads << " new query reads in "
+              << new_query_index_descriptors.size() << " new indices, " << state.number_of_target_reads - previous_state.number_of_target_reads
+              << " new target reads in " << new_target_index_descriptors.size() << " new indices" << std::endl;
+
+    // all queries against new targets
+    // if all_to_all new targets are also the new queries, symmetric pairs of indices are skipped in process_one_device_batch()
+    batches_of_indices = generate_batches_of_indices(application_parameters.query_indices_in_host_memory,
+                                                     application_parameters.query_indices_in_device_memory,
+                                                     application_parameters.target_indices_in_host_memory,
+                                                     application_parameters.target_indices_in_device_memory,
+                                                     state.query_index_descriptors,
+                                                     new_target_index_descriptors,
+                                                     false); // same_query_and_target
+    if (!application_parameters.all_to_all)
+    {
+        // new queries against previous targets
+        std::vector<BatchOfIndices> new_query_batches = generate_batches_of_indices(application_parameters.query_indices_in_host_memory,
+                                                                                    application_parameters.query_indices_in_device_memory,
+                                                                                    application_parameters.target_indices_in_host_memory,
+                                                                                    application_parameters.target_indices_in_device_memory,
+                                                                                    new_query_index_descriptors,
+                                                                                    previous_state.target_index_descriptors,
+                                                                                    false); // same_query_and_target
+        std::move(begin(new_query_batches),
+                  end(new_query_batches),
+                  std::back_inserter(batches_of_indices));
+    }
+
+    // everything after overlaps_file_size has been written by a run which has not finished, discard it
+    const std::string overlaps_path = get_incremental_overlaps_path(state_directory);
+    if (0 != truncate(overlaps_path.c_str(), previous_state.overlaps_file_size) && previous_state.overlaps_file_size != 0)
+    {
+        throw std::runtime_error("Could not truncate " + overlaps_path);
+    }
+
+    // overlaps of previous runs are a part of the output
+    if (previous_state.overlaps_file_size > 0)
+    {
+        std::FILE* previous_overlaps_file = std::fopen(overlaps_path.c_str(), "rb");
+        if (nullptr == previous_overlaps_file)
+        {
+            throw std::runtime_error("Could not open " + overlaps_path);
+        }
+        std::vector<char> buffer(1 << 20);
+        std::size_t bytes_read = 0;
+        while ((bytes_read = std::fread(buffer.data(), 1, buffer.size(), previous_overlaps_file)) > 0)
+        {
+            std::fwrite(buffer.data(), 1, bytes_read, stdout);
+        }
+        std::fclose(previous_overlaps_file);
+    }
+
+    incremental_overlaps_file = std::fopen(overlaps_path.c_str(), "ab");
+    if (nullptr == incremental_overlaps_file)
+    {
+        throw std::runtime_error("Could not open " + overlaps_path + " for writing");
+    }
+
+    return state;
+}
+
+/// \brief closes the file with overlaps and saves the state, called once all batches of a run with -X have been processed
+/// \param application_parameters
+/// \param state state returned by prepare_incremental_run()
+/// \throw std::runtime_error if overlaps or the state can not be written
+void finish_incremental_run(const ApplicationParameters& application_parameters,
+                            IncrementalState& state)
+{
+    if (0 != std::fflush(incremental_overlaps_file))
+    {
+        throw std::runtime_error("Could not write " + get_incremental_overlaps_path(application_parameters.incremental_directory));
+    }
+    state.overlaps_file_size = std::ftell(incremental_overlaps_file);
+    std::fclose(incremental_overlaps_file);
+    incremental_overlaps_file = nullptr;
+
+    save_incremental_state(application_parameters.incremental_directory,
+                           state);
+}
+
+/// server to stop on SIGINT or SIGTERM
+std::atomic<MappingServer*> server_to_stop(nullptr);
+
+/// \brief stops server_to_stop
+void stop_server_signal_handler(int)
+{
+    MappingServer* const server = server_to_stop.load();
+    if (server)
+    {
+        server->stop();
+    }
+}
+
+/// \brief generates target indices once and then maps queries received over a Unix domain socket until SIGINT or SIGTERM
+/// \param application_parameters
+/// \return exit code
+int serve(const ApplicationParameters& application_parameters)
+{
+    MappingService mapping_service(application_parameters,
+                                   0); // device_id
+
+    MappingServer server(application_parameters.serve_socket_path,
+                         [&mapping_service, &application_parameters](const std::string& request) {
+                             std::unique_ptr<io::FastaParser> query_parser = io::create_string_fasta_parser(request,
+                                                                                                            application_parameters.kmer_size + application_parameters.windows_size - 1);
+                             return mapping_service.map(*query_parser);
+                         });
+
+    server_to_stop = &server;
+    std::signal(SIGINT, stop_server_signal_handler);
+    std::signal(SIGTERM, stop_server_signal_handler);
+
+    std::cerr << "Listening on " << application_parameters.serve_socket_path << std::endl;
+    server.run();
+
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    server_to_stop = nullptr;
+
+    return 0;
+}
+
+/// \brief generates target indices once and then maps query reads chunk by chunk as they arrive from stdin or a growing file
+/// \param application_parameters
+/// \return exit code
+int stream(const ApplicationParameters& application_parameters)
+{
+    const bool read_stdin = application_parameters.query_filepath == "-";
+    const int query_fd    = read_stdin ? STDIN_FILENO : open(application_parameters.query_filepath.c_str(), O_RDONLY);
+    if (query_fd < 0)
+    {
+        std::cerr << "Could not open " << application_parameters.query_filepath << std::endl;
+        return 1;
+    }
+
+    MappingService mapping_service(application_parameters,
+                                   0); // device_id
+
+    StreamingFastaReader reader(query_fd,
+                                application_parameters.index_size * 1'000'000, // value was in MB
+                                std::chrono::milliseconds(application_parameters.stream_latency),
+                                application_parameters.kmer_size + application_parameters.windows_size - 1,
+                                !read_stdin, // a file is expected to grow, stdin ends when the producer closes it
+                                std::chrono::seconds(application_parameters.stream_idle_timeout));
+
+    int64_t number_of_chunks = 0;
+    int64_t number_of_reads  = 0;
+    while (std::unique_ptr<io::FastaParser> query_chunk = reader.get_next_chunk())
+    {
+        const auto mapping_start = std::chrono::steady_clock::now();
+        const std::string paf    = mapping_service.map(*query_chunk);
+        // flush immediately, downstream tools should see the overlaps of a chunk as soon as it has been mapped
+        std::cout << paf << std::flush;
+
+        ++number_of_chunks;
+        number_of_reads += query_chunk->get_num_seqences();
+        const auto mapping_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - mapping_start);
+        std::cerr << "Mapped chunk " << number_of_chunks << " with " << query_chunk->get_num_seqences() << " reads in " << mapping_time.count() << " ms" << std::endl;
+    }
+
+    std::cerr << "Mapped " << number_of_reads << " reads in " << number_of_chunks << " chunks" << std::endl;
+
+    if (!read_stdin)
+    {
+        close(query_fd);
+    }
+
+    return 0;
+}
+
+/// \brief writes sketch similarities of all pairs of query and target reads with high enough containment to stdout (see -j / --sketch-similarity)
+///
+/// Only minimizers are generated, there is no matching, chaining or overlap generation. Indices are generated on the host as the
+/// sketches are needed there anyway. Indices are grouped into the same host batches as for overlapping (-Q, -C), only the indices
+/// of one batch are kept in memory at a time and all of its pairs of indices are compared in parallel.
+///
+/// \param application_parameters
+/// \return exit code
+int compute_sketch_similarities(const ApplicationParameters& application_parameters)
+{
+    GW_NVTX_RANGE(profiler, "main::compute_sketch_similarities");
+
+    const io::FastaParser& query_parser  = *application_parameters.query_parser;
+    const io::FastaParser& target_parser = *application_parameters.target_parser;
+
+    const std::vector<BatchOfIndices> batches_of_indices = generate_batches_of_indices(application_parameters.query_indices_in_host_memory,
+                                                                                       application_parameters.query_indices_in_device_memory,
+                                                                                       application_parameters.target_indices_in_host_memory,
+                                                                                       application_parameters.target_indices_in_device_memory,
+                                                                                       application_parameters.query_parser,
+                                                                                       application_parameters.target_parser,
+                                                                                       application_parameters.index_size * 1'000'000,        // value was in MB
+                                                                                       application_parameters.target_index_size * 1'000'000, // value was in MB
+                                                                                       application_parameters.all_to_all);
+
+    for (const BatchOfIndices& batch : batches_of_indices)
+    {
+        // indices of the batch are released at the end of the iteration
+        IndexMapCPU query_indices;
+        IndexMapCPU target_indices;
+        const IndexMapCPU& target_indices_to_use = application_parameters.all_to_all ? query_indices : target_indices;
+        generate_indices_cpu(batch.host_batch, application_parameters, query_indices, target_indices);
+
+        const std::vector<std::pair<IndexDescriptor, IndexDescriptor>> pairs_of_indices = collect_pairs_of_indices(batch, application_parameters.all_to_all);
+        std::vector<std::int64_t> pair_ids(pairs_of_indices.size());
+        std::iota(std::begin(pair_ids), std::end(pair_ids), 0);
+        std::vector<std::string> outputs(pairs_of_indices.size());
+        for_each_in_parallel(pair_ids,
+                             [&](const std::int64_t pair_id) {
+                                 const IndexDescriptor& query_index_descriptor    = pairs_of_indices[pair_id].first;
+                                 const IndexDescriptor& target_index_descriptor   = pairs_of_indices[pair_id].second;
+                                 const std::vector<SketchSimilarity> similarities = find_sketch_similarities(*query_indices.at(query_index_descriptor),
+                                                                                                             *target_indices_to_use.at(target_index_descriptor),
+                                                                                                             application_parameters.all_to_all && query_index_descriptor == target_index_descriptor,
+                                                                                                             application_parameters.sketch_similarity_threshold);
+                                 outputs[pair_id] = format_sketch_similarities(similarities,
+                                                                               query_parser,
+                                                                               target_parser,
+                                                                               application_parameters.kmer_size);
+                             });
+
+        for (const std::string& output : outputs)
+        {
+            std::fwrite(output.data(), sizeof(char), output.size(), stdout);
+        }
+    }
+
+    std::fflush(stdout);
+    return 0;
+}
+
+/// \brief writes low-complexity intervals of query and target reads to the BED file given by -U
+/// \param parameters
+/// \return true on success
+bool write_low_complexity_intervals(const ApplicationParameters& parameters)
+{
+    GW_NVTX_RANGE(profiler, "main::write_low_complexity_intervals");
+
+    std::ofstream bed_file(parameters.dust_bed_filepath);
+    if (!bed_file)
+    {
+        std::cerr << "Could not open " << parameters.dust_bed_filepath << " for writing" << std::endl;
+        return false;
+    }
+
+    // with -U alone intervals are only written for inspection, so use the typical threshold
+    const std::int32_t score_threshold = parameters.dust_score_threshold > 0 ? parameters.dust_score_threshold : 20;
+
+    // query reads are not known upfront with -S and -s
+    if (parameters.queries_known_upfront() && !parameters.all_to_all)
+    {
+        write_low_complexity_intervals_bed(*parameters.query_parser, score_threshold, bed_file);
+    }
+    write_low_complexity_intervals_bed(*parameters.target_parser, score_threshold, bed_file);
+
+    if (!bed_file.flush())
+    {
+        std::cerr << "Could not write " << parameters.dust_bed_filepath << std::endl;
+        return false;
+    }
+    return true;
 }
 
 } // namespace
@@ -489,6 +1319,29 @@ int main(int argc, char* argv[])
 
     const ApplicationParameters parameters(argc, argv);
 
+    // post-processing, alignment and cpu backend share one pool of threads instead of each creating their own threads
+    initialize_global_thread_pool(parameters.num_threads, parameters.cpu_affinity);
+
+    if (!parameters.dust_bed_filepath.empty() && !write_low_complexity_intervals(parameters))
+    {
+        return 1;
+    }
+
+    if (!parameters.serve_socket_path.empty())
+    {
+        return serve(parameters);
+    }
+
+    if (parameters.stream_queries)
+    {
+        return stream(parameters);
+    }
+
+    if (parameters.sketch_similarity_threshold >= 0.0)
+    {
+        return compute_sketch_similarities(parameters);
+    }
+
     std::mutex output_mutex;
 
     // Program should process all combinations of query and target (if query and target are the same half of those can be skipped
@@ -499,22 +1352,54 @@ int main(int argc, char* argv[])
     // After a worker thread has taken a batch it generates all necessary indices and saves them in host memory using IndexCacheHost.
     // It then processes sub-batches one by one but first loading indices into IndexCacheDevice from IndexCacheHost and then finding
     // the overlaps.
-    // Output formatting and writing is done by a separate thread.
+    // Output formatting and writing is done by tasks executed on the global thread pool.
 
     // Split work into batches
-    std::vector<BatchOfIndices> batches_of_indices_vect = generate_batches_of_indices(parameters.query_indices_in_host_memory,
-                                                                                      parameters.query_indices_in_device_memory,
-                                                                                      parameters.target_indices_in_host_memory,
-                                                                                      parameters.target_indices_in_device_memory,
-                                                                                      parameters.query_parser,
-                                                                                      parameters.target_parser,
-                                                                                      parameters.index_size * 1'000'000,        // value was in MB
-                                                                                      parameters.target_index_size * 1'000'000, // value was in MB
-                                                                                      parameters.all_to_all);
+    std::vector<BatchOfIndices> batches_of_indices_vect;
+    IncrementalState incremental_state; // only used with -X
+    if (!parameters.incremental_directory.empty())
+    {
+        try
+        {
+            incremental_state = prepare_incremental_run(parameters,
+                                                        batches_of_indices_vect);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        batches_of_indices_vect = generate_batches_of_indices(parameters.query_indices_in_host_memory,
+                                                              parameters.query_indices_in_device_memory,
+                                                              parameters.target_indices_in_host_memory,
+                                                              parameters.target_indices_in_device_memory,
+                                                              parameters.query_parser,
+                                                              parameters.target_parser,
+                                                              parameters.index_size * 1'000'000,        // value was in MB
+                                                              parameters.target_index_size * 1'000'000, // value was in MB
+                                                              parameters.all_to_all);
+    }
     const int64_t number_of_total_batches               = get_size<int64_t>(batches_of_indices_vect);
     std::atomic<int64_t> number_of_processed_batches(0);
     ThreadsafeDataProvider<BatchOfIndices> batches_of_indices(std::move(batches_of_indices_vect));
 
+    if (parameters.backend == ComputeBackend::cpu)
+    {
+        // cpu backend uses no device, all work is done by one worker thread which uses the global thread pool
+        std::thread cpu_worker_thread(cpu_worker_thread_function,
+                                      std::ref(batches_of_indices),
+                                      std::ref(parameters),
+                                      std::ref(output_mutex),
+                                      number_of_total_batches,
+                                      std::ref(number_of_processed_batches));
+        cpu_worker_thread.join();
+        report_prescreened_pairs_of_indices(parameters);
+        return 0;
+    }
+
     // pairs of indices might be skipped if they cause out of memory errors
     std::atomic<int32_t> number_of_skipped_pairs_of_indices{0};
 
@@ -552,6 +1437,22 @@ int main(int argc, char* argv[])
         std::cerr << "NOTE: Skipped " << number_of_skipped_pairs_of_indices << " pairs of indices due to device out of memory error" << std::endl;
     }
 
+    report_prescreened_pairs_of_indices(parameters);
+
+    if (!parameters.incremental_directory.empty())
+    {
+        try
+        {
+            finish_incremental_run(parameters,
+                                   incremental_state);
+        }
+        catch (const std::runtime_error& e)
+        {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     return 0;
 }
 
@@ -0,0 +1,319 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "mapping_server.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <claraparabricks/genomeworks/logging/logging.hpp>
+#include <claraparabricks/genomeworks/utils/thread_pool.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// how often run() checks if stop() has been called
+constexpr int stop_check_interval_ms = 100;
+
+/// \brief throws std::runtime_error with description of errno
+/// \param what
+[[noreturn]] void throw_errno(const std::string& what)
+{
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+/// \brief creates Unix domain socket address
+/// \param socket_path
+/// \return socket address
+sockaddr_un create_socket_address(const std::string& socket_path)
+{
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socket_path.empty() || socket_path.size() >= sizeof(address.sun_path))
+    {
+        throw std::runtime_error("Invalid socket path: " + socket_path);
+    }
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    return address;
+}
+
+/// \brief reads from file descriptor until the other side closes it or shuts down writing
+/// \param fd
+/// \param deadline time by which the other side has to finish sending, no limit by default
+/// \return everything that was read
+/// \throw std::runtime_error if reading fails or deadline passes
+std::string read_until_end(const int fd,
+                           const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max())
+{
+    std::string data;
+    char buffer[64 * 1024];
+    while (true)
+    {
+        if (deadline != std::chrono::steady_clock::time_point::max())
+        {
+            const std::int64_t remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (remaining_ms <= 0)
+            {
+                throw std::runtime_error("Timed out waiting for the request");
+            }
+            pollfd read_pollfd    = {fd, POLLIN, 0};
+            const int poll_result = poll(&read_pollfd, 1, static_cast<int>(std::min<std::int64_t>(remaining_ms, INT_MAX)));
+            if (poll_result < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                throw_errno("Could not poll socket");
+            }
+            if (poll_result == 0)
+            {
+                throw std::runtime_error("Timed out waiting for the request");
+            }
+        }
+        const ssize_t read_bytes = read(fd, buffer, sizeof(buffer));
+        if (read_bytes == 0)
+        {
+            break;
+        }
+        if (read_bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw_errno("Could not read from socket");
+        }
+        data.append(buffer, read_bytes);
+    }
+    return data;
+}
+
+/// \brief writes all data to socket
+/// \param fd
+/// \param data
+void write_all(const int fd, const std::string& data)
+{
+    std::size_t written_bytes = 0;
+    while (written_bytes < data.size())
+    {
+        // MSG_NOSIGNAL - a client disconnecting early should not kill the server with SIGPIPE
+        const ssize_t sent_bytes = send(fd, data.data() + written_bytes, data.size() - written_bytes, MSG_NOSIGNAL);
+        if (sent_bytes < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw_errno("Could not write to socket");
+        }
+        written_bytes += sent_bytes;
+    }
+}
+
+} // namespace
+
+MappingServer::MappingServer(const std::string& socket_path,
+                             request_handler_t request_handler,
+                             const std::chrono::milliseconds request_timeout)
+    : socket_path_(socket_path)
+    , request_handler_(std::move(request_handler))
+    , request_timeout_(request_timeout)
+    , listening_fd_(-1)
+    , stop_requested_(false)
+{
+    const sockaddr_un address = create_socket_address(socket_path_);
+
+    // remove socket file left behind by a previous server, but do not touch other files
+    struct stat file_status;
+    if (lstat(socket_path_.c_str(), &file_status) == 0)
+    {
+        if (!S_ISSOCK(file_status.st_mode))
+        {
+            throw std::runtime_error(socket_path_ + " exists and is not a socket");
+        }
+        unlink(socket_path_.c_str());
+    }
+
+    listening_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listening_fd_ < 0)
+    {
+        throw_errno("Could not create socket");
+    }
+    if (bind(listening_fd_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listening_fd_, SOMAXCONN) != 0)
+    {
+        const int bind_errno = errno;
+        close(listening_fd_);
+        errno = bind_errno;
+        throw_errno("Could not listen on " + socket_path_);
+    }
+}
+
+MappingServer::~MappingServer()
+{
+    close(listening_fd_);
+    unlink(socket_path_.c_str());
+}
+
+void MappingServer::run()
+{
+    TaskGroup connection_tasks(get_global_thread_pool());
+
+    pollfd listening_pollfd = {listening_fd_, POLLIN, 0};
+    while (!stop_requested_)
+    {
+        const int poll_result = poll(&listening_pollfd, 1, stop_check_interval_ms);
+        if (poll_result < 0 && errno != EINTR)
+        {
+            throw_errno("Could not poll socket");
+        }
+        if (poll_result <= 0)
+        {
+            continue;
+        }
+
+        const int connection_fd = accept(listening_fd_, nullptr, nullptr);
+        if (connection_fd < 0)
+        {
+            if (errno != EINTR && errno != ECONNABORTED)
+            {
+                GW_LOG_WARN("Could not accept connection: {}", std::strerror(errno));
+            }
+            continue;
+        }
+
+        connection_tasks.run([this, connection_fd]() {
+            handle_connection(connection_fd);
+        });
+    }
+
+    connection_tasks.wait();
+}
+
+void MappingServer::stop()
+{
+    stop_requested_ = true;
+}
+
+void MappingServer::handle_connection(const int connection_fd)
+{
+    try
+    {
+        // a client that stops reading the response must not block the worker either
+        timeval send_timeout;
+        send_timeout.tv_sec  = request_timeout_.count() / 1000;
+        send_timeout.tv_usec = (request_timeout_.count() % 1000) * 1000;
+        if (setsockopt(connection_fd, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout)) != 0)
+        {
+            throw_errno("Could not set socket timeout");
+        }
+
+        const std::string request = read_until_end(connection_fd, std::chrono::steady_clock::now() + request_timeout_);
+        std::string response;
+        try
+        {
+            response = "OK\n" + request_handler_(request);
+        }
+        catch (const std::exception& e)
+        {
+            // error message has to fit into the header line
+            std::string message = e.what();
+            std::replace(std::begin(message), std::end(message), '\n', ' ');
+            response = "ERROR " + message + "\n";
+        }
+        write_all(connection_fd, response);
+    }
+    catch (const std::exception& e)
+    {
+        // problems with one client should not stop the server
+        GW_LOG_WARN("Could not handle request: {}", e.what());
+    }
+    close(connection_fd);
+}
+
+std::string request_mapping(const std::string& socket_path,
+                            const std::string& request)
+{
+    const sockaddr_un address = create_socket_address(socket_path);
+
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        throw_errno("Could not create socket");
+    }
+
+    std::string response;
+    try
+    {
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            throw_errno("Could not connect to " + socket_path);
+        }
+        write_all(fd, request);
+        // tells the server that the whole request has been sent
+        if (shutdown(fd, SHUT_WR) != 0)
+        {
+            throw_errno("Could not send request");
+        }
+        response = read_until_end(fd);
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+    close(fd);
+
+    const std::size_t header_end = response.find('\n');
+    if (header_end == std::string::npos)
+    {
+        throw std::runtime_error("Invalid response from server");
+    }
+    if (response.compare(0, header_end, "OK") != 0)
+    {
+        throw std::runtime_error(response.substr(0, header_end)); // "ERROR <message>"
+    }
+    return response.substr(header_end + 1);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,95 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <string>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// MappingServer - accepts mapping requests over a Unix domain socket
+///
+/// Protocol: client connects, sends the whole request (query reads in FASTA or FASTQ format) and shuts down the writing
+/// side of its socket. Server replies with "OK\n" followed by the response (overlaps in PAF format) or with "ERROR <message>\n"
+/// and closes the connection. Every connection carries exactly one request.
+///
+/// Connections are handled by tasks on the global thread pool, so multiple clients can send their requests at the same time.
+/// It is up to request_handler to serialize access to shared resources. A client that has not sent its whole request within
+/// request_timeout (or stops reading the response for that long) is disconnected, so idle clients cannot keep the threads of the pool busy.
+class MappingServer
+{
+public:
+    /// request_handler_t - takes a request and returns the response, exceptions are reported to the client as errors
+    using request_handler_t = std::function<std::string(const std::string&)>;
+
+    /// \brief Constructor, starts listening on the socket
+    /// \param socket_path path of the socket file, existing socket file is replaced
+    /// \param request_handler called once for every request
+    /// \param request_timeout time a client has to send its request and to accept every part of the response
+    /// \throw std::runtime_error if socket could not be created
+    MappingServer(const std::string& socket_path,
+                  request_handler_t request_handler,
+                  std::chrono::milliseconds request_timeout = std::chrono::seconds(10));
+
+    /// \brief Destructor, closes and removes the socket
+    ~MappingServer();
+
+    MappingServer(const MappingServer&) = delete;
+    MappingServer& operator=(const MappingServer&) = delete;
+    MappingServer(MappingServer&&)                 = delete;
+    MappingServer& operator=(MappingServer&&) = delete;
+
+    /// \brief accepts and handles connections until stop() is called, then waits for the connections that are already being handled
+    void run();
+
+    /// \brief makes run() return, safe to call from a signal handler
+    void stop();
+
+private:
+    /// \brief reads the request, calls request handler and sends back the response
+    /// \param connection_fd connection to handle, it gets closed by this function
+    void handle_connection(int connection_fd);
+
+    const std::string socket_path_;
+    const request_handler_t request_handler_;
+    const std::chrono::milliseconds request_timeout_;
+    int listening_fd_;
+    std::atomic<bool> stop_requested_;
+};
+
+/// \brief sends request to MappingServer and waits for the response, used by cudamapper client
+/// \param socket_path path of the socket server is listening on
+/// \param request query reads in FASTA or FASTQ format
+/// \return response (overlaps in PAF format)
+/// \throw std::runtime_error if server could not be reached or if it reported an error
+std::string request_mapping(const std::string& socket_path,
+                            const std::string& request);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
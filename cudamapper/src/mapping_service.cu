@@ -0,0 +1,212 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "mapping_service.cuh"
+
+#include <iostream>
+
+#include <claraparabricks/genomeworks/cudamapper/index.hpp>
+#include <claraparabricks/genomeworks/cudamapper/matcher.hpp>
+#include <claraparabricks/genomeworks/cudamapper/overlapper.hpp>
+#include <claraparabricks/genomeworks/cudamapper/utils.hpp>
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+#include <claraparabricks/genomeworks/utils/cudautils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include "application_parameters.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+MappingService::MappingService(const ApplicationParameters& application_parameters,
+                               const int32_t device_id)
+    : application_parameters_(application_parameters)
+    , device_id_(device_id)
+{
+    GW_NVTX_RANGE(profiler, "MappingService::MappingService");
+
+    GW_CU_CHECK_ERR(cudaSetDevice(device_id_));
+    GW_CU_CHECK_ERR(cudaStreamCreate(&cuda_stream_));
+    device_allocator_ = create_default_device_allocator(application_parameters_.max_cached_memory_bytes);
+
+    const io::FastaParser& target_parser = *application_parameters_.target_parser;
+    target_index_descriptors_            = group_reads_into_indices(target_parser,
+                                                                    application_parameters_.target_index_size * 1'000'000); // value was in MB
+
+    const bool keep_on_device = get_size<int64_t>(target_index_descriptors_) <= application_parameters_.target_indices_in_device_memory;
+
+    for (const IndexDescriptor& target_index_descriptor : target_index_descriptors_)
+    {
+        std::unique_ptr<Index> index_on_device = Index::create_index(device_allocator_,
+                                                                     target_parser,
+                                                                     target_index_descriptor.first_read(),
+                                                                     target_index_descriptor.first_read() + target_index_descriptor.number_of_reads(),
+                                                                     application_parameters_.kmer_size,
+                                                                     application_parameters_.windows_size,
+                                                                     true, // hash_representations
+                                                                     application_parameters_.filtering_parameter,
+                                                                     cuda_stream_,
+                                                                     application_parameters_.dust_score_threshold);
+        target_indices_on_host_.push_back(IndexHostCopyBase::create_cache(*index_on_device,
+                                                                          target_index_descriptor.first_read(),
+                                                                          application_parameters_.kmer_size,
+                                                                          application_parameters_.windows_size,
+                                                                          cuda_stream_));
+        if (keep_on_device)
+        {
+            target_indices_on_device_.push_back(std::move(index_on_device));
+        }
+    }
+
+    GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream_));
+
+    std::cerr << "Generated " << target_index_descriptors_.size() << " target indices"
+              << (keep_on_device ? ", all of them are kept in device memory" : ", they are kept in host memory")
+              << std::endl;
+}
+
+MappingService::~MappingService()
+{
+    GW_CU_CHECK_ERR(cudaSetDevice(device_id_));
+    // indices have to be freed before their stream gets destroyed
+    target_indices_on_device_.clear();
+    target_indices_on_host_.clear();
+    GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream_));
+    GW_CU_CHECK_ERR(cudaStreamDestroy(cuda_stream_));
+}
+
+std::string MappingService::map(const io::FastaParser& query_parser)
+{
+    GW_NVTX_RANGE(profiler, "MappingService::map");
+
+    std::lock_guard<std::mutex> lg(mutex_);
+
+    // requests are handled by thread pool threads, which are not bound to any device
+    GW_CU_CHECK_ERR(cudaSetDevice(device_id_));
+
+    std::string paf;
+    if (query_parser.get_num_seqences() == 0)
+    {
+        return paf;
+    }
+
+    const std::vector<IndexDescriptor> query_index_descriptors = group_reads_into_indices(query_parser,
+                                                                                          application_parameters_.index_size * 1'000'000); // value was in MB
+
+    for (const IndexDescriptor& query_index_descriptor : query_index_descriptors)
+    {
+        std::unique_ptr<Index> query_index = Index::create_index(device_allocator_,
+                                                                 query_parser,
+                                                                 query_index_descriptor.first_read(),
+                                                                 query_index_descriptor.first_read() + query_index_descriptor.number_of_reads(),
+                                                                 application_parameters_.kmer_size,
+                                                                 application_parameters_.windows_size,
+                                                                 true, // hash_representations
+                                                                 application_parameters_.filtering_parameter,
+                                                                 cuda_stream_,
+                                                                 application_parameters_.dust_score_threshold);
+        paf += map_query_index(*query_index, query_parser);
+    }
+
+    GW_CU_CHECK_ERR(cudaStreamSynchronize(cuda_stream_));
+
+    return paf;
+}
+
+int64_t MappingService::number_of_target_indices() const
+{
+    return get_size<int64_t>(target_index_descriptors_);
+}
+
+std::string MappingService::map_query_index(const Index& query_index,
+                                            const io::FastaParser& query_parser)
+{
+    const io::FastaParser& target_parser = *application_parameters_.target_parser;
+
+    std::string paf;
+    int32_t number_of_skipped_target_indices = 0;
+
+    for (std::size_t target_index_id = 0; target_index_id < target_index_descriptors_.size(); ++target_index_id)
+    {
+        try
+        {
+            std::shared_ptr<Index> target_index = target_indices_on_device_.empty()
+                                                      ? std::shared_ptr<Index>(target_indices_on_host_[target_index_id]->copy_index_to_device(device_allocator_, cuda_stream_))
+                                                      : target_indices_on_device_[target_index_id];
+
+            // find anchors and overlaps
+            auto matcher = Matcher::create_matcher(device_allocator_,
+                                                   query_index,
+                                                   *target_index,
+                                                   cuda_stream_);
+
+            std::vector<Overlap> overlaps;
+            auto overlapper = Overlapper::create_overlapper(device_allocator_,
+                                                            cuda_stream_);
+            overlapper->get_overlaps(overlaps,
+                                     matcher->anchors(),
+                                     false, // all_to_all, queries and targets are never the same reads
+                                     application_parameters_.min_residues,
+                                     application_parameters_.min_overlap_len,
+                                     application_parameters_.min_bases_per_residue,
+                                     application_parameters_.min_overlap_fraction);
+
+            // free up memory taken by matcher
+            matcher.reset(nullptr);
+
+            Overlapper::post_process_overlaps(overlaps, application_parameters_.drop_fused_overlaps);
+
+            if (application_parameters_.perform_overlap_end_rescue)
+            {
+                Overlapper::rescue_overlap_ends(overlaps,
+                                                query_parser,
+                                                target_parser,
+                                                50,
+                                                0.5);
+            }
+
+            paf += format_paf(overlaps,
+                              {},
+                              query_parser,
+                              target_parser,
+                              application_parameters_.kmer_size);
+        }
+        catch (device_memory_allocation_exception& oom_exception)
+        {
+            // if the application ran out of memory skip this pair of indices
+            ++number_of_skipped_target_indices;
+        }
+    }
+
+    if (number_of_skipped_target_indices != 0)
+    {
+        std::cerr << "NOTE: Skipped " << number_of_skipped_target_indices << " pairs of indices due to device out of memory error" << std::endl;
+    }
+
+    return paf;
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,105 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/utils/allocator.hpp>
+
+#include "index_descriptor.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace io
+{
+class FastaParser;
+} // namespace io
+
+namespace cudamapper
+{
+
+class ApplicationParameters;
+class Index;
+class IndexHostCopyBase;
+
+/// MappingService - keeps target indices resident and maps queries against them
+///
+/// Target indices are generated once in the constructor and kept in host memory as IndexHostCopies. If all of them fit
+/// into -c / --target-indices-in-device-memory they are also kept in device memory. Every call to map() then only generates
+/// query indices, so a long-lived process can map many small batches of queries without re-parsing and re-indexing the target.
+class MappingService
+{
+public:
+    /// \brief Constructor, generates target indices
+    /// \param application_parameters target parser, index and overlap parameters are taken from here, query parser is ignored
+    /// \param device_id device to do all the work on
+    MappingService(const ApplicationParameters& application_parameters,
+                   int32_t device_id);
+
+    /// \brief Destructor
+    ~MappingService();
+
+    MappingService(const MappingService&) = delete;
+    MappingService& operator=(const MappingService&) = delete;
+    MappingService(MappingService&&)                 = delete;
+    MappingService& operator=(MappingService&&) = delete;
+
+    /// \brief finds overlaps between given queries and the targets, can be called from multiple threads but calls are executed one at a time
+    /// \param query_parser queries to map
+    /// \return overlaps in PAF format
+    std::string map(const io::FastaParser& query_parser);
+
+    /// \brief returns the number of target indices
+    /// \return the number of target indices
+    int64_t number_of_target_indices() const;
+
+private:
+    /// \brief finds overlaps between one query index and all target indices
+    /// \param query_index
+    /// \param query_parser
+    /// \return overlaps in PAF format
+    std::string map_query_index(const Index& query_index,
+                                const io::FastaParser& query_parser);
+
+    const ApplicationParameters& application_parameters_;
+    const int32_t device_id_;
+    cudaStream_t cuda_stream_;
+    DefaultDeviceAllocator device_allocator_;
+
+    /// descriptors of target indices
+    std::vector<IndexDescriptor> target_index_descriptors_;
+    /// host copies of target indices, same order as target_index_descriptors_
+    std::vector<std::shared_ptr<const IndexHostCopyBase>> target_indices_on_host_;
+    /// target indices kept in device memory, empty if they do not all fit into device memory
+    std::vector<std::shared_ptr<Index>> target_indices_on_device_;
+
+    /// there is only one device and one stream, so requests are processed one at a time
+    std::mutex mutex_;
+};
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
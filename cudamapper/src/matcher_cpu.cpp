@@ -0,0 +1,143 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "matcher_cpu.hpp"
+
+#include <algorithm>
+#include <tuple>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace details
+{
+namespace matcher_cpu
+{
+
+void generate_anchors(std::vector<Anchor>& anchors,
+                      const IndexCPU& query_index,
+                      const IndexCPU& target_index)
+{
+    const std::vector<representation_t>& query_unique_representations  = query_index.unique_representations();
+    const std::vector<std::uint32_t>& query_first_occurrences          = query_index.first_occurrence_of_representations();
+    const std::vector<representation_t>& target_unique_representations = target_index.unique_representations();
+    const std::vector<std::uint32_t>& target_first_occurrences         = target_index.first_occurrence_of_representations();
+    const std::vector<read_id_t>& query_read_ids                       = query_index.read_ids();
+    const std::vector<position_in_read_t>& query_positions_in_reads    = query_index.positions_in_reads();
+    const std::vector<read_id_t>& target_read_ids                      = target_index.read_ids();
+    const std::vector<position_in_read_t>& target_positions_in_reads   = target_index.positions_in_reads();
+
+    // first pass only counts the anchors so that the output can be allocated only once
+    std::int64_t number_of_anchors = 0;
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        if (1 == pass)
+        {
+            anchors.reserve(anchors.size() + number_of_anchors);
+        }
+
+        std::size_t query_unique_index  = 0;
+        std::size_t target_unique_index = 0;
+        while (query_unique_index < query_unique_representations.size() && target_unique_index < target_unique_representations.size())
+        {
+            const representation_t query_representation  = query_unique_representations[query_unique_index];
+            const representation_t target_representation = target_unique_representations[target_unique_index];
+            if (query_representation < target_representation)
+            {
+                ++query_unique_index;
+            }
+            else if (target_representation < query_representation)
+            {
+                ++target_unique_index;
+            }
+            else
+            {
+                const std::uint32_t query_begin  = query_first_occurrences[query_unique_index];
+                const std::uint32_t query_end    = query_first_occurrences[query_unique_index + 1];
+                const std::uint32_t target_begin = target_first_occurrences[target_unique_index];
+                const std::uint32_t target_end   = target_first_occurrences[target_unique_index + 1];
+                if (0 == pass)
+                {
+                    number_of_anchors += static_cast<std::int64_t>(query_end - query_begin) * (target_end - target_begin);
+                }
+                else
+                {
+                    for (std::uint32_t query_idx = query_begin; query_idx < query_end; ++query_idx)
+                    {
+                        for (std::uint32_t target_idx = target_begin; target_idx < target_end; ++target_idx)
+                        {
+                            Anchor a;
+                            a.query_read_id_           = query_read_ids[query_idx];
+                            a.target_read_id_          = target_read_ids[target_idx];
+                            a.query_position_in_read_  = query_positions_in_reads[query_idx];
+                            a.target_position_in_read_ = target_positions_in_reads[target_idx];
+                            anchors.push_back(a);
+                        }
+                    }
+                }
+                ++query_unique_index;
+                ++target_unique_index;
+            }
+        }
+    }
+}
+
+void sort_anchors(std::vector<Anchor>& anchors)
+{
+    std::sort(std::begin(anchors),
+              std::end(anchors),
+              [](const Anchor& i, const Anchor& j) {
+                  return std::tie(i.query_read_id_, i.target_read_id_, i.query_position_in_read_, i.target_position_in_read_) <
+                         std::tie(j.query_read_id_, j.target_read_id_, j.query_position_in_read_, j.target_position_in_read_);
+              });
+}
+
+} // namespace matcher_cpu
+} // namespace details
+
+MatcherCPU::MatcherCPU(const IndexCPU& query_index,
+                       const IndexCPU& target_index)
+{
+    if (0 == query_index.number_of_reads() || 0 == target_index.number_of_reads())
+    {
+        return;
+    }
+
+    details::matcher_cpu::generate_anchors(anchors_,
+                                           query_index,
+                                           target_index);
+
+    details::matcher_cpu::sort_anchors(anchors_);
+}
+
+std::vector<Anchor>& MatcherCPU::anchors()
+{
+    return anchors_;
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,79 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <vector>
+
+#include <claraparabricks/genomeworks/cudamapper/types.hpp>
+
+#include "index_cpu.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// MatcherCPU - host implementation of MatcherGPU, finds anchors between a query and a target IndexCPU
+class MatcherCPU
+{
+public:
+    /// \brief Constructor
+    /// \param query_index
+    /// \param target_index
+    MatcherCPU(const IndexCPU& query_index,
+               const IndexCPU& target_index);
+
+    /// \brief return anchors
+    /// \return anchors sorted by query_read_id -> target_read_id -> query_position_in_read -> target_position_in_read
+    std::vector<Anchor>& anchors();
+
+private:
+    std::vector<Anchor> anchors_;
+};
+
+namespace details
+{
+namespace matcher_cpu
+{
+
+/// \brief Creates an anchor for every pair of query and target sketch elements which share the same representation
+///
+/// Both indices contain unique_representations sorted in ascending order, so matching representations are found by walking both arrays at the same time
+///
+/// \param anchors output array, anchors are appended to it unsorted
+/// \param query_index
+/// \param target_index
+void generate_anchors(std::vector<Anchor>& anchors,
+                      const IndexCPU& query_index,
+                      const IndexCPU& target_index);
+
+/// \brief sorts anchors by query_read_id -> target_read_id -> query_position_in_read -> target_position_in_read
+/// \param anchors
+void sort_anchors(std::vector<Anchor>& anchors);
+
+} // namespace matcher_cpu
+} // namespace details
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,207 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "overlapper_cpu.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// \brief returns true if two neighboring anchors belong to the same chain, same as Anchor's operator== in overlapper_triggered.cu
+/// \param lhs the anchor that comes first in the sorted array
+/// \param rhs the anchor that comes second in the sorted array
+bool anchors_in_same_chain(const Anchor& lhs,
+                           const Anchor& rhs)
+{
+    return (lhs.query_read_id_ == rhs.query_read_id_) &&
+           (lhs.target_read_id_ == rhs.target_read_id_) &&
+           (rhs.query_position_in_read_ - lhs.query_position_in_read_) < 150 &&
+           std::abs(int(rhs.target_position_in_read_) - int(lhs.target_position_in_read_)) < 150;
+}
+
+/// \brief returns true if two neighboring chains can be fused, same as cuOverlapKey's operator== in overlapper_triggered.cu
+/// \param a first anchor of the first chain
+/// \param b first anchor of the second chain
+bool chains_fusable(const Anchor& a,
+                    const Anchor& b)
+{
+    const int distance_difference = std::abs(std::abs(int(a.query_position_in_read_) - int(b.query_position_in_read_)) -
+                                             std::abs(int(a.target_position_in_read_) - int(b.target_position_in_read_)));
+
+    return (a.target_read_id_ == b.target_read_id_) &&
+           (a.query_read_id_ == b.query_read_id_) &&
+           distance_difference < 300;
+}
+
+/// \brief returns true if overlap should be kept, same as FilterOverlapOp in overlapper_triggered.cu
+bool keep_overlap(const Overlap& overlap,
+                  const size_t min_residues,
+                  const size_t min_overlap_len,
+                  const size_t min_bases_per_residue,
+                  const float min_overlap_fraction,
+                  const bool indexes_identical)
+{
+    const auto target_overlap_length = overlap.target_end_position_in_read_ - overlap.target_start_position_in_read_;
+    const auto query_overlap_length  = overlap.query_end_position_in_read_ - overlap.query_start_position_in_read_;
+    const auto overlap_length        = std::max(target_overlap_length, query_overlap_length);
+    const bool self_mapping          = (overlap.query_read_id_ == overlap.target_read_id_) && indexes_identical;
+
+    return ((overlap.num_residues_ >= min_residues) &&
+            ((overlap_length / overlap.num_residues_) < min_bases_per_residue) &&
+            (query_overlap_length >= min_overlap_len) &&
+            (target_overlap_length >= min_overlap_len) &&
+            (!self_mapping) &&
+            ((static_cast<float>(target_overlap_length) / static_cast<float>(overlap_length)) > min_overlap_fraction) &&
+            ((static_cast<float>(query_overlap_length) / static_cast<float>(overlap_length)) > min_overlap_fraction));
+}
+
+/// \brief creates an overlap out of the first and the last anchor of a fused chain, same as CreateOverlap in overlapper_triggered.cu
+Overlap create_overlap(const Anchor& overlap_start_anchor,
+                       const Anchor& overlap_end_anchor,
+                       const std::uint32_t num_residues)
+{
+    Overlap new_overlap;
+
+    new_overlap.query_read_id_                 = overlap_end_anchor.query_read_id_;
+    new_overlap.target_read_id_                = overlap_end_anchor.target_read_id_;
+    new_overlap.num_residues_                  = num_residues;
+    new_overlap.target_end_position_in_read_   = overlap_end_anchor.target_position_in_read_;
+    new_overlap.target_start_position_in_read_ = overlap_start_anchor.target_position_in_read_;
+    new_overlap.query_end_position_in_read_    = overlap_end_anchor.query_position_in_read_;
+    new_overlap.query_start_position_in_read_  = overlap_start_anchor.query_position_in_read_;
+    new_overlap.overlap_complete               = true;
+
+    // If the target start position is greater than the target end position
+    // We can safely assume that the query and target are template and
+    // complement reads.
+    if (new_overlap.target_start_position_in_read_ > new_overlap.target_end_position_in_read_)
+    {
+        new_overlap.relative_strand = RelativeStrand::Reverse;
+        std::swap(new_overlap.target_start_position_in_read_, new_overlap.target_end_position_in_read_);
+    }
+    else
+    {
+        new_overlap.relative_strand = RelativeStrand::Forward;
+    }
+    return new_overlap;
+}
+
+} // namespace
+
+void OverlapperCPU::get_overlaps(std::vector<Overlap>& fused_overlaps,
+                                 const std::vector<Anchor>& anchors,
+                                 bool all_to_all,
+                                 int64_t min_residues,
+                                 int64_t min_overlap_len,
+                                 int64_t min_bases_per_residue,
+                                 float min_overlap_fraction)
+{
+    const int32_t tail_length_for_chain = 3;
+    const int64_t n_anchors             = get_size<int64_t>(anchors);
+
+    fused_overlaps.clear();
+
+    if (0 == n_anchors)
+    {
+        return;
+    }
+
+    // chain_start[i] is the index of the first anchor of chain i, chain_length[i] is the number of anchors in it
+    std::vector<int64_t> chain_start;
+    std::vector<int64_t> chain_length;
+    chain_start.push_back(0);
+    chain_length.push_back(1);
+    for (int64_t i = 1; i < n_anchors; ++i)
+    {
+        if (anchors_in_same_chain(anchors[i - 1], anchors[i]))
+        {
+            ++chain_length.back();
+        }
+        else
+        {
+            chain_start.push_back(i);
+            chain_length.push_back(1);
+        }
+    }
+
+    // fuse neighboring chains which are long enough, then create and filter overlaps
+    bool fused_chain_open        = false;
+    int64_t previous_key_anchor  = 0;
+    int64_t fused_overlap_start  = 0;
+    int64_t fused_overlap_end    = 0;
+    std::uint32_t fused_residues = 0;
+    auto flush_fused_chain       = [&]() {
+        if (fused_chain_open)
+        {
+            const Overlap overlap = create_overlap(anchors[fused_overlap_start],
+                                                   anchors[fused_overlap_end - 1],
+                                                   fused_residues);
+            if (keep_overlap(overlap, min_residues, min_overlap_len, min_bases_per_residue, min_overlap_fraction, all_to_all))
+            {
+                fused_overlaps.push_back(overlap);
+            }
+        }
+    };
+
+    for (std::size_t chain = 0; chain < chain_start.size(); ++chain)
+    {
+        if (chain_length[chain] < tail_length_for_chain)
+        {
+            continue;
+        }
+
+        const int64_t overlap_start = chain_start[chain];
+        const int64_t overlap_end   = chain_start[chain] + chain_length[chain];
+
+        // keys are compared with the key of the previous long chain, as in reduce by key
+        if (fused_chain_open && chains_fusable(anchors[previous_key_anchor], anchors[overlap_start]))
+        {
+            fused_residues += static_cast<std::uint32_t>(chain_length[chain]);
+            fused_overlap_start = std::min(fused_overlap_start, overlap_start);
+            fused_overlap_end   = std::max(fused_overlap_end, overlap_end);
+        }
+        else
+        {
+            flush_fused_chain();
+            fused_chain_open    = true;
+            fused_residues      = static_cast<std::uint32_t>(chain_length[chain]);
+            fused_overlap_start = overlap_start;
+            fused_overlap_end   = overlap_end;
+        }
+        previous_key_anchor = overlap_start;
+    }
+    flush_fused_chain();
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,92 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "read_list.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+std::vector<std::string> load_read_list(const std::string& read_list_path)
+{
+    std::ifstream read_list_file(read_list_path);
+    if (!read_list_file)
+    {
+        throw std::runtime_error("Could not open read list " + read_list_path);
+    }
+
+    std::vector<std::string> read_names;
+    std::string line;
+    while (std::getline(read_list_file, line))
+    {
+        std::istringstream line_stream(line);
+        std::string read_name;
+        if (!(line_stream >> read_name))
+        {
+            continue; // empty line
+        }
+        if (read_name.front() == '>' || read_name.front() == '@')
+        {
+            read_name.erase(0, 1);
+        }
+        if (!read_name.empty())
+        {
+            read_names.push_back(std::move(read_name));
+        }
+    }
+
+    if (read_list_file.bad())
+    {
+        throw std::runtime_error("Could not read read list " + read_list_path);
+    }
+
+    return read_names;
+}
+
+std::unique_ptr<io::FastaParser> create_read_list_parser(const io::FastaParser& parser,
+                                                         const std::vector<std::string>& read_names)
+{
+    const std::unordered_set<std::string> listed_read_names(std::begin(read_names), std::end(read_names));
+
+    std::vector<io::FastaSequence> listed_reads;
+    for (read_id_t read_id = 0; read_id < parser.get_num_seqences(); ++read_id)
+    {
+        const io::FastaSequence& read = parser.get_sequence_by_id(read_id);
+        if (listed_read_names.count(read.name) > 0)
+        {
+            listed_reads.push_back(read);
+        }
+    }
+
+    return io::create_fasta_parser_from_sequences(std::move(listed_reads));
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,60 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// \brief loads names of reads from a read list file (see --query-read-list and --target-read-list)
+///
+/// Every non-empty line contains one read name. Only the first word of the line is used and a leading '>' or '@' is ignored,
+/// so FASTA/FASTQ header lines can be used directly.
+///
+/// \param read_list_path
+/// \return names of listed reads
+/// \throw std::runtime_error if the file can not be read
+std::vector<std::string> load_read_list(const std::string& read_list_path);
+
+/// \brief returns a parser which only contains listed reads of the original parser
+///
+/// Listed reads are assigned new consecutive read_ids starting from 0 in the order they have in the original parser. Unlisted reads are
+/// not part of the returned parser, so they never end up in any index. Sequences of listed reads are copied, so the original parser
+/// can be destroyed afterwards.
+///
+/// \param parser original parser
+/// \param read_names names of reads to keep, names which are not in the parser are ignored
+/// \return parser with listed reads
+std::unique_ptr<io::FastaParser> create_read_list_parser(const io::FastaParser& parser,
+                                                         const std::vector<std::string>& read_names);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,224 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "sketch_similarity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <unordered_map>
+
+#include <claraparabricks/genomeworks/utils/cudautils.hpp>
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// \brief returns the number of unique representations of every read in the index, element i belongs to read smallest_read_id() + i
+std::vector<std::int32_t> count_unique_representations_per_read(const IndexCPU& index)
+{
+    std::vector<std::int32_t> representations_per_read(index.number_of_reads(), 0);
+
+    const std::vector<read_id_t>& read_ids                                = index.read_ids();
+    const std::vector<std::uint32_t>& first_occurrence_of_representations = index.first_occurrence_of_representations();
+    for (std::int64_t i = 0; i + 1 < get_size<std::int64_t>(first_occurrence_of_representations); ++i)
+    {
+        // read_ids of sketch elements with the same representation are sorted
+        for (std::uint32_t j = first_occurrence_of_representations[i]; j < first_occurrence_of_representations[i + 1]; ++j)
+        {
+            if (j == first_occurrence_of_representations[i] || read_ids[j] != read_ids[j - 1])
+            {
+                ++representations_per_read[read_ids[j] - index.smallest_read_id()];
+            }
+        }
+    }
+
+    return representations_per_read;
+}
+
+/// \brief returns read_ids of sketch elements [first, past_the_last) without duplicates
+std::vector<read_id_t> get_unique_read_ids(const std::vector<read_id_t>& read_ids,
+                                           const std::uint32_t first,
+                                           const std::uint32_t past_the_last)
+{
+    std::vector<read_id_t> unique_read_ids;
+    for (std::uint32_t i = first; i < past_the_last; ++i)
+    {
+        if (unique_read_ids.empty() || unique_read_ids.back() != read_ids[i])
+        {
+            unique_read_ids.push_back(read_ids[i]);
+        }
+    }
+    return unique_read_ids;
+}
+
+} // namespace
+
+double jaccard_index(const SketchSimilarity& similarity)
+{
+    const std::int32_t union_size = similarity.query_representations + similarity.target_representations - similarity.shared_representations;
+    return union_size > 0 ? static_cast<double>(similarity.shared_representations) / union_size : 0.0;
+}
+
+double containment(const SketchSimilarity& similarity)
+{
+    const std::int32_t smaller_size = std::min(similarity.query_representations, similarity.target_representations);
+    return smaller_size > 0 ? static_cast<double>(similarity.shared_representations) / smaller_size : 0.0;
+}
+
+double mash_distance(const SketchSimilarity& similarity,
+                     const std::int32_t kmer_size)
+{
+    const double jaccard = jaccard_index(similarity);
+    if (jaccard <= 0.0)
+    {
+        return 1.0;
+    }
+    // max also turns -0.0 of identical reads into 0.0
+    return std::max(0.0, std::min(1.0, -1.0 / kmer_size * std::log(2.0 * jaccard / (1.0 + jaccard))));
+}
+
+std::vector<SketchSimilarity> find_sketch_similarities(const IndexCPU& query_index,
+                                                       const IndexCPU& target_index,
+                                                       const bool same_index,
+                                                       const double min_containment)
+{
+    GW_NVTX_RANGE(profiler, "find_sketch_similarities");
+
+    if (query_index.number_of_reads() == 0 || target_index.number_of_reads() == 0)
+    {
+        return {};
+    }
+
+    // *** count shared representations of every pair of reads ***
+    // key is query_read_id in upper and target_read_id in lower 32 bits
+    std::unordered_map<std::uint64_t, std::int32_t> shared_representations;
+
+    const std::vector<representation_t>& query_unique_representations  = query_index.unique_representations();
+    const std::vector<representation_t>& target_unique_representations = target_index.unique_representations();
+    const std::vector<std::uint32_t>& query_first_occurrences          = query_index.first_occurrence_of_representations();
+    const std::vector<std::uint32_t>& target_first_occurrences         = target_index.first_occurrence_of_representations();
+
+    std::int64_t query_representation_index  = 0;
+    std::int64_t target_representation_index = 0;
+    while (query_representation_index < get_size<std::int64_t>(query_unique_representations) &&
+           target_representation_index < get_size<std::int64_t>(target_unique_representations))
+    {
+        const representation_t query_representation  = query_unique_representations[query_representation_index];
+        const representation_t target_representation = target_unique_representations[target_representation_index];
+        if (query_representation < target_representation)
+        {
+            ++query_representation_index;
+            continue;
+        }
+        if (target_representation < query_representation)
+        {
+            ++target_representation_index;
+            continue;
+        }
+
+        const std::vector<read_id_t> query_read_ids  = get_unique_read_ids(query_index.read_ids(),
+                                                                          query_first_occurrences[query_representation_index],
+                                                                          query_first_occurrences[query_representation_index + 1]);
+        const std::vector<read_id_t> target_read_ids = get_unique_read_ids(target_index.read_ids(),
+                                                                           target_first_occurrences[target_representation_index],
+                                                                           target_first_occurrences[target_representation_index + 1]);
+        for (const read_id_t query_read_id : query_read_ids)
+        {
+            for (const read_id_t target_read_id : target_read_ids)
+            {
+                if (!same_index || query_read_id < target_read_id)
+                {
+                    ++shared_representations[(static_cast<std::uint64_t>(query_read_id) << 32) | target_read_id];
+                }
+            }
+        }
+
+        ++query_representation_index;
+        ++target_representation_index;
+    }
+
+    // *** keep pairs with high enough containment ***
+    const std::vector<std::int32_t> query_representations_per_read  = count_unique_representations_per_read(query_index);
+    const std::vector<std::int32_t> target_representations_per_read = count_unique_representations_per_read(target_index);
+
+    std::vector<SketchSimilarity> similarities;
+    for (const auto& pair_and_shared_representations : shared_representations)
+    {
+        SketchSimilarity similarity;
+        similarity.query_read_id          = static_cast<read_id_t>(pair_and_shared_representations.first >> 32);
+        similarity.target_read_id         = static_cast<read_id_t>(pair_and_shared_representations.first & 0xFFFFFFFF);
+        similarity.shared_representations = pair_and_shared_representations.second;
+        similarity.query_representations  = query_representations_per_read[similarity.query_read_id - query_index.smallest_read_id()];
+        similarity.target_representations = target_representations_per_read[similarity.target_read_id - target_index.smallest_read_id()];
+        if (containment(similarity) >= min_containment)
+        {
+            similarities.push_back(similarity);
+        }
+    }
+
+    std::sort(std::begin(similarities),
+              std::end(similarities),
+              [](const SketchSimilarity& a, const SketchSimilarity& b) {
+                  return a.query_read_id < b.query_read_id || (a.query_read_id == b.query_read_id && a.target_read_id < b.target_read_id);
+              });
+
+    return similarities;
+}
+
+std::string format_sketch_similarities(const std::vector<SketchSimilarity>& similarities,
+                                       const io::FastaParser& query_parser,
+                                       const io::FastaParser& target_parser,
+                                       const std::int32_t kmer_size)
+{
+    GW_NVTX_RANGE(profiler, "format_sketch_similarities");
+
+    std::string output;
+    // 100 is an overestimate of number of characters needed for non-string values
+    char values[100];
+    for (const SketchSimilarity& similarity : similarities)
+    {
+        std::snprintf(values,
+                      sizeof(values),
+                      "\t%.6f\t%.6f\t%.6f\t%d\t%d\t%d\n",
+                      mash_distance(similarity, kmer_size),
+                      jaccard_index(similarity),
+                      containment(similarity),
+                      similarity.shared_representations,
+                      similarity.query_representations,
+                      similarity.target_representations);
+        output += query_parser.get_sequence_by_id(similarity.query_read_id).name;
+        output += '\t';
+        output += target_parser.get_sequence_by_id(similarity.target_read_id).name;
+        output += values;
+    }
+    return output;
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
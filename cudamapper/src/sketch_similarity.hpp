@@ -0,0 +1,97 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/cudamapper/types.hpp>
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "index_cpu.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// SketchSimilarity - similarity of two reads estimated from the sets of their minimizer representations (see -j / --sketch-similarity)
+struct SketchSimilarity
+{
+    read_id_t query_read_id;
+    read_id_t target_read_id;
+    /// number of representations present in both reads
+    std::int32_t shared_representations;
+    /// number of unique representations in query read
+    std::int32_t query_representations;
+    /// number of unique representations in target read
+    std::int32_t target_representations;
+};
+
+/// \brief returns estimated Jaccard index of k-mer sets of both reads
+double jaccard_index(const SketchSimilarity& similarity);
+
+/// \brief returns the fraction of representations of the smaller read which are also in the other read
+double containment(const SketchSimilarity& similarity);
+
+/// \brief returns Mash distance, an estimate of the mutation rate between both reads, 1.0 if they share no representations
+/// \param similarity
+/// \param kmer_size
+/// \return Mash distance
+double mash_distance(const SketchSimilarity& similarity,
+                     std::int32_t kmer_size);
+
+/// \brief finds all pairs of reads from both indices whose containment is at least min_containment
+///
+/// Representations of both indices are merged, for every shared representation all pairs of reads with it get their number of shared
+/// representations increased. No anchors are generated and no chaining is done.
+///
+/// \param query_index
+/// \param target_index
+/// \param same_index true if query_index and target_index are the same index, only pairs with query_read_id < target_read_id are reported then
+/// \param min_containment pairs with lower containment() are not reported
+/// \return similar pairs of reads sorted by query_read_id and target_read_id
+std::vector<SketchSimilarity> find_sketch_similarities(const IndexCPU& query_index,
+                                                       const IndexCPU& target_index,
+                                                       bool same_index,
+                                                       double min_containment);
+
+/// \brief formats similarities as tab-separated lines
+///
+/// Columns are query read name, target read name, Mash distance, Jaccard index, containment, shared representations,
+/// query representations and target representations
+///
+/// \param similarities
+/// \param query_parser
+/// \param target_parser
+/// \param kmer_size
+/// \return formatted similarities
+std::string format_sketch_similarities(const std::vector<SketchSimilarity>& similarities,
+                                       const io::FastaParser& query_parser,
+                                       const io::FastaParser& target_parser,
+                                       std::int32_t kmer_size);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,330 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "streaming_fasta_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+/// how long to wait before checking again if a followed file has grown
+constexpr std::chrono::milliseconds follow_poll_interval(100);
+
+/// \brief returns length of line without the new line character and without '\r'
+/// \param data
+/// \param line_begin
+/// \param line_end position of '\n'
+/// \return length of line
+std::size_t get_line_length(const std::string& data,
+                            const std::size_t line_begin,
+                            const std::size_t line_end)
+{
+    std::size_t length = line_end - line_begin;
+    if (length > 0 && data[line_end - 1] == '\r')
+    {
+        --length;
+    }
+    return length;
+}
+
+/// \brief finds the end of the last complete FASTQ record, records have the usual header, sequence, '+' and quality lines
+/// \param data
+/// \return number of characters that belong to complete records
+std::size_t find_end_of_complete_fastq_records(const std::string& data)
+{
+    std::size_t end_of_complete_records = 0;
+    std::size_t position                = 0;
+    while (position < data.size())
+    {
+        // header
+        std::size_t line_end = data.find('\n', position);
+        if (line_end == std::string::npos)
+        {
+            break;
+        }
+        position = line_end + 1;
+
+        // sequence can span multiple lines
+        std::size_t sequence_length = 0;
+        while (position < data.size() && data[position] != '+')
+        {
+            line_end = data.find('\n', position);
+            if (line_end == std::string::npos)
+            {
+                return end_of_complete_records;
+            }
+            sequence_length += get_line_length(data, position, line_end);
+            position = line_end + 1;
+        }
+
+        // '+' line
+        line_end = data.find('\n', position);
+        if (line_end == std::string::npos)
+        {
+            break;
+        }
+        position = line_end + 1;
+
+        // quality can also span multiple lines, but it has the same length as sequence
+        std::size_t quality_length = 0;
+        while (quality_length < sequence_length)
+        {
+            line_end = data.find('\n', position);
+            if (line_end == std::string::npos)
+            {
+                return end_of_complete_records;
+            }
+            quality_length += get_line_length(data, position, line_end);
+            position = line_end + 1;
+        }
+
+        // skip empty lines between records
+        while (position < data.size() && (data[position] == '\n' || data[position] == '\r'))
+        {
+            ++position;
+        }
+
+        end_of_complete_records = position;
+    }
+    return end_of_complete_records;
+}
+
+} // namespace
+
+std::size_t find_end_of_complete_records(const std::string& data)
+{
+    const std::size_t first_record = data.find_first_not_of("\r\n");
+    if (first_record == std::string::npos)
+    {
+        return 0;
+    }
+
+    if (data[first_record] == '@')
+    {
+        return find_end_of_complete_fastq_records(data);
+    }
+
+    // FASTA record ends where the next one begins
+    const std::size_t last_record = data.rfind("\n>");
+    if (last_record == std::string::npos || last_record < first_record)
+    {
+        return 0;
+    }
+    return last_record + 1;
+}
+
+StreamingFastaReader::StreamingFastaReader(const int fd,
+                                           const number_of_basepairs_t max_basepairs_per_chunk,
+                                           const std::chrono::milliseconds max_latency,
+                                           const number_of_basepairs_t min_sequence_length,
+                                           const bool follow,
+                                           const std::chrono::milliseconds idle_timeout)
+    : fd_(fd)
+    , max_basepairs_per_chunk_(max_basepairs_per_chunk)
+    , max_latency_(max_latency)
+    , min_sequence_length_(min_sequence_length)
+    , follow_(follow)
+    , idle_timeout_(idle_timeout)
+    , buffer_()
+    , reads_()
+    , basepairs_in_reads_(0)
+    , first_read_arrival_()
+    , buffer_data_arrival_()
+    , last_data_arrival_(steady_clock_t::now())
+    , end_of_input_(false)
+{
+}
+
+std::unique_ptr<io::FastaParser> StreamingFastaReader::get_next_chunk()
+{
+    while (true)
+    {
+        if (!reads_.empty() &&
+            (basepairs_in_reads_ >= max_basepairs_per_chunk_ || end_of_input_ || steady_clock_t::now() >= first_read_arrival_ + max_latency_))
+        {
+            return create_chunk();
+        }
+
+        if (end_of_input_)
+        {
+            return nullptr;
+        }
+
+        // without pending reads or a pending FASTA record there is nothing to return, so wait for data as long as needed
+        steady_clock_t::time_point deadline = get_pending_record_deadline();
+        if (!reads_.empty())
+        {
+            deadline = std::min(deadline, first_read_arrival_ + max_latency_);
+        }
+        read_more(deadline);
+    }
+}
+
+void StreamingFastaReader::read_more(const steady_clock_t::time_point deadline)
+{
+    const steady_clock_t::time_point now = steady_clock_t::now();
+    if (now >= deadline)
+    {
+        parse_complete_records();
+        return;
+    }
+
+    int timeout_ms = -1; // wait indefinitely
+    if (deadline != steady_clock_t::time_point::max())
+    {
+        const int64_t remaining_ms = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now).count() + 1;
+        timeout_ms                 = static_cast<int>(std::min<int64_t>(remaining_ms, std::numeric_limits<int>::max()));
+    }
+
+    pollfd input_pollfd = {fd_, POLLIN, 0};
+    const int poll_result = poll(&input_pollfd, 1, timeout_ms);
+    if (poll_result < 0)
+    {
+        if (errno == EINTR)
+        {
+            return;
+        }
+        throw std::runtime_error(std::string("Could not poll input: ") + std::strerror(errno));
+    }
+    if (poll_result == 0)
+    {
+        // deadline passed, pending FASTA record might be considered complete now
+        parse_complete_records();
+        return;
+    }
+
+    char data[64 * 1024];
+    const ssize_t read_bytes = read(fd_, data, sizeof(data));
+    if (read_bytes < 0)
+    {
+        if (errno == EINTR || errno == EAGAIN)
+        {
+            return;
+        }
+        throw std::runtime_error(std::string("Could not read input: ") + std::strerror(errno));
+    }
+
+    if (read_bytes > 0)
+    {
+        last_data_arrival_ = steady_clock_t::now();
+        if (buffer_.empty())
+        {
+            buffer_data_arrival_ = last_data_arrival_;
+        }
+        buffer_.append(data, read_bytes);
+    }
+    else if (!follow_ || steady_clock_t::now() >= last_data_arrival_ + idle_timeout_)
+    {
+        end_of_input_ = true;
+    }
+    else
+    {
+        // end of a file which might still grow, regular files are always ready for reading so sleep instead of polling
+        const steady_clock_t::time_point wake_up = std::min(deadline, steady_clock_t::now() + follow_poll_interval);
+        std::this_thread::sleep_until(wake_up);
+    }
+
+    parse_complete_records();
+}
+
+void StreamingFastaReader::parse_complete_records()
+{
+    std::size_t end_of_complete_records = buffer_.size();
+    if (!end_of_input_ && steady_clock_t::now() < get_pending_record_deadline())
+    {
+        end_of_complete_records = find_end_of_complete_records(buffer_);
+    }
+    if (end_of_complete_records == 0)
+    {
+        return;
+    }
+
+    std::unique_ptr<io::FastaParser> parser = io::create_string_fasta_parser(buffer_.substr(0, end_of_complete_records),
+                                                                             min_sequence_length_);
+    buffer_.erase(0, end_of_complete_records);
+    const steady_clock_t::time_point records_arrival = buffer_data_arrival_;
+    // the rest of buffer_ has arrived with the last read at the latest
+    buffer_data_arrival_ = last_data_arrival_;
+
+    const number_of_reads_t number_of_reads = parser->get_num_seqences();
+    if (number_of_reads > 0 && reads_.empty())
+    {
+        first_read_arrival_ = records_arrival;
+    }
+    for (read_id_t read_id = 0; read_id < number_of_reads; ++read_id)
+    {
+        const io::FastaSequence& read = parser->get_sequence_by_id(read_id);
+        basepairs_in_reads_ += get_size<int64_t>(read.seq);
+        reads_.push_back(read);
+    }
+}
+
+StreamingFastaReader::steady_clock_t::time_point StreamingFastaReader::get_pending_record_deadline() const
+{
+    const std::size_t first_record = buffer_.find_first_not_of("\r\n");
+    if (first_record == std::string::npos || buffer_[first_record] != '>' || buffer_.back() != '\n')
+    {
+        return steady_clock_t::time_point::max();
+    }
+    return buffer_data_arrival_ + max_latency_;
+}
+
+std::unique_ptr<io::FastaParser> StreamingFastaReader::create_chunk()
+{
+    // take reads until the chunk is full, but at least one
+    std::size_t number_of_reads_in_chunk = 0;
+    int64_t basepairs_in_chunk           = 0;
+    while (number_of_reads_in_chunk < reads_.size() &&
+           (number_of_reads_in_chunk == 0 || basepairs_in_chunk + get_size<int64_t>(reads_[number_of_reads_in_chunk].seq) <= max_basepairs_per_chunk_))
+    {
+        basepairs_in_chunk += get_size<int64_t>(reads_[number_of_reads_in_chunk].seq);
+        ++number_of_reads_in_chunk;
+    }
+
+    std::vector<io::FastaSequence> chunk(std::make_move_iterator(std::begin(reads_)),
+                                         std::make_move_iterator(std::begin(reads_) + number_of_reads_in_chunk));
+    reads_.erase(std::begin(reads_), std::begin(reads_) + number_of_reads_in_chunk);
+    basepairs_in_reads_ -= basepairs_in_chunk;
+    // remaining reads have been waiting at least as long as the chunk, so they keep its arrival time
+
+    return io::create_fasta_parser_from_sequences(std::move(chunk));
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
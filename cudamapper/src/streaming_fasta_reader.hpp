@@ -0,0 +1,115 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/types.hpp>
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+/// StreamingFastaReader - reads FASTA or FASTQ records as they arrive and groups them into chunks
+///
+/// Input is read from a file descriptor, e.g. stdin or a file which is still being written to. A chunk is returned once it
+/// has max_basepairs_per_chunk basepairs, once its first read has been waiting for max_latency or once the input has ended,
+/// whichever comes first. A FASTA record is considered complete once the header of the next record (or the end of input)
+/// has been read or once it has been waiting for max_latency and ends with a new line, a FASTQ record once all of its
+/// quality values have been read.
+class StreamingFastaReader
+{
+public:
+    using steady_clock_t = std::chrono::steady_clock;
+
+    /// \brief Constructor
+    /// \param fd file descriptor to read from, it is not closed by the reader
+    /// \param max_basepairs_per_chunk chunk is returned as soon as it has this many basepairs, a single longer read is returned in its own chunk
+    /// \param max_latency maximum time between the arrival of a read and the return of its chunk (not taking into account the time get_next_chunk() is not being called)
+    /// \param min_sequence_length shorter reads are dropped
+    /// \param follow if true reaching the end of file does not end the input, instead reader waits for more data until nothing gets appended for idle_timeout
+    /// \param idle_timeout see follow
+    StreamingFastaReader(int fd,
+                         number_of_basepairs_t max_basepairs_per_chunk,
+                         std::chrono::milliseconds max_latency,
+                         number_of_basepairs_t min_sequence_length = 0,
+                         bool follow                               = false,
+                         std::chrono::milliseconds idle_timeout    = std::chrono::milliseconds(0));
+
+    /// \brief waits for the next chunk of reads
+    /// \return parser with reads of the chunk in the order they arrived, nullptr if the input has ended and all reads have been returned
+    /// \throw std::invalid_argument if the input is not valid FASTA or FASTQ
+    std::unique_ptr<io::FastaParser> get_next_chunk();
+
+private:
+    /// \brief reads data that is available, waits for it at most until deadline
+    /// \param deadline
+    void read_more(steady_clock_t::time_point deadline);
+
+    /// \brief moves records which have been fully read from buffer_ to reads_
+    void parse_complete_records();
+
+    /// \brief returns when the FASTA record at the end of buffer_ is considered complete even without the header of the next record
+    /// \return the deadline, time_point::max() if buffer_ does not end with a complete line of a FASTA record
+    steady_clock_t::time_point get_pending_record_deadline() const;
+
+    /// \brief returns reads_ (or their front part if they have too many basepairs) as a chunk
+    /// \return the chunk
+    std::unique_ptr<io::FastaParser> create_chunk();
+
+    const int fd_;
+    const number_of_basepairs_t max_basepairs_per_chunk_;
+    const std::chrono::milliseconds max_latency_;
+    const number_of_basepairs_t min_sequence_length_;
+    const bool follow_;
+    const std::chrono::milliseconds idle_timeout_;
+
+    /// data that has been read, but does not form a complete record yet
+    std::string buffer_;
+    /// complete reads which have not been returned yet
+    std::vector<io::FastaSequence> reads_;
+    /// basepairs in reads_
+    int64_t basepairs_in_reads_;
+    /// when the first of reads_ has been read
+    steady_clock_t::time_point first_read_arrival_;
+    /// when the oldest data in buffer_ has been read
+    steady_clock_t::time_point buffer_data_arrival_;
+    /// when data was last read
+    steady_clock_t::time_point last_data_arrival_;
+    /// input has ended, all remaining data in buffer_ forms complete records
+    bool end_of_input_;
+};
+
+/// \brief finds the end of the last complete record in FASTA or FASTQ data
+/// \param data beginning of FASTA or FASTQ data
+/// \return number of characters that belong to complete records
+std::size_t find_end_of_complete_records(const std::string& data);
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,122 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+
+#include "gtest/gtest.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include "../src/alignment_binning.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+Overlap make_overlap(const position_in_read_t query_length, const position_in_read_t target_length)
+{
+    Overlap overlap;
+    overlap.query_read_id_                 = 0;
+    overlap.target_read_id_                = 1;
+    overlap.query_start_position_in_read_  = 10;
+    overlap.query_end_position_in_read_    = 10 + query_length;
+    overlap.target_start_position_in_read_ = 5;
+    overlap.target_end_position_in_read_   = 5 + target_length;
+    overlap.relative_strand                = RelativeStrand::Forward;
+    return overlap;
+}
+} // namespace
+
+TEST(TestCudamapperAlignmentBinning, no_overlaps)
+{
+    std::vector<std::int32_t> overlap_order = {3, 4};
+    EXPECT_TRUE(bin_overlaps_by_length({}, 2.0f, overlap_order).empty());
+    EXPECT_TRUE(overlap_order.empty());
+}
+
+TEST(TestCudamapperAlignmentBinning, long_overlap_gets_own_bin)
+{
+    const std::vector<Overlap> overlaps = {make_overlap(5000, 5100),
+                                           make_overlap(200000, 199000),
+                                           make_overlap(4800, 5200),
+                                           make_overlap(3000, 2900),
+                                           make_overlap(5500, 5400)};
+    std::vector<std::int32_t> overlap_order;
+    const std::vector<AlignmentBin> bins = bin_overlaps_by_length(overlaps, 2.0f, overlap_order);
+
+    const std::vector<std::int32_t> expected_order = {3, 0, 2, 4, 1};
+    EXPECT_EQ(overlap_order, expected_order);
+    ASSERT_EQ(bins.size(), 2u);
+    EXPECT_EQ(bins[0].begin, 0);
+    EXPECT_EQ(bins[0].end, 4);
+    EXPECT_EQ(bins[0].max_query_length, 5500);
+    EXPECT_EQ(bins[0].max_target_length, 5400);
+    EXPECT_EQ(bins[1].begin, 4);
+    EXPECT_EQ(bins[1].end, 5);
+    EXPECT_EQ(bins[1].max_query_length, 200000);
+    EXPECT_EQ(bins[1].max_target_length, 199000);
+}
+
+TEST(TestCudamapperAlignmentBinning, bins_respect_length_ratio)
+{
+    std::vector<Overlap> overlaps;
+    for (position_in_read_t length = 0; length < 1000; length += 7)
+    {
+        overlaps.push_back(make_overlap(length, length / 2));
+    }
+    std::vector<std::int32_t> overlap_order;
+    const std::vector<AlignmentBin> bins = bin_overlaps_by_length(overlaps, 1.5f, overlap_order);
+
+    ASSERT_FALSE(bins.empty());
+    EXPECT_EQ(bins.front().begin, 0);
+    EXPECT_EQ(bins.back().end, static_cast<std::int32_t>(overlaps.size()));
+    for (std::size_t i = 0; i < bins.size(); ++i)
+    {
+        ASSERT_LT(bins[i].begin, bins[i].end);
+        if (i > 0)
+        {
+            EXPECT_EQ(bins[i - 1].end, bins[i].begin);
+        }
+        const position_in_read_t shortest = overlaps[overlap_order[bins[i].begin]].query_end_position_in_read_ - overlaps[overlap_order[bins[i].begin]].query_start_position_in_read_;
+        EXPECT_LE(bins[i].max_query_length, 1.5f * std::max<position_in_read_t>(shortest, 1));
+    }
+
+    EXPECT_THROW(bin_overlaps_by_length(overlaps, 0.5f, overlap_order), std::invalid_argument);
+}
+
+TEST(TestCudamapperAlignmentBinning, batch_size)
+{
+    // memory for 100 alignments shared by 4 engines
+    EXPECT_EQ(calc_alignment_batch_size(100 * 1000, 1000, 4, 1000000), 25);
+    // batches are not larger than the share of one engine
+    EXPECT_EQ(calc_alignment_batch_size(100 * 1000, 1000, 4, 10), 3);
+    // at least one alignment per batch, even if the memory estimate says otherwise
+    EXPECT_EQ(calc_alignment_batch_size(10, 1000, 4, 10), 1);
+    EXPECT_THROW(calc_alignment_batch_size(100, 0, 4, 10), std::invalid_argument);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
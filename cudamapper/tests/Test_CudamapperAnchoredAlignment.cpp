@@ -0,0 +1,287 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/utils/genomeutils.hpp>
+
+#include "../src/anchored_alignment.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+Overlap make_overlap(const position_in_read_t query_start, const position_in_read_t query_end,
+                     const position_in_read_t target_start, const position_in_read_t target_end,
+                     const RelativeStrand relative_strand)
+{
+    Overlap overlap;
+    overlap.query_read_id_                 = 0;
+    overlap.target_read_id_                = 1;
+    overlap.query_start_position_in_read_  = query_start;
+    overlap.query_end_position_in_read_    = query_end;
+    overlap.target_start_position_in_read_ = target_start;
+    overlap.target_end_position_in_read_   = target_end;
+    overlap.relative_strand                = relative_strand;
+    return overlap;
+}
+
+Anchor make_anchor(const read_id_t query_read_id, const read_id_t target_read_id, const position_in_read_t query_position, const position_in_read_t target_position)
+{
+    Anchor anchor;
+    anchor.query_read_id_           = query_read_id;
+    anchor.target_read_id_          = target_read_id;
+    anchor.query_position_in_read_  = query_position;
+    anchor.target_position_in_read_ = target_position;
+    return anchor;
+}
+
+/// checks that the segments of the only overlap are consecutive and cover it completely
+void check_segments_cover_overlap(const Overlap& overlap, const OverlapSegments& overlap_segments)
+{
+    ASSERT_EQ(overlap_segments.first_segment.size(), 2u);
+    ASSERT_EQ(overlap_segments.first_segment[0], 0);
+    ASSERT_EQ(overlap_segments.first_segment[1], static_cast<std::int64_t>(overlap_segments.segments.size()));
+    const std::vector<Overlap>& segments = overlap_segments.segments;
+    ASSERT_FALSE(segments.empty());
+    const bool reverse = overlap.relative_strand == RelativeStrand::Reverse;
+    EXPECT_EQ(segments.front().query_start_position_in_read_, overlap.query_start_position_in_read_);
+    EXPECT_EQ(segments.back().query_end_position_in_read_, overlap.query_end_position_in_read_);
+    EXPECT_EQ(reverse ? segments.front().target_end_position_in_read_ : segments.front().target_start_position_in_read_,
+              reverse ? overlap.target_end_position_in_read_ : overlap.target_start_position_in_read_);
+    EXPECT_EQ(reverse ? segments.back().target_start_position_in_read_ : segments.back().target_end_position_in_read_,
+              reverse ? overlap.target_start_position_in_read_ : overlap.target_end_position_in_read_);
+    for (std::size_t i = 0; i < segments.size(); ++i)
+    {
+        EXPECT_LT(segments[i].query_start_position_in_read_, segments[i].query_end_position_in_read_);
+        EXPECT_LT(segments[i].target_start_position_in_read_, segments[i].target_end_position_in_read_);
+        EXPECT_EQ(segments[i].relative_strand, overlap.relative_strand);
+        if (i > 0)
+        {
+            EXPECT_EQ(segments[i].query_start_position_in_read_, segments[i - 1].query_end_position_in_read_);
+            EXPECT_EQ(reverse ? segments[i].target_end_position_in_read_ : segments[i].target_start_position_in_read_,
+                      reverse ? segments[i - 1].target_start_position_in_read_ : segments[i - 1].target_end_position_in_read_);
+        }
+    }
+}
+
+/// computes a global edit distance alignment of query and target, returns its CIGAR string with M, I and D operations
+std::string naive_global_cigar(const std::string& query, const std::string& target)
+{
+    const std::size_t m = query.size();
+    const std::size_t n = target.size();
+    std::vector<std::vector<std::int32_t>> distance(m + 1, std::vector<std::int32_t>(n + 1, 0));
+    for (std::size_t i = 0; i <= m; ++i)
+        distance[i][0] = static_cast<std::int32_t>(i);
+    for (std::size_t j = 0; j <= n; ++j)
+        distance[0][j] = static_cast<std::int32_t>(j);
+    for (std::size_t i = 1; i <= m; ++i)
+        for (std::size_t j = 1; j <= n; ++j)
+            distance[i][j] = std::min({distance[i - 1][j - 1] + (query[i - 1] == target[j - 1] ? 0 : 1),
+                                       distance[i - 1][j] + 1,
+                                       distance[i][j - 1] + 1});
+
+    std::string operations;
+    std::size_t i = m;
+    std::size_t j = n;
+    while (i > 0 || j > 0)
+    {
+        if (i > 0 && j > 0 && distance[i][j] == distance[i - 1][j - 1] + (query[i - 1] == target[j - 1] ? 0 : 1))
+        {
+            operations += 'M';
+            --i;
+            --j;
+        }
+        else if (i > 0 && distance[i][j] == distance[i - 1][j] + 1)
+        {
+            operations += 'I';
+            --i;
+        }
+        else
+        {
+            operations += 'D';
+            --j;
+        }
+    }
+    std::reverse(std::begin(operations), std::end(operations));
+
+    std::string cigar;
+    for (std::size_t begin = 0; begin < operations.size();)
+    {
+        std::size_t end = begin;
+        while (end < operations.size() && operations[end] == operations[begin])
+            ++end;
+        cigar += std::to_string(end - begin) + operations[begin];
+        begin = end;
+    }
+    return cigar;
+}
+} // namespace
+
+TEST(TestCudamapperAnchoredAlignment, overlap_without_anchors_is_one_segment)
+{
+    const Overlap overlap             = make_overlap(100, 5000, 200, 5100, RelativeStrand::Forward);
+    const std::vector<Anchor> anchors = {make_anchor(0, 2, 500, 600), make_anchor(1, 1, 500, 600)};
+
+    const OverlapSegments overlap_segments = split_overlaps_at_anchors({overlap}, anchors, 1000, 15);
+    check_segments_cover_overlap(overlap, overlap_segments);
+    EXPECT_EQ(overlap_segments.segments.size(), 1u);
+}
+
+TEST(TestCudamapperAnchoredAlignment, forward_overlap_is_split_at_furthest_anchors)
+{
+    const Overlap overlap = make_overlap(1000, 2000, 3000, 4010, RelativeStrand::Forward);
+    std::vector<Anchor> anchors;
+    for (position_in_read_t i = 1000; i <= 2000; i += 100)
+    {
+        anchors.push_back(make_anchor(0, 1, i, i + 2000 + (i - 1000) / 100));
+    }
+
+    const OverlapSegments overlap_segments = split_overlaps_at_anchors({overlap}, anchors, 250, 15);
+    check_segments_cover_overlap(overlap, overlap_segments);
+    const std::vector<position_in_read_t> expected_query_starts  = {1000, 1200, 1400, 1600, 1800};
+    const std::vector<position_in_read_t> expected_target_starts = {3000, 3202, 3404, 3606, 3808};
+    ASSERT_EQ(overlap_segments.segments.size(), expected_query_starts.size());
+    for (std::size_t i = 0; i < expected_query_starts.size(); ++i)
+    {
+        EXPECT_EQ(overlap_segments.segments[i].query_start_position_in_read_, expected_query_starts[i]) << i;
+        EXPECT_EQ(overlap_segments.segments[i].target_start_position_in_read_, expected_target_starts[i]) << i;
+    }
+}
+
+TEST(TestCudamapperAnchoredAlignment, anchors_off_the_diagonal_are_skipped)
+{
+    const Overlap overlap = make_overlap(0, 3000, 0, 3000, RelativeStrand::Forward);
+    // the anchor at query position 1000 belongs to a repeat 800 bases away from the overlap's diagonal
+    const std::vector<Anchor> anchors = {make_anchor(0, 1, 1000, 1800), make_anchor(0, 1, 1500, 1510), make_anchor(0, 1, 2500, 2490)};
+
+    const OverlapSegments overlap_segments = split_overlaps_at_anchors({overlap}, anchors, 1000, 15);
+    check_segments_cover_overlap(overlap, overlap_segments);
+    ASSERT_EQ(overlap_segments.segments.size(), 3u);
+    EXPECT_EQ(overlap_segments.segments[1].query_start_position_in_read_, 1500u);
+    EXPECT_EQ(overlap_segments.segments[1].target_start_position_in_read_, 1510u);
+    EXPECT_EQ(overlap_segments.segments[2].query_start_position_in_read_, 2500u);
+    EXPECT_EQ(overlap_segments.segments[2].target_start_position_in_read_, 2490u);
+}
+
+TEST(TestCudamapperAnchoredAlignment, reverse_overlap_segments_go_backwards_in_target)
+{
+    // the target k-mers of the anchors are the reverse complements of query k-mers 300 and 600 bases into the overlap
+    const std::int32_t kmer_size      = 15;
+    const Overlap overlap             = make_overlap(0, 1000, 5000, 6000, RelativeStrand::Reverse);
+    const std::vector<Anchor> anchors = {make_anchor(0, 1, 300, 6000 - 300 - kmer_size), make_anchor(0, 1, 600, 6000 - 600 - kmer_size)};
+
+    const OverlapSegments overlap_segments = split_overlaps_at_anchors({overlap}, anchors, 400, kmer_size);
+    check_segments_cover_overlap(overlap, overlap_segments);
+    ASSERT_EQ(overlap_segments.segments.size(), 3u);
+    EXPECT_EQ(overlap_segments.segments[0].target_start_position_in_read_, 5700u);
+    EXPECT_EQ(overlap_segments.segments[0].target_end_position_in_read_, 6000u);
+    EXPECT_EQ(overlap_segments.segments[2].target_start_position_in_read_, 5000u);
+    EXPECT_EQ(overlap_segments.segments[2].target_end_position_in_read_, 5400u);
+}
+
+TEST(TestCudamapperAnchoredAlignment, reverse_complement_segments_align_without_indels)
+{
+    // the target read contains the reverse complement of the query read between two random flanks
+    const std::int32_t kmer_size = 15;
+    std::minstd_rand rng(7);
+    const std::string query = genomeutils::generate_random_genome(1200, rng);
+    std::string query_rc(query.size(), 'N');
+    genomeutils::reverse_complement(query.data(), static_cast<std::int32_t>(query.size()), &query_rc[0]);
+    const std::string target = genomeutils::generate_random_genome(500, rng) + query_rc + genomeutils::generate_random_genome(300, rng);
+
+    const Overlap overlap = make_overlap(0, 1200, 500, 1700, RelativeStrand::Reverse);
+    // query k-mer at position q is the reverse complement of the target k-mer at 1700 - q - kmer_size
+    std::vector<Anchor> anchors;
+    for (position_in_read_t query_position = 0; query_position + kmer_size <= 1200; query_position += 50)
+    {
+        anchors.push_back(make_anchor(0, 1, query_position, 1700 - query_position - kmer_size));
+    }
+
+    const OverlapSegments overlap_segments = split_overlaps_at_anchors({overlap}, anchors, 300, kmer_size);
+    check_segments_cover_overlap(overlap, overlap_segments);
+    ASSERT_GT(overlap_segments.segments.size(), 1u);
+
+    std::vector<std::string> segment_cigars;
+    for (const Overlap& segment : overlap_segments.segments)
+    {
+        const std::string segment_query = query.substr(segment.query_start_position_in_read_,
+                                                       segment.query_end_position_in_read_ - segment.query_start_position_in_read_);
+        const std::int32_t target_length = segment.target_end_position_in_read_ - segment.target_start_position_in_read_;
+        std::string segment_target(target_length, 'N');
+        genomeutils::reverse_complement(target.data() + segment.target_start_position_in_read_, target_length, &segment_target[0]);
+        segment_cigars.push_back(naive_global_cigar(segment_query, segment_target));
+    }
+
+    const std::vector<std::string> cigars = stitch_segment_cigars(overlap_segments, segment_cigars);
+    ASSERT_EQ(cigars.size(), 1u);
+    EXPECT_EQ(cigars[0], "1200M");
+}
+
+TEST(TestCudamapperAnchoredAlignment, multiple_overlaps)
+{
+    const std::vector<Overlap> overlaps = {make_overlap(0, 1000, 0, 1000, RelativeStrand::Forward),
+                                           make_overlap(2000, 3000, 2000, 3000, RelativeStrand::Forward)};
+    const std::vector<Anchor> anchors   = {make_anchor(0, 1, 500, 500), make_anchor(0, 1, 2500, 2500)};
+
+    const OverlapSegments overlap_segments                 = split_overlaps_at_anchors(overlaps, anchors, 600, 15);
+    const std::vector<std::int64_t> expected_first_segment = {0, 2, 4};
+    EXPECT_EQ(overlap_segments.first_segment, expected_first_segment);
+    ASSERT_EQ(overlap_segments.segments.size(), 4u);
+    EXPECT_EQ(overlap_segments.segments[3].query_start_position_in_read_, 2500u);
+}
+
+TEST(TestCudamapperAnchoredAlignment, invalid_segment_length)
+{
+    EXPECT_THROW(split_overlaps_at_anchors({}, {}, 0, 15), std::invalid_argument);
+    EXPECT_THROW(split_overlaps_at_anchors({}, {}, 1000, 0), std::invalid_argument);
+}
+
+TEST(TestCudamapperAnchoredAlignment, cigars_are_stitched)
+{
+    OverlapSegments overlap_segments;
+    overlap_segments.segments      = {make_overlap(0, 4, 0, 5, RelativeStrand::Forward),
+                                 make_overlap(4, 6, 5, 7, RelativeStrand::Forward),
+                                 make_overlap(6, 11, 7, 11, RelativeStrand::Forward),
+                                 make_overlap(0, 10, 0, 10, RelativeStrand::Forward),
+                                 make_overlap(10, 20, 10, 20, RelativeStrand::Forward)};
+    overlap_segments.first_segment                = {0, 3, 5};
+    const std::vector<std::string> segment_cigars = {"3M1I1M", "2M", "1D4M", "10M", ""};
+
+    const std::vector<std::string> cigars = stitch_segment_cigars(overlap_segments, segment_cigars);
+    ASSERT_EQ(cigars.size(), 2u);
+    EXPECT_EQ(cigars[0], "3M1I3M1D4M");
+    EXPECT_EQ(cigars[1], "");
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,142 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "../src/incremental_state.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+std::string create_temporary_directory()
+{
+    char directory_template[] = "/tmp/gw_incremental_state_XXXXXX";
+    const char* directory     = mkdtemp(directory_template);
+    return directory ? std::string(directory) : std::string();
+}
+
+void remove_temporary_directory(const std::string& directory)
+{
+    std::remove((directory + "/state.txt").c_str());
+    rmdir(get_incremental_index_directory(directory).c_str());
+    rmdir(directory.c_str());
+}
+
+} // namespace
+
+TEST(TestCudamapperIncrementalState, empty_state_before_first_run)
+{
+    const std::string state_directory = create_temporary_directory();
+    ASSERT_FALSE(state_directory.empty());
+
+    const IncrementalState state = load_incremental_state(state_directory);
+    EXPECT_TRUE(state.parameters.empty());
+    EXPECT_EQ(state.number_of_query_reads, 0);
+    EXPECT_EQ(state.number_of_target_reads, 0);
+    EXPECT_EQ(state.overlaps_file_size, 0);
+    EXPECT_TRUE(state.query_index_descriptors.empty());
+    EXPECT_TRUE(state.target_index_descriptors.empty());
+
+    // index directory is created together with the state directory
+    EXPECT_EQ(0, access(get_incremental_index_directory(state_directory).c_str(), F_OK));
+
+    remove_temporary_directory(state_directory);
+}
+
+TEST(TestCudamapperIncrementalState, save_and_load)
+{
+    const std::string state_directory = create_temporary_directory();
+    ASSERT_FALSE(state_directory.empty());
+
+    IncrementalState state;
+    state.parameters               = "k=15 w=10 F=1e-05";
+    state.query_filepath           = "/data/query reads.fasta";
+    state.target_filepath          = "/data/target.fastq.gz";
+    state.number_of_query_reads    = 1200;
+    state.number_of_target_reads   = 35;
+    state.query_reads_hash         = 0xFEDCBA9876543210ull;
+    state.target_reads_hash        = 17;
+    state.overlaps_file_size       = 123456789012ll;
+    state.query_index_descriptors  = {{0, 1000}, {1000, 200}};
+    state.target_index_descriptors = {{0, 35}};
+
+    load_incremental_state(state_directory); // creates directories
+    save_incremental_state(state_directory, state);
+    const IncrementalState loaded_state = load_incremental_state(state_directory);
+
+    EXPECT_EQ(loaded_state.parameters, state.parameters);
+    EXPECT_EQ(loaded_state.query_filepath, state.query_filepath);
+    EXPECT_EQ(loaded_state.target_filepath, state.target_filepath);
+    EXPECT_EQ(loaded_state.number_of_query_reads, state.number_of_query_reads);
+    EXPECT_EQ(loaded_state.number_of_target_reads, state.number_of_target_reads);
+    EXPECT_EQ(loaded_state.query_reads_hash, state.query_reads_hash);
+    EXPECT_EQ(loaded_state.target_reads_hash, state.target_reads_hash);
+    EXPECT_EQ(loaded_state.overlaps_file_size, state.overlaps_file_size);
+    EXPECT_EQ(loaded_state.query_index_descriptors, state.query_index_descriptors);
+    EXPECT_EQ(loaded_state.target_index_descriptors, state.target_index_descriptors);
+
+    remove_temporary_directory(state_directory);
+}
+
+TEST(TestCudamapperIncrementalState, invalid_state_file)
+{
+    const std::string state_directory = create_temporary_directory();
+    ASSERT_FALSE(state_directory.empty());
+
+    {
+        std::ofstream state_file(state_directory + "/state.txt");
+        state_file << "not a state file\n";
+    }
+    EXPECT_THROW(load_incremental_state(state_directory), std::runtime_error);
+
+    remove_temporary_directory(state_directory);
+}
+
+TEST(TestCudamapperIncrementalState, hash_reads_only_depends_on_previous_reads)
+{
+    const std::unique_ptr<io::FastaParser> parser          = io::create_string_fasta_parser(">read_0\nACGT\n>read_1\nGGCC\n");
+    const std::unique_ptr<io::FastaParser> appended_parser = io::create_string_fasta_parser(">read_0\nACGT\n>read_1\nGGCC\n>read_2\nTTAA\n");
+    const std::unique_ptr<io::FastaParser> modified_parser = io::create_string_fasta_parser(">read_0\nACGT\n>read_1\nGGCA\n>read_2\nTTAA\n");
+
+    EXPECT_EQ(hash_reads(*parser, 2), hash_reads(*appended_parser, 2));
+    EXPECT_NE(hash_reads(*parser, 2), hash_reads(*appended_parser, 3));
+    EXPECT_NE(hash_reads(*parser, 2), hash_reads(*modified_parser, 2));
+    EXPECT_EQ(hash_reads(*parser, 1), hash_reads(*modified_parser, 1));
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
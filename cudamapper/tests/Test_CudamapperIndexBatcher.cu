@@ -924,6 +924,40 @@ TEST(TestCudamapperIndexBatcher, test_generate_batches_of_indices_exceptions)
     target_basepairs_per_index = query_basepairs_per_index;
 }
 
+TEST(TestCudamapperIndexBatcher, test_generate_batches_of_indices_from_index_descriptors)
+{
+    // previous query indices against one new target index, as in an incremental run
+    const std::vector<IndexDescriptor> query_index_descriptors  = {{0, 10}, {10, 10}, {20, 10}};
+    const std::vector<IndexDescriptor> target_index_descriptors = {{30, 5}};
+
+    const std::vector<BatchOfIndices> expected_batches = {{{{{0, 10}, {10, 10}}, {{30, 5}}},
+                                                           {{{{0, 10}}, {{30, 5}}},
+                                                            {{{10, 10}}, {{30, 5}}}}},
+                                                          {{{{20, 10}}, {{30, 5}}},
+                                                           {{{{20, 10}}, {{30, 5}}}}}};
+
+    const std::vector<BatchOfIndices> generated_batches = generate_batches_of_indices(2, // query_indices_per_host_batch
+                                                                                      1, // query_indices_per_device_batch
+                                                                                      2, // target_indices_per_host_batch
+                                                                                      1, // target_indices_per_device_batch
+                                                                                      query_index_descriptors,
+                                                                                      target_index_descriptors,
+                                                                                      false); // same_query_and_target
+
+    test_generated_batches(generated_batches,
+                           expected_batches);
+
+    // same_query_and_target requires the same index descriptors
+    ASSERT_THROW(generate_batches_of_indices(2,
+                                             1,
+                                             2,
+                                             1,
+                                             query_index_descriptors,
+                                             target_index_descriptors,
+                                             true),
+                 std::invalid_argument);
+}
+
 } // namespace cudamapper
 
 } // namespace genomeworks
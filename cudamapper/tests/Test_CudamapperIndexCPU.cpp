@@ -0,0 +1,249 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+#include "cudamapper_file_location.hpp"
+
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "../src/index_cpu.hpp"
+#include "../src/low_complexity_masker.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace details
+{
+
+namespace index_cpu
+{
+
+void test_find_minimizers(const std::string& basepairs,
+                          const std::uint64_t minimizer_size,
+                          const std::uint64_t window_size,
+                          const read_id_t read_id,
+                          const bool hash_representations,
+                          const std::vector<representation_t>& expected_representations,
+                          const std::vector<position_in_read_t>& expected_positions_in_reads,
+                          const std::vector<SketchElement::DirectionOfRepresentation>& expected_directions_of_reads)
+{
+    std::vector<representation_t> representations;
+    std::vector<read_id_t> read_ids;
+    std::vector<position_in_read_t> positions_in_reads;
+    std::vector<SketchElement::DirectionOfRepresentation> directions_of_reads;
+
+    find_minimizers(basepairs.data(),
+                    basepairs.size(),
+                    read_id,
+                    minimizer_size,
+                    window_size,
+                    hash_representations,
+                    representations,
+                    read_ids,
+                    positions_in_reads,
+                    directions_of_reads);
+
+    ASSERT_EQ(representations.size(), expected_representations.size());
+    ASSERT_EQ(read_ids.size(), expected_representations.size());
+    ASSERT_EQ(positions_in_reads.size(), expected_positions_in_reads.size());
+    ASSERT_EQ(directions_of_reads.size(), expected_directions_of_reads.size());
+    for (std::size_t i = 0; i < expected_representations.size(); ++i)
+    {
+        EXPECT_EQ(representations[i], expected_representations[i]) << "index: " << i;
+        EXPECT_EQ(read_ids[i], read_id) << "index: " << i;
+        EXPECT_EQ(positions_in_reads[i], expected_positions_in_reads[i]) << "index: " << i;
+        EXPECT_EQ(directions_of_reads[i], expected_directions_of_reads[i]) << "index: " << i;
+    }
+}
+
+TEST(TestCudamapperIndexCPU, test_find_minimizers_GATT_4_1)
+{
+    // GATT: forward 2033, reverse (AATC) 0031 -> reverse is taken
+    test_find_minimizers("GATT",
+                         4,
+                         1,
+                         0,
+                         false,
+                         {0b00001101},
+                         {0},
+                         {SketchElement::DirectionOfRepresentation::REVERSE});
+
+    // with hashing forward representation is smaller, same value as generated by IndexGPU
+    test_find_minimizers("GATT",
+                         4,
+                         1,
+                         0,
+                         true,
+                         {304626093},
+                         {0},
+                         {SketchElement::DirectionOfRepresentation::FORWARD});
+}
+
+TEST(TestCudamapperIndexCPU, test_find_minimizers_CCCATACC_2_7)
+{
+    // kmer representation: forward, reverse
+    // CC: <11> 22
+    // CC: <11> 22
+    // CA: <10> 32
+    // AT: <03> 03
+    // TA: <30> 30
+    // AC: <01> 23
+    // CC: <11> 22
+
+    // front end minimizers: CC(0), CC(1), CA(2), AT(3), AT(3), AC(5)
+    // central minimizers: AC(5)
+    // back end minimizers: AC(5), AC(5), AC(5), AC(5), AC(5), CC(6)
+
+    const std::vector<SketchElement::DirectionOfRepresentation> all_forward(6, SketchElement::DirectionOfRepresentation::FORWARD);
+    test_find_minimizers("CCCATACC",
+                         2,
+                         7,
+                         3,
+                         false,
+                         {0b0101, 0b0101, 0b0100, 0b0011, 0b0001, 0b0101},
+                         {0, 1, 2, 3, 5, 6},
+                         all_forward);
+
+    test_find_minimizers("CCCATACC",
+                         2,
+                         7,
+                         3,
+                         true,
+                         {2515151312, 2515151312, 1582582417, 2515151312},
+                         {0, 1, 2, 6},
+                         {all_forward.begin(), all_forward.begin() + 4});
+}
+
+} // namespace index_cpu
+
+} // namespace details
+
+void test_index_cpu(const std::string& filename,
+                    const read_id_t first_read_id,
+                    const read_id_t past_the_last_read_id,
+                    const std::uint64_t kmer_size,
+                    const std::uint64_t window_size,
+                    const double filtering_parameter,
+                    const std::vector<representation_t>& expected_representations,
+                    const std::vector<position_in_read_t>& expected_positions_in_reads,
+                    const std::vector<read_id_t>& expected_read_ids,
+                    const std::vector<representation_t>& expected_unique_representations,
+                    const std::vector<std::uint32_t>& expected_first_occurrence_of_representations,
+                    const read_id_t expected_number_of_reads,
+                    const position_in_read_t expected_number_of_basepairs_in_longest_read)
+{
+    std::unique_ptr<io::FastaParser> parser = io::create_kseq_fasta_parser(filename);
+
+    const IndexCPU index(*parser,
+                         first_read_id,
+                         past_the_last_read_id,
+                         kmer_size,
+                         window_size,
+                         false,
+                         filtering_parameter);
+
+    ASSERT_EQ(index.number_of_reads(), expected_number_of_reads);
+    ASSERT_EQ(index.number_of_basepairs_in_longest_read(), expected_number_of_basepairs_in_longest_read);
+    ASSERT_EQ(index.smallest_read_id(), first_read_id);
+    ASSERT_EQ(index.largest_read_id(), past_the_last_read_id - 1);
+
+    ASSERT_EQ(index.representations().size(), expected_representations.size());
+    ASSERT_EQ(index.positions_in_reads().size(), expected_positions_in_reads.size());
+    ASSERT_EQ(index.read_ids().size(), expected_read_ids.size());
+    ASSERT_EQ(index.directions_of_reads().size(), expected_read_ids.size());
+    for (std::size_t i = 0; i < expected_representations.size(); ++i)
+    {
+        EXPECT_EQ(index.representations()[i], expected_representations[i]) << "i: " << i;
+        EXPECT_EQ(index.positions_in_reads()[i], expected_positions_in_reads[i]) << "i: " << i;
+        EXPECT_EQ(index.read_ids()[i], expected_read_ids[i]) << "i: " << i;
+    }
+
+    ASSERT_EQ(index.unique_representations(), expected_unique_representations);
+    ASSERT_EQ(index.first_occurrence_of_representations(), expected_first_occurrence_of_representations);
+}
+
+TEST(TestCudamapperIndexCPU, AAAACTGAA_GCCAAAG_2_3)
+{
+    // Same data as TestCudamapperIndexGPU.AAAACTGAA_GCCAAAG_2_3
+    //              0        1        2        3        4        5        6        7        8        9        10       11
+    // data arrays: AA(0f0), AA(1f0), AA(2f0), AA(7f0), AA(3f1), AA(4f1), AC(3f0), AG(4r0), AG(5f1), CA(2f1), CC(1f1), GC(0f1)
+    test_index_cpu(std::string(CUDAMAPPER_BENCHMARK_DATA_DIR) + "/aaaactgaa_gccaaag.fasta",
+                   0,
+                   2,
+                   2,
+                   3,
+                   1.0,
+                   {0b0000, 0b0000, 0b0000, 0b0000, 0b0000, 0b0000, 0b0001, 0b0010, 0b0010, 0b0100, 0b0101, 0b1001},
+                   {0, 1, 2, 7, 3, 4, 3, 4, 5, 2, 1, 0},
+                   {0, 0, 0, 0, 1, 1, 0, 0, 1, 1, 1, 1},
+                   {0b0000, 0b0001, 0b0010, 0b0100, 0b0101, 0b1001},
+                   {0, 6, 7, 9, 10, 11, 12},
+                   2,
+                   9);
+}
+
+TEST(TestCudamapperIndexCPU, AAAACTGAA_GCCAAAG_2_3_filtering)
+{
+    // Same data as TestCudamapperIndexGPU.AAAACTGAA_GCCAAAG_2_3_filtering
+    // filtering_parameter = 0.5 <=> filtering_threshold = 12 * 0.5 = 6, all AA elements get removed
+    // data arrays after filtering: AC(3f0), AG(4r0), AG(5f1), CA(2f1), CC(1f1), GC(0f1)
+    test_index_cpu(std::string(CUDAMAPPER_BENCHMARK_DATA_DIR) + "/aaaactgaa_gccaaag.fasta",
+                   0,
+                   2,
+                   2,
+                   3,
+                   0.5,
+                   {0b0001, 0b0010, 0b0010, 0b0100, 0b0101, 0b1001},
+                   {3, 4, 5, 2, 1, 0},
+                   {0, 0, 1, 1, 1, 1},
+                   {0b0001, 0b0010, 0b0100, 0b0101, 0b1001},
+                   {0, 1, 3, 4, 5, 6},
+                   2,
+                   9);
+}
+
+TEST(TestCudamapperIndexCPU, low_complexity_sketch_elements_masked)
+{
+    // read_0 ends with a homopolymer, with masking no sketch element may overlap it
+    const std::string basepairs                   = "ACGTTGCAAGCTTCGATCGGATCCTAGGCATGCAATTGCCGGTACCTTAAGGCTAGCTAG" + std::string(60, 'A');
+    const std::unique_ptr<io::FastaParser> parser = io::create_string_fasta_parser(">read_0\n" + basepairs + "\n");
+    const std::uint64_t kmer_size                 = 5;
+
+    const IndexCPU unmasked_index(*parser, 0, 1, kmer_size, 4, true, 1.0, 0);
+    const IndexCPU masked_index(*parser, 0, 1, kmer_size, 4, true, 1.0, 20);
+
+    ASSERT_GT(masked_index.representations().size(), 0u);
+    EXPECT_LT(masked_index.representations().size(), unmasked_index.representations().size());
+    const std::vector<MaskedInterval> masked_intervals = find_low_complexity_intervals(basepairs, 20);
+    ASSERT_FALSE(masked_intervals.empty());
+    for (const position_in_read_t position : masked_index.positions_in_reads())
+    {
+        EXPECT_FALSE(is_kmer_masked(masked_intervals, position, kmer_size));
+    }
+    EXPECT_EQ(masked_index.number_of_basepairs_in_longest_read(), unmasked_index.number_of_basepairs_in_longest_read());
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -161,6 +161,37 @@ TEST(TestCudamapperIndexDescriptor, test_group_reads_into_indices_some_reads_lar
                                   expected_index_descriptors);
 }
 
+TEST(TestCudamapperIndexDescriptor, test_group_reads_into_indices_range_of_reads)
+{
+    // Only reads in [first_read, past_the_last_read) are grouped, reads before and after the range have no influence
+
+    // target FASTA: 20_reads.fasta
+    // read_5:  8 basepairs
+    // read_6:  6 basepairs
+    // read_7:  3 basepairs
+    // read_8:  3 basepairs
+    // read_9:  5 basepairs
+    // read_10: 7 basepairs
+    // read_11: 3 basepairs
+    // range: [5, 12)
+    // max basepairs in index: 10
+    // indices: {5, 1}, {6, 2}, {8, 2}, {10, 2}
+
+    const std::shared_ptr<const io::FastaParser> parser = io::create_kseq_fasta_parser(std::string(CUDAMAPPER_BENCHMARK_DATA_DIR) + "/20_reads.fasta", 1, false);
+    const number_of_basepairs_t max_basepairs_per_index = 10;
+
+    const std::vector<IndexDescriptor> expected_index_descriptors = {{5, 1}, {6, 2}, {8, 2}, {10, 2}};
+
+    const std::vector<IndexDescriptor> generated_index_descriptors = group_reads_into_indices(*parser,
+                                                                                              5,
+                                                                                              12,
+                                                                                              max_basepairs_per_index);
+    ASSERT_EQ(generated_index_descriptors, expected_index_descriptors);
+
+    // empty range
+    ASSERT_TRUE(group_reads_into_indices(*parser, 20, 20, max_basepairs_per_index).empty());
+}
+
 } // namespace cudamapper
 
 } // namespace genomeworks
@@ -0,0 +1,107 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <claraparabricks/genomeworks/utils/signed_integer_utils.hpp>
+
+#include "../src/index_sketch.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+TEST(TestCudamapperIndexSketch, create_index_sketch)
+{
+    const std::vector<representation_t> unique_representations = {2, 3, 5, 7, 11, 13};
+
+    const IndexSketch small_sketch = create_index_sketch(unique_representations.data(), get_size(unique_representations), 4);
+    EXPECT_EQ(small_sketch.smallest_representations, std::vector<representation_t>({2, 3, 5, 7}));
+    EXPECT_EQ(small_sketch.number_of_unique_representations, 6);
+
+    const IndexSketch complete_sketch = create_index_sketch(unique_representations.data(), get_size(unique_representations), 100);
+    EXPECT_EQ(complete_sketch.smallest_representations, unique_representations);
+    EXPECT_EQ(complete_sketch.number_of_unique_representations, 6);
+}
+
+TEST(TestCudamapperIndexSketch, complete_sketches_give_exact_number)
+{
+    const std::vector<representation_t> a = {1, 4, 6, 9, 12};
+    const std::vector<representation_t> b = {2, 4, 9, 10, 12, 15, 20};
+
+    const IndexSketch sketch_a = create_index_sketch(a.data(), get_size(a), 10);
+    const IndexSketch sketch_b = create_index_sketch(b.data(), get_size(b), 10);
+
+    EXPECT_DOUBLE_EQ(estimate_number_of_shared_representations(sketch_a, sketch_b), 3.0);
+    EXPECT_DOUBLE_EQ(estimate_number_of_shared_representations(sketch_b, sketch_a), 3.0);
+}
+
+TEST(TestCudamapperIndexSketch, empty_sketch_shares_nothing)
+{
+    const std::vector<representation_t> a = {1, 4, 6};
+
+    const IndexSketch sketch_a = create_index_sketch(a.data(), get_size(a), 10);
+    const IndexSketch empty_sketch;
+
+    EXPECT_DOUBLE_EQ(estimate_number_of_shared_representations(sketch_a, empty_sketch), 0.0);
+    EXPECT_DOUBLE_EQ(estimate_number_of_shared_representations(empty_sketch, sketch_a), 0.0);
+}
+
+TEST(TestCudamapperIndexSketch, estimate_from_incomplete_sketches)
+{
+    // a = all even numbers in [0, 20000), b = all multiples of 3 in [0, 20000)
+    // shared are multiples of 6, elements are spread evenly so the estimate from the smallest elements should be close
+    std::vector<representation_t> a;
+    std::vector<representation_t> b;
+    std::int64_t number_of_shared_representations = 0;
+    for (representation_t i = 0; i < 20000; ++i)
+    {
+        if (i % 2 == 0)
+            a.push_back(i);
+        if (i % 3 == 0)
+            b.push_back(i);
+        if (i % 6 == 0)
+            ++number_of_shared_representations;
+    }
+
+    const IndexSketch sketch_a = create_index_sketch(a.data(), get_size(a), 600);
+    const IndexSketch sketch_b = create_index_sketch(b.data(), get_size(b), 600);
+
+    const double estimate = estimate_number_of_shared_representations(sketch_a, sketch_b);
+    EXPECT_NEAR(estimate, number_of_shared_representations, 0.05 * number_of_shared_representations);
+
+    // disjoint sets
+    std::vector<representation_t> c;
+    for (representation_t i = 1; i < 20000; i += 2)
+    {
+        c.push_back(i);
+    }
+    const IndexSketch sketch_c = create_index_sketch(c.data(), get_size(c), 600);
+    EXPECT_DOUBLE_EQ(estimate_number_of_shared_representations(sketch_a, sketch_c), 0.0);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
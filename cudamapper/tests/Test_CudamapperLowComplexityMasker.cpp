@@ -0,0 +1,117 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "../src/low_complexity_masker.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+// 60 basepairs without low-complexity regions
+const std::string complex_sequence = "ACGTTGCAAGCTTCGATCGGATCCTAGGCATGCAATTGCCGGTACCTTAAGGCTAGCTAG";
+} // namespace
+
+TEST(TestCudamapperLowComplexityMasker, complex_sequence_not_masked)
+{
+    EXPECT_TRUE(find_low_complexity_intervals(complex_sequence).empty());
+}
+
+TEST(TestCudamapperLowComplexityMasker, homopolymer_masked)
+{
+    const std::string homopolymer(100, 'A');
+    const std::vector<MaskedInterval> expected_intervals = {{0, 100}};
+    EXPECT_EQ(find_low_complexity_intervals(homopolymer), expected_intervals);
+}
+
+TEST(TestCudamapperLowComplexityMasker, microsatellite_between_complex_regions)
+{
+    std::string microsatellite;
+    for (int i = 0; i < 30; ++i)
+    {
+        microsatellite += "CA";
+    }
+    const std::string sequence = complex_sequence + microsatellite + complex_sequence;
+
+    const std::vector<MaskedInterval> intervals = find_low_complexity_intervals(sequence);
+    ASSERT_EQ(intervals.size(), 1u);
+    // interval covers the microsatellite, possibly extended by a few basepairs which continue the pattern
+    EXPECT_LE(intervals[0].begin, complex_sequence.size() + 2);
+    EXPECT_GE(intervals[0].end, complex_sequence.size() + microsatellite.size() - 2);
+    EXPECT_GE(intervals[0].begin, complex_sequence.size() - 4);
+    EXPECT_LE(intervals[0].end, complex_sequence.size() + microsatellite.size() + 4);
+}
+
+TEST(TestCudamapperLowComplexityMasker, ambiguous_basepairs_split_sequence)
+{
+    // N is never masked, low-complexity regions on both sides are found independently
+    const std::string sequence = std::string(40, 'T') + "N" + std::string(40, 'G');
+    const std::vector<MaskedInterval> expected_intervals = {{0, 40}, {41, 81}};
+    EXPECT_EQ(find_low_complexity_intervals(sequence), expected_intervals);
+}
+
+TEST(TestCudamapperLowComplexityMasker, is_kmer_masked)
+{
+    const std::vector<MaskedInterval> intervals = {{10, 20}, {30, 35}};
+    EXPECT_FALSE(is_kmer_masked(intervals, 0, 10));
+    EXPECT_TRUE(is_kmer_masked(intervals, 1, 10));
+    EXPECT_TRUE(is_kmer_masked(intervals, 19, 5));
+    EXPECT_FALSE(is_kmer_masked(intervals, 20, 10));
+    EXPECT_TRUE(is_kmer_masked(intervals, 21, 10));
+    EXPECT_FALSE(is_kmer_masked(intervals, 35, 10));
+    EXPECT_FALSE(is_kmer_masked({}, 0, 10));
+}
+
+TEST(TestCudamapperLowComplexityMasker, reads_in_parallel_and_bed_output)
+{
+    const std::string fasta = ">read_0\n" + complex_sequence + "\n>read_1\n" + std::string(50, 'C') + "\n>read_2\n" + complex_sequence + std::string(30, 'A') + "\n";
+    const std::unique_ptr<io::FastaParser> parser = io::create_string_fasta_parser(fasta);
+
+    const std::vector<std::vector<MaskedInterval>> intervals = find_low_complexity_intervals(*parser, 1, 3);
+    ASSERT_EQ(intervals.size(), 2u);
+    EXPECT_EQ(intervals[0], find_low_complexity_intervals(parser->get_sequence_by_id(1).seq));
+    EXPECT_EQ(intervals[1], find_low_complexity_intervals(parser->get_sequence_by_id(2).seq));
+
+    std::ostringstream bed;
+    write_low_complexity_intervals_bed(*parser, 20, bed);
+    std::ostringstream expected_bed;
+    expected_bed << "read_1\t0\t50\n";
+    for (const MaskedInterval& interval : intervals[1])
+    {
+        expected_bed << "read_2\t" << interval.begin << '\t' << interval.end << '\n';
+    }
+    EXPECT_EQ(bed.str(), expected_bed.str());
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
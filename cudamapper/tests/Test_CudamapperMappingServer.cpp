@@ -0,0 +1,213 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../src/mapping_server.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+std::string get_test_socket_path(const std::string& test_name)
+{
+    return "/tmp/gw_cudamapper_test_" + test_name + "_" + std::to_string(getpid()) + ".sock";
+}
+
+} // namespace
+
+TEST(TestCudamapperMappingServer, request_and_response)
+{
+    const std::string socket_path = get_test_socket_path("request_and_response");
+    MappingServer server(socket_path,
+                         [](const std::string& request) {
+                             return "response to " + request;
+                         });
+    std::thread server_thread([&server]() { server.run(); });
+
+    ASSERT_EQ(request_mapping(socket_path, ">read_0\nACGT\n"), "response to >read_0\nACGT\n");
+    ASSERT_EQ(request_mapping(socket_path, ""), "response to ");
+
+    server.stop();
+    server_thread.join();
+}
+
+TEST(TestCudamapperMappingServer, large_request_and_response)
+{
+    const std::string socket_path = get_test_socket_path("large_request_and_response");
+    MappingServer server(socket_path,
+                         [](const std::string& request) {
+                             return request + request;
+                         });
+    std::thread server_thread([&server]() { server.run(); });
+
+    // larger than socket buffers, so both sides have to read and write in multiple steps
+    std::string request(10'000'000, 'A');
+    for (std::size_t i = 0; i < request.size(); i += 1000)
+    {
+        request[i] = 'C';
+    }
+    ASSERT_EQ(request_mapping(socket_path, request), request + request);
+
+    server.stop();
+    server_thread.join();
+}
+
+TEST(TestCudamapperMappingServer, handler_error_is_reported_to_client)
+{
+    const std::string socket_path = get_test_socket_path("handler_error_is_reported_to_client");
+    MappingServer server(socket_path,
+                         [](const std::string& request) -> std::string {
+                             if (request.empty())
+                             {
+                                 throw std::invalid_argument("empty\nrequest");
+                             }
+                             return request;
+                         });
+    std::thread server_thread([&server]() { server.run(); });
+
+    try
+    {
+        request_mapping(socket_path, "");
+        FAIL() << "request_mapping() should have thrown";
+    }
+    catch (const std::runtime_error& e)
+    {
+        ASSERT_EQ(std::string(e.what()), "ERROR empty request");
+    }
+
+    // server keeps working after an error
+    ASSERT_EQ(request_mapping(socket_path, "abc"), "abc");
+
+    server.stop();
+    server_thread.join();
+}
+
+TEST(TestCudamapperMappingServer, multiple_clients)
+{
+    const std::string socket_path = get_test_socket_path("multiple_clients");
+    std::atomic<std::int32_t> number_of_requests(0);
+    MappingServer server(socket_path,
+                         [&number_of_requests](const std::string& request) {
+                             ++number_of_requests;
+                             return request;
+                         });
+    std::thread server_thread([&server]() { server.run(); });
+
+    const std::int32_t number_of_clients = 8;
+    std::vector<std::thread> client_threads;
+    std::atomic<bool> all_responses_correct(true);
+    for (std::int32_t client_id = 0; client_id < number_of_clients; ++client_id)
+    {
+        client_threads.emplace_back([&socket_path, &all_responses_correct, client_id]() {
+            for (std::int32_t i = 0; i < 10; ++i)
+            {
+                const std::string request = std::to_string(client_id) + "_" + std::to_string(i);
+                if (request_mapping(socket_path, request) != request)
+                {
+                    all_responses_correct = false;
+                }
+            }
+        });
+    }
+    for (std::thread& client_thread : client_threads)
+    {
+        client_thread.join();
+    }
+
+    server.stop();
+    server_thread.join();
+
+    ASSERT_TRUE(all_responses_correct);
+    ASSERT_EQ(number_of_requests, number_of_clients * 10);
+}
+
+TEST(TestCudamapperMappingServer, idle_client_is_disconnected)
+{
+    const std::string socket_path = get_test_socket_path("idle_client_is_disconnected");
+    MappingServer server(
+        socket_path,
+        [](const std::string& request) {
+            return request;
+        },
+        std::chrono::milliseconds(200));
+    std::thread server_thread([&server]() { server.run(); });
+
+    // connects, but never sends the end of its request
+    const int idle_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_GE(idle_fd, 0);
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+    ASSERT_EQ(connect(idle_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+
+    // other clients are served even if the idle one occupies a thread of the pool for a while
+    ASSERT_EQ(request_mapping(socket_path, "abc"), "abc");
+
+    // server closes the idle connection without a response
+    char buffer[16];
+    ASSERT_EQ(read(idle_fd, buffer, sizeof(buffer)), 0);
+    close(idle_fd);
+
+    server.stop();
+    server_thread.join();
+}
+
+TEST(TestCudamapperMappingServer, no_server)
+{
+    ASSERT_THROW(request_mapping(get_test_socket_path("no_server"), "abc"), std::runtime_error);
+}
+
+TEST(TestCudamapperMappingServer, socket_removed_after_server_is_destroyed)
+{
+    const std::string socket_path = get_test_socket_path("socket_removed_after_server_is_destroyed");
+    {
+        MappingServer server(socket_path,
+                             [](const std::string& request) {
+                                 return request;
+                             });
+        ASSERT_EQ(access(socket_path.c_str(), F_OK), 0);
+    }
+    ASSERT_NE(access(socket_path.c_str(), F_OK), 0);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
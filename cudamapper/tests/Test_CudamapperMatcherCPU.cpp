@@ -0,0 +1,61 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+#include "cudamapper_file_location.hpp"
+
+#include "../src/index_cpu.hpp"
+#include "../src/matcher_cpu.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+TEST(TestCudamapperMatcherCPU, AAAACTGAA_vs_GCCAAAG_2_3)
+{
+    // query: AAAACTGAA, sketch elements: AA(0f0), AA(1f0), AA(2f0), AA(7f0), AC(3f0), AG(4r0)
+    // target: GCCAAAG, sketch elements: AA(3f1), AA(4f1), AG(5f1), CA(2f1), CC(1f1), GC(0f1)
+    // matching representations: AA (4 x 2 anchors) and AG (1 x 1 anchor)
+    std::unique_ptr<io::FastaParser> parser = io::create_kseq_fasta_parser(std::string(CUDAMAPPER_BENCHMARK_DATA_DIR) + "/aaaactgaa_gccaaag.fasta");
+
+    const IndexCPU query_index(*parser, 0, 1, 2, 3, false);
+    const IndexCPU target_index(*parser, 1, 2, 2, 3, false);
+
+    MatcherCPU matcher(query_index, target_index);
+    const std::vector<Anchor>& anchors = matcher.anchors();
+
+    const std::vector<std::pair<position_in_read_t, position_in_read_t>> expected_positions = {{0, 3}, {0, 4}, {1, 3}, {1, 4}, {2, 3}, {2, 4}, {4, 5}, {7, 3}, {7, 4}};
+
+    ASSERT_EQ(anchors.size(), expected_positions.size());
+    for (std::size_t i = 0; i < expected_positions.size(); ++i)
+    {
+        EXPECT_EQ(anchors[i].query_read_id_, 0u) << "i: " << i;
+        EXPECT_EQ(anchors[i].target_read_id_, 1u) << "i: " << i;
+        EXPECT_EQ(anchors[i].query_position_in_read_, expected_positions[i].first) << "i: " << i;
+        EXPECT_EQ(anchors[i].target_position_in_read_, expected_positions[i].second) << "i: " << i;
+    }
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,114 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include "../src/overlapper_cpu.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+std::vector<Anchor> create_anchors(const read_id_t query_read_id,
+                                   const read_id_t target_read_id,
+                                   const std::vector<std::pair<position_in_read_t, position_in_read_t>>& positions)
+{
+    std::vector<Anchor> anchors;
+    for (const auto& position : positions)
+    {
+        Anchor anchor;
+        anchor.query_read_id_           = query_read_id;
+        anchor.target_read_id_          = target_read_id;
+        anchor.query_position_in_read_  = position.first;
+        anchor.target_position_in_read_ = position.second;
+        anchors.push_back(anchor);
+    }
+    return anchors;
+}
+
+} // namespace
+
+TEST(TestCudamapperOverlapperCPU, FourAnchorsOneOverlap)
+{
+    OverlapperCPU overlapper;
+
+    const std::vector<Anchor> anchors = create_anchors(1, 2, {{100, 1000}, {200, 1100}, {300, 1200}, {400, 1300}});
+
+    std::vector<Overlap> overlaps;
+    overlapper.get_overlaps(overlaps, anchors, false, 0, 0, 1000);
+    ASSERT_EQ(overlaps.size(), 1u);
+    ASSERT_EQ(overlaps[0].query_read_id_, 1u);
+    ASSERT_EQ(overlaps[0].target_read_id_, 2u);
+    ASSERT_EQ(overlaps[0].query_start_position_in_read_, 100u);
+    ASSERT_EQ(overlaps[0].query_end_position_in_read_, 400u);
+    ASSERT_EQ(overlaps[0].target_start_position_in_read_, 1000u);
+    ASSERT_EQ(overlaps[0].target_end_position_in_read_, 1300u);
+    ASSERT_EQ(overlaps[0].num_residues_, 4u);
+    ASSERT_EQ(overlaps[0].relative_strand, RelativeStrand::Forward);
+}
+
+TEST(TestCudamapperOverlapperCPU, ReverseStrand)
+{
+    OverlapperCPU overlapper;
+
+    const std::vector<Anchor> anchors = create_anchors(1, 2, {{100, 1300}, {200, 1200}, {300, 1100}, {400, 1000}});
+
+    std::vector<Overlap> overlaps;
+    overlapper.get_overlaps(overlaps, anchors, false, 0, 0, 1000);
+    ASSERT_EQ(overlaps.size(), 1u);
+    ASSERT_EQ(overlaps[0].target_start_position_in_read_, 1000u);
+    ASSERT_EQ(overlaps[0].target_end_position_in_read_, 1300u);
+    ASSERT_EQ(overlaps[0].relative_strand, RelativeStrand::Reverse);
+}
+
+TEST(TestCudamapperOverlapperCPU, TwoChainsFusedShortChainAndSelfMappingDropped)
+{
+    OverlapperCPU overlapper;
+
+    // read 1 vs read 2: two chains with a 500bp gap on both reads are fused into one overlap
+    std::vector<Anchor> anchors = create_anchors(1, 2, {{100, 1000}, {200, 1100}, {300, 1200}, {800, 1700}, {900, 1800}, {1000, 1900}});
+    // read 1 vs read 3: chain of two anchors is too short
+    const std::vector<Anchor> short_chain = create_anchors(1, 3, {{100, 100}, {200, 200}});
+    anchors.insert(std::end(anchors), std::begin(short_chain), std::end(short_chain));
+    // read 4 vs read 4: self mapping is dropped in all-to-all mode
+    const std::vector<Anchor> self_mapping = create_anchors(4, 4, {{100, 100}, {200, 200}, {300, 300}});
+    anchors.insert(std::end(anchors), std::begin(self_mapping), std::end(self_mapping));
+
+    std::vector<Overlap> overlaps;
+    overlapper.get_overlaps(overlaps, anchors, true, 0, 0, 1000);
+    ASSERT_EQ(overlaps.size(), 1u);
+    ASSERT_EQ(overlaps[0].query_read_id_, 1u);
+    ASSERT_EQ(overlaps[0].target_read_id_, 2u);
+    ASSERT_EQ(overlaps[0].query_start_position_in_read_, 100u);
+    ASSERT_EQ(overlaps[0].query_end_position_in_read_, 1000u);
+    ASSERT_EQ(overlaps[0].target_start_position_in_read_, 1000u);
+    ASSERT_EQ(overlaps[0].target_end_position_in_read_, 1900u);
+    ASSERT_EQ(overlaps[0].num_residues_, 6u);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,90 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "../src/read_list.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+TEST(TestCudamapperReadList, load_read_list)
+{
+    char file_template[]      = "/tmp/gw_read_list_XXXXXX";
+    const int file_descriptor = mkstemp(file_template);
+    ASSERT_NE(file_descriptor, -1);
+    close(file_descriptor);
+    {
+        std::ofstream read_list_file(file_template);
+        read_list_file << "read_0\n"
+                       << "\n"
+                       << ">read_1 comment\n"
+                       << "  @read_2\t\n"
+                       << "read_3\r\n";
+    }
+
+    const std::vector<std::string> expected_read_names = {"read_0", "read_1", "read_2", "read_3"};
+    EXPECT_EQ(load_read_list(file_template), expected_read_names);
+
+    std::remove(file_template);
+}
+
+TEST(TestCudamapperReadList, missing_read_list)
+{
+    EXPECT_THROW(load_read_list("/nonexistent/gw_read_list"), std::runtime_error);
+}
+
+TEST(TestCudamapperReadList, read_list_parser_keeps_listed_reads_in_order)
+{
+    const std::unique_ptr<io::FastaParser> parser = io::create_string_fasta_parser(">read_0\nAAAA\n>read_1\nCCCC\n>read_2\nGGGG\n>read_3\nTTTT\n");
+
+    const std::unique_ptr<io::FastaParser> read_list_parser = create_read_list_parser(*parser, {"read_3", "read_1", "not_in_file"});
+
+    ASSERT_EQ(read_list_parser->get_num_seqences(), 2);
+    EXPECT_EQ(read_list_parser->get_sequence_by_id(0).name, "read_1");
+    EXPECT_EQ(read_list_parser->get_sequence_by_id(0).seq, "CCCC");
+    EXPECT_EQ(read_list_parser->get_sequence_by_id(1).name, "read_3");
+    EXPECT_EQ(read_list_parser->get_sequence_by_id(1).seq, "TTTT");
+}
+
+TEST(TestCudamapperReadList, empty_read_list)
+{
+    const std::unique_ptr<io::FastaParser> parser = io::create_string_fasta_parser(">read_0\nAAAA\n");
+
+    EXPECT_EQ(create_read_list_parser(*parser, {})->get_num_seqences(), 0);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
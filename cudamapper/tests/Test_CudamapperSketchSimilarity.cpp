@@ -0,0 +1,107 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <claraparabricks/genomeworks/io/fasta_parser.hpp>
+
+#include "../src/index_cpu.hpp"
+#include "../src/sketch_similarity.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+TEST(TestCudamapperSketchSimilarity, similarity_measures)
+{
+    const SketchSimilarity similarity{0, 1, 25, 50, 100};
+    EXPECT_DOUBLE_EQ(jaccard_index(similarity), 0.2);
+    EXPECT_DOUBLE_EQ(containment(similarity), 0.5);
+    EXPECT_NEAR(mash_distance(similarity, 15), -1.0 / 15 * std::log(2.0 * 0.2 / 1.2), 1e-12);
+
+    const SketchSimilarity identical{0, 1, 40, 40, 40};
+    EXPECT_DOUBLE_EQ(jaccard_index(identical), 1.0);
+    EXPECT_DOUBLE_EQ(mash_distance(identical, 15), 0.0);
+
+    const SketchSimilarity unrelated{0, 1, 0, 40, 40};
+    EXPECT_DOUBLE_EQ(mash_distance(unrelated, 15), 1.0);
+}
+
+TEST(TestCudamapperSketchSimilarity, all_to_all_in_one_index)
+{
+    // read_1 is a copy of read_0, read_2 is the first half of read_0, read_3 is unrelated
+    const std::string read_0 = "ACGTTGCAAGCTTCGATCGGATCCTAGGCATGCAATTGCCGGTACCTTAAGGCTAGCTAG";
+    const std::string read_3 = "TTGACCATGGATCAGTCCAGTTACGGCATACGTAGGACTTTGACAGTCAGGTACCAATGC";
+    const std::unique_ptr<io::FastaParser> parser = io::create_string_fasta_parser(">read_0\n" + read_0 +
+                                                                                   "\n>read_1\n" + read_0 +
+                                                                                   "\n>read_2\n" + read_0.substr(0, 30) +
+                                                                                   "\n>read_3\n" + read_3 + "\n");
+    const IndexCPU index(*parser, 0, 4, 11, 3, true, 1.0);
+
+    const std::vector<SketchSimilarity> similarities = find_sketch_similarities(index, index, true, 0.9);
+
+    ASSERT_EQ(similarities.size(), 3u);
+    // identical reads
+    EXPECT_EQ(similarities[0].query_read_id, 0u);
+    EXPECT_EQ(similarities[0].target_read_id, 1u);
+    EXPECT_DOUBLE_EQ(jaccard_index(similarities[0]), 1.0);
+    // read_2 is contained in both copies of read_0
+    EXPECT_EQ(similarities[1].query_read_id, 0u);
+    EXPECT_EQ(similarities[1].target_read_id, 2u);
+    EXPECT_GE(containment(similarities[1]), 0.9);
+    EXPECT_LT(jaccard_index(similarities[1]), 1.0);
+    EXPECT_EQ(similarities[2].query_read_id, 1u);
+    EXPECT_EQ(similarities[2].target_read_id, 2u);
+
+    const std::string formatted = format_sketch_similarities({similarities[0]}, *parser, *parser, 11);
+    const std::string expected  = "read_0\tread_1\t0.000000\t1.000000\t1.000000\t" +
+                                 std::to_string(similarities[0].shared_representations) + '\t' +
+                                 std::to_string(similarities[0].shared_representations) + '\t' +
+                                 std::to_string(similarities[0].shared_representations) + '\n';
+    EXPECT_EQ(formatted, expected);
+}
+
+TEST(TestCudamapperSketchSimilarity, different_indices)
+{
+    const std::string read_0 = "ACGTTGCAAGCTTCGATCGGATCCTAGGCATGCAATTGCCGGTACCTTAAGGCTAGCTAG";
+    const std::unique_ptr<io::FastaParser> query_parser  = io::create_string_fasta_parser(">query_0\n" + read_0 + "\n");
+    const std::unique_ptr<io::FastaParser> target_parser = io::create_string_fasta_parser(">target_0\nTTGACCATGGATCAGTCCAGTTACGGCATACGTAGGACTTTGACAGTCAGGTACCAATGC\n>target_1\n" + read_0 + "\n");
+    const IndexCPU query_index(*query_parser, 0, 1, 11, 3, true, 1.0);
+    const IndexCPU target_index(*target_parser, 0, 2, 11, 3, true, 1.0);
+
+    const std::vector<SketchSimilarity> similarities = find_sketch_similarities(query_index, target_index, false, 0.0);
+
+    ASSERT_EQ(similarities.size(), 1u);
+    EXPECT_EQ(similarities[0].query_read_id, 0u);
+    EXPECT_EQ(similarities[0].target_read_id, 1u);
+    EXPECT_DOUBLE_EQ(containment(similarities[0]), 1.0);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
@@ -0,0 +1,203 @@
+/*
+* Copyright 2019-2020 NVIDIA CORPORATION.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../src/streaming_fasta_reader.hpp"
+
+namespace claraparabricks
+{
+
+namespace genomeworks
+{
+
+namespace cudamapper
+{
+
+namespace
+{
+
+void write_to_fd(const int fd, const std::string& data)
+{
+    ASSERT_EQ(write(fd, data.data(), data.size()), static_cast<ssize_t>(data.size()));
+}
+
+std::vector<std::string> get_read_names(const io::FastaParser& parser)
+{
+    std::vector<std::string> names;
+    for (read_id_t read_id = 0; read_id < parser.get_num_seqences(); ++read_id)
+    {
+        names.push_back(parser.get_sequence_by_id(read_id).name);
+    }
+    return names;
+}
+
+} // namespace
+
+TEST(TestCudamapperStreamingFastaReader, find_end_of_complete_records_fasta)
+{
+    ASSERT_EQ(find_end_of_complete_records(""), 0u);
+    ASSERT_EQ(find_end_of_complete_records(">read_0\nACGT"), 0u);
+    ASSERT_EQ(find_end_of_complete_records(">read_0\nACGT\n"), 0u); // next read might still continue this one
+    ASSERT_EQ(find_end_of_complete_records(">read_0\nACGT\n>"), 13u);
+    ASSERT_EQ(find_end_of_complete_records(">read_0\nACGT\nAC\n>read_1\nAA\n>read_2"), 27u);
+}
+
+TEST(TestCudamapperStreamingFastaReader, find_end_of_complete_records_fastq)
+{
+    ASSERT_EQ(find_end_of_complete_records("@read_0\nACGT\n+\nII"), 0u);
+    ASSERT_EQ(find_end_of_complete_records("@read_0\nACGT\n+\nIIII\n"), 20u);
+    // '@' at the beginning of quality line is not a new record
+    ASSERT_EQ(find_end_of_complete_records("@read_0\nACGT\n+\n@III\n@read_1\nAC\n+\n@"), 20u);
+    // multiline sequence and quality
+    ASSERT_EQ(find_end_of_complete_records("@read_0\nAC\nGT\n+\nII\nII\n@read_1\n"), 22u);
+}
+
+TEST(TestCudamapperStreamingFastaReader, chunks_limited_by_basepairs)
+{
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    write_to_fd(pipe_fds[1], ">read_0\nAAAA\n>read_1\nCCCC\n>read_2\nGGGGGGGGGG\n>read_3\nTT\n>read_4\nA\n");
+    close(pipe_fds[1]);
+
+    StreamingFastaReader reader(pipe_fds[0], 8, std::chrono::milliseconds(10'000), 2);
+
+    std::unique_ptr<io::FastaParser> chunk = reader.get_next_chunk();
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(get_read_names(*chunk), std::vector<std::string>({"read_0", "read_1"}));
+    // read longer than max_basepairs_per_chunk gets its own chunk
+    chunk = reader.get_next_chunk();
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(get_read_names(*chunk), std::vector<std::string>({"read_2"}));
+    // read_4 is shorter than min_sequence_length
+    chunk = reader.get_next_chunk();
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(get_read_names(*chunk), std::vector<std::string>({"read_3"}));
+    ASSERT_EQ(chunk->get_sequence_by_id(0).seq, "TT");
+    ASSERT_EQ(reader.get_next_chunk(), nullptr);
+
+    close(pipe_fds[0]);
+}
+
+TEST(TestCudamapperStreamingFastaReader, chunks_limited_by_latency)
+{
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    StreamingFastaReader reader(pipe_fds[0], 1'000'000, std::chrono::milliseconds(200));
+
+    // read_1 is not complete yet, but read_0 should not wait for it longer than max_latency
+    write_to_fd(pipe_fds[1], "@read_0\nACGT\n+\nIIII\n@read_1\nAC");
+    const auto start                       = std::chrono::steady_clock::now();
+    std::unique_ptr<io::FastaParser> chunk = reader.get_next_chunk();
+    const auto waited                      = std::chrono::steady_clock::now() - start;
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(get_read_names(*chunk), std::vector<std::string>({"read_0"}));
+    ASSERT_GE(waited, std::chrono::milliseconds(150));
+    ASSERT_LT(waited, std::chrono::milliseconds(5'000));
+
+    std::thread writer([&pipe_fds]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        write_to_fd(pipe_fds[1], "GT\n+\nIIII\n");
+        close(pipe_fds[1]);
+    });
+    chunk = reader.get_next_chunk();
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(get_read_names(*chunk), std::vector<std::string>({"read_1"}));
+    ASSERT_EQ(chunk->get_sequence_by_id(0).seq, "ACGT");
+    ASSERT_EQ(reader.get_next_chunk(), nullptr);
+    writer.join();
+
+    close(pipe_fds[0]);
+}
+
+TEST(TestCudamapperStreamingFastaReader, last_fasta_record_returned_after_latency)
+{
+    int pipe_fds[2];
+    ASSERT_EQ(pipe(pipe_fds), 0);
+
+    StreamingFastaReader reader(pipe_fds[0], 1'000'000, std::chrono::milliseconds(200));
+
+    // no header of a following record and no end of input, read_0 should still not wait longer than max_latency
+    write_to_fd(pipe_fds[1], ">read_0\nACGT\n");
+    const auto start                       = std::chrono::steady_clock::now();
+    std::unique_ptr<io::FastaParser> chunk = reader.get_next_chunk();
+    const auto waited                      = std::chrono::steady_clock::now() - start;
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(get_read_names(*chunk), std::vector<std::string>({"read_0"}));
+    ASSERT_EQ(chunk->get_sequence_by_id(0).seq, "ACGT");
+    ASSERT_GE(waited, std::chrono::milliseconds(150));
+    ASSERT_LT(waited, std::chrono::milliseconds(5'000));
+
+    write_to_fd(pipe_fds[1], ">read_1\nAC");
+    close(pipe_fds[1]);
+    chunk = reader.get_next_chunk();
+    ASSERT_NE(chunk, nullptr);
+    ASSERT_EQ(get_read_names(*chunk), std::vector<std::string>({"read_1"}));
+    ASSERT_EQ(reader.get_next_chunk(), nullptr);
+
+    close(pipe_fds[0]);
+}
+
+TEST(TestCudamapperStreamingFastaReader, follow_growing_file)
+{
+    char file_path[] = "/tmp/gw_cudamapper_streaming_XXXXXX";
+    const int write_fd = mkstemp(file_path);
+    ASSERT_GE(write_fd, 0);
+    const int read_fd = open(file_path, O_RDONLY);
+    ASSERT_GE(read_fd, 0);
+
+    write_to_fd(write_fd, ">read_0\nACGT\n");
+
+    StreamingFastaReader reader(read_fd, 1'000'000, std::chrono::milliseconds(50), 0, true, std::chrono::milliseconds(500));
+
+    std::thread writer([write_fd]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        write_to_fd(write_fd, ">read_1\nACGT\n");
+    });
+
+    std::vector<std::string> read_names;
+    while (std::unique_ptr<io::FastaParser> chunk = reader.get_next_chunk())
+    {
+        const std::vector<std::string> chunk_read_names = get_read_names(*chunk);
+        read_names.insert(std::end(read_names), std::begin(chunk_read_names), std::end(chunk_read_names));
+    }
+    writer.join();
+
+    // reader stops after idle_timeout without new data
+    ASSERT_EQ(read_names, std::vector<std::string>({"read_0", "read_1"}));
+
+    close(read_fd);
+    close(write_fd);
+    std::remove(file_path);
+}
+
+} // namespace cudamapper
+
+} // namespace genomeworks
+
+} // namespace claraparabricks
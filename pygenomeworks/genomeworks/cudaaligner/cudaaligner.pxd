@@ -44,6 +44,17 @@ cdef extern from "claraparabricks/genomeworks/cudaaligner/cudaaligner.hpp" \
     cdef enum AlignmentType:
         global_alignment = 0
         unset
+        semi_global_alignment
+        extension_alignment
+        global_affine_alignment
+        semi_global_affine_alignment
+        local_alignment
+
+    ctypedef struct AffineGapScores:
+        int32_t match
+        int32_t mismatch
+        int32_t gap_open
+        int32_t gap_extend
 
     cdef enum AlignmentState:
         match = 0
@@ -81,3 +92,5 @@ cdef extern from "claraparabricks/genomeworks/cudaaligner/aligner.hpp" \
         void reset() except +
 
     unique_ptr[Aligner] create_aligner(int32_t, int32_t, int32_t, AlignmentType, _Stream, int32_t, int64_t)
+    unique_ptr[Aligner] create_cpu_aligner(int32_t, int32_t, int32_t, AlignmentType) except +
+    unique_ptr[Aligner] create_cpu_aligner(int32_t, int32_t, int32_t, AlignmentType, const AffineGapScores&) except +
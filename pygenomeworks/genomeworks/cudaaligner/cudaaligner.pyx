@@ -95,6 +95,16 @@ class CudaAlignment:
         """
         if t == cudaaligner.global_alignment:
             return "global"
+        elif t == cudaaligner.semi_global_alignment:
+            return "semi_global"
+        elif t == cudaaligner.extension_alignment:
+            return "extension"
+        elif t == cudaaligner.global_affine_alignment:
+            return "global_affine"
+        elif t == cudaaligner.semi_global_affine_alignment:
+            return "semi_global_affine"
+        elif t == cudaaligner.local_alignment:
+            return "local"
         else:
             raise RuntimeError("Unknown alignment type encountered: " + t)
 
@@ -140,6 +150,7 @@ cdef class CudaAlignerBatch:
             stream=None,
             device_id=0,
             max_device_memory_allocator_caching_size=-1,
+            backend="gpu",
             *args,
             **kwargs):
         """Construct a CudaAligner object to run CUDA-accelerated sequence
@@ -149,12 +160,16 @@ cdef class CudaAlignerBatch:
             max_query_length - Max length of query string
             max_target_length - Max length of target string
             max_alignments - Maximum number of alignments to perform
-            alignment_type - Type of alignment (only global supported right now)
+            alignment_type - Type of alignment, "global", "semi_global", "extension", "global_affine",
+            "semi_global_affine" or "local" (all but global are only supported by the cpu backend, affine and
+            local types use match 2, mismatch -4, gap open -4 and gap extend -2)
             stream - CUDA stream for running kernel
             device_id - GPU device to use for running kernels
             max_device_memory_allocator_caching_size - Maximum amount of device memory to use for cached memory
             allocations the cudaaligner instance. max_device_memory_allocator_caching_size = -1 (default) means
             all available device memory.
+            backend - "gpu" runs the alignments on the GPU, "cpu" runs them on the CPU thread pool
+            (stream, device_id and max_device_memory_allocator_caching_size are ignored for "cpu")
         """
         cdef size_t st
         cdef _Stream temp_stream
@@ -170,8 +185,45 @@ cdef class CudaAlignerBatch:
         cdef cudaaligner.AlignmentType alignment_type_enum
         if (alignment_type == "global"):
             alignment_type_enum = cudaaligner.global_alignment
+        elif (alignment_type == "semi_global"):
+            alignment_type_enum = cudaaligner.semi_global_alignment
+        elif (alignment_type == "extension"):
+            alignment_type_enum = cudaaligner.extension_alignment
+        elif (alignment_type == "global_affine"):
+            alignment_type_enum = cudaaligner.global_affine_alignment
+        elif (alignment_type == "semi_global_affine"):
+            alignment_type_enum = cudaaligner.semi_global_affine_alignment
+        elif (alignment_type == "local"):
+            alignment_type_enum = cudaaligner.local_alignment
         else:
-            raise RuntimeError("Unknown alignment_type provided. Must be global.")
+            raise RuntimeError("Unknown alignment_type provided. "
+                               "Must be global, semi_global, extension, global_affine, semi_global_affine or local.")
+
+        if (alignment_type != "global" and backend != "cpu"):
+            raise RuntimeError("alignment_type " + alignment_type + " is only supported by the cpu backend.")
+
+        cdef cudaaligner.AffineGapScores affine_gap_scores
+        if (backend == "cpu"):
+            if (alignment_type in ("global_affine", "semi_global_affine", "local")):
+                affine_gap_scores.match = 2
+                affine_gap_scores.mismatch = -4
+                affine_gap_scores.gap_open = -4
+                affine_gap_scores.gap_extend = -2
+                self.aligner = cudaaligner.create_cpu_aligner(
+                    max_query_length,
+                    max_target_length,
+                    max_alignments,
+                    alignment_type_enum,
+                    affine_gap_scores)
+            else:
+                self.aligner = cudaaligner.create_cpu_aligner(
+                    max_query_length,
+                    max_target_length,
+                    max_alignments,
+                    alignment_type_enum)
+            return
+        elif (backend != "gpu"):
+            raise RuntimeError("Unknown backend provided. Must be gpu or cpu.")
 
         self.aligner = cudaaligner.create_aligner(
             max_query_length,
@@ -191,6 +243,7 @@ cdef class CudaAlignerBatch:
             stream=None,
             device_id=0,
             max_device_memory_allocator_caching_size=-1,
+            backend="gpu",
             *args,
             **kwargs):
         """Dummy implementation of __init__ function to allow